@@ -6,7 +6,7 @@
 -- Author     : Peter Schakel
 -- Company    : KVI
 -- Created    : 2012-09-11
--- Last update: 2012-09-28
+-- Last update: 2012-10-22
 -- Platform   : FPGA-generic
 -- Standard   : VHDL'93
 -------------------------------------------------------------------------------
@@ -20,6 +20,13 @@
 -- The serial burst has 4 clock cycles per bit. The timestamp is extended with a Reed Solomon code for Forward Error Correction.
 -- The timestamp can be set with the Whishbone Bus. This value is activated on the next PPS pulse. See TimestampEncoder.vhd.
 -- The Whishbone Bus addresses are described in the wb_BuTiSclock documentation.
+-- The phase of the BuTiS clock can be calibrated in hardware: all PLL phase steps are swept and the
+-- received timestamp bursts from the TimestampDecoder are checked on each step, see PLL_phasecalibration.vhd.
+-- With the 'use calibrated phase' bit set the centre of the error-free eye is used and the calibration
+-- is repeated automatically each time the PLLs get locked.
+-- With the 'track phase' bit set the slow drift of the BuTiS C2 phase is corrected continuously
+-- by adding an offset to the PLL phase, see PLL_phasetracker.vhd. The last 32 phase errors of the tracker
+-- can be read at Wishbone offset 0x80 (32 words).
 -- 
 -- Generics
 --
@@ -30,6 +37,10 @@
 --     gpio_slave_i : Record with Whishbone Bus signals
 --     wr_clock_i : White Rabbit 125MHz clock
 --     wr_PPSpulse_i : White Rabbit PPS pulse
+--     decoder_clock_i : clock of the TimestampDecoder that receives the BuTis T0 signal with timestamp
+--     decoder_write_i : TimestampDecoder has a new timestamp
+--     decoder_corrected_i : TimestampDecoder has corrected the timestamp
+--     decoder_error_i : TimestampDecoder could not correct the timestamp
 --
 -- Outputs
 --     gpio_slave_o : Record with Whishbone Bus signals
@@ -42,6 +53,9 @@
 --     wb_BuTiSclock : module with interface to Wishbone bus, generated by wbgen2
 --     PLL125MHz200MHz : Altera PLL for generating 200MHz from 125 MHz
 --     TimestampEncoder : Encoder for 64-bits timestamp into serial burst
+--     PLL_setphase : sets the phase of the PLL
+--     PLL_phasecalibration : sweeps the phase of the PLL to find the centre of the error-free eye
+--     PLL_phasetracker : tracks the phase drift of the BuTiS clock and calculates a phase offset
 --
 --
 -------------------------------------------------------------------------------
@@ -80,7 +94,11 @@ entity BuTiS_clock_generator is
 		BuTis_C2_o                             : out std_logic;
 		BuTis_T0_o                             : out std_logic;
 		BuTis_T0_timestamp_o                   : out std_logic;
-		error_o                                : out std_logic);
+		error_o                                : out std_logic;
+		decoder_clock_i                        : in  std_logic;
+		decoder_write_i                        : in  std_logic;
+		decoder_corrected_i                    : in  std_logic;
+		decoder_error_i                        : in  std_logic);
 end BuTiS_clock_generator;
 
 architecture rtl of BuTiS_clock_generator is
@@ -92,7 +110,7 @@ component wb_BuTiSclock is
 -- 
     wb_clk_i                                 : in     std_logic;
 -- 
-    wb_addr_i                                : in     std_logic_vector(1 downto 0);
+    wb_addr_i                                : in     std_logic_vector(2 downto 0);
 -- 
     wb_data_i                                : in     std_logic_vector(31 downto 0);
 -- 
@@ -120,14 +138,39 @@ component wb_BuTiSclock is
 -- Ports for PASS_THROUGH field: 'reset phase-PLL' in reg: 'BuTis clock generator control'
     wbbutis_control_reset_o                  : out    std_logic_vector(0 downto 0);
     wbbutis_control_reset_wr_o               : out    std_logic;
+-- Ports for PASS_THROUGH field: 'Calibrate phase' in reg: 'BuTis clock generator control'
+    wbbutis_control_calibrate_o              : out    std_logic_vector(0 downto 0);
+    wbbutis_control_calibrate_wr_o           : out    std_logic;
+-- Port for std_logic_vector field: 'Use calibrated phase' in reg: 'BuTis clock generator control'
+    wbbutis_control_usecal_o                 : out    std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'Track phase' in reg: 'BuTis clock generator control'
+    wbbutis_control_track_o                  : out    std_logic_vector(0 downto 0);
 -- Port for std_logic_vector field: 'unused' in reg: 'BuTis clock generator control'
-    wbbutis_control_unused_o                 : out    std_logic_vector(4 downto 0);
+    wbbutis_control_unused_o                 : out    std_logic_vector(1 downto 0);
 -- Port for std_logic_vector field: 'PLLphase' in reg: 'BuTis clock generator control'
     wbbutis_control_phase_o                  : out    std_logic_vector(7 downto 0);
 -- Port for std_logic_vector field: 'timestamp set busy' in reg: 'BuTis clock generator Status'
     wbbutis_status_set_i                     : in     std_logic_vector(0 downto 0);
 -- Port for std_logic_vector field: 'Phase of the PPS' in reg: 'BuTis clock generator Status'
-    wbbutis_status_ppsphase_i                : in     std_logic_vector(0 downto 0)
+    wbbutis_status_ppsphase_i                : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'Calibration busy' in reg: 'BuTis clock generator Status'
+    wbbutis_status_calbusy_i                 : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'Eye found' in reg: 'BuTis clock generator Status'
+    wbbutis_status_eyefound_i                : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'Calibrated phase' in reg: 'BuTis clock generator Status'
+    wbbutis_status_calphase_i                : in     std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'Eye width' in reg: 'BuTis clock generator Status'
+    wbbutis_status_eyewidth_i                : in     std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'Eye map' in reg: 'BuTis phase calibration eye map'
+    wbbutis_eyemap_map_i                     : in     std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Phase error' in reg: 'BuTis phase tracker status'
+    wbbutis_tracker_error_i                  : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'Phase offset' in reg: 'BuTis phase tracker status'
+    wbbutis_tracker_offset_i                 : in     std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'Locked' in reg: 'BuTis phase tracker status'
+    wbbutis_tracker_locked_i                 : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'Trace index' in reg: 'BuTis phase tracker status'
+    wbbutis_tracker_index_i                  : in     std_logic_vector(4 downto 0)
   );
 end component;
 
@@ -165,7 +208,57 @@ END component;
 		phase_i                                : in std_logic_vector(7 downto 0);
 		phasedone_i                            : in std_logic;
 		phasestep_o                            : out std_logic;
-		phaseupdown_o                          : out std_logic
+		phaseupdown_o                          : out std_logic;
+		ready_o                                : out std_logic
+   );
+  end component;
+
+  component PLL_phasecalibration is
+	generic(
+		g_phasesteps                           : integer := 28;
+		g_bursts                               : integer := 64;
+		g_settlebursts                         : integer := 4;
+		g_timeout                              : integer := 2500
+	);
+	port(
+		clock_i                                : in std_logic;
+		reset_i                                : in std_logic;
+		start_i                                : in std_logic;
+		ready_i                                : in std_logic;
+		burst_i                                : in std_logic;
+		corrected_i                            : in std_logic;
+		error_i                                : in std_logic;
+		phase_o                                : out std_logic_vector(7 downto 0);
+		busy_o                                 : out std_logic;
+		eyefound_o                             : out std_logic;
+		eyecentre_o                            : out std_logic_vector(7 downto 0);
+		eyewidth_o                             : out std_logic_vector(7 downto 0);
+		eyemap_o                               : out std_logic_vector(31 downto 0)
+   );
+  end component;
+
+  component PLL_phasetracker is
+	generic(
+		g_avgbits                              : integer := 12;
+		g_lockthreshold                        : integer := 16;
+		g_kp                                   : integer := 13107;
+		g_ki                                   : integer := 1311;
+		g_fkp                                  : integer := 65536/4;
+		g_fki                                  : integer := 65536/64
+	);
+	port(
+		clock_i                                : in std_logic;
+		reset_i                                : in std_logic;
+		enable_i                               : in std_logic;
+		wr_clock_i                             : in std_logic;
+		wr_PPSpulse_i                          : in std_logic;
+		BuTis_C2_i                             : in std_logic;
+		trace_index_i                          : in std_logic_vector(4 downto 0);
+		offset_o                               : out std_logic_vector(7 downto 0);
+		phase_error_o                          : out std_logic_vector(15 downto 0);
+		locked_o                               : out std_logic;
+		trace_wrindex_o                        : out std_logic_vector(4 downto 0);
+		trace_data_o                           : out std_logic_vector(31 downto 0)
    );
   end component;
 
@@ -174,7 +267,8 @@ END component;
 		g_timestampbytes                         : integer := 8;
 		g_clockcyclesperbit                      : integer := 4;
 		g_RScodewords                            : integer := 4;
-		g_BuTis_ratio                            : integer := 2000);
+		g_BuTis_ratio                            : integer := 2000;
+		g_RSclockdivisor                         : integer := 2);
   port(
 		BuTis_C2_i                               : in  std_logic;
 		BuTis_T0_i                               : in  std_logic;
@@ -248,6 +342,45 @@ END component;
   signal wbbutis_control_phase_sync_s          : std_logic_vector(7 downto 0);
   signal wbbutis_status_set_s                  : std_logic_vector(0 downto 0);  
   signal wbbutis_status_ppsphase_s             : std_logic_vector(0 downto 0);
+  signal wbbutis_control_calibrate_s           : std_logic_vector(0 downto 0);
+  signal wbbutis_control_calibrate_wr_s        : std_logic;
+  signal wbbutis_control_usecal_s              : std_logic_vector(0 downto 0);
+  signal wbbutis_status_calbusy_s              : std_logic_vector(0 downto 0);
+  signal wbbutis_status_eyefound_s             : std_logic_vector(0 downto 0);
+  signal wbbutis_status_calphase_s             : std_logic_vector(7 downto 0);
+  signal wbbutis_status_eyewidth_s             : std_logic_vector(7 downto 0);
+  signal wbbutis_eyemap_map_s                  : std_logic_vector(31 downto 0);
+  signal phase_target_s                        : std_logic_vector(7 downto 0) := (others => '0');
+  signal phase_base_s                          : std_logic_vector(7 downto 0) := (others => '0');
+  signal phase_base_prev_s                     : std_logic_vector(7 downto 0) := (others => '0');
+  signal wbbutis_control_track_s               : std_logic_vector(0 downto 0);
+  signal wbbutis_tracker_error_s               : std_logic_vector(15 downto 0);
+  signal wbbutis_tracker_offset_s              : std_logic_vector(7 downto 0);
+  signal wbbutis_tracker_locked_s              : std_logic_vector(0 downto 0);
+  signal wbbutis_tracker_index_s               : std_logic_vector(4 downto 0);
+  signal tracker_enable_s                      : std_logic := '0';
+  signal tracker_reset_s                       : std_logic := '0';
+  signal trace_data_s                          : std_logic_vector(31 downto 0);
+  signal wb_slave_stb_s                        : std_logic := '0';
+  signal wb_slave_ack_s                        : std_logic := '0';
+  signal wb_slave_dat_s                        : std_logic_vector(31 downto 0);
+  signal trace_ack_s                           : std_logic := '0';
+  signal trace_rddata_s                        : std_logic_vector(31 downto 0);
+  signal calibration_phase_s                   : std_logic_vector(7 downto 0);
+  signal calibration_start_s                   : std_logic := '0';
+  signal setphase_ready_s                      : std_logic := '0';
+  signal setphase_ready_sync0_s                : std_logic := '0';
+  signal setphase_ready_sync1_s                : std_logic := '0';
+  signal setphase_enable_sync0_s               : std_logic := '0';
+  signal setphase_enable_sync1_s               : std_logic := '0';
+  signal setphase_enable_sync2_s               : std_logic := '0';
+  signal decoder_corrected_s                   : std_logic := '0';
+  signal decoder_error_s                       : std_logic := '0';
+  signal decoder_toggle_s                      : std_logic := '0';
+  signal decoder_toggle_sync0_s                : std_logic := '0';
+  signal decoder_toggle_sync1_s                : std_logic := '0';
+  signal decoder_toggle_sync2_s                : std_logic := '0';
+  signal burst_s                               : std_logic := '0';
   signal phasecounterselect_S                  : std_logic_vector(3 downto 0) := (others => '0');
   signal phasestep_S                           : std_logic := '0';
   signal phaseupdown_S                         : std_logic := '0';
@@ -309,17 +442,32 @@ BuTis_T0_o <= BuTis_T0_s;
 BuTis_C2_o <= BuTiS_C2_s;
 BuTis_C2_ph0_o <= BuTiS_C2_ph0_s;
 
+-- the trace buffer of the phase tracker is read at offset 0x80, the registers are below
+wb_slave_stb_s <= gpio_slave_i.stb and (not gpio_slave_i.adr(7));
+gpio_slave_o.ack <= wb_slave_ack_s or trace_ack_s;
+gpio_slave_o.dat <= trace_rddata_s when trace_ack_s='1' else wb_slave_dat_s;
+
+-- process to read the trace buffer: the data is registered with the request, every strobe
+-- is acknowledged one cycle later, never stalls
+trace_read_process: process(clk_sys_i)
+begin
+	if rising_edge(clk_sys_i) then
+		trace_ack_s <= gpio_slave_i.cyc and gpio_slave_i.stb and gpio_slave_i.adr(7);
+		trace_rddata_s <= trace_data_s;
+	end if;
+end process;
+
 wb_BuTiSclock1: wb_BuTiSclock port map(
 		rst_n_i => rst_n_i,
 		wb_clk_i => clk_sys_i,
-		wb_addr_i => gpio_slave_i.adr(3 downto 2),
+		wb_addr_i => gpio_slave_i.adr(4 downto 2),
 		wb_data_i => gpio_slave_i.dat,
-		wb_data_o => gpio_slave_o.dat,
+		wb_data_o => wb_slave_dat_s,
 		wb_cyc_i => gpio_slave_i.cyc,
 		wb_sel_i => gpio_slave_i.sel,
-		wb_stb_i => gpio_slave_i.stb,
+		wb_stb_i => wb_slave_stb_s,
 		wb_we_i => gpio_slave_i.we,
-		wb_ack_o => gpio_slave_o.ack ,
+		wb_ack_o => wb_slave_ack_s,
 		wbbutis_timestamp_lw_o => wbbutis_timestamp_lw_s,
 		wbbutis_timestamp_hw_o => wbbutis_timestamp_hw_s,
 		wbbutis_control_set_o => wbbutis_control_set_s,
@@ -328,10 +476,23 @@ wb_BuTiSclock1: wb_BuTiSclock port map(
 		wbbutis_control_sync_wr_o => wbbutis_control_sync_wr_s,
 		wbbutis_control_reset_o => wbbutis_control_reset_s,
 		wbbutis_control_reset_wr_o => wbbutis_control_reset_wr_s,
+		wbbutis_control_calibrate_o => wbbutis_control_calibrate_s,
+		wbbutis_control_calibrate_wr_o => wbbutis_control_calibrate_wr_s,
+		wbbutis_control_usecal_o => wbbutis_control_usecal_s,
+		wbbutis_control_track_o => wbbutis_control_track_s,
 		wbbutis_control_unused_o => open,
 		wbbutis_control_phase_o => wbbutis_control_phase_s,
 		wbbutis_status_set_i => wbbutis_status_set_s,
-		wbbutis_status_ppsphase_i => wbbutis_status_ppsphase_s);
+		wbbutis_status_ppsphase_i => wbbutis_status_ppsphase_s,
+		wbbutis_status_calbusy_i => wbbutis_status_calbusy_s,
+		wbbutis_status_eyefound_i => wbbutis_status_eyefound_s,
+		wbbutis_status_calphase_i => wbbutis_status_calphase_s,
+		wbbutis_status_eyewidth_i => wbbutis_status_eyewidth_s,
+		wbbutis_eyemap_map_i => wbbutis_eyemap_map_s,
+		wbbutis_tracker_error_i => wbbutis_tracker_error_s,
+		wbbutis_tracker_offset_i => wbbutis_tracker_offset_s,
+		wbbutis_tracker_locked_i => wbbutis_tracker_locked_s,
+		wbbutis_tracker_index_i => wbbutis_tracker_index_s);
 
 --wr_clockdiv5clks_s(3 downto 1) <= (others => '0');
 --altclkctrl1: altclkctrl
@@ -400,7 +561,7 @@ begin
 		else
 			reset_phasePLL_s <= '0';
 		end if;
-		wbbutis_control_phase_sync_s <= wbbutis_control_phase_s;
+		wbbutis_control_phase_sync_s <= phase_target_s;
 		if (PLL_locked_s='1') and (phasePLL_locked_s='1') then
 			setphase_enable_S <= '1';
 		else
@@ -416,7 +577,102 @@ PLL_setphase1: PLL_setphase port map(
 		phase_i => wbbutis_control_phase_sync_s,
 		phasedone_i => phasedone_s,
 		phasestep_o => phasestep_S,
-		phaseupdown_o => phaseupdown_S);
+		phaseupdown_o => phaseupdown_S,
+		ready_o => setphase_ready_s);
+
+-- process to pass each received timestamp burst with its status from the decoder clock to clk_sys_i with a toggle
+decoderburst_process: process(decoder_clock_i)
+begin
+	if rising_edge(decoder_clock_i) then
+		if decoder_write_i='1' then
+			decoder_corrected_s <= decoder_corrected_i;
+			decoder_error_s <= decoder_error_i;
+			decoder_toggle_s <= not decoder_toggle_s;
+		end if;
+	end if;
+end process;
+
+-- process to start the calibration on command, or automatically when the PLLs get locked and the calibrated phase is used
+calibration_control_process: process(clk_sys_i)
+begin
+	if rising_edge(clk_sys_i) then
+		if ((wbbutis_control_calibrate_wr_s='1') and (wbbutis_control_calibrate_s(0)='1')) 
+				or ((setphase_enable_sync1_s='1') and (setphase_enable_sync2_s='0') and (wbbutis_control_usecal_s(0)='1')) then
+			calibration_start_s <= '1';
+		else
+			calibration_start_s <= '0';
+		end if;
+		if decoder_toggle_sync1_s/=decoder_toggle_sync2_s then
+			burst_s <= '1';
+		else
+			burst_s <= '0';
+		end if;
+		if wbbutis_status_calbusy_s(0)='1' then
+			phase_base_s <= calibration_phase_s;
+		elsif (wbbutis_control_usecal_s(0)='1') and (wbbutis_status_eyefound_s(0)='1') then
+			phase_base_s <= wbbutis_status_calphase_s;
+		else
+			phase_base_s <= wbbutis_control_phase_s;
+		end if;
+		phase_base_prev_s <= phase_base_s;
+		if (wbbutis_control_track_s(0)='1') and (setphase_enable_sync1_s='1') and (wbbutis_status_calbusy_s(0)='0') then
+			tracker_enable_s <= '1';
+		else
+			tracker_enable_s <= '0';
+		end if;
+		if (reset_s='1') or (phase_base_s/=phase_base_prev_s) then -- new reference phase for the tracker
+			tracker_reset_s <= '1';
+		else
+			tracker_reset_s <= '0';
+		end if;
+		if tracker_enable_s='0' then
+			phase_target_s <= phase_base_s;
+		elsif (wbbutis_tracker_offset_s(7)='1') and (conv_integer(not wbbutis_tracker_offset_s)>=conv_integer(phase_base_s)) then
+			phase_target_s <= (others => '0');
+		elsif (wbbutis_tracker_offset_s(7)='0') and (conv_integer(wbbutis_tracker_offset_s)+conv_integer(phase_base_s)>255) then
+			phase_target_s <= (others => '1');
+		else
+			phase_target_s <= phase_base_s+wbbutis_tracker_offset_s; -- offset is signed, the carry is dropped
+		end if;
+		decoder_toggle_sync2_s <= decoder_toggle_sync1_s;
+		decoder_toggle_sync1_s <= decoder_toggle_sync0_s;
+		decoder_toggle_sync0_s <= decoder_toggle_s;
+		setphase_enable_sync2_s <= setphase_enable_sync1_s;
+		setphase_enable_sync1_s <= setphase_enable_sync0_s;
+		setphase_enable_sync0_s <= setphase_enable_S;
+		setphase_ready_sync1_s <= setphase_ready_sync0_s;
+		setphase_ready_sync0_s <= setphase_ready_s;
+	end if;
+end process;
+
+PLL_phasecalibration1: PLL_phasecalibration port map(
+		clock_i => clk_sys_i,
+		reset_i => reset_s,
+		start_i => calibration_start_s,
+		ready_i => setphase_ready_sync1_s,
+		burst_i => burst_s,
+		corrected_i => decoder_corrected_s,
+		error_i => decoder_error_s,
+		phase_o => calibration_phase_s,
+		busy_o => wbbutis_status_calbusy_s(0),
+		eyefound_o => wbbutis_status_eyefound_s(0),
+		eyecentre_o => wbbutis_status_calphase_s,
+		eyewidth_o => wbbutis_status_eyewidth_s,
+		eyemap_o => wbbutis_eyemap_map_s);
+
+PLL_phasetracker1: PLL_phasetracker port map(
+		clock_i => clk_sys_i,
+		reset_i => tracker_reset_s,
+		enable_i => tracker_enable_s,
+		wr_clock_i => wr_clock_i,
+		wr_PPSpulse_i => wr_PPSpulse_i,
+		BuTis_C2_i => BuTiS_C2_s,
+		trace_index_i => gpio_slave_i.adr(6 downto 2),
+		offset_o => wbbutis_tracker_offset_s,
+		phase_error_o => wbbutis_tracker_error_s,
+		locked_o => wbbutis_tracker_locked_s(0),
+		trace_wrindex_o => wbbutis_tracker_index_s,
+		trace_data_o => trace_data_s);
 
   
 --syncpulse_s <= wr_PPSpulse_i;
@@ -6,7 +6,7 @@
 -- Author     : Peter Schakel
 -- Company    : KVI
 -- Created    : 2012-11-21
--- Last update: 2013-02-25
+-- Last update: 2013-03-04
 -- Platform   : FPGA-generic
 -- Standard   : VHDL'93
 -------------------------------------------------------------------------------
@@ -29,6 +29,9 @@
 --
 -- Outputs
 --     gpio_slave_o : Record with Whishbone Bus signals
+--     irq_o : Interrupt, high level: while reading from flash data is available in the read-fifo,
+--         otherwise the module is ready for the next command (not busy).
+--         The firmware enables the interrupt in the VIC only while it waits for the module.
 --
 -- Components
 --     flash_access : Module to access external flash (ALTASMI_PARALLEL)
@@ -66,7 +69,8 @@ entity FlashUpdateModule is
 		rst_n_i                                : in std_logic;
 		gpio_slave_i                           : in t_wishbone_slave_in;
 		gpio_slave_o                           : out t_wishbone_slave_out;
-		watchdog_reset_i                       : in std_logic
+		watchdog_reset_i                       : in std_logic;
+		irq_o                                  : out std_logic
     );
 end FlashUpdateModule;
 
@@ -339,6 +343,8 @@ signal flash_write_param_cold_s              : std_logic := '0';
 signal flash_reconfig_cold_s                 : std_logic := '0';
 signal flash_param_in_cold_s                 : std_logic_vector(23 downto 0) := x"800000";
 
+signal irq_s                                 : std_logic := '0';
+
 signal leds_s                                : std_logic_vector(7 downto 0) := "00000000";
 		 
 type flashmode_type is (data,id,status);
@@ -512,6 +518,22 @@ begin
 	end if;
 end process;		
 
+-- interrupt: read data available when reading, otherwise ready for the next command
+-- uses the same busy bits as the software, including the delayed access signals
+irq_s <= wbflash_flash_read_valid_s(0) when flash_enable_reading_s='1' else
+	'1' when (wbflash_flash_read_busy_s(0)='0') and (wbflash_params_read_busy_s(0)='0') else
+	'0';
+irq_process: process(clk_sys_i)
+begin
+	if rising_edge(clk_sys_i) then
+		if rst_n_i='0' then
+			irq_o <= '0';
+		else
+			irq_o <= irq_s;
+		end if;
+	end if;
+end process;
+
 -- process to store errors for 'illegal read' and 'erase error'
 error_process: process(clk_cal_i)
 begin
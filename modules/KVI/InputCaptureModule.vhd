@@ -0,0 +1,531 @@
+-------------------------------------------------------------------------------
+-- Title      : Timestamp input capture
+-- Project    : White Rabbit generator
+-------------------------------------------------------------------------------
+-- File       : InputCaptureModule.vhd
+-- Author     : Peter Schakel
+-- Company    : KVI
+-- Created    : 2012-10-24
+-- Last update: 2012-10-24
+-- Platform   : FPGA-generic
+-- Standard   : VHDL'93
+-------------------------------------------------------------------------------
+-- Description:
+--
+-- Captures the BuTiS timestamp on the rising and/or falling edges of up to 8 input channels.
+-- A running timestamp is kept on the BuTiS C2 clock (200MHz): it is loaded with each received timestamp
+-- from the Timestamp Decoder plus the number of clock cycles since the received BuTiS T0, and incremented on every clock cycle.
+-- The inputs are sampled with a 500MHz clock. On each enabled edge the 5 lowest bits of the running timestamp (Gray coded)
+-- and the number of 500MHz clock cycles since these bits last changed (fine phase, 2ns steps) are held.
+-- A toggle passes the event to the BuTiS C2 clock, where the full timestamp is reconstructed and the event is written in a fifo.
+-- Events on different channels are written round robin, one event each BuTiS C2 clock cycle.
+-- After an edge the channel is blind for g_deadtime 500MHz clock cycles, edges in this period are not seen.
+-- Events are only taken while the PLL of the 500MHz clock is locked (clock500MHz_locked_i).
+-- If the channel still has a pending event or if the fifo is full the event is lost and counted.
+-- The registers are described in the wb_inputCapture documentation.
+-- The fifo is read from address offset 0x80..0xfc as pairs of 32-bits words:
+--     offset 8*n+0x80 : timestamp bits 31..0
+--                       reading this word takes the first event of the fifo, both words are from this event
+--     offset 8*n+0x84 : bit 31 event valid (fifo was not empty), bit 30 rising edge, bits 29..27 channel,
+--                       bits 26..25 fine phase in 2ns steps, bit 24 timestamp valid, bits 23..0 timestamp bits 55..32
+--                       reading this word removes the event from the fifo
+-- A block read of the full range gives up to 16 events. The timestamp counts in 5ns BuTiS C2 clock cycles,
+-- the event time is timestamp*5ns+fine*2ns with a constant delay of a few ns that is not compensated.
+--
+-- Generics
+--     g_channels : number of input channels (1..8)
+--     g_fifosize : number of events in the fifo
+--     g_deadtime : number of 500MHz clock cycles to ignore edges after an edge, should be at least 4 BuTiS C2 clock cycles
+--
+-- Inputs
+--     clk_sys_i : 125MHz Whishbone bus clock
+--     rst_n_i : reset: low active
+--     gpio_slave_i : Record with Whishbone Bus signals
+--     BuTis_C2_i : BuTiS C2 clock : 200MHz
+--     clock500MHz_i : 500MHz clock for sampling the inputs, same reference as BuTis_C2_i:
+--                     the edges of both clocks must coincide every 10ns with a phase that is the same after every lock,
+--                     otherwise the fine phase has no fixed relation to the timestamp
+--     clock500MHz_locked_i : PLL of the 500MHz clock is locked, asynchronous
+--     timestamp_i : Timestamp from Timestamp Decoder Module
+--     timestamp_write_i : Write signal for Timestamp from Timestamp Decoder Module
+--     BuTis_T0_i : received BuTis T0 from Timestamp Decoder Module, 1 clock pulse
+--     inputs_i : input channels
+--
+-- Outputs
+--     gpio_slave_o : Record with Whishbone Bus signals
+--
+-- Components
+--     wb_inputCapture : module with interface to Wishbone bus, generated by wbgen2
+--     generic_async_fifo : fifo for the events, 64 bits wide
+--
+-------------------------------------------------------------------------------
+-- Copyright (c) 2012 KVI / Peter Schakel
+-------------------------------------------------------------------------------
+-- Revisions  :
+-- Date        Version  Author          Description
+-------------------------------------------------------------------------------
+
+library ieee;
+use ieee.std_logic_1164.all;
+--use ieee.numeric_std.all;
+USE ieee.std_logic_unsigned.all ;
+USE ieee.std_logic_arith.all ;
+
+library work;
+use work.genram_pkg.all;
+use work.wishbone_pkg.all;
+
+entity InputCaptureModule is
+	generic(
+		g_channels                             : integer := 4;
+		g_fifosize                             : integer := 2048;
+		g_deadtime                             : integer := 12
+	);
+	port(
+		clk_sys_i                              : in std_logic;
+		rst_n_i                                : in std_logic;
+		gpio_slave_i                           : in t_wishbone_slave_in;
+		gpio_slave_o                           : out t_wishbone_slave_out;
+		BuTis_C2_i                             : in std_logic;
+		clock500MHz_i                          : in std_logic;
+		clock500MHz_locked_i                   : in std_logic;
+		timestamp_i                            : in std_logic_vector(63 downto 0);
+		timestamp_write_i                      : in std_logic;
+		BuTis_T0_i                             : in std_logic;
+		inputs_i                               : in std_logic_vector(g_channels-1 downto 0)
+    );
+end InputCaptureModule;
+
+architecture struct of InputCaptureModule is
+
+component wb_inputCapture is
+  port (
+--
+    rst_n_i                                  : in     std_logic;
+--
+    wb_clk_i                                 : in     std_logic;
+--
+    wb_addr_i                                : in     std_logic_vector(1 downto 0);
+--
+    wb_data_i                                : in     std_logic_vector(31 downto 0);
+--
+    wb_data_o                                : out    std_logic_vector(31 downto 0);
+--
+    wb_cyc_i                                 : in     std_logic;
+--
+    wb_sel_i                                 : in     std_logic_vector(3 downto 0);
+--
+    wb_stb_i                                 : in     std_logic;
+--
+    wb_we_i                                  : in     std_logic;
+--
+    wb_ack_o                                 : out    std_logic;
+-- Port for std_logic_vector field: 'Rising edge enable' in reg: 'Input capture control'
+    wbcapt_control_rising_o                  : out    std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'Falling edge enable' in reg: 'Input capture control'
+    wbcapt_control_falling_o                 : out    std_logic_vector(7 downto 0);
+-- Ports for PASS_THROUGH field: 'Clear' in reg: 'Input capture control'
+    wbcapt_control_clear_o                   : out    std_logic_vector(0 downto 0);
+    wbcapt_control_clear_wr_o                : out    std_logic;
+-- Port for std_logic_vector field: 'Fifo count' in reg: 'Input capture status'
+    wbcapt_status_count_i                    : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'Fifo full' in reg: 'Input capture status'
+    wbcapt_status_full_i                     : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'Overflow' in reg: 'Input capture status'
+    wbcapt_status_overflow_i                 : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'Timestamp valid' in reg: 'Input capture status'
+    wbcapt_status_tsvalid_i                  : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'lost_counter' in reg: 'Lost events counter'
+    wbcapt_lost_nr_i                         : in     std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'event_counter' in reg: 'Events counter'
+    wbcapt_events_nr_i                       : in     std_logic_vector(31 downto 0)
+  );
+end component;
+
+constant graybits_c                        : integer := 5;
+type gray_array_type is array(0 to g_channels-1) of std_logic_vector(graybits_c-1 downto 0);
+type fine_array_type is array(0 to g_channels-1) of std_logic_vector(1 downto 0);
+type deadtime_array_type is array(0 to g_channels-1) of integer range 0 to g_deadtime;
+
+function gray2bin(gray : std_logic_vector) return std_logic_vector is
+variable bin_v : std_logic_vector(gray'length-1 downto 0);
+begin
+	bin_v(gray'length-1) := gray(gray'high);
+	for i in gray'length-2 downto 0 loop
+		bin_v(i) := bin_v(i+1) xor gray(gray'low+i);
+	end loop;
+	return bin_v;
+end function;
+
+signal wbcapt_control_rising_s             : std_logic_vector(7 downto 0);
+signal wbcapt_control_falling_s            : std_logic_vector(7 downto 0);
+signal wbcapt_control_clear_s              : std_logic_vector(0 downto 0);
+signal wbcapt_control_clear_wr_s           : std_logic := '0';
+signal wbcapt_status_count_s               : std_logic_vector(15 downto 0) := (others => '0');
+signal wbcapt_status_full_s                : std_logic_vector(0 downto 0) := (others => '0');
+signal wbcapt_status_overflow_s            : std_logic_vector(0 downto 0) := (others => '0');
+signal wbcapt_status_tsvalid_s             : std_logic_vector(0 downto 0) := (others => '0');
+signal wbcapt_lost_nr_s                    : std_logic_vector(31 downto 0) := (others => '0');
+signal wbcapt_events_nr_s                  : std_logic_vector(31 downto 0) := (others => '0');
+
+signal wb_stb_s                            : std_logic := '0';
+signal wb_ack_s                            : std_logic := '0';
+signal wb_data_s                           : std_logic_vector(31 downto 0);
+signal fifo_ack_s                          : std_logic := '0';
+signal fifo_data_s                         : std_logic_vector(31 downto 0) := (others => '0');
+signal fifo_event_s                        : std_logic_vector(63 downto 0) := (others => '0');
+
+-- BuTiS C2 clock domain
+signal since_T0_s                          : integer range 0 to 65535 := 65535;
+signal timestamp_hold_s                    : std_logic_vector(63 downto 0) := (others => '0');
+signal offset_hold_s                       : std_logic_vector(15 downto 0) := (others => '0');
+signal timestamp_load_s                    : std_logic := '0';
+signal running_timestamp_s                 : std_logic_vector(63 downto 0) := (others => '0');
+signal timestamp_gray_s                    : std_logic_vector(graybits_c-1 downto 0) := (others => '0');
+signal tsvalid_s                           : std_logic := '0';
+signal toggle_sync0_s                      : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal toggle_sync1_s                      : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal toggle_sync2_s                      : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal pending_s                           : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal pending_gray_s                      : gray_array_type := (others => (others => '0'));
+signal pending_fine_s                      : fine_array_type := (others => (others => '0'));
+signal pending_edge_s                      : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal roundrobin_s                        : integer range 0 to g_channels-1 := 0;
+signal event_valid_s                       : std_logic := '0';
+signal event_channel_s                     : integer range 0 to g_channels-1 := 0;
+signal event_edge_s                        : std_logic := '0';
+signal event_fine_s                        : std_logic_vector(1 downto 0) := (others => '0');
+signal event_gray_s                        : std_logic_vector(graybits_c-1 downto 0) := (others => '0');
+signal event_timestamp_s                   : std_logic_vector(63 downto 0) := (others => '0');
+signal fifo_write_s                        : std_logic := '0';
+signal fifo_data_in_s                      : std_logic_vector(63 downto 0) := (others => '0');
+signal fifo_wrfull_s                       : std_logic := '0';
+signal lost_counter_s                      : std_logic_vector(31 downto 0) := (others => '0');
+signal event_counter_s                     : std_logic_vector(31 downto 0) := (others => '0');
+signal overflow_s                          : std_logic := '0';
+signal lost_busy_s                         : std_logic := '0';
+signal counters_hold_lost_s                : std_logic_vector(31 downto 0) := (others => '0');
+signal counters_hold_events_s              : std_logic_vector(31 downto 0) := (others => '0');
+signal counters_toggle_s                   : std_logic := '0';
+signal counters_divider_s                  : integer range 0 to 15 := 0;
+signal clear_toggle_sync0_s                : std_logic := '0';
+signal clear_toggle_sync1_s                : std_logic := '0';
+signal clear_toggle_sync2_s                : std_logic := '0';
+signal locked_sync0_s                      : std_logic := '0';
+signal locked_sync1_s                      : std_logic := '0';
+
+-- 500MHz clock domain
+signal rising_sync0_s                      : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal rising_sync1_s                      : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal falling_sync0_s                     : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal falling_sync1_s                     : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal inputs_sync0_s                      : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal inputs_sync1_s                      : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal inputs_prev_s                       : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal gray_sync0_s                        : std_logic_vector(graybits_c-1 downto 0) := (others => '0');
+signal gray_sync1_s                        : std_logic_vector(graybits_c-1 downto 0) := (others => '0');
+signal gray_prev_s                         : std_logic_vector(graybits_c-1 downto 0) := (others => '0');
+signal subcounter_s                        : std_logic_vector(1 downto 0) := (others => '0');
+signal deadtime_s                          : deadtime_array_type := (others => 0);
+signal hold_gray_s                         : gray_array_type := (others => (others => '0'));
+signal hold_fine_s                         : fine_array_type := (others => (others => '0'));
+signal hold_edge_s                         : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+signal hold_toggle_s                       : std_logic_vector(g_channels-1 downto 0) := (others => '0');
+
+-- Whishbone Bus clock domain
+signal fifo_read_s                         : std_logic := '0';
+signal fifo_q_s                            : std_logic_vector(63 downto 0);
+signal fifo_empty_s                        : std_logic := '1';
+signal fifo_full_s                         : std_logic := '0';
+signal fifo_count_s                        : std_logic_vector(f_log2_size(g_fifosize)-1 downto 0);
+signal fifo_reset_n_s                      : std_logic := '0';
+signal clear_counter_s                     : integer range 0 to 7 := 0;
+signal clear_toggle_s                      : std_logic := '0';
+signal counters_toggle_sync0_s             : std_logic := '0';
+signal counters_toggle_sync1_s             : std_logic := '0';
+signal counters_toggle_sync2_s             : std_logic := '0';
+signal overflow_sync0_s                    : std_logic := '0';
+signal tsvalid_sync0_s                     : std_logic := '0';
+
+begin
+
+wb_inputCapture1: wb_inputCapture port map(
+	rst_n_i => rst_n_i,
+	wb_clk_i => clk_sys_i,
+	wb_addr_i => gpio_slave_i.adr(3 downto 2),
+	wb_data_i => gpio_slave_i.dat,
+	wb_data_o => wb_data_s,
+	wb_cyc_i => gpio_slave_i.cyc,
+	wb_sel_i => gpio_slave_i.sel,
+	wb_stb_i => wb_stb_s,
+	wb_we_i => gpio_slave_i.we,
+	wb_ack_o => wb_ack_s,
+	wbcapt_control_rising_o => wbcapt_control_rising_s,
+	wbcapt_control_falling_o => wbcapt_control_falling_s,
+	wbcapt_control_clear_o => wbcapt_control_clear_s,
+	wbcapt_control_clear_wr_o => wbcapt_control_clear_wr_s,
+	wbcapt_status_count_i => wbcapt_status_count_s,
+	wbcapt_status_full_i => wbcapt_status_full_s,
+	wbcapt_status_overflow_i => wbcapt_status_overflow_s,
+	wbcapt_status_tsvalid_i => wbcapt_status_tsvalid_s,
+	wbcapt_lost_nr_i => wbcapt_lost_nr_s,
+	wbcapt_events_nr_i => wbcapt_events_nr_s
+	);
+
+-- addresses from 0x80 are the fifo block, the registers are below
+wb_stb_s <= gpio_slave_i.stb and not gpio_slave_i.adr(7);
+gpio_slave_o.ack <= wb_ack_s or fifo_ack_s;
+gpio_slave_o.dat <= fifo_data_s when fifo_ack_s='1' else wb_data_s;
+
+
+-- process for the running timestamp on the BuTiS C2 clock
+timestamp_process: process (BuTis_C2_i)
+begin
+	if rising_edge(BuTis_C2_i) then
+		if rst_n_i='0' then
+			since_T0_s <= 65535;
+			timestamp_load_s <= '0';
+			tsvalid_s <= '0';
+		else
+			if BuTis_T0_i='1' then
+				since_T0_s <= 1;
+			elsif since_T0_s<65535 then
+				since_T0_s <= since_T0_s+1;
+			end if;
+			if (timestamp_write_i='1') and (since_T0_s<65535) then -- loaded on the next clock cycle
+				timestamp_hold_s <= timestamp_i;
+				offset_hold_s <= conv_std_logic_vector(since_T0_s+1,16);
+				timestamp_load_s <= '1';
+			else
+				timestamp_load_s <= '0';
+			end if;
+			if timestamp_load_s='1' then
+				running_timestamp_s <= timestamp_hold_s+offset_hold_s;
+				tsvalid_s <= '1';
+			else
+				running_timestamp_s <= running_timestamp_s+1;
+			end if;
+		end if;
+		-- Gray code: only one bit changes every clock cycle so it can be sampled with the 500MHz clock,
+		-- registered against glitches of the xor; it is one clock cycle behind running_timestamp_s
+		timestamp_gray_s <= running_timestamp_s(graybits_c-1 downto 0) xor ('0' & running_timestamp_s(graybits_c-1 downto 1));
+	end if;
+end process;
+
+-- process to detect edges on the 500MHz clock and hold the fine phase until the event is taken by the BuTiS C2 clock
+sample_process: process (clock500MHz_i)
+variable sub_v : std_logic_vector(1 downto 0);
+begin
+	if rising_edge(clock500MHz_i) then
+		rising_sync0_s <= wbcapt_control_rising_s(g_channels-1 downto 0);
+		rising_sync1_s <= rising_sync0_s;
+		falling_sync0_s <= wbcapt_control_falling_s(g_channels-1 downto 0);
+		falling_sync1_s <= falling_sync0_s;
+		inputs_sync0_s <= inputs_i;
+		inputs_sync1_s <= inputs_sync0_s;
+		inputs_prev_s <= inputs_sync1_s;
+		gray_sync0_s <= timestamp_gray_s;
+		gray_sync1_s <= gray_sync0_s;
+		gray_prev_s <= gray_sync1_s;
+		if gray_sync1_s/=gray_prev_s then -- first 500MHz clock cycle in this BuTiS C2 clock cycle
+			sub_v := "00";
+		elsif subcounter_s/="11" then
+			sub_v := subcounter_s+1;
+		else
+			sub_v := subcounter_s;
+		end if;
+		subcounter_s <= sub_v;
+		for i in 0 to g_channels-1 loop
+			if deadtime_s(i)/=0 then
+				deadtime_s(i) <= deadtime_s(i)-1;
+			elsif ((inputs_sync1_s(i)='1') and (inputs_prev_s(i)='0') and (rising_sync1_s(i)='1'))
+					or ((inputs_sync1_s(i)='0') and (inputs_prev_s(i)='1') and (falling_sync1_s(i)='1')) then
+				hold_gray_s(i) <= gray_sync1_s;
+				hold_fine_s(i) <= sub_v;
+				hold_edge_s(i) <= inputs_sync1_s(i);
+				hold_toggle_s(i) <= not hold_toggle_s(i);
+				deadtime_s(i) <= g_deadtime;
+			end if;
+		end loop;
+	end if;
+end process;
+
+-- process to collect the events from all channels, round robin, and reconstruct the full timestamp
+collect_process: process (BuTis_C2_i)
+variable selected_v : integer range 0 to g_channels-1;
+variable found_v : boolean;
+variable lost_v : std_logic;
+variable diff_v : std_logic_vector(graybits_c-1 downto 0);
+begin
+	if rising_edge(BuTis_C2_i) then
+		toggle_sync0_s <= hold_toggle_s;
+		toggle_sync1_s <= toggle_sync0_s;
+		toggle_sync2_s <= toggle_sync1_s;
+		clear_toggle_sync0_s <= clear_toggle_s;
+		clear_toggle_sync1_s <= clear_toggle_sync0_s;
+		clear_toggle_sync2_s <= clear_toggle_sync1_s;
+		locked_sync0_s <= clock500MHz_locked_i;
+		locked_sync1_s <= locked_sync0_s;
+		-- select the next pending channel
+		found_v := false;
+		selected_v := 0;
+		for i in g_channels-1 downto 0 loop
+			if (pending_s((roundrobin_s+i) mod g_channels)='1') then
+				selected_v := (roundrobin_s+i) mod g_channels;
+				found_v := true;
+			end if;
+		end loop;
+		event_valid_s <= '0';
+		if found_v then
+			event_valid_s <= '1';
+			event_channel_s <= selected_v;
+			event_edge_s <= pending_edge_s(selected_v);
+			event_fine_s <= pending_fine_s(selected_v);
+			event_gray_s <= pending_gray_s(selected_v);
+			event_timestamp_s <= running_timestamp_s;
+			pending_s(selected_v) <= '0';
+			if selected_v<g_channels-1 then
+				roundrobin_s <= selected_v+1;
+			else
+				roundrobin_s <= 0;
+			end if;
+		end if;
+		-- take new events from the 500MHz clock domain, the hold registers are stable during the dead time;
+		-- without lock the 500MHz clock and its events are not valid
+		lost_v := '0';
+		for i in 0 to g_channels-1 loop
+			if (toggle_sync1_s(i)/=toggle_sync2_s(i)) and (locked_sync1_s='1') then
+				if (pending_s(i)='1') and not (found_v and (selected_v=i)) then
+					lost_v := '1';
+				else
+					pending_s(i) <= '1';
+					pending_gray_s(i) <= hold_gray_s(i);
+					pending_fine_s(i) <= hold_fine_s(i);
+					pending_edge_s(i) <= hold_edge_s(i);
+				end if;
+			end if;
+		end loop;
+		-- replace the low bits of the timestamp by the bits sampled at the edge
+		diff_v := event_timestamp_s(graybits_c-1 downto 0)-gray2bin(event_gray_s)-1; -- -1: the Gray code is one cycle behind
+		fifo_data_in_s(63) <= '1';
+		fifo_data_in_s(62) <= event_edge_s;
+		fifo_data_in_s(61 downto 59) <= conv_std_logic_vector(event_channel_s,3);
+		fifo_data_in_s(58 downto 57) <= event_fine_s;
+		fifo_data_in_s(56) <= tsvalid_s;
+		fifo_data_in_s(55 downto 0) <= event_timestamp_s(55 downto 0)-diff_v;
+		if (event_valid_s='1') and (fifo_wrfull_s='0') then
+			fifo_write_s <= '1';
+		else
+			fifo_write_s <= '0';
+		end if;
+		if (event_valid_s='1') and (fifo_wrfull_s='1') then
+			lost_busy_s <= '1';
+		else
+			lost_busy_s <= lost_v;
+		end if;
+		-- counters, passed to the Whishbone Bus clock domain with a toggle every 16 clock cycles
+		if (rst_n_i='0') or (clear_toggle_sync1_s/=clear_toggle_sync2_s) then
+			lost_counter_s <= (others => '0');
+			event_counter_s <= (others => '0');
+			overflow_s <= '0';
+			pending_s <= (others => '0');
+		else
+			if (lost_busy_s='1') and (lost_counter_s/=x"ffffffff") then
+				lost_counter_s <= lost_counter_s+1;
+			end if;
+			if lost_busy_s='1' then
+				overflow_s <= '1';
+			end if;
+			if fifo_write_s='1' then
+				event_counter_s <= event_counter_s+1;
+			end if;
+		end if;
+		if counters_divider_s<15 then
+			counters_divider_s <= counters_divider_s+1;
+		else
+			counters_divider_s <= 0;
+			counters_hold_lost_s <= lost_counter_s;
+			counters_hold_events_s <= event_counter_s;
+			counters_toggle_s <= not counters_toggle_s;
+		end if;
+	end if;
+end process;
+
+eventfifo: generic_async_fifo
+	generic map (
+		g_data_width => 64,
+		g_size => g_fifosize,
+		g_show_ahead => true,
+		g_with_rd_full => true,
+		g_with_rd_count => true
+    )
+	port map(
+		rst_n_i => fifo_reset_n_s,
+		clk_wr_i => BuTis_C2_i,
+		d_i => fifo_data_in_s,
+		we_i => fifo_write_s,
+		wr_full_o => fifo_wrfull_s,
+		clk_rd_i => clk_sys_i,
+		q_o => fifo_q_s,
+		rd_i => fifo_read_s,
+		rd_empty_o => fifo_empty_s,
+		rd_full_o => fifo_full_s,
+		rd_count_o => fifo_count_s
+	);
+
+-- reading the high word of an event removes the event taken with the low word from the fifo
+fifo_read_s <= '1' when (gpio_slave_i.cyc='1') and (gpio_slave_i.stb='1') and (gpio_slave_i.we='0')
+		and (gpio_slave_i.adr(7)='1') and (gpio_slave_i.adr(2)='1') and (fifo_event_s(63)='1') else '0';
+fifo_reset_n_s <= '0' when (rst_n_i='0') or (clear_counter_s/=0) else '1';
+wbcapt_status_full_s(0) <= fifo_full_s;
+
+-- process for the fifo block, clear command and status on the Whishbone Bus clock, never stalls
+status_process: process (clk_sys_i)
+begin
+	if rising_edge(clk_sys_i) then
+		fifo_ack_s <= gpio_slave_i.cyc and gpio_slave_i.stb and gpio_slave_i.adr(7);
+		-- the low word takes the whole event, the high word is read from it so both halves belong together
+		if gpio_slave_i.adr(2)='0' then
+			fifo_data_s <= fifo_q_s(31 downto 0);
+		else
+			fifo_data_s <= fifo_event_s(63 downto 32);
+		end if;
+		if fifo_reset_n_s='0' then
+			fifo_event_s <= (others => '0');
+		elsif (gpio_slave_i.cyc='1') and (gpio_slave_i.stb='1') and (gpio_slave_i.adr(7)='1') then
+			if gpio_slave_i.adr(2)='0' then
+				if fifo_empty_s='0' then
+					fifo_event_s <= fifo_q_s;
+				else
+					fifo_event_s <= (others => '0');
+				end if;
+			else
+				fifo_event_s(63) <= '0'; -- removed from the fifo, a second read of the high word gives no event
+			end if;
+		end if;
+		if (wbcapt_control_clear_wr_s='1') and (wbcapt_control_clear_s(0)='1') then
+			clear_counter_s <= 7; -- hold the fifo reset for a few clock cycles
+			clear_toggle_s <= not clear_toggle_s;
+		elsif clear_counter_s/=0 then
+			clear_counter_s <= clear_counter_s-1;
+		end if;
+		if fifo_full_s='1' then
+			wbcapt_status_count_s <= conv_std_logic_vector(g_fifosize,16);
+		else
+			wbcapt_status_count_s <= ext(fifo_count_s,16);
+		end if;
+		overflow_sync0_s <= overflow_s;
+		wbcapt_status_overflow_s(0) <= overflow_sync0_s;
+		tsvalid_sync0_s <= tsvalid_s;
+		wbcapt_status_tsvalid_s(0) <= tsvalid_sync0_s;
+		if counters_toggle_sync1_s/=counters_toggle_sync2_s then
+			wbcapt_lost_nr_s <= counters_hold_lost_s;
+			wbcapt_events_nr_s <= counters_hold_events_s;
+		end if;
+		counters_toggle_sync2_s <= counters_toggle_sync1_s;
+		counters_toggle_sync1_s <= counters_toggle_sync0_s;
+		counters_toggle_sync0_s <= counters_toggle_s;
+	end if;
+end process;
+
+end struct;
@@ -0,0 +1,236 @@
+-------------------------------------------------------------------------------
+-- Title      : PLL phase calibration
+-- Project    : White Rabbit generator
+-------------------------------------------------------------------------------
+-- File       : PLL_phasecalibration.vhd
+-- Author     : Peter Schakel
+-- Company    : KVI
+-- Created    : 2012-10-19
+-- Last update: 2012-10-19
+-- Platform   : FPGA-generic
+-- Standard   : VHDL'93
+-------------------------------------------------------------------------------
+-- Description:
+--
+-- Calibrates the phase of the BuTiS PLL by sweeping all phase steps.
+-- On each phase step the received timestamp bursts are checked for errors and corrections.
+-- A phase step is error-free if g_bursts bursts were received without errors and without corrections.
+-- After the sweep the longest range of error-free phase steps (the eye) is searched,
+-- the phase range may wrap around from the last to the first phase step.
+-- The result is the phase in the centre of the eye, with the width of the eye in phase steps.
+-- The phase steps itself are done by the PLL_setphase module.
+--
+-- Generics
+--     g_phasesteps : number of phase steps to sweep (maximum 32)
+--     g_bursts : number of bursts to check on each phase step
+--     g_settlebursts : number of bursts to skip after each phase change
+--     g_timeout : number of clock cycles to wait for each burst before the phase step is marked as faulty
+--
+-- Inputs
+--     clock_i : clock, 125MHz Whishbone bus clock
+--     reset_i : reset
+--     start_i : start calibration
+--     ready_i : PLL_setphase has reached the requested phase
+--     burst_i : pulse for each received timestamp burst
+--     corrected_i : received timestamp has been corrected, valid with burst_i
+--     error_i : received timestamp has errors that could not be corrected, valid with burst_i
+--
+-- Outputs
+--     phase_o : phase for the PLL during calibration, the centre of the eye afterwards
+--     busy_o : calibration busy
+--     eyefound_o : calibration finished with at least one error-free phase step
+--     eyecentre_o : phase in the centre of the eye
+--     eyewidth_o : number of error-free phase steps in the eye
+--     eyemap_o : result of the sweep: bit n is set if phase step n was error-free
+--
+-- Components
+--
+--
+-------------------------------------------------------------------------------
+-- Copyright (c) 2012 KVI / Peter Schakel
+-------------------------------------------------------------------------------
+-- Revisions  :
+-- Date        Version  Author          Description
+-------------------------------------------------------------------------------
+
+library IEEE;
+use IEEE.std_logic_1164.ALL;
+USE ieee.std_logic_unsigned.all ;
+USE ieee.std_logic_arith.all ;
+
+entity PLL_phasecalibration is
+	generic(
+		g_phasesteps                           : integer := 28;
+		g_bursts                               : integer := 64;
+		g_settlebursts                         : integer := 4;
+		g_timeout                              : integer := 2500
+	);
+	port(
+		clock_i                                : in std_logic;
+		reset_i                                : in std_logic;
+		start_i                                : in std_logic;
+		ready_i                                : in std_logic;
+		burst_i                                : in std_logic;
+		corrected_i                            : in std_logic;
+		error_i                                : in std_logic;
+		phase_o                                : out std_logic_vector(7 downto 0);
+		busy_o                                 : out std_logic;
+		eyefound_o                             : out std_logic;
+		eyecentre_o                            : out std_logic_vector(7 downto 0);
+		eyewidth_o                             : out std_logic_vector(7 downto 0);
+		eyemap_o                               : out std_logic_vector(31 downto 0)
+   );
+end PLL_phasecalibration;
+
+architecture struct of PLL_phasecalibration is
+
+constant waitphase_c                       : integer := 15; -- clock cycles before PLL_setphase has seen the new phase
+
+type calibrationstate_type is (IDLE,SETPHASE,WAITREADY,SETTLE,MEASURE,ANALYSE,DONE);
+signal calibrationstate_S                  : calibrationstate_type := IDLE;
+signal phasestep_S                         : integer range 0 to g_phasesteps-1 := 0;
+signal waitcounter_S                       : integer range 0 to waitphase_c := 0;
+signal burstcounter_S                      : integer range 0 to g_bursts := 0;
+signal timeoutcounter_S                    : integer range 0 to g_timeout := 0;
+signal errorfree_S                         : std_logic := '0';
+signal eyemap_S                            : std_logic_vector(31 downto 0) := (others => '0');
+signal analyseindex_S                      : integer range 0 to 2*g_phasesteps := 0;
+signal runstart_S                          : integer range 0 to g_phasesteps-1 := 0;
+signal runlength_S                         : integer range 0 to g_phasesteps := 0;
+signal beststart_S                         : integer range 0 to g_phasesteps-1 := 0;
+signal bestlength_S                        : integer range 0 to g_phasesteps := 0;
+signal eyefound_S                          : std_logic := '0';
+signal eyecentre_S                         : integer range 0 to g_phasesteps-1 := 0;
+
+attribute syn_encoding : string;
+attribute syn_encoding of calibrationstate_type : type is "safe";
+
+begin
+
+busy_o <= '0' when (calibrationstate_S=IDLE) or (calibrationstate_S=DONE) else '1';
+eyefound_o <= eyefound_S;
+eyemap_o <= eyemap_S;
+eyecentre_o <= conv_std_logic_vector(eyecentre_S,8);
+eyewidth_o <= conv_std_logic_vector(bestlength_S,8);
+phase_o <= conv_std_logic_vector(phasestep_S,8) when (calibrationstate_S/=IDLE) and (calibrationstate_S/=DONE)
+	else conv_std_logic_vector(eyecentre_S,8);
+
+-- process with state machine to sweep the phase, check the received bursts and find the centre of the eye
+calibration_process: process (clock_i)
+variable index_v : integer range 0 to g_phasesteps-1;
+begin
+	if rising_edge(clock_i) then
+		if reset_i='1' then
+			eyefound_S <= '0';
+			eyecentre_S <= 0;
+			bestlength_S <= 0;
+			eyemap_S <= (others => '0');
+			calibrationstate_S <= IDLE;
+		else
+			case calibrationstate_S is
+				when IDLE | DONE => -- wait for start command, the result stays valid
+					phasestep_S <= 0;
+					if start_i='1' then
+						eyefound_S <= '0';
+						eyemap_S <= (others => '0');
+						calibrationstate_S <= SETPHASE;
+					end if;
+				when SETPHASE => -- give PLL_setphase the time to start on the new phase
+					waitcounter_S <= 0;
+					calibrationstate_S <= WAITREADY;
+				when WAITREADY => -- wait until the PLL has the requested phase
+					burstcounter_S <= 0;
+					timeoutcounter_S <= 0;
+					errorfree_S <= '1';
+					if waitcounter_S<waitphase_c then
+						waitcounter_S <= waitcounter_S+1;
+					elsif ready_i='1' then
+						calibrationstate_S <= SETTLE;
+					end if;
+				when SETTLE => -- skip the first bursts after a phase change
+					if burst_i='1' then
+						timeoutcounter_S <= 0;
+						if burstcounter_S<g_settlebursts-1 then
+							burstcounter_S <= burstcounter_S+1;
+						else
+							burstcounter_S <= 0;
+							calibrationstate_S <= MEASURE;
+						end if;
+					elsif timeoutcounter_S<g_timeout then
+						timeoutcounter_S <= timeoutcounter_S+1;
+					else
+						errorfree_S <= '0';
+						burstcounter_S <= 0;
+						calibrationstate_S <= MEASURE;
+					end if;
+				when MEASURE => -- count bursts, any error, correction or missing burst marks the phase step as faulty
+					if (burst_i='1') and (burstcounter_S<g_bursts) and (errorfree_S='1') then
+						timeoutcounter_S <= 0;
+						burstcounter_S <= burstcounter_S+1;
+						if (corrected_i='1') or (error_i='1') then
+							errorfree_S <= '0';
+						end if;
+					elsif timeoutcounter_S<g_timeout then
+						timeoutcounter_S <= timeoutcounter_S+1;
+					else
+						errorfree_S <= '0';
+					end if;
+					if (burstcounter_S=g_bursts) or (errorfree_S='0') then
+						eyemap_S(phasestep_S) <= errorfree_S;
+						if phasestep_S<g_phasesteps-1 then
+							phasestep_S <= phasestep_S+1;
+							calibrationstate_S <= SETPHASE;
+						else
+							analyseindex_S <= 0;
+							runlength_S <= 0;
+							bestlength_S <= 0;
+							calibrationstate_S <= ANALYSE;
+						end if;
+					end if;
+				when ANALYSE => -- find the longest range of error-free phase steps, twice around for wrapping eyes
+					if analyseindex_S<2*g_phasesteps then
+						if analyseindex_S<g_phasesteps then
+							index_v := analyseindex_S;
+						else
+							index_v := analyseindex_S-g_phasesteps;
+						end if;
+						if eyemap_S(index_v)='1' then
+							if runlength_S=0 then
+								runstart_S <= index_v;
+							end if;
+							if runlength_S<g_phasesteps then
+								runlength_S <= runlength_S+1;
+								if runlength_S+1>bestlength_S then
+									bestlength_S <= runlength_S+1;
+									if runlength_S=0 then
+										beststart_S <= index_v;
+									else
+										beststart_S <= runstart_S;
+									end if;
+								end if;
+							end if;
+						else
+							runlength_S <= 0;
+						end if;
+						analyseindex_S <= analyseindex_S+1;
+					else
+						if bestlength_S>0 then
+							eyefound_S <= '1';
+							if beststart_S+bestlength_S/2<g_phasesteps then
+								eyecentre_S <= beststart_S+bestlength_S/2;
+							else
+								eyecentre_S <= beststart_S+bestlength_S/2-g_phasesteps;
+							end if;
+						else
+							eyefound_S <= '0';
+						end if;
+						calibrationstate_S <= DONE;
+					end if;
+				when others =>
+					calibrationstate_S <= IDLE;
+			end case;
+		end if;
+	end if;
+end process;
+
+end struct;
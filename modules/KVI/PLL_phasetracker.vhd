@@ -0,0 +1,361 @@
+-------------------------------------------------------------------------------
+-- Title      : PLL phase tracker
+-- Project    : White Rabbit generator
+-------------------------------------------------------------------------------
+-- File       : PLL_phasetracker.vhd
+-- Author     : Peter Schakel
+-- Company    : KVI
+-- Created    : 2012-10-22
+-- Last update: 2012-10-22
+-- Platform   : FPGA-generic
+-- Standard   : VHDL'93
+-------------------------------------------------------------------------------
+-- Description:
+--
+-- Tracks slow phase drift between the White Rabbit 125MHz clock and the BuTiS 200MHz C2 clock.
+-- A 25MHz reference is made from the White Rabbit clock (divide by 5) and sampled with the BuTiS C2 clock.
+-- Every 40ns (8 C2 clock cycles) the position of the rising edge of the reference is determined.
+-- The first position after reset is the reference, the deviation of each next position is accumulated
+-- over 2^g_avgbits periods. Clock jitter makes the average finer than one C2 clock cycle.
+-- The accumulated phase error (units of 1/256 C2 clock cycle) is the input of a PI controller (gc_dual_pi_controller).
+-- The frequency of the BuTiS C2 clock is measured with the PPS (gc_frequency_meter):
+-- the PI controller runs in frequency mode until the frequency is 200MHz within freqenter_c counts per PPS
+-- (the asynchronous gate of the meter gives +-1 count), it goes back to frequency mode when the
+-- frequency error becomes larger than freqleave_c counts.
+-- The PI output is the phase offset in PLL phase steps, this offset is changed with at most one step for each update.
+-- A positive phase step of the PLL is assumed to delay the BuTiS C2 clock.
+-- The tracker is locked if the last 8 phase errors were within g_lockthreshold.
+-- The last 32 phase errors are kept in a trace buffer.
+--
+-- Generics
+--     g_avgbits : number of 40ns periods to average the phase is 2^g_avgbits
+--     g_lockthreshold : maximum phase error for lock (units of 1/256 C2 clock cycle)
+--     g_kp, g_ki : PI controller coefficients for the phase, 16 fraction bits
+--     g_fkp, g_fki : PI controller coefficients for the frequency, 16 fraction bits
+--
+-- Inputs
+--     clock_i : clock, 125MHz Whishbone bus clock
+--     reset_i : reset, also restarts with a new reference phase
+--     enable_i : enable tracking
+--     wr_clock_i : White Rabbit 125MHz clock
+--     wr_PPSpulse_i : White Rabbit PPS pulse
+--     BuTis_C2_i : BuTiS 200 MHz clock, phase adjusted
+--     trace_index_i : index in trace buffer for reading
+--
+-- Outputs
+--     offset_o : phase offset in PLL phase steps (signed)
+--     phase_error_o : last phase error (signed)
+--     locked_o : phase tracker locked
+--     trace_wrindex_o : index in trace buffer of the next phase error
+--     trace_data_o : trace buffer data at trace_index_i: bit 15..0 phase error, bit 23..16 offset, bit 31 locked
+--
+-- Components
+--     gc_frequency_meter : measures frequency of the BuTiS C2 clock
+--     gc_dual_pi_controller : PI controller
+--
+--
+-------------------------------------------------------------------------------
+-- Copyright (c) 2012 KVI / Peter Schakel
+-------------------------------------------------------------------------------
+-- Revisions  :
+-- Date        Version  Author          Description
+-------------------------------------------------------------------------------
+
+library IEEE;
+use IEEE.std_logic_1164.ALL;
+USE ieee.std_logic_unsigned.all ;
+USE ieee.std_logic_arith.all ;
+
+library work;
+use work.gencores_pkg.all;
+
+entity PLL_phasetracker is
+	generic(
+		g_avgbits                              : integer := 12;
+		g_lockthreshold                        : integer := 16;
+		g_kp                                   : integer := 13107;
+		g_ki                                   : integer := 1311;
+		g_fkp                                  : integer := 65536/4;
+		g_fki                                  : integer := 65536/64
+	);
+	port(
+		clock_i                                : in std_logic;
+		reset_i                                : in std_logic;
+		enable_i                               : in std_logic;
+		wr_clock_i                             : in std_logic;
+		wr_PPSpulse_i                          : in std_logic;
+		BuTis_C2_i                             : in std_logic;
+		trace_index_i                          : in std_logic_vector(4 downto 0);
+		offset_o                               : out std_logic_vector(7 downto 0);
+		phase_error_o                          : out std_logic_vector(15 downto 0);
+		locked_o                               : out std_logic;
+		trace_wrindex_o                        : out std_logic_vector(4 downto 0);
+		trace_data_o                           : out std_logic_vector(31 downto 0)
+   );
+end PLL_phasetracker;
+
+architecture struct of PLL_phasetracker is
+
+constant errorbits_c                       : integer := 12;
+constant dacbits_c                         : integer := 16;
+constant dacbias_c                         : integer := 32767;
+constant maxoffset_c                       : integer := 127;
+constant C2frequency_c                     : integer := 200000000;
+constant freqenter_c                       : integer := 2; -- frequency error to go to phase mode
+constant freqleave_c                       : integer := 8; -- frequency error to go back to frequency mode
+
+type trace_type is array(0 to 31) of std_logic_vector(31 downto 0);
+
+signal rst_n_s                             : std_logic := '0';
+signal ref_counter_s                       : integer range 0 to 4 := 0;
+signal ref_s                               : std_logic := '0';
+signal ref_sample_s                        : std_logic := '0';
+signal ref_sample_sync_s                   : std_logic := '0';
+signal ref_sample_prev_s                   : std_logic := '0';
+signal reset_C2_sync0_s                    : std_logic := '0';
+signal reset_C2_s                          : std_logic := '0';
+signal C2_counter_s                        : integer range 0 to 7 := 0;
+signal edge_position_s                     : integer range 0 to 7 := 0;
+signal edge_found_s                        : std_logic := '0';
+signal reference_valid_s                   : std_logic := '0';
+signal reference_position_s                : integer range 0 to 7 := 0;
+signal accumulator_s                       : integer range -4*2**g_avgbits to 4*2**g_avgbits := 0;
+signal window_counter_s                    : integer range 0 to 2**g_avgbits-1 := 0;
+signal phase_sum_s                         : integer range -4*2**g_avgbits to 4*2**g_avgbits := 0;
+signal phase_toggle_s                      : std_logic := '0';
+signal phase_toggle_sync0_s                : std_logic := '0';
+signal phase_toggle_sync1_s                : std_logic := '0';
+signal phase_toggle_sync2_s                : std_logic := '0';
+
+signal PPS_sync0_s                         : std_logic := '0';
+signal PPS_sync1_s                         : std_logic := '0';
+signal PPS_sync2_s                         : std_logic := '0';
+signal PPS_pulse_s                         : std_logic := '0';
+signal freq_s                              : std_logic_vector(31 downto 0);
+signal freq_valid_s                        : std_logic := '0';
+signal freq_valid_prev_s                   : std_logic := '0';
+signal freq_err_s                          : std_logic_vector(errorbits_c-1 downto 0) := (others => '0');
+signal freq_err_stb_s                      : std_logic := '0';
+signal freq_ok_s                           : std_logic := '0';
+signal phase_err_s                         : std_logic_vector(errorbits_c-1 downto 0) := (others => '0');
+signal phase_err_stb_s                     : std_logic := '0';
+signal mode_sel_s                          : std_logic := '1';
+signal dac_val_s                           : std_logic_vector(dacbits_c-1 downto 0);
+signal dac_val_stb_s                       : std_logic := '0';
+
+signal offset_s                            : integer range -maxoffset_c to maxoffset_c := 0;
+signal lockcounter_s                       : integer range 0 to 8 := 0;
+signal trace_s                             : trace_type := (others => (others => '0'));
+signal trace_wrindex_s                     : integer range 0 to 31 := 0;
+
+begin
+
+rst_n_s <= '1' when (reset_i='0') and (enable_i='1') else '0';
+offset_o <= conv_std_logic_vector(offset_s,8);
+phase_error_o <= sxt(phase_err_s,16);
+locked_o <= '1' when lockcounter_s=8 else '0';
+mode_sel_s <= not freq_ok_s; -- frequency mode until the BuTiS frequency is correct
+trace_wrindex_o <= conv_std_logic_vector(trace_wrindex_s,5);
+trace_data_o <= trace_s(conv_integer(trace_index_i));
+
+-- process to make 25MHz reference from the White Rabbit clock
+reference_process: process(wr_clock_i)
+begin
+	if rising_edge(wr_clock_i) then
+		if ref_counter_s<4 then
+			ref_counter_s <= ref_counter_s+1;
+		else
+			ref_counter_s <= 0;
+		end if;
+		if ref_counter_s<2 then
+			ref_s <= '1';
+		else
+			ref_s <= '0';
+		end if;
+	end if;
+end process;
+
+-- process to find the position of the reference edge in each 40ns period and to accumulate the deviation from the first position
+phasedetector_process: process(BuTis_C2_i)
+variable deviation_v : integer range -4 to 3;
+begin
+	if rising_edge(BuTis_C2_i) then
+		ref_sample_s <= ref_s; -- the timing for this signal is tight, the sample can be metastable
+		ref_sample_sync_s <= ref_sample_s;
+		ref_sample_prev_s <= ref_sample_sync_s;
+		reset_C2_sync0_s <= not rst_n_s;
+		reset_C2_s <= reset_C2_sync0_s;
+		if C2_counter_s<7 then
+			C2_counter_s <= C2_counter_s+1;
+		else
+			C2_counter_s <= 0;
+		end if;
+		if (ref_sample_sync_s='1') and (ref_sample_prev_s='0') then
+			edge_position_s <= C2_counter_s;
+			edge_found_s <= '1';
+		end if;
+		if reset_C2_s='1' then
+			reference_valid_s <= '0';
+			accumulator_s <= 0;
+			window_counter_s <= 0;
+			edge_found_s <= '0';
+		elsif (C2_counter_s=7) and (edge_found_s='1') then
+			edge_found_s <= '0';
+			if reference_valid_s='0' then
+				reference_position_s <= edge_position_s;
+				reference_valid_s <= '1';
+			else
+				deviation_v := edge_position_s-reference_position_s;
+				if edge_position_s-reference_position_s>3 then
+					deviation_v := edge_position_s-reference_position_s-8;
+				elsif edge_position_s-reference_position_s<-4 then
+					deviation_v := edge_position_s-reference_position_s+8;
+				end if;
+				if window_counter_s<2**g_avgbits-1 then
+					window_counter_s <= window_counter_s+1;
+					accumulator_s <= accumulator_s+deviation_v;
+				else -- hold the sum for the clock_i domain, stable for 2^g_avgbits periods
+					window_counter_s <= 0;
+					accumulator_s <= 0;
+					phase_sum_s <= accumulator_s+deviation_v;
+					phase_toggle_s <= not phase_toggle_s;
+				end if;
+			end if;
+		end if;
+	end if;
+end process;
+
+-- process to synchronise the PPS and to make the phase error in units of 1/256 C2 clock cycle for the PI controller
+error_process: process(clock_i)
+variable error_v : integer;
+begin
+	if rising_edge(clock_i) then
+		PPS_sync0_s <= wr_PPSpulse_i;
+		PPS_sync1_s <= PPS_sync0_s;
+		PPS_sync2_s <= PPS_sync1_s;
+		PPS_pulse_s <= PPS_sync1_s and not PPS_sync2_s;
+		phase_toggle_sync0_s <= phase_toggle_s;
+		phase_toggle_sync1_s <= phase_toggle_sync0_s;
+		phase_toggle_sync2_s <= phase_toggle_sync1_s;
+		phase_err_stb_s <= '0';
+		freq_err_stb_s <= '0';
+		if phase_toggle_sync1_s/=phase_toggle_sync2_s then
+			if g_avgbits>=8 then
+				error_v := phase_sum_s/(2**(g_avgbits-8));
+			else
+				error_v := phase_sum_s*(2**(8-g_avgbits));
+			end if;
+			if error_v>2**(errorbits_c-1)-1 then
+				error_v := 2**(errorbits_c-1)-1;
+			elsif error_v<-2**(errorbits_c-1) then
+				error_v := -2**(errorbits_c-1);
+			end if;
+			phase_err_s <= conv_std_logic_vector(error_v,errorbits_c);
+			phase_err_stb_s <= '1';
+		end if;
+		freq_valid_prev_s <= freq_valid_s;
+		if (freq_valid_s='1') and (freq_valid_prev_s='0') then
+			error_v := conv_integer(freq_s(30 downto 0))-C2frequency_c;
+			if error_v>2**(errorbits_c-1)-1 then
+				error_v := 2**(errorbits_c-1)-1;
+			elsif error_v<-2**(errorbits_c-1) then
+				error_v := -2**(errorbits_c-1);
+			end if;
+			if (error_v>=-freqenter_c) and (error_v<=freqenter_c) then
+				freq_ok_s <= '1';
+			elsif (error_v<-freqleave_c) or (error_v>freqleave_c) then
+				freq_ok_s <= '0';
+			end if;
+			freq_err_s <= conv_std_logic_vector(error_v,errorbits_c);
+			freq_err_stb_s <= '1';
+		end if;
+		if rst_n_s='0' then
+			freq_ok_s <= '0';
+		end if;
+	end if;
+end process;
+
+frequency_meter: gc_frequency_meter
+	generic map(
+		g_with_internal_timebase => false,
+		g_clk_sys_freq => 125000000,
+		g_counter_bits => 32)
+	port map(
+		clk_sys_i => clock_i,
+		clk_in_i => BuTis_C2_i,
+		rst_n_i => rst_n_s,
+		pps_p1_i => PPS_pulse_s,
+		freq_o => freq_s,
+		freq_valid_o => freq_valid_s);
+
+PI_controller: gc_dual_pi_controller
+	generic map(
+		g_error_bits => errorbits_c,
+		g_dacval_bits => dacbits_c,
+		g_output_bias => dacbias_c,
+		g_integrator_fracbits => 16,
+		g_integrator_overbits => 6,
+		g_coef_bits => 16)
+	port map(
+		clk_sys_i => clock_i,
+		rst_n_sysclk_i => rst_n_s,
+		phase_err_i => phase_err_s,
+		phase_err_stb_p_i => phase_err_stb_s,
+		freq_err_i => freq_err_s,
+		freq_err_stb_p_i => freq_err_stb_s,
+		mode_sel_i => mode_sel_s,
+		dac_val_o => dac_val_s,
+		dac_val_stb_p_o => dac_val_stb_s,
+		pll_pcr_enable_i => '1',
+		pll_pcr_force_f_i => '0',
+		pll_fbgr_f_kp_i => conv_std_logic_vector(g_fkp,16),
+		pll_fbgr_f_ki_i => conv_std_logic_vector(g_fki,16),
+		pll_pbgr_p_kp_i => conv_std_logic_vector(g_kp,16),
+		pll_pbgr_p_ki_i => conv_std_logic_vector(g_ki,16));
+
+-- process to move the phase offset one step towards the PI output, check for lock and fill the trace buffer
+offset_process: process(clock_i)
+variable target_v : integer;
+variable error_v : integer;
+begin
+	if rising_edge(clock_i) then
+		if rst_n_s='0' then
+			offset_s <= 0;
+			lockcounter_s <= 0;
+		else
+			if dac_val_stb_s='1' then
+				target_v := conv_integer(dac_val_s)-dacbias_c;
+				if (target_v>offset_s) and (offset_s<maxoffset_c) then
+					offset_s <= offset_s+1;
+				elsif (target_v<offset_s) and (offset_s>-maxoffset_c) then
+					offset_s <= offset_s-1;
+				end if;
+			end if;
+			if phase_err_stb_s='1' then
+				error_v := conv_integer(signed(phase_err_s));
+				if (freq_ok_s='1') and (error_v<=g_lockthreshold) and (error_v>=-g_lockthreshold) then
+					if lockcounter_s<8 then
+						lockcounter_s <= lockcounter_s+1;
+					end if;
+				else
+					lockcounter_s <= 0;
+				end if;
+				trace_s(trace_wrindex_s)(15 downto 0) <= sxt(phase_err_s,16);
+				trace_s(trace_wrindex_s)(23 downto 16) <= conv_std_logic_vector(offset_s,8);
+				trace_s(trace_wrindex_s)(30 downto 24) <= (others => '0');
+				if lockcounter_s=8 then
+					trace_s(trace_wrindex_s)(31) <= '1';
+				else
+					trace_s(trace_wrindex_s)(31) <= '0';
+				end if;
+				if trace_wrindex_s<31 then
+					trace_wrindex_s <= trace_wrindex_s+1;
+				else
+					trace_wrindex_s <= 0;
+				end if;
+			end if;
+		end if;
+	end if;
+end process;
+
+end struct;
@@ -17,19 +17,16 @@
 -- Generics
 --
 -- Inputs
---     clk_sys_i : 125MHz Whishbone bus clock
---     rst_n_i : reset: low active
+--     clock_i : clock for the PLL phase adjustment (scanclk of the PLL)
+--     reset_i : reset, the PLL phase is zero after reset
 --     enable_i : enable phase adjusting
---     gpio_slave_i : Record with Whishbone Bus signals
---     wr_clock_i : White Rabbit 125MHz clock
---     wr_PPSpulse_i : White Rabbit PPS pulse
+--     phase_i : desired phase in PLL phase steps
+--     phasedone_i : phasedone signal from the PLL
 --
 -- Outputs
---     gpio_slave_o : Record with Whishbone Bus signals
---     BuTis_C2_o : BuTiS 200 MHz clock
---     BuTis_T0_o : BuTis T0 100kHz signal
---     BuTis_T0_timestamp_o : BuTis T0 100kHz signal with serial encoded 64-bits timestamp
---     error_o : error detected: wr_PPSpulse_i signal period is not exactly 1 second
+--     phasestep_o : phasestep signal to the PLL
+--     phaseupdown_o : phaseupdown signal to the PLL
+--     ready_o : the PLL phase is equal to phase_i
 --
 -- Components
 --
@@ -54,7 +51,8 @@ entity PLL_setphase is
 		phase_i                                : in std_logic_vector(7 downto 0);
 		phasedone_i                            : in std_logic;
 		phasestep_o                            : out std_logic;
-		phaseupdown_o                          : out std_logic
+		phaseupdown_o                          : out std_logic;
+		ready_o                                : out std_logic
    );
 end PLL_setphase;
 
@@ -75,6 +73,7 @@ begin
 
 phasestep_o <= phasestep_S;
 phaseupdown_o <= phaseupdown_S;
+ready_o <= '1' when (enable_i='1') and (reset_i='0') and (phasestate_S=STEADY) and (actualphase_S=phase_i) else '0';
 
 -- process to detect the phasedone_i signal from the PLL
 phasedone_process: process (clock_i,phasedone_i)
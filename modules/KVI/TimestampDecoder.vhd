@@ -45,6 +45,9 @@
 --     timestamp_write_o : Write signal for Timestamp_o: new value decoded
 --     corrected_o : Error in serial burst was successfully corrected with Reed Solomon
 --     error_o : error detected that could not be corrected
+--     corrected_symbols_o : number of bytes in the serial burst that were changed by the Reed Solomon decoder
+--     T0_period_o : number of BuTiS C2 clock cycles between the last two BuTis T0 signals (saturates at 65535)
+--     linkstat_write_o : Write signal for corrected_symbols_o and T0_period_o: all bytes of the burst are read
 --
 -- Components
 --     RS_DEC4 : Open source Reed Solomon decoder by Anatoliy Sergienko, Volodya Lepeha
@@ -82,7 +85,10 @@ entity TimestampDecoder is
 	timestamp_o                              : out std_logic_vector(g_timestampbytes*8-1 downto 0);
 	timestamp_write_o                        : out std_logic;
 	corrected_o                              : out std_logic;
-	error_o                                  : out std_logic);
+	error_o                                  : out std_logic;
+	corrected_symbols_o                      : out std_logic_vector(3 downto 0);
+	T0_period_o                              : out std_logic_vector(15 downto 0);
+	linkstat_write_o                         : out std_logic);
 end TimestampDecoder;
 
 architecture rtl of TimestampDecoder is
@@ -103,6 +109,7 @@ component RS_DEC4 is
 end component;
 
 constant serialbytes_c                       : integer := g_timestampbytes + g_RScodewords;
+type rawbytes_type is array(0 to serialbytes_c-1) of std_logic_vector(7 downto 0);
 
 type RS_decoder_mode_type is (WAITFORSIGNAL,SER2PAR,WAITRESULT,READRESULT,READRESULT_ODD,WAITFORZEROS);
 signal RS_decoder_mode_s                     : RS_decoder_mode_type := WAITFORSIGNAL;
@@ -135,6 +142,10 @@ signal bitcounter_s                          : integer range 0 to 7 := 0;
 signal bytecounter_s                         : integer range 0 to g_timestampbytes+g_RScodewords := 0;
 signal ratiocounter_s                        : integer range 0 to g_BuTis_ratio+g_BuTis_T0_precision := 0;
 signal zeroscounter_s                        : integer range 0 to g_BuTis_ratio/2 := 0;
+
+signal rawbytes_s                            : rawbytes_type := (others => (others => '0'));
+signal corrected_symbols_s                   : integer range 0 to serialbytes_c := 0;
+signal T0period_counter_s                    : integer range 0 to 65535 := 0;
 			
 			
 attribute syn_encoding : string;
@@ -212,6 +223,26 @@ end generate;
 
 BuTis_T0_o <= '1' when (RS_decoder_mode_s=WAITFORSIGNAL) and (serial_i='1') and (serial_s='0') else '0';
 
+-- process to measure the period between two successive BuTis T0 signals, used for link quality statistics
+T0period_process : process(BuTis_C2_i)
+begin
+    if rising_edge(BuTis_C2_i) then
+		if reset_i = '1' then
+			T0period_counter_s <= 65535;
+			T0_period_o <= (others => '1');
+		elsif (RS_decoder_mode_s=WAITFORSIGNAL) and (serial_i='1') and (serial_s='0') then
+			if T0period_counter_s<65535 then
+				T0_period_o <= conv_std_logic_vector(T0period_counter_s+1,16);
+			else
+				T0_period_o <= (others => '1');
+			end if;
+			T0period_counter_s <= 0;
+		elsif T0period_counter_s<65535 then
+			T0period_counter_s <= T0period_counter_s+1;
+		end if;
+	end if;
+end process;
+
 -- process with state machine to translate serial data to parallel, feed it to the decoder and combine the result to one timestamp
 BuTis_process : process(BuTis_C2_i)
 begin
@@ -221,11 +252,13 @@ begin
 			RS_decoder_STR_s <= '0';
 			RS_decoder_RD_s <= '0';
 			timestamp_write_o <= '0'; 
+			linkstat_write_o <= '0';
 			error_s <= '0';
 			ratiocounter_s <= 0;
 			RS_decoder_mode_s <= WAITFORSIGNAL;
 		else
 			timestamp_write_o <= '0'; 
+			linkstat_write_o <= '0';
 			if ratiocounter_s<g_BuTis_ratio+g_BuTis_T0_precision then -- ratiocounter to check 100kHz period
 				ratiocounter_s <= ratiocounter_s+1;
 			end if;
@@ -280,6 +313,9 @@ begin
 							RS_decoder_EN_s <= '0';
 						else
 							bitcounter_s <= 0;
+							if (bytecounter_s>0) then -- keep the received bytes to count the corrected symbols afterwards
+								rawbytes_s(bytecounter_s-1) <= RS_decoder_Din_s;
+							end if;
 							if (bytecounter_s=0) then  -- simple test to improve bit phase, doesn't improve! (disabled now)
 								if phasecheck_counter_s>7 then -- first 8 bits is startbyte (0xaa)
 									phaseadjust_s <= 0; -- 0;
@@ -330,6 +366,15 @@ begin
 					RS_decoder_EN_s <= '1';
 					RS_decoder_STR_s <= '0';
 					RS_decoder_RD_s <= '1';
+					if bytecounter_s=0 then -- count the bytes that differ between the received burst and the decoder output
+						if RS_decoder_Dout_s/=rawbytes_s(0) then
+							corrected_symbols_s <= 1;
+						else
+							corrected_symbols_s <= 0;
+						end if;
+					elsif RS_decoder_Dout_s/=rawbytes_s(bytecounter_s) then
+						corrected_symbols_s <= corrected_symbols_s+1;
+					end if;
 					if bytecounter_s<g_timestampbytes-1 then
 						timestamp_s((g_timestampbytes-bytecounter_s)*8-1 downto (g_timestampbytes-bytecounter_s-1)*8) 
 							<= RS_decoder_Dout_s;
@@ -356,6 +401,7 @@ begin
 							RS_decoder_mode_s <= READRESULT;
 						end if;
 					else
+						linkstat_write_o <= '1';
 						zeroscounter_s <= 0;
 						RS_decoder_mode_s <= WAITFORZEROS;
 					end if;
@@ -383,6 +429,7 @@ begin
    end if;
 end process;
 
+corrected_symbols_o <= conv_std_logic_vector(corrected_symbols_s,4);
   
 end;
 
@@ -6,7 +6,7 @@
 -- Author     : Peter Schakel
 -- Company    : KVI
 -- Created    : 2012-08-27
--- Last update: 2012-09-28
+-- Last update: 2012-10-23
 -- Platform   : FPGA-generic
 -- Standard   : VHDL'93
 -------------------------------------------------------------------------------
@@ -23,12 +23,20 @@
 --     then the timestamp bytes are tranceived, Most Significant Byte first
 --     after this the Reed Solomon bytes, calculated on the timestamp bytes are sent
 --     Between the last bit and the next BuTiS T0 with code the signal is zero
+-- The timestamp increments exactly g_BuTis_ratio between two BuTiS T0 pulses, so the next timestamp is known
+-- one period in advance. The Reed Solomon bytes for the next timestamp are calculated during the current period,
+-- the serializer takes the timestamp and Reed Solomon bytes from registers.
+-- The Reed Solomon encoder runs with a clock enable of 1/g_RSclockdivisor of the BuTiS C2 clock:
+-- the paths inside RS_EN4 can be constrained as multicycle paths.
+-- After reset, a new timestamp (settimestamp_i) or a wrong BuTiS T0 period the Reed Solomon bytes are calculated
+-- directly after the BuTiS T0 pulse; this is ready before the last timestamp byte is sent.
 -- 
 -- Generics
 --     g_timestampbytes : number of bytes for the timestamp, (8 means 64-bit timestamp)
 --     g_clockcyclesperbit : number 200MHz clock cycles for each serial bit (default 4)
 --     g_RScodewords : number of code words (=bytes) for Reed Solomons code, (4 means that upto 2 erroneous bytes can be corrected)
 --     g_BuTis_ratio : Ratio between BuTiS C2 clock (200MHz) and T0 signal (100kHz)
+--     g_RSclockdivisor : clock enable divisor for the Reed Solomon encoder
 --
 -- Inputs
 --     BuTis_C2_i : BuTiS 200 MHz clock
@@ -50,8 +58,6 @@
 -- Revisions  :
 -- Date        Version  Author          Description
 -------------------------------------------------------------------------------
-
-
 library ieee;
 use ieee.std_logic_1164.all;
 --use ieee.numeric_std.all;
@@ -64,7 +70,8 @@ entity TimestampEncoder is
 		g_timestampbytes                         : integer := 8;
 		g_clockcyclesperbit                      : integer := 4;
 		g_RScodewords                            : integer := 4;
-		g_BuTis_ratio                            : integer := 2000);
+		g_BuTis_ratio                            : integer := 2000;
+		g_RSclockdivisor                         : integer := 2);
   port(
 		BuTis_C2_i                               : in  std_logic;
 		BuTis_T0_i                               : in  std_logic;
@@ -96,6 +103,8 @@ constant serialbytes_c                       : integer := g_timestampbytes + g_R
 
 type RS_encoder_mode_type is (STARTBYTE,PAR2SER,NEXTTIMESTAMP);
 signal RS_encoder_mode_s                     : RS_encoder_mode_type := NEXTTIMESTAMP;
+type RS_calc_mode_type is (RS_IDLE,RS_START,RS_FEED,RS_READ,RS_DONE);
+signal RS_calc_mode_s                        : RS_calc_mode_type := RS_IDLE;
 
 signal RS_encoder_EN_s                       : std_logic := '0';
 signal RS_encoder_Din_s                      : std_logic_vector(7 downto 0) := (others => '0');
@@ -107,12 +116,26 @@ signal BuTis_T0_s                            : std_logic := '0';
 signal serial_s                              : std_logic := '0';
 signal timestamp_s                           : std_logic_vector(g_timestampbytes*8-1 downto 0) := (others => '0');
 signal timestampcounter_s                    : std_logic_vector(g_timestampbytes*8-1 downto 0) := (others => '0');
+signal nexttimestamp_s                       : std_logic_vector(g_timestampbytes*8-1 downto 0) := (others => '0');
+signal T0edge_s                              : std_logic := '0';
+signal periodok_s                            : std_logic := '0';
+signal timestampchanged_s                    : std_logic := '0';
+
+signal RS_clockcounter_s                     : integer range 0 to g_RSclockdivisor-1 := 0;
+signal RS_data_s                             : std_logic_vector(g_timestampbytes*8-1 downto 0) := (others => '0');
+signal RS_current_s                          : std_logic := '0';
+signal RS_readcounter_s                      : integer range 0 to serialbytes_c-1 := 0;
+signal RS_parity_s                           : std_logic_vector(g_RScodewords*8-1 downto 0) := (others => '0');
+signal needcurrent_s                         : std_logic := '0';
+signal neednext_s                            : std_logic := '0';
+signal parity_s                              : std_logic_vector(g_RScodewords*8-1 downto 0) := (others => '0');
+signal parityvalid_s                         : std_logic := '0';
+signal burstparity_s                         : std_logic_vector(g_RScodewords*8-1 downto 0) := (others => '0');
+signal burstdata_s                           : std_logic_vector(g_timestampbytes*8-1 downto 0) := (others => '0');
 
-signal RS_encoder_enable_s                   : std_logic;
 signal clockcounter_s                        : integer range 0 to g_clockcyclesperbit-1 := 0;
 signal bitcounter_s                          : integer range 0 to 7 := 0;
 signal bytecounter_s                         : integer range 0 to g_timestampbytes+g_RScodewords-1 := 0;
-signal tsbytecounter_s                       : integer range 0 to g_timestampbytes := 0;
 signal BuTis_T0_counter_s                    : integer range 0 to g_BuTis_ratio := 0;
 
 begin
@@ -129,11 +152,15 @@ RS_encoder: RS_EN4 port map(
 	SNB => RS_encoder_SNB_s);
 	
  -- process for timestamp counter and check for time between BuTiS_T0 100kHz pulses
+ -- the timestamp for the next BuTiS_T0 pulse is known one period in advance: nexttimestamp_s
 timestamp_process : process(BuTis_C2_i)
 begin
     if rising_edge(BuTis_C2_i) then
 		if reset_i = '1' then
 			timestampcounter_s <= (others => '0');
+			T0edge_s <= '0';
+			periodok_s <= '0';
+			timestampchanged_s <= '0';
 		else
 			if settimestamp_i='1' then
 				timestampcounter_s <= timestamp_i; 
@@ -142,42 +169,134 @@ begin
 			end if;
 			if BuTis_T0_i='1' and BuTis_T0_s='0' then -- rising edge BuTis_T0
 				timestamp_s <= timestampcounter_s;
+				if settimestamp_i='1' then
+					nexttimestamp_s <= timestamp_i+(g_BuTis_ratio-1);
+				else
+					nexttimestamp_s <= timestampcounter_s+g_BuTis_ratio;
+				end if;
 				if BuTis_T0_counter_s/=g_BuTis_ratio-1 then
 					error_o <= '1';
+					periodok_s <= '0';
 				else
 					error_o <= '0';
+					periodok_s <= '1';
 				end if;
 				BuTis_T0_counter_s <= 0;
-				RS_encoder_STR_s <= '1';
-				tsbytecounter_s <= 0;
+				T0edge_s <= '1';
+				timestampchanged_s <= '0';
 			else -- increment counter for BuTiS_T0 period check
+				if settimestamp_i='1' then -- shift the next timestamp with the same amount as the counter
+					if BuTis_T0_counter_s<g_BuTis_ratio-1 then
+						nexttimestamp_s <= timestamp_i+(g_BuTis_ratio-2-BuTis_T0_counter_s);
+					else
+						nexttimestamp_s <= timestamp_i;
+					end if;
+					timestampchanged_s <= '1';
+				else
+					timestampchanged_s <= '0';
+				end if;
 				if BuTis_T0_counter_s<=g_BuTis_ratio-1 then
 					BuTis_T0_counter_s <= BuTis_T0_counter_s+1;
 				end if;					
-				RS_encoder_STR_s <= '0';
-				if tsbytecounter_s<g_timestampbytes then
-					RS_encoder_Din_s <= timestamp_s(g_timestampbytes*8-tsbytecounter_s*8-1 downto g_timestampbytes*8-tsbytecounter_s*8-8);
-					tsbytecounter_s <= tsbytecounter_s+1;
+				T0edge_s <= '0';
+			end if;
+		end if;
+	end if;
+end process;
+
+ -- clock enable for the Reed Solomon encoder, all paths inside RS_EN4 are multicycle paths of g_RSclockdivisor clock cycles
+RS_clockenable_process : process(BuTis_C2_i)
+begin
+    if rising_edge(BuTis_C2_i) then
+		if reset_i = '1' then
+			RS_clockcounter_s <= 0;
+		elsif RS_clockcounter_s<g_RSclockdivisor-1 then
+			RS_clockcounter_s <= RS_clockcounter_s+1;
+		else
+			RS_clockcounter_s <= 0;
+		end if;
+	end if;
+end process;
+RS_encoder_EN_s <= '1' when RS_clockcounter_s=0 else '0';
+
+RS_encoder_STR_s <= '1' when RS_calc_mode_s=RS_START else '0';
+RS_encoder_RD_s <= '1' when RS_calc_mode_s=RS_READ else '0';
+RS_encoder_Din_s <= RS_data_s(g_timestampbytes*8-1 downto g_timestampbytes*8-8) when RS_calc_mode_s=RS_FEED else (others => '0');
+
+ -- process with statemachine to calculate the Reed Solomon code words in advance:
+ -- during each BuTiS_T0 period the code words for the next timestamp are calculated and stored in parity_s.
+ -- On the BuTiS_T0 pulse they are copied to burstparity_s for the serializer.
+ -- If the precalculated code words are not valid (after reset, a changed timestamp or a wrong BuTiS_T0 period)
+ -- the code words for the current timestamp are calculated first, this is ready long before the serializer needs them.
+RS_calc_process : process(BuTis_C2_i)
+begin
+    if rising_edge(BuTis_C2_i) then
+		if reset_i = '1' then
+			RS_calc_mode_s <= RS_IDLE;
+			needcurrent_s <= '0';
+			neednext_s <= '0';
+			parityvalid_s <= '0';
+		else
+			if RS_encoder_EN_s='1' then
+				case RS_calc_mode_s is
+					when RS_IDLE =>
+						RS_readcounter_s <= 0;
+						if needcurrent_s='1' then
+							RS_data_s <= timestamp_s;
+							RS_current_s <= '1';
+							needcurrent_s <= '0';
+							RS_calc_mode_s <= RS_START;
+						elsif neednext_s='1' then
+							RS_data_s <= nexttimestamp_s;
+							RS_current_s <= '0';
+							neednext_s <= '0';
+							RS_calc_mode_s <= RS_START;
+						end if;
+					when RS_START => -- STR pulse for the encoder
+						RS_calc_mode_s <= RS_FEED;
+					when RS_FEED => -- timestamp bytes, Most Significant Byte first, followed by zeros until the code words are ready
+						RS_data_s <= RS_data_s(g_timestampbytes*8-9 downto 0) & x"00";
+						if RS_encoder_SNB_s='1' then
+							RS_calc_mode_s <= RS_READ;
+						end if;
+					when RS_READ => -- read all bytes from the encoder, keep the code words
+						if RS_readcounter_s>=g_timestampbytes then
+							RS_parity_s <= RS_parity_s(g_RScodewords*8-9 downto 0) & RS_encoder_Dout_s;
+						end if;
+						if RS_readcounter_s<serialbytes_c-1 then
+							RS_readcounter_s <= RS_readcounter_s+1;
+						else
+							RS_calc_mode_s <= RS_DONE;
+						end if;
+					when RS_DONE =>
+						if RS_current_s='1' then
+							burstparity_s <= RS_parity_s;
+						elsif neednext_s='0' then -- discard if the next timestamp has changed during the calculation
+							parity_s <= RS_parity_s;
+							parityvalid_s <= '1';
+						end if;
+						RS_calc_mode_s <= RS_IDLE;
+					when others =>
+						RS_calc_mode_s <= RS_IDLE;
+				end case;
+			end if;
+			if T0edge_s='1' then
+				if (parityvalid_s='1') and (periodok_s='1') then
+					burstparity_s <= parity_s;
 				else
-					RS_encoder_Din_s <= (others => '0');
+					needcurrent_s <= '1';
 				end if;
+				parityvalid_s <= '0';
+				neednext_s <= '1';
+			elsif timestampchanged_s='1' then
+				parityvalid_s <= '0';
+				neednext_s <= '1';
 			end if;
 		end if;
 	end if;
 end process;
-
-RS_encoder_RD_s <= '1' when -- read signal for Reed Solomon encoder module
-	(RS_encoder_mode_s=PAR2SER) and (clockcounter_s=g_clockcyclesperbit-1) and (bitcounter_s=7) and (bytecounter_s<serialbytes_c-1)
-		else '0';
-RS_encoder_EN_s <= '1' when -- enable signal for Reed Solomon encoder module
-		(reset_i='0') 
-		or (BuTis_T0_i='1' and BuTis_T0_s='0')
-		or ((RS_encoder_enable_s='1') and (RS_encoder_mode_s=STARTBYTE))
-		or (RS_encoder_RD_s='1')
-		or (RS_encoder_mode_s=NEXTTIMESTAMP)
-	else '0';
 	
- -- process with statemachine to encode byte-wide data and serialize the result
+ -- process with statemachine to serialize the timestamp and the code words
 BuTis_process : process(BuTis_C2_i)
 begin
     if rising_edge(BuTis_C2_i) then
@@ -185,7 +304,6 @@ begin
 			BuTis_T0_s <= '0';
 			RS_encoder_mode_s <= NEXTTIMESTAMP;
 			serial_s <= '0';
-			RS_encoder_enable_s <= '1';
 		else
 			BuTis_T0_s <= BuTis_T0_i;
 			
@@ -195,7 +313,6 @@ begin
 				bitcounter_s <= 0;
 				bytecounter_s <= 0;
 				serial_s <= '0';
-				RS_encoder_enable_s <= '1';
 			elsif RS_encoder_mode_s=STARTBYTE then -- state STARTBYTE: send one byte serially startbyte is 0x55
 				if clockcounter_s=0 then
 					serial_s <= not serial_s;
@@ -208,16 +325,14 @@ begin
 						bitcounter_s <= bitcounter_s+1;
 					else
 						bitcounter_s <= 0;
+						burstdata_s <= timestamp_s;
 						RS_encoder_mode_s <= PAR2SER;
 					end if;
 				end if;
 				bytecounter_s <= 0;
-				if RS_encoder_SNB_s='1' then
-					RS_encoder_enable_s <= '0';
-				end if;
-			elsif RS_encoder_mode_s=PAR2SER then -- state PAR2SER: translate byte-wise encoded data to serial
+			elsif RS_encoder_mode_s=PAR2SER then -- state PAR2SER: translate timestamp and code words to serial
 				if clockcounter_s=0 then
-					serial_s <= RS_encoder_Dout_s(7-bitcounter_s);
+					serial_s <= burstdata_s(g_timestampbytes*8-1-bitcounter_s);
 				end if;
 				if clockcounter_s<g_clockcyclesperbit-1 then
 					clockcounter_s <= clockcounter_s+1;
@@ -227,6 +342,12 @@ begin
 						bitcounter_s <= bitcounter_s+1;
 					else
 						bitcounter_s <= 0;
+						if bytecounter_s=g_timestampbytes-1 then -- timestamp done: continue with the code words
+							burstdata_s <= (others => '0');
+							burstdata_s(g_timestampbytes*8-1 downto (g_timestampbytes-g_RScodewords)*8) <= burstparity_s;
+						else
+							burstdata_s <= burstdata_s(g_timestampbytes*8-9 downto 0) & x"00";
+						end if;
 						if bytecounter_s<serialbytes_c-1 then
 							bytecounter_s <= bytecounter_s+1;
 						else
@@ -244,4 +365,3 @@ end process;
 
   
 end;
-
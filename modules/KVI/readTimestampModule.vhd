@@ -16,9 +16,18 @@
 -- During reading a disable bit must be set to prevent data corruption.
 -- The Whishbone Bus addresses are described in the wb_readTimestamp documentation.
 -- 
+-- Link quality histograms are kept in hardware, one update for each received serial burst.
+-- They are readable as a block of 32 words from address offset 0x80:
+--     0x80..0x9c : corrected symbols : bin n = bursts with n corrected bytes (n=0..6), bin 7 = not correctable
+--     0xa0..0xdc : T0 period deviation from g_BuTis_ratio : bin 0 = below -g_BuTis_T0_precision,
+--                  bins 1..14 divide the window -g_BuTis_T0_precision..+g_BuTis_T0_precision, bin 15 = above
+--     0xe0..0xfc : burst arrival jitter : bin n = period differs n clock cycles from the previous period, bin 7 = 7 or more
+-- The counters saturate at 0xffffffff. They can be frozen and cleared with the control register.
 -- 
 -- Generics
 --     g_timestampbytes : number of bytes for timestamp, should be 64 for 2*32
+--     g_BuTis_ratio : Ratio between BuTiS C2 clock (200MHz) and T0 signal (100kHz)
+--     g_BuTis_T0_precision : window for the T0 period deviation histogram (+/- number of clock cycles)
 --
 -- Inputs
 --     clk_sys_i : 125MHz Whishbone bus clock
@@ -29,6 +38,9 @@
 --     timestamp_write_i : Write signal for Timestamp from Timestamp Decoder Module
 --     timestamp_corrected_i : Indicates if Timestamp has been succesfully corrected for errors
 --     timestamp_error_i : Indicates that errors could not have been corrected
+--     corrected_symbols_i : Number of bytes corrected in the last serial burst
+--     T0_period_i : Period of the last BuTiS T0 in BuTiS C2 clock cycles
+--     linkstat_write_i : Write signal for corrected_symbols_i and T0_period_i
 --
 -- Outputs
 --     gpio_slave_o : Record with Whishbone Bus signals
@@ -55,7 +67,9 @@ use work.wishbone_pkg.all;
 
 entity readTimestampModule is
 	generic(
-		g_timestampbytes                       : integer := 8
+		g_timestampbytes                       : integer := 8;
+		g_BuTis_ratio                          : integer := 2000;
+		g_BuTis_T0_precision                   : integer := 100
 	);
 	port(
 		clk_sys_i                              : in std_logic;
@@ -66,7 +80,10 @@ entity readTimestampModule is
 		timestamp_i                            : in std_logic_vector(g_timestampbytes*8-1 downto 0);
 		timestamp_write_i                      : in std_logic;
 		timestamp_corrected_i                  : in std_logic;
-		timestamp_error_i                      : in std_logic
+		timestamp_error_i                      : in std_logic;
+		corrected_symbols_i                    : in std_logic_vector(3 downto 0);
+		T0_period_i                            : in std_logic_vector(15 downto 0);
+		linkstat_write_i                       : in std_logic
     );
 end readTimestampModule;
 
@@ -110,10 +127,20 @@ component wb_readTimestamp is
     wbrdtime_control_correction_i            : in     std_logic_vector(0 downto 0);
 -- Ports for PASS_THROUGH field: 'Clear' in reg: 'Read Timestamp control'
     wbrdtime_control_clear_o                 : out    std_logic_vector(0 downto 0);
-    wbrdtime_control_clear_wr_o              : out    std_logic
+    wbrdtime_control_clear_wr_o              : out    std_logic;
+-- Port for std_logic_vector field: 'Histogram freeze' in reg: 'Read Timestamp control'
+    wbrdtime_control_hist_freeze_o           : out    std_logic_vector(0 downto 0);
+-- Ports for PASS_THROUGH field: 'Histogram clear' in reg: 'Read Timestamp control'
+    wbrdtime_control_hist_clear_o            : out    std_logic_vector(0 downto 0);
+    wbrdtime_control_hist_clear_wr_o         : out    std_logic
 	 );
 end component;
 
+constant periodbins_c                      : integer := 14; -- number of bins inside the T0 precision window
+constant periodbinwidth_c                  : integer := (2*g_BuTis_T0_precision+periodbins_c)/periodbins_c;
+type histogram8_type is array(0 to 7) of std_logic_vector(31 downto 0);
+type histogram16_type is array(0 to 15) of std_logic_vector(31 downto 0);
+
 signal wbrdtime_high_timestamp_s           : std_logic_vector(31 downto 0);
 signal wbrdtime_low_timestamp_s            : std_logic_vector(31 downto 0);
 signal timestamp_s                         : std_logic_vector(g_timestampbytes*8-1 downto 0) := (others => '0');
@@ -132,6 +159,33 @@ signal timestamp_error_sync1_s             : std_logic := '0';
 signal timestamp_corrected_s               : std_logic := '0';
 signal timestamp_corrected_sync0_s         : std_logic := '0';
 signal timestamp_corrected_sync1_s         : std_logic := '0';
+
+signal wb_stb_s                            : std_logic := '0';
+signal wb_ack_s                            : std_logic := '0';
+signal wb_data_s                           : std_logic_vector(31 downto 0);
+signal wbrdtime_control_hist_freeze_s      : std_logic_vector(0 downto 0);
+signal wbrdtime_control_hist_clear_s       : std_logic_vector(0 downto 0);
+signal wbrdtime_control_hist_clear_wr_s    : std_logic := '0';
+signal hist_ack_s                          : std_logic := '0';
+signal hist_data_s                         : std_logic_vector(31 downto 0) := (others => '0');
+
+signal linkstat_symbols_s                  : std_logic_vector(3 downto 0) := (others => '0');
+signal linkstat_period_s                   : std_logic_vector(15 downto 0) := (others => '0');
+signal linkstat_error_s                    : std_logic := '0';
+signal linkstat_toggle_s                   : std_logic := '0';
+signal linkstat_toggle_sync0_s             : std_logic := '0';
+signal linkstat_toggle_sync1_s             : std_logic := '0';
+signal linkstat_toggle_sync2_s             : std_logic := '0';
+signal linkstat_new_s                      : std_logic := '0';
+signal prev_period_s                       : integer range 0 to 65535 := 0;
+signal prev_period_valid_s                 : std_logic := '0';
+signal jitter_valid_s                      : std_logic := '0';
+signal symbolsbin_s                        : integer range 0 to 7 := 0;
+signal periodbin_s                         : integer range 0 to 15 := 0;
+signal jitterbin_s                         : integer range 0 to 7 := 0;
+signal hist_symbols_s                      : histogram8_type := (others => (others => '0'));
+signal hist_period_s                       : histogram16_type := (others => (others => '0'));
+signal hist_jitter_s                       : histogram8_type := (others => (others => '0'));
 	
 begin
 
@@ -142,12 +196,12 @@ wb_readTimestamp1: wb_readTimestamp port map(
 	wb_clk_i => clk_sys_i,
 	wb_addr_i => gpio_slave_i.adr(4 downto 2),
 	wb_data_i => gpio_slave_i.dat,
-	wb_data_o => gpio_slave_o.dat,
+	wb_data_o => wb_data_s,
 	wb_cyc_i => gpio_slave_i.cyc,
 	wb_sel_i => gpio_slave_i.sel,
-	wb_stb_i => gpio_slave_i.stb,
+	wb_stb_i => wb_stb_s,
 	wb_we_i => gpio_slave_i.we,
-	wb_ack_o => gpio_slave_o.ack ,
+	wb_ack_o => wb_ack_s,
 	wbrdtime_high_timestamp_i => wbrdtime_high_timestamp_s,
 	wbrdtime_low_timestamp_i => wbrdtime_low_timestamp_s,
 	wbrdtime_errors_nr_i => wbrdtime_errors_nr_s,
@@ -156,9 +210,17 @@ wb_readTimestamp1: wb_readTimestamp port map(
 	wbrdtime_control_error_i => wbrdtime_control_error_s,
 	wbrdtime_control_correction_i => wbrdtime_control_correction_s,
 	wbrdtime_control_clear_o => wbrdtime_control_clear_s,
-	wbrdtime_control_clear_wr_o => wbrdtime_control_clear_wr_s
+	wbrdtime_control_clear_wr_o => wbrdtime_control_clear_wr_s,
+	wbrdtime_control_hist_freeze_o => wbrdtime_control_hist_freeze_s,
+	wbrdtime_control_hist_clear_o => wbrdtime_control_hist_clear_s,
+	wbrdtime_control_hist_clear_wr_o => wbrdtime_control_hist_clear_wr_s
 	);
 
+-- addresses from 0x80 are the histogram block, the registers are below
+wb_stb_s <= gpio_slave_i.stb and not gpio_slave_i.adr(7);
+gpio_slave_o.ack <= wb_ack_s or hist_ack_s;
+gpio_slave_o.dat <= hist_data_s when hist_ack_s='1' else wb_data_s;
+
 	 
 	 
 process (BuTis_C2_i)
@@ -183,6 +245,12 @@ variable extendcounter_v : integer range 0 to 7;
 				timestamp_error_s <= '0';
 			end if;
 			wbrdtime_control_disable_sync_s <= wbrdtime_control_disable_s(0);
+			if linkstat_write_i='1' then -- hold the link statistics and signal them to the clk_sys_i domain with a toggle
+				linkstat_symbols_s <= corrected_symbols_i;
+				linkstat_period_s <= T0_period_i;
+				linkstat_error_s <= timestamp_error_i;
+				linkstat_toggle_s <= not linkstat_toggle_s;
+			end if;
 		end if;
 end process;	
 wbrdtime_high_timestamp_s <= timestamp_s(g_timestampbytes*8-1 downto 32);
@@ -209,6 +277,102 @@ process (clk_sys_i)
 		end if;
 end process;	
 
+-- process to determine the histogram bins for each new burst: the held link statistics are stable for a full T0 period
+linkstat_process: process (clk_sys_i)
+variable period_v : integer range 0 to 65535;
+variable deviation_v : integer range -65535 to 65535;
+variable bin_v : integer range 0 to 15;
+begin
+		if rising_edge(clk_sys_i) then
+			linkstat_new_s <= '0';
+			if rst_n_i = '0' then
+				prev_period_valid_s <= '0';
+				jitter_valid_s <= '0';
+			elsif linkstat_toggle_sync1_s/=linkstat_toggle_sync2_s then
+				if linkstat_error_s='1' then
+					symbolsbin_s <= 7;
+				elsif conv_integer(linkstat_symbols_s)<7 then
+					symbolsbin_s <= conv_integer(linkstat_symbols_s);
+				else
+					symbolsbin_s <= 6;
+				end if;
+				period_v := conv_integer(linkstat_period_s);
+				deviation_v := period_v-g_BuTis_ratio;
+				if deviation_v<-g_BuTis_T0_precision then
+					periodbin_s <= 0;
+				elsif deviation_v>g_BuTis_T0_precision then
+					periodbin_s <= 15;
+				else
+					bin_v := 1;
+					for i in 1 to periodbins_c-1 loop
+						if deviation_v+g_BuTis_T0_precision>=i*periodbinwidth_c then
+							bin_v := i+1;
+						end if;
+					end loop;
+					periodbin_s <= bin_v;
+				end if;
+				if period_v-prev_period_s>=7 or prev_period_s-period_v>=7 then
+					jitterbin_s <= 7;
+				elsif period_v>=prev_period_s then
+					jitterbin_s <= period_v-prev_period_s;
+				else
+					jitterbin_s <= prev_period_s-period_v;
+				end if;
+				if period_v<65535 then
+					jitter_valid_s <= prev_period_valid_s;
+					prev_period_valid_s <= '1';
+				else -- no previous T0 seen: no jitter for this one and the next one
+					jitter_valid_s <= '0';
+					prev_period_valid_s <= '0';
+				end if;
+				prev_period_s <= period_v;
+				linkstat_new_s <= '1';
+			end if;
+			linkstat_toggle_sync2_s <= linkstat_toggle_sync1_s;
+			linkstat_toggle_sync1_s <= linkstat_toggle_sync0_s;
+			linkstat_toggle_sync0_s <= linkstat_toggle_s;
+		end if;
+end process;
+
+-- process to count the bursts in the histograms, saturating counters
+histogram_process: process (clk_sys_i)
+begin
+		if rising_edge(clk_sys_i) then
+			if (rst_n_i = '0') or ((wbrdtime_control_hist_clear_wr_s='1') and (wbrdtime_control_hist_clear_s(0)='1')) then
+				hist_symbols_s <= (others => (others => '0'));
+				hist_period_s <= (others => (others => '0'));
+				hist_jitter_s <= (others => (others => '0'));
+			elsif (linkstat_new_s='1') and (wbrdtime_control_hist_freeze_s(0)='0') then
+				if hist_symbols_s(symbolsbin_s)/=x"ffffffff" then
+					hist_symbols_s(symbolsbin_s) <= hist_symbols_s(symbolsbin_s)+1;
+				end if;
+				if hist_period_s(periodbin_s)/=x"ffffffff" then
+					hist_period_s(periodbin_s) <= hist_period_s(periodbin_s)+1;
+				end if;
+				if (jitter_valid_s='1') and (hist_jitter_s(jitterbin_s)/=x"ffffffff") then
+					hist_jitter_s(jitterbin_s) <= hist_jitter_s(jitterbin_s)+1;
+				end if;
+			end if;
+		end if;
+end process;
+
+-- process to read the histogram block with the Wishbone Bus, never stalls
+histogram_read_process: process (clk_sys_i)
+variable index_v : integer range 0 to 31;
+begin
+		if rising_edge(clk_sys_i) then
+			hist_ack_s <= gpio_slave_i.cyc and gpio_slave_i.stb and gpio_slave_i.adr(7);
+			index_v := conv_integer(gpio_slave_i.adr(6 downto 2));
+			if index_v<8 then
+				hist_data_s <= hist_symbols_s(index_v);
+			elsif index_v<24 then
+				hist_data_s <= hist_period_s(index_v-8);
+			else
+				hist_data_s <= hist_jitter_s(index_v-24);
+			end if;
+		end if;
+end process;
+
 
     
 end struct;
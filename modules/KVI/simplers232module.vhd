@@ -6,18 +6,46 @@
 -- Author     : Peter Schakel
 -- Company    : KVI
 -- Created    : 2012-09-07
--- Last update: 2012-09-07
+-- Last update: 2012-10-25
 -- Platform   : FPGA-generic
 -- Standard   : VHDL'93
 -------------------------------------------------------------------------------
 -- Description:
 --
 -- Wishbone Bus module for communicates over serial connection : 
---     baudrate : fixed to 11k5
+--     baudrate : selectable, see control register
 --     data bits : 8 bits
 --     stop bits : 1
 -- 
--- Receiver part has not been used nor tested.
+-- Data to send is written in a transmit fifo, the transmitter sends the bytes from this fifo.
+-- Received data is written in a receive fifo, bytes received while this fifo is full are counted as lost.
+-- The number of bytes in both fifos can be read in the fifo level register.
+-- 
+-- Interrupts, level sensitive for the vectored interrupt controller (wb_vic):
+--     txirq_o : transmit fifo level is equal or below the transmit threshold, and transmit interrupt enabled
+--     rxirq_o : receive fifo not empty and level is equal or above the receive threshold, and receive interrupt enabled
+--
+-- Generics
+--     CLOCK_FREQUENCY : clock frequency in Hz, used for the baudrate
+--     g_txfifosize : number of bytes in the transmit fifo
+--     g_rxfifosize : number of bytes in the receive fifo
+--
+-- Inputs
+--     clk_sys_i : 125MHz Whishbone bus clock
+--     rst_n_i : reset: low active
+--     gpio_slave_i : Record with Whishbone Bus signals
+--     serial_i : serial data input
+--
+-- Outputs
+--     gpio_slave_o : Record with Whishbone Bus signals
+--     serial_o : serial data output
+--     txirq_o : transmit interrupt
+--     rxirq_o : receive interrupt
+--
+-- Components
+--     wb_rs232 : module with interface to Wishbone bus, generated by wbgen2
+--     RS232module : serial transmitter and receiver
+--     generic_sync_fifo : fifo for transmit and receive data
 --
 -------------------------------------------------------------------------------
 -- Copyright (c) 2012 KVI / Peter Schakel
@@ -38,7 +66,9 @@ use work.wishbone_pkg.all;
 
 entity simplers232module is
 	generic(
-		CLOCK_FREQUENCY    : integer := 125000000
+		CLOCK_FREQUENCY    : integer := 125000000;
+		g_txfifosize       : integer := 256;
+		g_rxfifosize       : integer := 256
 	);
 	port(
 		clk_sys_i                              : in std_logic;
@@ -46,7 +76,9 @@ entity simplers232module is
 		gpio_slave_i                           : in t_wishbone_slave_in;
 		gpio_slave_o                           : out t_wishbone_slave_out;
 		serial_i                               : in std_logic;
-		serial_o                               : out std_logic
+		serial_o                               : out std_logic;
+		txirq_o                                : out std_logic;
+		rxirq_o                                : out std_logic
     );
 end simplers232module;
 
@@ -86,8 +118,24 @@ component wb_rs232 is
     wbrs232_status_allowed_i                 : in     std_logic_vector(0 downto 0);
 -- Port for std_logic_vector field: 'data available' in reg: 'status'
     wbrs232_status_available_i               : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'transmitter empty' in reg: 'status'
+    wbrs232_status_txempty_i                 : in     std_logic_vector(0 downto 0);
 -- Port for std_logic_vector field: 'baudrate' in reg: 'control'
-    wbrs232_control_baud_o                   : out    std_logic_vector(2 downto 0)
+    wbrs232_control_baud_o                   : out    std_logic_vector(2 downto 0);
+-- Port for std_logic_vector field: 'transmit interrupt enable' in reg: 'control'
+    wbrs232_control_txirq_o                  : out    std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'receive interrupt enable' in reg: 'control'
+    wbrs232_control_rxirq_o                  : out    std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'transmit level' in reg: 'fifo level'
+    wbrs232_level_tx_i                       : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'receive level' in reg: 'fifo level'
+    wbrs232_level_rx_i                       : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'transmit threshold' in reg: 'interrupt thresholds'
+    wbrs232_threshold_tx_o                   : out    std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'receive threshold' in reg: 'interrupt thresholds'
+    wbrs232_threshold_rx_o                   : out    std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'lost' in reg: 'receive lost'
+    wbrs232_lost_count_i                     : in     std_logic_vector(31 downto 0)
   );
 end component;
 
@@ -153,13 +201,31 @@ signal wbrs232_data_wr_s                     : std_logic;
 signal wbrs232_done_wr_s                     : std_logic;
 signal wbrs232_status_allowed_s              : std_logic_vector(0 downto 0);
 signal wbrs232_status_available_s            : std_logic_vector(0 downto 0);
+signal wbrs232_status_txempty_s              : std_logic_vector(0 downto 0);
 signal wbrs232_control_baud_s                : std_logic_vector(2 downto 0);
+signal wbrs232_control_txirq_s               : std_logic_vector(0 downto 0);
+signal wbrs232_control_rxirq_s               : std_logic_vector(0 downto 0);
+signal wbrs232_threshold_tx_s                : std_logic_vector(15 downto 0);
+signal wbrs232_threshold_rx_s                : std_logic_vector(15 downto 0);
 signal rs232_data_in_s                       : std_logic_vector(7 downto 0);
 signal rs232_busy_s                          : std_logic;
-signal readfifo_empty_s                      : std_logic;
 signal rs232_data_in_wr_s                    : std_logic;
 signal reset_S                               : std_logic;
 
+signal txfifo_data_s                         : std_logic_vector(7 downto 0);
+signal txfifo_empty_s                        : std_logic;
+signal txfifo_full_s                         : std_logic;
+signal txfifo_count_s                        : std_logic_vector(f_log2_size(g_txfifosize)-1 downto 0);
+signal txfifo_level_s                        : std_logic_vector(15 downto 0);
+signal txfifo_wr_s                           : std_logic;
+signal txload_s                              : std_logic;
+signal readfifo_empty_s                      : std_logic;
+signal readfifo_full_s                       : std_logic;
+signal readfifo_count_s                      : std_logic_vector(f_log2_size(g_rxfifosize)-1 downto 0);
+signal readfifo_level_s                      : std_logic_vector(15 downto 0);
+signal readfifo_wr_s                         : std_logic;
+signal lost_s                                : std_logic_vector(31 downto 0) := (others => '0');
+
 	
 begin
 
@@ -183,7 +249,15 @@ wb_rs2321: wb_rs232 port map(
 	wbrs232_done_done_wr_o => wbrs232_done_wr_s,
 	wbrs232_status_allowed_i => wbrs232_status_allowed_s,
 	wbrs232_status_available_i => wbrs232_status_available_s,
-	wbrs232_control_baud_o => wbrs232_control_baud_s
+	wbrs232_status_txempty_i => wbrs232_status_txempty_s,
+	wbrs232_control_baud_o => wbrs232_control_baud_s,
+	wbrs232_control_txirq_o => wbrs232_control_txirq_s,
+	wbrs232_control_rxirq_o => wbrs232_control_rxirq_s,
+	wbrs232_level_tx_i => txfifo_level_s,
+	wbrs232_level_rx_i => readfifo_level_s,
+	wbrs232_threshold_tx_o => wbrs232_threshold_tx_s,
+	wbrs232_threshold_rx_o => wbrs232_threshold_rx_s,
+	wbrs232_lost_count_i => lost_s
 	);
 	 
  reset_s <= not rst_n_i;
@@ -195,27 +269,88 @@ wb_rs2321: wb_rs232 port map(
 	RxIn => serial_i,
 	RxOut => rs232_data_in_s,
 	RxPulse => rs232_data_in_wr_s,
-	TxIn => wbrs232_data_o_s,
+	TxIn => txfifo_data_s,
 	TxOut => serial_o,
-	TxLoad => wbrs232_data_wr_s,
+	TxLoad => txload_s,
 	TxBusy => rs232_busy_s); 
 
+ -- transmit fifo: the next byte is loaded in the transmitter as soon as it is idle
+ txfifo_wr_s <= '1' when (wbrs232_data_wr_s='1') and (txfifo_full_s='0') else '0';
+ txload_s <= '1' when (txfifo_empty_s='0') and (rs232_busy_s='0') else '0';
+ txfifo: generic_sync_fifo 
+  generic map(
+    g_data_width => 8,
+    g_size => g_txfifosize,
+    g_show_ahead => true,
+    g_with_empty => true,
+    g_with_full => true,
+    g_with_count => true)
+  port map (
+    rst_n_i => rst_n_i,
+    clk_i => clk_sys_i,
+    d_i => wbrs232_data_o_s,
+    we_i => txfifo_wr_s,
+    q_o => txfifo_data_s,
+    rd_i => txload_s,
+    empty_o => txfifo_empty_s,
+    full_o => txfifo_full_s,
+    almost_empty_o => open,
+    almost_full_o => open,
+    count_o => txfifo_count_s);
+ txfifo_level_s <= conv_std_logic_vector(g_txfifosize,16) when txfifo_full_s='1' else ext(txfifo_count_s,16);
 	
- wbrs232_status_allowed_s(0) <= '1' when rs232_busy_s='0' else '0';
+ wbrs232_status_allowed_s(0) <= '1' when txfifo_full_s='0' else '0';
  wbrs232_status_available_s(0) <= '1' when readfifo_empty_s='0' else '0';
+ wbrs232_status_txempty_s(0) <= '1' when (txfifo_empty_s='1') and (rs232_busy_s='0') else '0';
+ 
+ -- receive fifo: bytes received while the fifo is full are lost
+ readfifo_wr_s <= '1' when (rs232_data_in_wr_s='1') and (readfifo_full_s='0') else '0';
  readfifo: generic_sync_fifo 
+  generic map(
+    g_data_width => 8,
+    g_size => g_rxfifosize,
+    g_show_ahead => true,
+    g_with_empty => true,
+    g_with_full => true,
+    g_with_count => true)
   port map (
     rst_n_i => rst_n_i,
     clk_i => clk_sys_i,
     d_i => rs232_data_in_s,
-    we_i => rs232_data_in_wr_s,
+    we_i => readfifo_wr_s,
     q_o => wbrs232_data_i_s,
     rd_i => wbrs232_done_wr_s,
     empty_o => readfifo_empty_s,
-    full_o => open,
+    full_o => readfifo_full_s,
     almost_empty_o => open,
     almost_full_o => open,
-    count_o => open);
+    count_o => readfifo_count_s);
+ readfifo_level_s <= conv_std_logic_vector(g_rxfifosize,16) when readfifo_full_s='1' else ext(readfifo_count_s,16);
+
+-- process to count lost bytes and generate the interrupts
+irq_process: process(clk_sys_i)
+begin
+	if rising_edge(clk_sys_i) then
+		if rst_n_i='0' then
+			lost_s <= (others => '0');
+			txirq_o <= '0';
+			rxirq_o <= '0';
+		else
+			if (rs232_data_in_wr_s='1') and (readfifo_full_s='1') then
+				lost_s <= lost_s+1;
+			end if;
+			if (wbrs232_control_txirq_s(0)='1') and (txfifo_level_s<=wbrs232_threshold_tx_s) then
+				txirq_o <= '1';
+			else
+				txirq_o <= '0';
+			end if;
+			if (wbrs232_control_rxirq_s(0)='1') and (readfifo_empty_s='0') and (readfifo_level_s>=wbrs232_threshold_rx_s) then
+				rxirq_o <= '1';
+			else
+				rxirq_o <= '0';
+			end if;
+		end if;
+	end if;
+end process;
   
 end struct;
-
@@ -15,7 +15,8 @@ component TimestampEncoder is
 		g_timestampbytes                         : integer := 8;
 		g_clockcyclesperbit                      : integer := 4;
 		g_RScodewords                            : integer := 4;
-		g_BuTis_ratio                            : integer := 2000);
+		g_BuTis_ratio                            : integer := 2000;
+		g_RSclockdivisor                         : integer := 2);
   port(
 		BuTis_C2_i                               : in  std_logic;
 		BuTis_T0_i                               : in  std_logic;
@@ -41,7 +42,10 @@ component TimestampDecoder is
 	timestamp_o                              : out std_logic_vector(g_timestampbytes*8-1 downto 0);
 	timestamp_write_o                        : out std_logic;
 	corrected_o                              : out std_logic;
-	error_o                                  : out std_logic);
+	error_o                                  : out std_logic;
+	corrected_symbols_o                      : out std_logic_vector(3 downto 0);
+	T0_period_o                              : out std_logic_vector(15 downto 0);
+	linkstat_write_o                         : out std_logic);
 end component;
 
 signal BuTis_C2_i    : std_logic;
@@ -60,6 +64,9 @@ signal generror      : std_logic;
 
 signal serial_ok     : std_logic;
 signal timestamp_write_o     : std_logic;
+signal corrected_symbols_o   : std_logic_vector(3 downto 0);
+signal T0_period_o           : std_logic_vector(15 downto 0);
+signal linkstat_write_o      : std_logic;
 
 signal timestamp_ok  : std_logic_vector(8*8-1 downto 0);
 
@@ -87,7 +94,10 @@ uut2: TimestampDecoder port map(
 	timestamp_o => timestamp_o,
 	timestamp_write_o => timestamp_write_o,
 	corrected_o => correction_o,
-	error_o => error_dec);
+	error_o => error_dec,
+	corrected_symbols_o => corrected_symbols_o,
+	T0_period_o => T0_period_o,
+	linkstat_write_o => linkstat_write_o);
 
 uut_ok: TimestampEncoder port map(
 	BuTis_C2_i => BuTis_C2_i,
@@ -106,7 +116,10 @@ uut2_ok: TimestampDecoder port map(
 	timestamp_o => timestamp_ok,
 	timestamp_write_o => open,
 	corrected_o => open,
-	error_o => open);
+	error_o => open,
+	corrected_symbols_o => open,
+	T0_period_o => open,
+	linkstat_write_o => open);
 	
 	
    -- Clock process definitions
@@ -209,6 +222,13 @@ variable f : std_logic := '0';
 				end if;
 				e := '0';
 			end if;
+			if linkstat_write_o='1' then
+				write(l, string'("period "));
+				write(l, conv_integer(unsigned(T0_period_o)));
+				write(l, string'(" corrected symbols "));
+				write(l, conv_integer(unsigned(corrected_symbols_o)));
+				writeline(output,l);	
+			end if;
 		end if;
 end process;
 	
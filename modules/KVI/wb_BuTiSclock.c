@@ -67,11 +67,29 @@
 #define WBBUTIS_CONTROL_RESET_W(value)        WBGEN2_GEN_WRITE(value, 2, 1)
 #define WBBUTIS_CONTROL_RESET_R(reg)          WBGEN2_GEN_READ(reg, 2, 1)
 
+/* definitions for field: Calibrate phase in reg: BuTis clock generator control */
+#define WBBUTIS_CONTROL_CALIBRATE_MASK        WBGEN2_GEN_MASK(3, 1)
+#define WBBUTIS_CONTROL_CALIBRATE_SHIFT       3
+#define WBBUTIS_CONTROL_CALIBRATE_W(value)    WBGEN2_GEN_WRITE(value, 3, 1)
+#define WBBUTIS_CONTROL_CALIBRATE_R(reg)      WBGEN2_GEN_READ(reg, 3, 1)
+
+/* definitions for field: Use calibrated phase in reg: BuTis clock generator control */
+#define WBBUTIS_CONTROL_USECAL_MASK           WBGEN2_GEN_MASK(4, 1)
+#define WBBUTIS_CONTROL_USECAL_SHIFT          4
+#define WBBUTIS_CONTROL_USECAL_W(value)       WBGEN2_GEN_WRITE(value, 4, 1)
+#define WBBUTIS_CONTROL_USECAL_R(reg)         WBGEN2_GEN_READ(reg, 4, 1)
+
+/* definitions for field: Track phase in reg: BuTis clock generator control */
+#define WBBUTIS_CONTROL_TRACK_MASK            WBGEN2_GEN_MASK(5, 1)
+#define WBBUTIS_CONTROL_TRACK_SHIFT           5
+#define WBBUTIS_CONTROL_TRACK_W(value)        WBGEN2_GEN_WRITE(value, 5, 1)
+#define WBBUTIS_CONTROL_TRACK_R(reg)          WBGEN2_GEN_READ(reg, 5, 1)
+
 /* definitions for field: unused in reg: BuTis clock generator control */
-#define WBBUTIS_CONTROL_UNUSED_MASK           WBGEN2_GEN_MASK(3, 5)
-#define WBBUTIS_CONTROL_UNUSED_SHIFT          3
-#define WBBUTIS_CONTROL_UNUSED_W(value)       WBGEN2_GEN_WRITE(value, 3, 5)
-#define WBBUTIS_CONTROL_UNUSED_R(reg)         WBGEN2_GEN_READ(reg, 3, 5)
+#define WBBUTIS_CONTROL_UNUSED_MASK           WBGEN2_GEN_MASK(6, 2)
+#define WBBUTIS_CONTROL_UNUSED_SHIFT          6
+#define WBBUTIS_CONTROL_UNUSED_W(value)       WBGEN2_GEN_WRITE(value, 6, 2)
+#define WBBUTIS_CONTROL_UNUSED_R(reg)         WBGEN2_GEN_READ(reg, 6, 2)
 
 /* definitions for field: PLLphase in reg: BuTis clock generator control */
 #define WBBUTIS_CONTROL_PHASE_MASK            WBGEN2_GEN_MASK(8, 8)
@@ -93,6 +111,64 @@
 #define WBBUTIS_STATUS_PPSPHASE_W(value)      WBGEN2_GEN_WRITE(value, 1, 1)
 #define WBBUTIS_STATUS_PPSPHASE_R(reg)        WBGEN2_GEN_READ(reg, 1, 1)
 
+/* definitions for field: Calibration busy in reg: BuTis clock generator Status */
+#define WBBUTIS_STATUS_CALBUSY_MASK           WBGEN2_GEN_MASK(2, 1)
+#define WBBUTIS_STATUS_CALBUSY_SHIFT          2
+#define WBBUTIS_STATUS_CALBUSY_W(value)       WBGEN2_GEN_WRITE(value, 2, 1)
+#define WBBUTIS_STATUS_CALBUSY_R(reg)         WBGEN2_GEN_READ(reg, 2, 1)
+
+/* definitions for field: Eye found in reg: BuTis clock generator Status */
+#define WBBUTIS_STATUS_EYEFOUND_MASK          WBGEN2_GEN_MASK(3, 1)
+#define WBBUTIS_STATUS_EYEFOUND_SHIFT         3
+#define WBBUTIS_STATUS_EYEFOUND_W(value)      WBGEN2_GEN_WRITE(value, 3, 1)
+#define WBBUTIS_STATUS_EYEFOUND_R(reg)        WBGEN2_GEN_READ(reg, 3, 1)
+
+/* definitions for field: Calibrated phase in reg: BuTis clock generator Status */
+#define WBBUTIS_STATUS_CALPHASE_MASK          WBGEN2_GEN_MASK(8, 8)
+#define WBBUTIS_STATUS_CALPHASE_SHIFT         8
+#define WBBUTIS_STATUS_CALPHASE_W(value)      WBGEN2_GEN_WRITE(value, 8, 8)
+#define WBBUTIS_STATUS_CALPHASE_R(reg)        WBGEN2_GEN_READ(reg, 8, 8)
+
+/* definitions for field: Eye width in reg: BuTis clock generator Status */
+#define WBBUTIS_STATUS_EYEWIDTH_MASK          WBGEN2_GEN_MASK(16, 8)
+#define WBBUTIS_STATUS_EYEWIDTH_SHIFT         16
+#define WBBUTIS_STATUS_EYEWIDTH_W(value)      WBGEN2_GEN_WRITE(value, 16, 8)
+#define WBBUTIS_STATUS_EYEWIDTH_R(reg)        WBGEN2_GEN_READ(reg, 16, 8)
+
+/* definitions for register: BuTis phase calibration eye map */
+
+/* definitions for field: Eye map in reg: BuTis phase calibration eye map */
+#define WBBUTIS_EYEMAP_MAP_MASK               WBGEN2_GEN_MASK(0, 32)
+#define WBBUTIS_EYEMAP_MAP_SHIFT              0
+#define WBBUTIS_EYEMAP_MAP_W(value)           WBGEN2_GEN_WRITE(value, 0, 32)
+#define WBBUTIS_EYEMAP_MAP_R(reg)             WBGEN2_GEN_READ(reg, 0, 32)
+
+/* definitions for register: BuTis phase tracker status */
+
+/* definitions for field: Phase error in reg: BuTis phase tracker status */
+#define WBBUTIS_TRACKER_ERROR_MASK            WBGEN2_GEN_MASK(0, 16)
+#define WBBUTIS_TRACKER_ERROR_SHIFT           0
+#define WBBUTIS_TRACKER_ERROR_W(value)        WBGEN2_GEN_WRITE(value, 0, 16)
+#define WBBUTIS_TRACKER_ERROR_R(reg)          WBGEN2_GEN_READ(reg, 0, 16)
+
+/* definitions for field: Phase offset in reg: BuTis phase tracker status */
+#define WBBUTIS_TRACKER_OFFSET_MASK           WBGEN2_GEN_MASK(16, 8)
+#define WBBUTIS_TRACKER_OFFSET_SHIFT          16
+#define WBBUTIS_TRACKER_OFFSET_W(value)       WBGEN2_GEN_WRITE(value, 16, 8)
+#define WBBUTIS_TRACKER_OFFSET_R(reg)         WBGEN2_GEN_READ(reg, 16, 8)
+
+/* definitions for field: Locked in reg: BuTis phase tracker status */
+#define WBBUTIS_TRACKER_LOCKED_MASK           WBGEN2_GEN_MASK(24, 1)
+#define WBBUTIS_TRACKER_LOCKED_SHIFT          24
+#define WBBUTIS_TRACKER_LOCKED_W(value)       WBGEN2_GEN_WRITE(value, 24, 1)
+#define WBBUTIS_TRACKER_LOCKED_R(reg)         WBGEN2_GEN_READ(reg, 24, 1)
+
+/* definitions for field: Trace index in reg: BuTis phase tracker status */
+#define WBBUTIS_TRACKER_INDEX_MASK            WBGEN2_GEN_MASK(25, 5)
+#define WBBUTIS_TRACKER_INDEX_SHIFT           25
+#define WBBUTIS_TRACKER_INDEX_W(value)        WBGEN2_GEN_WRITE(value, 25, 5)
+#define WBBUTIS_TRACKER_INDEX_R(reg)          WBGEN2_GEN_READ(reg, 25, 5)
+
 PACKED struct WBBUTIS_WB {
   /* [0x0]: REG TimeStamp data Low word */
   uint32_t TIMESTAMP;
@@ -102,6 +178,10 @@ PACKED struct WBBUTIS_WB {
   uint32_t CONTROL;
   /* [0xc]: REG BuTis clock generator Status */
   uint32_t STATUS;
+  /* [0x10]: REG BuTis phase calibration eye map */
+  uint32_t EYEMAP;
+  /* [0x14]: REG BuTis phase tracker status */
+  uint32_t TRACKER;
 };
 
 #endif
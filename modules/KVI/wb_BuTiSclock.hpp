@@ -0,0 +1,74 @@
+/*
+  C++ register access for slave core: BuTis clock generator
+
+  * File           : wb_BuTiSclock.hpp
+  * Author         : generated by wbgen_cpp.py from gen_BuTiSclock.wb
+  * Standard       : C++11
+
+    THIS FILE WAS GENERATED BY wbgen_cpp.py FROM SOURCE FILE gen_BuTiSclock.wb
+    DO NOT HAND-EDIT, see wb_regs.hpp for the use of the types
+
+*/
+
+#ifndef __WBGEN_CPP_GEN_BUTISCLOCK_WB
+#define __WBGEN_CPP_GEN_BUTISCLOCK_WB
+
+#include "wb_regs.hpp"
+
+namespace wbbutis {
+
+  /* [0x0]: REG TimeStamp data Low word */
+  namespace timestamp_lw {
+    struct reg : wbregs::reg<0x0, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RW> lw; // Low Word
+  }
+
+  /* [0x4]: REG TimeStamp data High word */
+  namespace timestamp_hw {
+    struct reg : wbregs::reg<0x4, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RW> hw; // High Word
+  }
+
+  /* [0x8]: REG BuTis clock generator control */
+  namespace control {
+    struct reg : wbregs::reg<0x8, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 1, wbregs::WO> set; // Set on next PPS
+    typedef wbregs::field<reg, 1, 1, wbregs::WO> sync; // Re-synchronize
+    typedef wbregs::field<reg, 2, 1, wbregs::WO> reset; // reset phase-PLL
+    typedef wbregs::field<reg, 3, 1, wbregs::WO> calibrate; // Calibrate phase
+    typedef wbregs::field<reg, 4, 1, wbregs::RW> usecal; // Use calibrated phase
+    typedef wbregs::field<reg, 5, 1, wbregs::RW> track; // Track phase
+    typedef wbregs::field<reg, 6, 2, wbregs::RW> unused; // unused
+    typedef wbregs::field<reg, 8, 8, wbregs::RW> phase; // PLLphase
+  }
+
+  /* [0xc]: REG BuTis clock generator Status */
+  namespace status {
+    struct reg : wbregs::reg<0xc, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 1, wbregs::RO> set; // timestamp set busy
+    typedef wbregs::field<reg, 1, 1, wbregs::RO> ppsphase; // Phase of the PPS
+    typedef wbregs::field<reg, 2, 1, wbregs::RO> calbusy; // Calibration busy
+    typedef wbregs::field<reg, 3, 1, wbregs::RO> eyefound; // Eye found
+    typedef wbregs::field<reg, 8, 8, wbregs::RO> calphase; // Calibrated phase
+    typedef wbregs::field<reg, 16, 8, wbregs::RO> eyewidth; // Eye width
+  }
+
+  /* [0x10]: REG BuTis phase calibration eye map */
+  namespace eyemap {
+    struct reg : wbregs::reg<0x10, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RO> map; // Eye map
+  }
+
+  /* [0x14]: REG BuTis phase tracker status */
+  namespace tracker {
+    struct reg : wbregs::reg<0x14, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 16, wbregs::RO> error; // Phase error
+    typedef wbregs::field<reg, 16, 8, wbregs::RO> offset; // Phase offset
+    typedef wbregs::field<reg, 24, 1, wbregs::RO> locked; // Locked
+    typedef wbregs::field<reg, 25, 5, wbregs::RO> index; // Trace index
+  }
+
+  const uint32_t size = 0x18; // bytes
+}
+
+#endif
@@ -21,7 +21,7 @@ entity wb_BuTiSclock is
 -- 
     wb_clk_i                                 : in     std_logic;
 -- 
-    wb_addr_i                                : in     std_logic_vector(1 downto 0);
+    wb_addr_i                                : in     std_logic_vector(2 downto 0);
 -- 
     wb_data_i                                : in     std_logic_vector(31 downto 0);
 -- 
@@ -49,14 +49,39 @@ entity wb_BuTiSclock is
 -- Ports for PASS_THROUGH field: 'reset phase-PLL' in reg: 'BuTis clock generator control'
     wbbutis_control_reset_o                  : out    std_logic_vector(0 downto 0);
     wbbutis_control_reset_wr_o               : out    std_logic;
+-- Ports for PASS_THROUGH field: 'Calibrate phase' in reg: 'BuTis clock generator control'
+    wbbutis_control_calibrate_o              : out    std_logic_vector(0 downto 0);
+    wbbutis_control_calibrate_wr_o           : out    std_logic;
+-- Port for std_logic_vector field: 'Use calibrated phase' in reg: 'BuTis clock generator control'
+    wbbutis_control_usecal_o                 : out    std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'Track phase' in reg: 'BuTis clock generator control'
+    wbbutis_control_track_o                  : out    std_logic_vector(0 downto 0);
 -- Port for std_logic_vector field: 'unused' in reg: 'BuTis clock generator control'
-    wbbutis_control_unused_o                 : out    std_logic_vector(4 downto 0);
+    wbbutis_control_unused_o                 : out    std_logic_vector(1 downto 0);
 -- Port for std_logic_vector field: 'PLLphase' in reg: 'BuTis clock generator control'
     wbbutis_control_phase_o                  : out    std_logic_vector(7 downto 0);
 -- Port for std_logic_vector field: 'timestamp set busy' in reg: 'BuTis clock generator Status'
     wbbutis_status_set_i                     : in     std_logic_vector(0 downto 0);
 -- Port for std_logic_vector field: 'Phase of the PPS' in reg: 'BuTis clock generator Status'
-    wbbutis_status_ppsphase_i                : in     std_logic_vector(0 downto 0)
+    wbbutis_status_ppsphase_i                : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'Calibration busy' in reg: 'BuTis clock generator Status'
+    wbbutis_status_calbusy_i                 : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'Eye found' in reg: 'BuTis clock generator Status'
+    wbbutis_status_eyefound_i                : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'Calibrated phase' in reg: 'BuTis clock generator Status'
+    wbbutis_status_calphase_i                : in     std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'Eye width' in reg: 'BuTis clock generator Status'
+    wbbutis_status_eyewidth_i                : in     std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'Eye map' in reg: 'BuTis phase calibration eye map'
+    wbbutis_eyemap_map_i                     : in     std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Phase error' in reg: 'BuTis phase tracker status'
+    wbbutis_tracker_error_i                  : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'Phase offset' in reg: 'BuTis phase tracker status'
+    wbbutis_tracker_offset_i                 : in     std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'Locked' in reg: 'BuTis phase tracker status'
+    wbbutis_tracker_locked_i                 : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'Trace index' in reg: 'BuTis phase tracker status'
+    wbbutis_tracker_index_i                  : in     std_logic_vector(4 downto 0)
   );
 end wb_BuTiSclock;
 
@@ -64,13 +89,15 @@ architecture syn of wb_BuTiSclock is
 
 signal wbbutis_timestamp_lw_int                 : std_logic_vector(31 downto 0);
 signal wbbutis_timestamp_hw_int                 : std_logic_vector(31 downto 0);
-signal wbbutis_control_unused_int               : std_logic_vector(4 downto 0);
+signal wbbutis_control_usecal_int               : std_logic_vector(0 downto 0);
+signal wbbutis_control_track_int                : std_logic_vector(0 downto 0);
+signal wbbutis_control_unused_int               : std_logic_vector(1 downto 0);
 signal wbbutis_control_phase_int                : std_logic_vector(7 downto 0);
 signal ack_sreg                                 : std_logic_vector(9 downto 0);
 signal rddata_reg                               : std_logic_vector(31 downto 0);
 signal wrdata_reg                               : std_logic_vector(31 downto 0);
 signal bwsel_reg                                : std_logic_vector(3 downto 0);
-signal rwaddr_reg                               : std_logic_vector(1 downto 0);
+signal rwaddr_reg                               : std_logic_vector(2 downto 0);
 signal ack_in_progress                          : std_logic      ;
 signal wr_int                                   : std_logic      ;
 signal rd_int                                   : std_logic      ;
@@ -100,7 +127,10 @@ begin
       wbbutis_control_set_wr_o <= '0';
       wbbutis_control_sync_wr_o <= '0';
       wbbutis_control_reset_wr_o <= '0';
-      wbbutis_control_unused_int <= std_logic_vector(to_unsigned(0, 5));
+      wbbutis_control_calibrate_wr_o <= '0';
+      wbbutis_control_usecal_int <= std_logic_vector(to_unsigned(0, 1));
+      wbbutis_control_track_int <= std_logic_vector(to_unsigned(0, 1));
+      wbbutis_control_unused_int <= std_logic_vector(to_unsigned(0, 2));
       wbbutis_control_phase_int <= std_logic_vector(to_unsigned(0, 8));
     elsif rising_edge(bus_clock_int) then
 -- advance the ACK generator shift register
@@ -111,16 +141,18 @@ begin
           wbbutis_control_set_wr_o <= '0';
           wbbutis_control_sync_wr_o <= '0';
           wbbutis_control_reset_wr_o <= '0';
+          wbbutis_control_calibrate_wr_o <= '0';
           ack_in_progress <= '0';
         else
           wbbutis_control_set_wr_o <= '0';
           wbbutis_control_sync_wr_o <= '0';
           wbbutis_control_reset_wr_o <= '0';
+          wbbutis_control_calibrate_wr_o <= '0';
         end if;
       else
         if ((wb_cyc_i = '1') and (wb_stb_i = '1')) then
-          case rwaddr_reg(1 downto 0) is
-          when "00" => 
+          case rwaddr_reg(2 downto 0) is
+          when "000" => 
             if (wb_we_i = '1') then
               wbbutis_timestamp_lw_int <= wrdata_reg(31 downto 0);
             else
@@ -128,7 +160,7 @@ begin
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "01" => 
+          when "001" => 
             if (wb_we_i = '1') then
               wbbutis_timestamp_hw_int <= wrdata_reg(31 downto 0);
             else
@@ -136,16 +168,20 @@ begin
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "10" => 
+          when "010" => 
             if (wb_we_i = '1') then
               wbbutis_control_set_wr_o <= '1';
               wbbutis_control_sync_wr_o <= '1';
               wbbutis_control_reset_wr_o <= '1';
-              wbbutis_control_unused_int <= wrdata_reg(7 downto 3);
+              wbbutis_control_calibrate_wr_o <= '1';
+              wbbutis_control_usecal_int <= wrdata_reg(4 downto 4);
+              wbbutis_control_track_int <= wrdata_reg(5 downto 5);
+              wbbutis_control_unused_int <= wrdata_reg(7 downto 6);
               wbbutis_control_phase_int <= wrdata_reg(15 downto 8);
               rddata_reg(0) <= 'X';
               rddata_reg(1) <= 'X';
               rddata_reg(2) <= 'X';
+              rddata_reg(3) <= 'X';
               rddata_reg(16) <= 'X';
               rddata_reg(17) <= 'X';
               rddata_reg(18) <= 'X';
@@ -163,13 +199,17 @@ begin
               rddata_reg(30) <= 'X';
               rddata_reg(31) <= 'X';
             else
-              rddata_reg(7 downto 3) <= wbbutis_control_unused_int;
+              rddata_reg(4 downto 4) <= wbbutis_control_usecal_int;
+              rddata_reg(5 downto 5) <= wbbutis_control_track_int;
+              rddata_reg(7 downto 6) <= wbbutis_control_unused_int;
               rddata_reg(15 downto 8) <= wbbutis_control_phase_int;
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "11" => 
+          when "011" => 
             if (wb_we_i = '1') then
+              rddata_reg(0) <= 'X';
+              rddata_reg(1) <= 'X';
               rddata_reg(2) <= 'X';
               rddata_reg(3) <= 'X';
               rddata_reg(4) <= 'X';
@@ -203,6 +243,59 @@ begin
             else
               rddata_reg(0 downto 0) <= wbbutis_status_set_i;
               rddata_reg(1 downto 1) <= wbbutis_status_ppsphase_i;
+              rddata_reg(2 downto 2) <= wbbutis_status_calbusy_i;
+              rddata_reg(3 downto 3) <= wbbutis_status_eyefound_i;
+              rddata_reg(15 downto 8) <= wbbutis_status_calphase_i;
+              rddata_reg(23 downto 16) <= wbbutis_status_eyewidth_i;
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "100" => 
+            if (wb_we_i = '1') then
+            else
+              rddata_reg(31 downto 0) <= wbbutis_eyemap_map_i;
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "101" => 
+            if (wb_we_i = '1') then
+              rddata_reg(0) <= 'X';
+              rddata_reg(1) <= 'X';
+              rddata_reg(2) <= 'X';
+              rddata_reg(3) <= 'X';
+              rddata_reg(4) <= 'X';
+              rddata_reg(5) <= 'X';
+              rddata_reg(6) <= 'X';
+              rddata_reg(7) <= 'X';
+              rddata_reg(8) <= 'X';
+              rddata_reg(9) <= 'X';
+              rddata_reg(10) <= 'X';
+              rddata_reg(11) <= 'X';
+              rddata_reg(12) <= 'X';
+              rddata_reg(13) <= 'X';
+              rddata_reg(14) <= 'X';
+              rddata_reg(15) <= 'X';
+              rddata_reg(16) <= 'X';
+              rddata_reg(17) <= 'X';
+              rddata_reg(18) <= 'X';
+              rddata_reg(19) <= 'X';
+              rddata_reg(20) <= 'X';
+              rddata_reg(21) <= 'X';
+              rddata_reg(22) <= 'X';
+              rddata_reg(23) <= 'X';
+              rddata_reg(24) <= 'X';
+              rddata_reg(25) <= 'X';
+              rddata_reg(26) <= 'X';
+              rddata_reg(27) <= 'X';
+              rddata_reg(28) <= 'X';
+              rddata_reg(29) <= 'X';
+              rddata_reg(30) <= 'X';
+              rddata_reg(31) <= 'X';
+            else
+              rddata_reg(15 downto 0) <= wbbutis_tracker_error_i;
+              rddata_reg(23 downto 16) <= wbbutis_tracker_offset_i;
+              rddata_reg(24 downto 24) <= wbbutis_tracker_locked_i;
+              rddata_reg(29 downto 25) <= wbbutis_tracker_index_i;
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
@@ -232,12 +325,28 @@ begin
 -- reset phase-PLL
 -- pass-through field: reset phase-PLL in register: BuTis clock generator control
   wbbutis_control_reset_o <= wrdata_reg(2 downto 2);
+-- Calibrate phase
+-- pass-through field: Calibrate phase in register: BuTis clock generator control
+  wbbutis_control_calibrate_o <= wrdata_reg(3 downto 3);
+-- Use calibrated phase
+  wbbutis_control_usecal_o <= wbbutis_control_usecal_int;
+-- Track phase
+  wbbutis_control_track_o <= wbbutis_control_track_int;
 -- unused
   wbbutis_control_unused_o <= wbbutis_control_unused_int;
 -- PLLphase
   wbbutis_control_phase_o <= wbbutis_control_phase_int;
 -- timestamp set busy
 -- Phase of the PPS
+-- Calibration busy
+-- Eye found
+-- Calibrated phase
+-- Eye width
+-- Eye map
+-- Phase error
+-- Phase offset
+-- Locked
+-- Trace index
   rwaddr_reg <= wb_addr_i;
 -- ACK signal generation. Just pass the LSB of ACK counter.
   wb_ack_o <= ack_sreg(0);
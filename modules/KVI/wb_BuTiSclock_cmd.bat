@@ -1 +1,2 @@
 lua "C:\Program Files\wishbone-gen\wbgen2" gen_BuTiSclock.wb -target pipelined -lang vhdl -vo wb_BuTiSclock.vhd -co wb_BuTiSclock.c -doco wb_BuTiSclock.html
+python wbgen_cpp.py gen_BuTiSclock.wb wb_BuTiSclock.hpp
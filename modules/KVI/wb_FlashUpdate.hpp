@@ -0,0 +1,71 @@
+/*
+  C++ register access for slave core: External Flash Update
+
+  * File           : wb_FlashUpdate.hpp
+  * Author         : generated by wbgen_cpp.py from gen_FlashUpdate.wb
+  * Standard       : C++11
+
+    THIS FILE WAS GENERATED BY wbgen_cpp.py FROM SOURCE FILE gen_FlashUpdate.wb
+    DO NOT HAND-EDIT, see wb_regs.hpp for the use of the types
+
+*/
+
+#ifndef __WBGEN_CPP_GEN_FLASHUPDATE_WB
+#define __WBGEN_CPP_GEN_FLASHUPDATE_WB
+
+#include "wb_regs.hpp"
+
+namespace wbflash {
+
+  /* [0x0]: REG Flash parameters */
+  namespace params {
+    struct reg : wbregs::reg<0x0, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 24, wbregs::RW> data; // parameter data
+    typedef wbregs::field<reg, 24, 3, wbregs::RW> address; // parameter address
+    typedef wbregs::field<reg, 27, 1, wbregs::WO> write; // parameter write
+    typedef wbregs::field<reg, 28, 1, wbregs::WO> request; // parameter read request
+    typedef wbregs::field<reg, 29, 3, wbregs::WO> reconf; // start reconfiguration
+  }
+
+  /* [0x4]: REG Flash parameters read */
+  namespace params_read {
+    struct reg : wbregs::reg<0x4, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 24, wbregs::RO> data; // data read
+    typedef wbregs::field<reg, 24, 3, wbregs::RO> address; // addres read
+    typedef wbregs::field<reg, 27, 1, wbregs::RO> busy; // configuration busy
+    typedef wbregs::field<reg, 28, 1, wbregs::RO> error; // configuration data error
+    typedef wbregs::field<reg, 29, 1, wbregs::RO> illegal; // configuration write error
+    typedef wbregs::field<reg, 30, 1, wbregs::RO> erase_error; // illegal flash erase
+  }
+
+  /* [0x8]: REG Flash data */
+  namespace flash_data {
+    struct reg : wbregs::reg<0x8, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 8, wbregs::RW> data; // flash data
+    typedef wbregs::field<reg, 8, 24, wbregs::RW> address; // flash address
+  }
+
+  /* [0xc]: REG Flash read */
+  namespace flash_read {
+    struct reg : wbregs::reg<0xc, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 8, wbregs::RO> data; // data from flash
+    typedef wbregs::field<reg, 8, 1, wbregs::RO> valid; // data from flash is valid
+    typedef wbregs::field<reg, 9, 1, wbregs::RO> busy; // accessing flash is busy
+    typedef wbregs::field<reg, 10, 1, wbregs::RO> error; // error accessing flash
+  }
+
+  /* [0x10]: REG Flash access */
+  namespace flash_access {
+    struct reg : wbregs::reg<0x10, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 1, wbregs::RW> enable; // Enable data access
+    typedef wbregs::field<reg, 1, 1, wbregs::RW> read_enable; // Enable reading from flash
+    typedef wbregs::field<reg, 2, 3, wbregs::RW> write_enable; // Enable writing to flash
+    typedef wbregs::field<reg, 5, 3, wbregs::RW> erase_enable; // Enable erasing sector
+    typedef wbregs::field<reg, 8, 1, wbregs::WO> id; // Read ID from flash
+    typedef wbregs::field<reg, 9, 1, wbregs::WO> status; // Read status form flash
+  }
+
+  const uint32_t size = 0x14; // bytes
+}
+
+#endif
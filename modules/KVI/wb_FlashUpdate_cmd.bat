@@ -1 +1,2 @@
 lua "C:\Program Files\wishbone-gen\wbgen2" gen_FlashUpdate.wb -target pipelined -lang vhdl -vo wb_FlashUpdate.vhd -co wb_FlashUpdate.c -doco wb_FlashUpdate.html
+python wbgen_cpp.py gen_FlashUpdate.wb wb_FlashUpdate.hpp
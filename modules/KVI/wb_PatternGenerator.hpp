@@ -0,0 +1,53 @@
+/*
+  C++ register access for slave core: Digital pattern generator
+
+  * File           : wb_PatternGenerator.hpp
+  * Author         : generated by wbgen_cpp.py from gen_PatternGenerator.wb
+  * Standard       : C++11
+
+    THIS FILE WAS GENERATED BY wbgen_cpp.py FROM SOURCE FILE gen_PatternGenerator.wb
+    DO NOT HAND-EDIT, see wb_regs.hpp for the use of the types
+
+*/
+
+#ifndef __WBGEN_CPP_GEN_PATTERNGENERATOR_WB
+#define __WBGEN_CPP_GEN_PATTERNGENERATOR_WB
+
+#include "wb_regs.hpp"
+
+namespace wbpattern {
+
+  /* [0x0]: REG Pattern data input */
+  namespace data_in {
+    struct reg : wbregs::reg<0x0, wbregs::WO> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::WO> data_in; // data_in
+  }
+
+  /* [0x4]: REG Pattern period time */
+  namespace period {
+    struct reg : wbregs::reg<0x4, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RW> period; // period
+  }
+
+  /* [0x8]: REG Pattern control */
+  namespace control {
+    struct reg : wbregs::reg<0x8, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 1, wbregs::RW> enable; // Enable
+    typedef wbregs::field<reg, 1, 1, wbregs::RW> load; // Load pattern
+    typedef wbregs::field<reg, 2, 1, wbregs::WO> stop; // Stop pattern
+    typedef wbregs::field<reg, 3, 1, wbregs::WO> softtrigger; // Soft trigger
+  }
+
+  /* [0xc]: REG Pattern Status */
+  namespace status {
+    struct reg : wbregs::reg<0xc, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 1, wbregs::RO> pattern_busy; // Pattern busy
+    typedef wbregs::field<reg, 1, 15, wbregs::RO> reserved; // Not used
+    typedef wbregs::field<reg, 16, 8, wbregs::RO> width; // Pattern width
+    typedef wbregs::field<reg, 24, 8, wbregs::RO> depthbits; // Bits for pattern memory depth
+  }
+
+  const uint32_t size = 0x10; // bytes
+}
+
+#endif
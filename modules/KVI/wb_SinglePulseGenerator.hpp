@@ -0,0 +1,51 @@
+/*
+  C++ register access for slave core: Single Pulse Generator
+
+  * File           : wb_SinglePulseGenerator.hpp
+  * Author         : generated by wbgen_cpp.py from gen_SinglePulseGenerator.wb
+  * Standard       : C++11
+
+    THIS FILE WAS GENERATED BY wbgen_cpp.py FROM SOURCE FILE gen_SinglePulseGenerator.wb
+    DO NOT HAND-EDIT, see wb_regs.hpp for the use of the types
+
+*/
+
+#ifndef __WBGEN_CPP_GEN_SINGLEPULSEGENERATOR_WB
+#define __WBGEN_CPP_GEN_SINGLEPULSEGENERATOR_WB
+
+#include "wb_regs.hpp"
+
+namespace wbpulse {
+
+  /* [0x0]: REG Delay after trigger */
+  namespace delay {
+    struct reg : wbregs::reg<0x0, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RW> delay; // delay
+  }
+
+  /* [0x4]: REG Pulse duration */
+  namespace duration {
+    struct reg : wbregs::reg<0x4, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RW> duration; // duration
+  }
+
+  /* [0x8]: REG Pulse control */
+  namespace control {
+    struct reg : wbregs::reg<0x8, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 1, wbregs::RW> enable; // enable
+    typedef wbregs::field<reg, 1, 1, wbregs::RW> reserved; // Not used
+    typedef wbregs::field<reg, 2, 1, wbregs::WO> stop; // Stop pulse
+    typedef wbregs::field<reg, 3, 1, wbregs::WO> softtrigger; // Soft trigger
+  }
+
+  /* [0xc]: REG Pulse Status */
+  namespace status {
+    struct reg : wbregs::reg<0xc, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 1, wbregs::RO> pulse_busy; // Pulse busy
+    typedef wbregs::field<reg, 1, 1, wbregs::RO> pulse_active; // Pulse active
+  }
+
+  const uint32_t size = 0x10; // bytes
+}
+
+#endif
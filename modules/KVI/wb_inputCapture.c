@@ -0,0 +1,107 @@
+/*
+  Register definitions for slave core: Timestamp input capture
+
+  * File           : wb_inputCapture.c
+  * Author         : auto-generated by wbgen2 from gen_inputCapture.wb
+  * Created        : 10/24/12 11:02:17
+  * Standard       : ANSI C
+
+    THIS FILE WAS GENERATED BY wbgen2 FROM SOURCE FILE gen_inputCapture.wb
+    DO NOT HAND-EDIT UNLESS IT'S ABSOLUTELY NECESSARY!
+
+*/
+
+#ifndef __WBGEN2_REGDEFS_GEN_INPUTCAPTURE_WB
+#define __WBGEN2_REGDEFS_GEN_INPUTCAPTURE_WB
+
+#include <inttypes.h>
+
+#if defined( __GNUC__)
+#define PACKED __attribute__ ((packed))
+#else
+#error "Unsupported compiler?"
+#endif
+
+#ifndef __WBGEN2_MACROS_DEFINED__
+#define __WBGEN2_MACROS_DEFINED__
+#define WBGEN2_GEN_MASK(offset, size) (((1<<(size))-1) << (offset))
+#define WBGEN2_GEN_WRITE(value, offset, size) (((value) & ((1<<(size))-1)) << (offset))
+#define WBGEN2_GEN_READ(reg, offset, size) (((reg) >> (offset)) & ((1<<(size))-1))
+#define WBGEN2_SIGN_EXTEND(value, bits) (((value) & (1<<bits) ? ~((1<<(bits))-1): 0 ) | (value))
+#endif
+
+
+/* definitions for register: Input capture control */
+
+/* definitions for field: Rising edge enable in reg: Input capture control */
+#define WBCAPT_CONTROL_RISING_MASK            WBGEN2_GEN_MASK(0, 8)
+#define WBCAPT_CONTROL_RISING_SHIFT           0
+#define WBCAPT_CONTROL_RISING_W(value)        WBGEN2_GEN_WRITE(value, 0, 8)
+#define WBCAPT_CONTROL_RISING_R(reg)          WBGEN2_GEN_READ(reg, 0, 8)
+
+/* definitions for field: Falling edge enable in reg: Input capture control */
+#define WBCAPT_CONTROL_FALLING_MASK           WBGEN2_GEN_MASK(8, 8)
+#define WBCAPT_CONTROL_FALLING_SHIFT          8
+#define WBCAPT_CONTROL_FALLING_W(value)       WBGEN2_GEN_WRITE(value, 8, 8)
+#define WBCAPT_CONTROL_FALLING_R(reg)         WBGEN2_GEN_READ(reg, 8, 8)
+
+/* definitions for field: Clear in reg: Input capture control */
+#define WBCAPT_CONTROL_CLEAR_MASK             WBGEN2_GEN_MASK(16, 1)
+#define WBCAPT_CONTROL_CLEAR_SHIFT            16
+#define WBCAPT_CONTROL_CLEAR_W(value)         WBGEN2_GEN_WRITE(value, 16, 1)
+#define WBCAPT_CONTROL_CLEAR_R(reg)           WBGEN2_GEN_READ(reg, 16, 1)
+
+/* definitions for register: Input capture status */
+
+/* definitions for field: Fifo count in reg: Input capture status */
+#define WBCAPT_STATUS_COUNT_MASK              WBGEN2_GEN_MASK(0, 16)
+#define WBCAPT_STATUS_COUNT_SHIFT             0
+#define WBCAPT_STATUS_COUNT_W(value)          WBGEN2_GEN_WRITE(value, 0, 16)
+#define WBCAPT_STATUS_COUNT_R(reg)            WBGEN2_GEN_READ(reg, 0, 16)
+
+/* definitions for field: Fifo full in reg: Input capture status */
+#define WBCAPT_STATUS_FULL_MASK               WBGEN2_GEN_MASK(16, 1)
+#define WBCAPT_STATUS_FULL_SHIFT              16
+#define WBCAPT_STATUS_FULL_W(value)           WBGEN2_GEN_WRITE(value, 16, 1)
+#define WBCAPT_STATUS_FULL_R(reg)             WBGEN2_GEN_READ(reg, 16, 1)
+
+/* definitions for field: Overflow in reg: Input capture status */
+#define WBCAPT_STATUS_OVERFLOW_MASK           WBGEN2_GEN_MASK(17, 1)
+#define WBCAPT_STATUS_OVERFLOW_SHIFT          17
+#define WBCAPT_STATUS_OVERFLOW_W(value)       WBGEN2_GEN_WRITE(value, 17, 1)
+#define WBCAPT_STATUS_OVERFLOW_R(reg)         WBGEN2_GEN_READ(reg, 17, 1)
+
+/* definitions for field: Timestamp valid in reg: Input capture status */
+#define WBCAPT_STATUS_TSVALID_MASK            WBGEN2_GEN_MASK(18, 1)
+#define WBCAPT_STATUS_TSVALID_SHIFT           18
+#define WBCAPT_STATUS_TSVALID_W(value)        WBGEN2_GEN_WRITE(value, 18, 1)
+#define WBCAPT_STATUS_TSVALID_R(reg)          WBGEN2_GEN_READ(reg, 18, 1)
+
+/* definitions for register: Lost events counter */
+
+/* definitions for field: lost_counter in reg: Lost events counter */
+#define WBCAPT_LOST_NR_MASK                   WBGEN2_GEN_MASK(0, 32)
+#define WBCAPT_LOST_NR_SHIFT                  0
+#define WBCAPT_LOST_NR_W(value)               WBGEN2_GEN_WRITE(value, 0, 32)
+#define WBCAPT_LOST_NR_R(reg)                 WBGEN2_GEN_READ(reg, 0, 32)
+
+/* definitions for register: Events counter */
+
+/* definitions for field: event_counter in reg: Events counter */
+#define WBCAPT_EVENTS_NR_MASK                 WBGEN2_GEN_MASK(0, 32)
+#define WBCAPT_EVENTS_NR_SHIFT                0
+#define WBCAPT_EVENTS_NR_W(value)             WBGEN2_GEN_WRITE(value, 0, 32)
+#define WBCAPT_EVENTS_NR_R(reg)               WBGEN2_GEN_READ(reg, 0, 32)
+
+PACKED struct WBCAPT_WB {
+  /* [0x0]: REG Input capture control */
+  uint32_t CONTROL;
+  /* [0x4]: REG Input capture status */
+  uint32_t STATUS;
+  /* [0x8]: REG Lost events counter */
+  uint32_t LOST;
+  /* [0xc]: REG Events counter */
+  uint32_t EVENTS;
+};
+
+#endif
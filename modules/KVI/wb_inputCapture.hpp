@@ -0,0 +1,52 @@
+/*
+  C++ register access for slave core: Timestamp input capture
+
+  * File           : wb_inputCapture.hpp
+  * Author         : generated by wbgen_cpp.py from gen_inputCapture.wb
+  * Standard       : C++11
+
+    THIS FILE WAS GENERATED BY wbgen_cpp.py FROM SOURCE FILE gen_inputCapture.wb
+    DO NOT HAND-EDIT, see wb_regs.hpp for the use of the types
+
+*/
+
+#ifndef __WBGEN_CPP_GEN_INPUTCAPTURE_WB
+#define __WBGEN_CPP_GEN_INPUTCAPTURE_WB
+
+#include "wb_regs.hpp"
+
+namespace wbcapt {
+
+  /* [0x0]: REG Input capture control */
+  namespace control {
+    struct reg : wbregs::reg<0x0, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 8, wbregs::RW> rising; // Rising edge enable
+    typedef wbregs::field<reg, 8, 8, wbregs::RW> falling; // Falling edge enable
+    typedef wbregs::field<reg, 16, 1, wbregs::WO> clear; // Clear
+  }
+
+  /* [0x4]: REG Input capture status */
+  namespace status {
+    struct reg : wbregs::reg<0x4, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 16, wbregs::RO> count; // Fifo count
+    typedef wbregs::field<reg, 16, 1, wbregs::RO> full; // Fifo full
+    typedef wbregs::field<reg, 17, 1, wbregs::RO> overflow; // Overflow
+    typedef wbregs::field<reg, 18, 1, wbregs::RO> tsvalid; // Timestamp valid
+  }
+
+  /* [0x8]: REG Lost events counter */
+  namespace lost {
+    struct reg : wbregs::reg<0x8, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RO> nr; // lost_counter
+  }
+
+  /* [0xc]: REG Events counter */
+  namespace events {
+    struct reg : wbregs::reg<0xc, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RO> nr; // event_counter
+  }
+
+  const uint32_t size = 0x10; // bytes
+}
+
+#endif
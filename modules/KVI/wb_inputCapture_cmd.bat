@@ -0,0 +1,2 @@
+lua "C:\Program Files\wishbone-gen\wbgen2" gen_inputCapture.wb -target pipelined -lang vhdl -vo wb_inputCapture.vhd -co wb_inputCapture.c -doco wb_inputCapture.html
+python wbgen_cpp.py gen_inputCapture.wb wb_inputCapture.hpp
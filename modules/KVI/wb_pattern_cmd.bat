@@ -1 +1,2 @@
 lua "C:\Program Files\wishbone-gen\wbgen2" gen_PatternGenerator.wb -target pipelined -lang vhdl -vo wb_PatternGenerator.vhd -co wb_PatternGenerator.c -doco wb_PatternGenerator.html
+python wbgen_cpp.py gen_PatternGenerator.wb wb_PatternGenerator.hpp
@@ -1 +1,2 @@
 lua "C:\Program Files\wishbone-gen\wbgen2" gen_SinglePulseGenerator.wb -target pipelined -lang vhdl -vo wb_SinglePulseGenerator.vhd -co wb_SinglePulseGenerator.c -doco wb_SinglePulseGenerator.html
+python wbgen_cpp.py gen_SinglePulseGenerator.wb wb_SinglePulseGenerator.hpp
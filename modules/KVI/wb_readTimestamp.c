@@ -89,6 +89,18 @@
 #define WBRDTIME_CONTROL_CLEAR_W(value)       WBGEN2_GEN_WRITE(value, 3, 1)
 #define WBRDTIME_CONTROL_CLEAR_R(reg)         WBGEN2_GEN_READ(reg, 3, 1)
 
+/* definitions for field: Histogram freeze in reg: Read Timestamp control */
+#define WBRDTIME_CONTROL_HIST_FREEZE_MASK     WBGEN2_GEN_MASK(4, 1)
+#define WBRDTIME_CONTROL_HIST_FREEZE_SHIFT    4
+#define WBRDTIME_CONTROL_HIST_FREEZE_W(value) WBGEN2_GEN_WRITE(value, 4, 1)
+#define WBRDTIME_CONTROL_HIST_FREEZE_R(reg)   WBGEN2_GEN_READ(reg, 4, 1)
+
+/* definitions for field: Histogram clear in reg: Read Timestamp control */
+#define WBRDTIME_CONTROL_HIST_CLEAR_MASK      WBGEN2_GEN_MASK(5, 1)
+#define WBRDTIME_CONTROL_HIST_CLEAR_SHIFT     5
+#define WBRDTIME_CONTROL_HIST_CLEAR_W(value)  WBGEN2_GEN_WRITE(value, 5, 1)
+#define WBRDTIME_CONTROL_HIST_CLEAR_R(reg)    WBGEN2_GEN_READ(reg, 5, 1)
+
 PACKED struct WBRDTIME_WB {
   /* [0x0]: REG Timestamp High Word */
   uint32_t HIGH;
@@ -0,0 +1,58 @@
+/*
+  C++ register access for slave core: Read 64-bits timestamp
+
+  * File           : wb_readTimestamp.hpp
+  * Author         : generated by wbgen_cpp.py from gen_readTimestamp.wb
+  * Standard       : C++11
+
+    THIS FILE WAS GENERATED BY wbgen_cpp.py FROM SOURCE FILE gen_readTimestamp.wb
+    DO NOT HAND-EDIT, see wb_regs.hpp for the use of the types
+
+*/
+
+#ifndef __WBGEN_CPP_GEN_READTIMESTAMP_WB
+#define __WBGEN_CPP_GEN_READTIMESTAMP_WB
+
+#include "wb_regs.hpp"
+
+namespace wbrdtime {
+
+  /* [0x0]: REG Timestamp High Word */
+  namespace high {
+    struct reg : wbregs::reg<0x0, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RO> timestamp; // timestamp
+  }
+
+  /* [0x4]: REG Timestamp Low Word */
+  namespace low {
+    struct reg : wbregs::reg<0x4, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RO> timestamp; // timestamp
+  }
+
+  /* [0x8]: REG Timestamp error counter */
+  namespace errors {
+    struct reg : wbregs::reg<0x8, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RO> nr; // error_counter
+  }
+
+  /* [0xc]: REG Timestamp correction counter */
+  namespace corrections {
+    struct reg : wbregs::reg<0xc, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RO> nr; // correction_counter
+  }
+
+  /* [0x10]: REG Read Timestamp control */
+  namespace control {
+    struct reg : wbregs::reg<0x10, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 1, wbregs::RW> disable; // disable
+    typedef wbregs::field<reg, 1, 1, wbregs::RO> error; // Error
+    typedef wbregs::field<reg, 2, 1, wbregs::RO> correction; // Correction
+    typedef wbregs::field<reg, 3, 1, wbregs::WO> clear; // Clear
+    typedef wbregs::field<reg, 4, 1, wbregs::RW> hist_freeze; // Histogram freeze
+    typedef wbregs::field<reg, 5, 1, wbregs::WO> hist_clear; // Histogram clear
+  }
+
+  const uint32_t size = 0x14; // bytes
+}
+
+#endif
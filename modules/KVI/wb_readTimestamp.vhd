@@ -52,13 +52,19 @@ entity wb_readTimestamp is
     wbrdtime_control_correction_i            : in     std_logic_vector(0 downto 0);
 -- Ports for PASS_THROUGH field: 'Clear' in reg: 'Read Timestamp control'
     wbrdtime_control_clear_o                 : out    std_logic_vector(0 downto 0);
-    wbrdtime_control_clear_wr_o              : out    std_logic
+    wbrdtime_control_clear_wr_o              : out    std_logic;
+-- Port for std_logic_vector field: 'Histogram freeze' in reg: 'Read Timestamp control'
+    wbrdtime_control_hist_freeze_o           : out    std_logic_vector(0 downto 0);
+-- Ports for PASS_THROUGH field: 'Histogram clear' in reg: 'Read Timestamp control'
+    wbrdtime_control_hist_clear_o            : out    std_logic_vector(0 downto 0);
+    wbrdtime_control_hist_clear_wr_o         : out    std_logic
   );
 end wb_readTimestamp;
 
 architecture syn of wb_readTimestamp is
 
 signal wbrdtime_control_disable_int             : std_logic_vector(0 downto 0);
+signal wbrdtime_control_hist_freeze_int         : std_logic_vector(0 downto 0);
 signal ack_sreg                                 : std_logic_vector(9 downto 0);
 signal rddata_reg                               : std_logic_vector(31 downto 0);
 signal wrdata_reg                               : std_logic_vector(31 downto 0);
@@ -90,6 +96,8 @@ begin
       rddata_reg <= std_logic_vector(to_unsigned(0, 32));
       wbrdtime_control_disable_int <= std_logic_vector(to_unsigned(0, 1));
       wbrdtime_control_clear_wr_o <= '0';
+      wbrdtime_control_hist_freeze_int <= std_logic_vector(to_unsigned(0, 1));
+      wbrdtime_control_hist_clear_wr_o <= '0';
     elsif rising_edge(bus_clock_int) then
 -- advance the ACK generator shift register
       ack_sreg(8 downto 0) <= ack_sreg(9 downto 1);
@@ -97,9 +105,11 @@ begin
       if (ack_in_progress = '1') then
         if (ack_sreg(0) = '1') then
           wbrdtime_control_clear_wr_o <= '0';
+          wbrdtime_control_hist_clear_wr_o <= '0';
           ack_in_progress <= '0';
         else
           wbrdtime_control_clear_wr_o <= '0';
+          wbrdtime_control_hist_clear_wr_o <= '0';
         end if;
       else
         if ((wb_cyc_i = '1') and (wb_stb_i = '1')) then
@@ -136,8 +146,9 @@ begin
             if (wb_we_i = '1') then
               wbrdtime_control_disable_int <= wrdata_reg(0 downto 0);
               wbrdtime_control_clear_wr_o <= '1';
+              wbrdtime_control_hist_freeze_int <= wrdata_reg(4 downto 4);
+              wbrdtime_control_hist_clear_wr_o <= '1';
               rddata_reg(3) <= 'X';
-              rddata_reg(4) <= 'X';
               rddata_reg(5) <= 'X';
               rddata_reg(6) <= 'X';
               rddata_reg(7) <= 'X';
@@ -169,6 +180,7 @@ begin
               rddata_reg(0 downto 0) <= wbrdtime_control_disable_int;
               rddata_reg(1 downto 1) <= wbrdtime_control_error_i;
               rddata_reg(2 downto 2) <= wbrdtime_control_correction_i;
+              rddata_reg(4 downto 4) <= wbrdtime_control_hist_freeze_int;
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
@@ -196,6 +208,11 @@ begin
 -- Clear
 -- pass-through field: Clear in register: Read Timestamp control
   wbrdtime_control_clear_o <= wrdata_reg(3 downto 3);
+-- Histogram freeze
+  wbrdtime_control_hist_freeze_o <= wbrdtime_control_hist_freeze_int;
+-- Histogram clear
+-- pass-through field: Histogram clear in register: Read Timestamp control
+  wbrdtime_control_hist_clear_o <= wrdata_reg(5 downto 5);
   rwaddr_reg <= wb_addr_i;
 -- ACK signal generation. Just pass the LSB of ACK counter.
   wb_ack_o <= ack_sreg(0);
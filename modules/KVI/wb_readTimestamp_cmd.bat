@@ -1 +1,2 @@
 lua "C:\Program Files\wishbone-gen\wbgen2" gen_readTimestamp.wb -target pipelined -lang vhdl -vo wb_readTimestamp.vhd -co wb_readTimestamp.c -doco wb_readTimestamp.html
+python wbgen_cpp.py gen_readTimestamp.wb wb_readTimestamp.hpp
@@ -0,0 +1,152 @@
+/*
+  Typed register access for the wishbone slaves, used with the headers generated by wbgen_cpp.py
+
+  * File           : wb_regs.hpp
+  * Author         : Peter Schakel
+  * Company        : KVI
+  * Created        : 2012-10-26
+  * Standard       : C++11
+
+  The generated headers describe each register as a type with its offset and access,
+  and each field as a type with register, shift, width and access.
+  Everything is resolved at compile time: a field write compiles to the same single
+  bus access as the hand-written code with a volatile pointer and a magic number.
+
+  Example, the pattern generator at 0x110400 in the LM32 firmware:
+
+    #include "wb_PatternGenerator.hpp"
+    wbregs::mmio<0x110400> pattern;
+
+    wbregs::write(pattern, wbpattern::period::period::make(1085));
+    // enable and load in one bus access, instead of *pattern_control = 3:
+    wbregs::write(pattern, wbpattern::control::enable::set<1>() | wbpattern::control::load::set<1>());
+    if (wbregs::get<wbpattern::status::pattern_busy>(pattern)) ...
+
+  Checked at compile time:
+    - set<V>() with a value that does not fit in the field
+    - combining fields of different registers with |
+    - writing a read-only register or field, reading a write-only register or field
+    - modify (read-modify-write) on a register that is not read/write
+
+  The bus is a template parameter with read(offset) and write(offset, value):
+    mmio<Base>   : LM32 firmware, base address known at compile time
+    mmio_at      : LM32 firmware, base address found at run time
+    eb_bus       : host over Etherbone, see wb_regs_eb.hpp
+*/
+
+#ifndef WB_REGS_HPP
+#define WB_REGS_HPP
+
+#include <stdint.h>
+
+namespace wbregs {
+
+enum access_t { RO, WO, RW };
+
+// Register at byte offset Offset from the base address of the slave.
+// The generated headers derive a struct from this, so that each register is a distinct type.
+template <uint32_t Offset, access_t Access>
+struct reg {
+  static const uint32_t offset = Offset;
+  static const access_t access = Access;
+};
+
+// Value for register Reg: the bits to write and the mask of the fields in the value
+template <class Reg>
+struct value {
+  uint32_t bits;
+  uint32_t mask;
+  constexpr value(uint32_t b, uint32_t m) : bits(b), mask(m) {}
+};
+
+// Combine field values of the same register, written with one bus access
+template <class Reg>
+constexpr value<Reg> operator|(value<Reg> a, value<Reg> b) {
+  return value<Reg>(a.bits | b.bits, a.mask | b.mask);
+}
+
+// Field of Width bits at bit Shift in register Reg
+template <class Reg, unsigned Shift, unsigned Width, access_t Access>
+struct field {
+  static_assert(Width >= 1 && Shift + Width <= 32, "field does not fit in a 32-bit register");
+  typedef Reg reg_type;
+  static const unsigned shift = Shift;
+  static const unsigned width = Width;
+  static const access_t access = Access;
+  static const uint32_t max = (Width == 32) ? 0xffffffffu : ((1u << (Width % 32)) - 1u);
+  static const uint32_t mask = max << Shift;
+
+  // constant value, checked at compile time
+  template <uint32_t V>
+  static constexpr value<Reg> set() {
+    static_assert(Access != RO, "field is read only");
+    static_assert(V <= max, "value does not fit in the field");
+    return value<Reg>(V << Shift, mask);
+  }
+
+  // run time value, truncated to the field width like WBGEN2_GEN_WRITE
+  static constexpr value<Reg> make(uint32_t v) {
+    static_assert(Access != RO, "field is read only");
+    return value<Reg>((v & max) << Shift, mask);
+  }
+
+  // field from a register value read earlier
+  static constexpr uint32_t get(uint32_t regvalue) {
+    return (regvalue >> Shift) & max;
+  }
+};
+
+// Read a register
+template <class Reg, class Bus>
+inline uint32_t read(Bus& bus) {
+  static_assert(Reg::access != WO, "register is write only");
+  return bus.read(Reg::offset);
+}
+
+// Read one field, one bus access
+template <class Field, class Bus>
+inline uint32_t get(Bus& bus) {
+  static_assert(Field::access != WO, "field is write only");
+  return Field::get(bus.read(Field::reg_type::offset));
+}
+
+// Write a register, fields that are not in the value are written as zero
+template <class Reg, class Bus>
+inline void write(Bus& bus, value<Reg> v) {
+  static_assert(Reg::access != RO, "register is read only");
+  bus.write(Reg::offset, v.bits);
+}
+
+// Read-modify-write: only the fields in the value are changed
+template <class Reg, class Bus>
+inline void modify(Bus& bus, value<Reg> v) {
+  static_assert(Reg::access == RW, "read-modify-write needs a read/write register");
+  bus.write(Reg::offset, (bus.read(Reg::offset) & ~v.mask) | v.bits);
+}
+
+// LM32 firmware: slave at a base address known at compile time
+template <uint32_t Base>
+struct mmio {
+  static uint32_t read(uint32_t offset) {
+    return *(volatile uint32_t*)(uintptr_t)(Base + offset);
+  }
+  static void write(uint32_t offset, uint32_t v) {
+    *(volatile uint32_t*)(uintptr_t)(Base + offset) = v;
+  }
+};
+
+// LM32 firmware: slave at a base address found at run time (SDB)
+struct mmio_at {
+  uint32_t base;
+  explicit mmio_at(uint32_t b) : base(b) {}
+  uint32_t read(uint32_t offset) const {
+    return *(volatile uint32_t*)(uintptr_t)(base + offset);
+  }
+  void write(uint32_t offset, uint32_t v) const {
+    *(volatile uint32_t*)(uintptr_t)(base + offset) = v;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,204 @@
+/*
+  Compile time check of the C++ register headers against the wbgen2 C headers
+
+  * File           : wb_regs_check.cpp
+  * Author         : Peter Schakel
+  * Company        : KVI
+  * Created        : 2012-10-26
+  * Standard       : C++11
+
+  The wb_*.c files are generated by wbgen2 from the same gen_*.wb files as the VHDL slaves,
+  the wb_*.hpp files by wbgen_cpp.py. This file only compiles when every register offset,
+  field position and slave size in the C++ headers matches the wbgen2 output.
+  Run after regenerating the headers (wb_regs_check_cmd.bat):
+
+    g++ -std=c++11 -fsyntax-only wb_regs_check.cpp
+
+  WBGEN2_GEN_MASK overflows for 32-bit fields, and wbgen2 writes no macros for a field without prefix:
+  these are checked with the shift and a full mask.
+  Add the asserts for the new registers and fields when a .wb file is changed.
+*/
+
+#include <stddef.h>
+
+#include "wb_BuTiSclock.hpp"
+#include "wb_FlashUpdate.hpp"
+#include "wb_inputCapture.hpp"
+#include "wb_PatternGenerator.hpp"
+#include "wb_readTimestamp.hpp"
+#include "wb_rs232.hpp"
+#include "wb_SinglePulseGenerator.hpp"
+
+// wbgen2 names both timestamp registers TIMESTAMP: give the struct members different names
+#define WB_REGS_CHECK_CAT2(a, b) a##b
+#define WB_REGS_CHECK_CAT(a, b) WB_REGS_CHECK_CAT2(a, b)
+#define TIMESTAMP WB_REGS_CHECK_CAT(TIMESTAMP_, __LINE__)
+#include "wb_BuTiSclock.c"
+#undef TIMESTAMP
+#include "wb_FlashUpdate.c"
+#include "wb_inputCapture.c"
+#include "wb_PatternGenerator.c"
+#include "wb_readTimestamp.c"
+#include "wb_rs232.c"
+#include "wb_SinglePulseGenerator.c"
+
+typedef struct WBBUTIS_WB WBBUTIS_WB;
+typedef struct WBFLASH_WB WBFLASH_WB;
+typedef struct WBCAPT_WB WBCAPT_WB;
+typedef struct WBPATTERN_WB WBPATTERN_WB;
+typedef struct WBRDTIME_WB WBRDTIME_WB;
+typedef struct WBRS232_WB WBRS232_WB;
+typedef struct WBPULSE_WB WBPULSE_WB;
+
+// BuTis clock generator
+// both timestamp registers are TIMESTAMP in the struct, they are the two words before CONTROL
+static_assert(wbbutis::timestamp_lw::reg::offset + 4 == wbbutis::timestamp_hw::reg::offset, "wbbutis timestamp_lw offset");
+static_assert(wbbutis::timestamp_hw::reg::offset + 4 == offsetof(WBBUTIS_WB, CONTROL), "wbbutis timestamp_hw offset");
+static_assert(wbbutis::timestamp_lw::lw::shift == WBBUTIS_TIMESTAMP_LW_SHIFT && wbbutis::timestamp_lw::lw::mask == 0xffffffffu, "wbbutis timestamp_lw lw");
+static_assert(wbbutis::timestamp_hw::hw::shift == WBBUTIS_TIMESTAMP_HW_SHIFT && wbbutis::timestamp_hw::hw::mask == 0xffffffffu, "wbbutis timestamp_hw hw");
+static_assert(wbbutis::control::reg::offset == offsetof(WBBUTIS_WB, CONTROL), "wbbutis control offset");
+static_assert(wbbutis::control::set::shift == WBBUTIS_CONTROL_SET_SHIFT && wbbutis::control::set::mask == (uint32_t)WBBUTIS_CONTROL_SET_MASK, "wbbutis control set");
+static_assert(wbbutis::control::sync::shift == WBBUTIS_CONTROL_SYNC_SHIFT && wbbutis::control::sync::mask == (uint32_t)WBBUTIS_CONTROL_SYNC_MASK, "wbbutis control sync");
+static_assert(wbbutis::control::reset::shift == WBBUTIS_CONTROL_RESET_SHIFT && wbbutis::control::reset::mask == (uint32_t)WBBUTIS_CONTROL_RESET_MASK, "wbbutis control reset");
+static_assert(wbbutis::control::calibrate::shift == WBBUTIS_CONTROL_CALIBRATE_SHIFT && wbbutis::control::calibrate::mask == (uint32_t)WBBUTIS_CONTROL_CALIBRATE_MASK, "wbbutis control calibrate");
+static_assert(wbbutis::control::usecal::shift == WBBUTIS_CONTROL_USECAL_SHIFT && wbbutis::control::usecal::mask == (uint32_t)WBBUTIS_CONTROL_USECAL_MASK, "wbbutis control usecal");
+static_assert(wbbutis::control::track::shift == WBBUTIS_CONTROL_TRACK_SHIFT && wbbutis::control::track::mask == (uint32_t)WBBUTIS_CONTROL_TRACK_MASK, "wbbutis control track");
+static_assert(wbbutis::control::unused::shift == WBBUTIS_CONTROL_UNUSED_SHIFT && wbbutis::control::unused::mask == (uint32_t)WBBUTIS_CONTROL_UNUSED_MASK, "wbbutis control unused");
+static_assert(wbbutis::control::phase::shift == WBBUTIS_CONTROL_PHASE_SHIFT && wbbutis::control::phase::mask == (uint32_t)WBBUTIS_CONTROL_PHASE_MASK, "wbbutis control phase");
+static_assert(wbbutis::status::reg::offset == offsetof(WBBUTIS_WB, STATUS), "wbbutis status offset");
+static_assert(wbbutis::status::set::shift == WBBUTIS_STATUS_SET_SHIFT && wbbutis::status::set::mask == (uint32_t)WBBUTIS_STATUS_SET_MASK, "wbbutis status set");
+static_assert(wbbutis::status::ppsphase::shift == WBBUTIS_STATUS_PPSPHASE_SHIFT && wbbutis::status::ppsphase::mask == (uint32_t)WBBUTIS_STATUS_PPSPHASE_MASK, "wbbutis status ppsphase");
+static_assert(wbbutis::status::calbusy::shift == WBBUTIS_STATUS_CALBUSY_SHIFT && wbbutis::status::calbusy::mask == (uint32_t)WBBUTIS_STATUS_CALBUSY_MASK, "wbbutis status calbusy");
+static_assert(wbbutis::status::eyefound::shift == WBBUTIS_STATUS_EYEFOUND_SHIFT && wbbutis::status::eyefound::mask == (uint32_t)WBBUTIS_STATUS_EYEFOUND_MASK, "wbbutis status eyefound");
+static_assert(wbbutis::status::calphase::shift == WBBUTIS_STATUS_CALPHASE_SHIFT && wbbutis::status::calphase::mask == (uint32_t)WBBUTIS_STATUS_CALPHASE_MASK, "wbbutis status calphase");
+static_assert(wbbutis::status::eyewidth::shift == WBBUTIS_STATUS_EYEWIDTH_SHIFT && wbbutis::status::eyewidth::mask == (uint32_t)WBBUTIS_STATUS_EYEWIDTH_MASK, "wbbutis status eyewidth");
+static_assert(wbbutis::eyemap::reg::offset == offsetof(WBBUTIS_WB, EYEMAP), "wbbutis eyemap offset");
+static_assert(wbbutis::eyemap::map::shift == WBBUTIS_EYEMAP_MAP_SHIFT && wbbutis::eyemap::map::mask == 0xffffffffu, "wbbutis eyemap map");
+static_assert(wbbutis::tracker::reg::offset == offsetof(WBBUTIS_WB, TRACKER), "wbbutis tracker offset");
+static_assert(wbbutis::tracker::error::shift == WBBUTIS_TRACKER_ERROR_SHIFT && wbbutis::tracker::error::mask == (uint32_t)WBBUTIS_TRACKER_ERROR_MASK, "wbbutis tracker error");
+static_assert(wbbutis::tracker::offset::shift == WBBUTIS_TRACKER_OFFSET_SHIFT && wbbutis::tracker::offset::mask == (uint32_t)WBBUTIS_TRACKER_OFFSET_MASK, "wbbutis tracker offset");
+static_assert(wbbutis::tracker::locked::shift == WBBUTIS_TRACKER_LOCKED_SHIFT && wbbutis::tracker::locked::mask == (uint32_t)WBBUTIS_TRACKER_LOCKED_MASK, "wbbutis tracker locked");
+static_assert(wbbutis::tracker::index::shift == WBBUTIS_TRACKER_INDEX_SHIFT && wbbutis::tracker::index::mask == (uint32_t)WBBUTIS_TRACKER_INDEX_MASK, "wbbutis tracker index");
+static_assert(wbbutis::size == sizeof(WBBUTIS_WB), "wbbutis size");
+
+// External Flash Update
+static_assert(wbflash::params::reg::offset == offsetof(WBFLASH_WB, PARAMS), "wbflash params offset");
+static_assert(wbflash::params::data::shift == WBFLASH_PARAMS_DATA_SHIFT && wbflash::params::data::mask == (uint32_t)WBFLASH_PARAMS_DATA_MASK, "wbflash params data");
+static_assert(wbflash::params::address::shift == WBFLASH_PARAMS_ADDRESS_SHIFT && wbflash::params::address::mask == (uint32_t)WBFLASH_PARAMS_ADDRESS_MASK, "wbflash params address");
+static_assert(wbflash::params::write::shift == WBFLASH_PARAMS_WRITE_SHIFT && wbflash::params::write::mask == (uint32_t)WBFLASH_PARAMS_WRITE_MASK, "wbflash params write");
+static_assert(wbflash::params::request::shift == WBFLASH_PARAMS_REQUEST_SHIFT && wbflash::params::request::mask == (uint32_t)WBFLASH_PARAMS_REQUEST_MASK, "wbflash params request");
+static_assert(wbflash::params::reconf::shift == WBFLASH_PARAMS_RECONF_SHIFT && wbflash::params::reconf::mask == (uint32_t)WBFLASH_PARAMS_RECONF_MASK, "wbflash params reconf");
+static_assert(wbflash::params_read::reg::offset == offsetof(WBFLASH_WB, PARAMS_READ), "wbflash params_read offset");
+static_assert(wbflash::params_read::data::shift == WBFLASH_PARAMS_READ_DATA_SHIFT && wbflash::params_read::data::mask == (uint32_t)WBFLASH_PARAMS_READ_DATA_MASK, "wbflash params_read data");
+static_assert(wbflash::params_read::address::shift == WBFLASH_PARAMS_READ_ADDRESS_SHIFT && wbflash::params_read::address::mask == (uint32_t)WBFLASH_PARAMS_READ_ADDRESS_MASK, "wbflash params_read address");
+static_assert(wbflash::params_read::busy::shift == WBFLASH_PARAMS_READ_BUSY_SHIFT && wbflash::params_read::busy::mask == (uint32_t)WBFLASH_PARAMS_READ_BUSY_MASK, "wbflash params_read busy");
+static_assert(wbflash::params_read::error::shift == WBFLASH_PARAMS_READ_ERROR_SHIFT && wbflash::params_read::error::mask == (uint32_t)WBFLASH_PARAMS_READ_ERROR_MASK, "wbflash params_read error");
+static_assert(wbflash::params_read::illegal::shift == WBFLASH_PARAMS_READ_ILLEGAL_SHIFT && wbflash::params_read::illegal::mask == (uint32_t)WBFLASH_PARAMS_READ_ILLEGAL_MASK, "wbflash params_read illegal");
+static_assert(wbflash::params_read::erase_error::shift == WBFLASH_PARAMS_READ_ERASE_ERROR_SHIFT && wbflash::params_read::erase_error::mask == (uint32_t)WBFLASH_PARAMS_READ_ERASE_ERROR_MASK, "wbflash params_read erase_error");
+static_assert(wbflash::flash_data::reg::offset == offsetof(WBFLASH_WB, FLASH_DATA), "wbflash flash_data offset");
+static_assert(wbflash::flash_data::data::shift == WBFLASH_FLASH_DATA_DATA_SHIFT && wbflash::flash_data::data::mask == (uint32_t)WBFLASH_FLASH_DATA_DATA_MASK, "wbflash flash_data data");
+static_assert(wbflash::flash_data::address::shift == WBFLASH_FLASH_DATA_ADDRESS_SHIFT && wbflash::flash_data::address::mask == (uint32_t)WBFLASH_FLASH_DATA_ADDRESS_MASK, "wbflash flash_data address");
+static_assert(wbflash::flash_read::reg::offset == offsetof(WBFLASH_WB, FLASH_READ), "wbflash flash_read offset");
+static_assert(wbflash::flash_read::data::shift == WBFLASH_FLASH_READ_DATA_SHIFT && wbflash::flash_read::data::mask == (uint32_t)WBFLASH_FLASH_READ_DATA_MASK, "wbflash flash_read data");
+static_assert(wbflash::flash_read::valid::shift == WBFLASH_FLASH_READ_VALID_SHIFT && wbflash::flash_read::valid::mask == (uint32_t)WBFLASH_FLASH_READ_VALID_MASK, "wbflash flash_read valid");
+static_assert(wbflash::flash_read::busy::shift == WBFLASH_FLASH_READ_BUSY_SHIFT && wbflash::flash_read::busy::mask == (uint32_t)WBFLASH_FLASH_READ_BUSY_MASK, "wbflash flash_read busy");
+static_assert(wbflash::flash_read::error::shift == WBFLASH_FLASH_READ_ERROR_SHIFT && wbflash::flash_read::error::mask == (uint32_t)WBFLASH_FLASH_READ_ERROR_MASK, "wbflash flash_read error");
+static_assert(wbflash::flash_access::reg::offset == offsetof(WBFLASH_WB, FLASH_ACCESS), "wbflash flash_access offset");
+static_assert(wbflash::flash_access::enable::shift == WBFLASH_FLASH_ACCESS_ENABLE_SHIFT && wbflash::flash_access::enable::mask == (uint32_t)WBFLASH_FLASH_ACCESS_ENABLE_MASK, "wbflash flash_access enable");
+static_assert(wbflash::flash_access::read_enable::shift == WBFLASH_FLASH_ACCESS_READ_ENABLE_SHIFT && wbflash::flash_access::read_enable::mask == (uint32_t)WBFLASH_FLASH_ACCESS_READ_ENABLE_MASK, "wbflash flash_access read_enable");
+static_assert(wbflash::flash_access::write_enable::shift == WBFLASH_FLASH_ACCESS_WRITE_ENABLE_SHIFT && wbflash::flash_access::write_enable::mask == (uint32_t)WBFLASH_FLASH_ACCESS_WRITE_ENABLE_MASK, "wbflash flash_access write_enable");
+static_assert(wbflash::flash_access::erase_enable::shift == WBFLASH_FLASH_ACCESS_ERASE_ENABLE_SHIFT && wbflash::flash_access::erase_enable::mask == (uint32_t)WBFLASH_FLASH_ACCESS_ERASE_ENABLE_MASK, "wbflash flash_access erase_enable");
+static_assert(wbflash::flash_access::id::shift == WBFLASH_FLASH_ACCESS_ID_SHIFT && wbflash::flash_access::id::mask == (uint32_t)WBFLASH_FLASH_ACCESS_ID_MASK, "wbflash flash_access id");
+static_assert(wbflash::flash_access::status::shift == WBFLASH_FLASH_ACCESS_STATUS_SHIFT && wbflash::flash_access::status::mask == (uint32_t)WBFLASH_FLASH_ACCESS_STATUS_MASK, "wbflash flash_access status");
+static_assert(wbflash::size == sizeof(WBFLASH_WB), "wbflash size");
+
+// Timestamp input capture
+static_assert(wbcapt::control::reg::offset == offsetof(WBCAPT_WB, CONTROL), "wbcapt control offset");
+static_assert(wbcapt::control::rising::shift == WBCAPT_CONTROL_RISING_SHIFT && wbcapt::control::rising::mask == (uint32_t)WBCAPT_CONTROL_RISING_MASK, "wbcapt control rising");
+static_assert(wbcapt::control::falling::shift == WBCAPT_CONTROL_FALLING_SHIFT && wbcapt::control::falling::mask == (uint32_t)WBCAPT_CONTROL_FALLING_MASK, "wbcapt control falling");
+static_assert(wbcapt::control::clear::shift == WBCAPT_CONTROL_CLEAR_SHIFT && wbcapt::control::clear::mask == (uint32_t)WBCAPT_CONTROL_CLEAR_MASK, "wbcapt control clear");
+static_assert(wbcapt::status::reg::offset == offsetof(WBCAPT_WB, STATUS), "wbcapt status offset");
+static_assert(wbcapt::status::count::shift == WBCAPT_STATUS_COUNT_SHIFT && wbcapt::status::count::mask == (uint32_t)WBCAPT_STATUS_COUNT_MASK, "wbcapt status count");
+static_assert(wbcapt::status::full::shift == WBCAPT_STATUS_FULL_SHIFT && wbcapt::status::full::mask == (uint32_t)WBCAPT_STATUS_FULL_MASK, "wbcapt status full");
+static_assert(wbcapt::status::overflow::shift == WBCAPT_STATUS_OVERFLOW_SHIFT && wbcapt::status::overflow::mask == (uint32_t)WBCAPT_STATUS_OVERFLOW_MASK, "wbcapt status overflow");
+static_assert(wbcapt::status::tsvalid::shift == WBCAPT_STATUS_TSVALID_SHIFT && wbcapt::status::tsvalid::mask == (uint32_t)WBCAPT_STATUS_TSVALID_MASK, "wbcapt status tsvalid");
+static_assert(wbcapt::lost::reg::offset == offsetof(WBCAPT_WB, LOST), "wbcapt lost offset");
+static_assert(wbcapt::lost::nr::shift == WBCAPT_LOST_NR_SHIFT && wbcapt::lost::nr::mask == 0xffffffffu, "wbcapt lost nr");
+static_assert(wbcapt::events::reg::offset == offsetof(WBCAPT_WB, EVENTS), "wbcapt events offset");
+static_assert(wbcapt::events::nr::shift == WBCAPT_EVENTS_NR_SHIFT && wbcapt::events::nr::mask == 0xffffffffu, "wbcapt events nr");
+static_assert(wbcapt::size == sizeof(WBCAPT_WB), "wbcapt size");
+
+// Digital pattern generator
+static_assert(wbpattern::data_in::reg::offset == offsetof(WBPATTERN_WB, DATA_IN), "wbpattern data_in offset");
+static_assert(wbpattern::data_in::data_in::shift == 0 && wbpattern::data_in::data_in::mask == 0xffffffffu, "wbpattern data_in data_in");
+static_assert(wbpattern::period::reg::offset == offsetof(WBPATTERN_WB, PERIOD), "wbpattern period offset");
+static_assert(wbpattern::period::period::shift == WBPATTERN_PERIOD_PERIOD_SHIFT && wbpattern::period::period::mask == 0xffffffffu, "wbpattern period period");
+static_assert(wbpattern::control::reg::offset == offsetof(WBPATTERN_WB, CONTROL), "wbpattern control offset");
+static_assert(wbpattern::control::enable::shift == WBPATTERN_CONTROL_ENABLE_SHIFT && wbpattern::control::enable::mask == (uint32_t)WBPATTERN_CONTROL_ENABLE_MASK, "wbpattern control enable");
+static_assert(wbpattern::control::load::shift == WBPATTERN_CONTROL_LOAD_SHIFT && wbpattern::control::load::mask == (uint32_t)WBPATTERN_CONTROL_LOAD_MASK, "wbpattern control load");
+static_assert(wbpattern::control::stop::shift == WBPATTERN_CONTROL_STOP_SHIFT && wbpattern::control::stop::mask == (uint32_t)WBPATTERN_CONTROL_STOP_MASK, "wbpattern control stop");
+static_assert(wbpattern::control::softtrigger::shift == WBPATTERN_CONTROL_SOFTTRIGGER_SHIFT && wbpattern::control::softtrigger::mask == (uint32_t)WBPATTERN_CONTROL_SOFTTRIGGER_MASK, "wbpattern control softtrigger");
+static_assert(wbpattern::status::reg::offset == offsetof(WBPATTERN_WB, STATUS), "wbpattern status offset");
+static_assert(wbpattern::status::pattern_busy::shift == WBPATTERN_STATUS_PATTERN_BUSY_SHIFT && wbpattern::status::pattern_busy::mask == (uint32_t)WBPATTERN_STATUS_PATTERN_BUSY_MASK, "wbpattern status pattern_busy");
+static_assert(wbpattern::status::reserved::shift == WBPATTERN_STATUS_RESERVED_SHIFT && wbpattern::status::reserved::mask == (uint32_t)WBPATTERN_STATUS_RESERVED_MASK, "wbpattern status reserved");
+static_assert(wbpattern::status::width::shift == WBPATTERN_STATUS_WIDTH_SHIFT && wbpattern::status::width::mask == (uint32_t)WBPATTERN_STATUS_WIDTH_MASK, "wbpattern status width");
+static_assert(wbpattern::status::depthbits::shift == WBPATTERN_STATUS_DEPTHBITS_SHIFT && wbpattern::status::depthbits::mask == (uint32_t)WBPATTERN_STATUS_DEPTHBITS_MASK, "wbpattern status depthbits");
+static_assert(wbpattern::size == sizeof(WBPATTERN_WB), "wbpattern size");
+
+// Read 64-bits timestamp
+static_assert(wbrdtime::high::reg::offset == offsetof(WBRDTIME_WB, HIGH), "wbrdtime high offset");
+static_assert(wbrdtime::high::timestamp::shift == WBRDTIME_HIGH_TIMESTAMP_SHIFT && wbrdtime::high::timestamp::mask == 0xffffffffu, "wbrdtime high timestamp");
+static_assert(wbrdtime::low::reg::offset == offsetof(WBRDTIME_WB, LOW), "wbrdtime low offset");
+static_assert(wbrdtime::low::timestamp::shift == WBRDTIME_LOW_TIMESTAMP_SHIFT && wbrdtime::low::timestamp::mask == 0xffffffffu, "wbrdtime low timestamp");
+static_assert(wbrdtime::errors::reg::offset == offsetof(WBRDTIME_WB, ERRORS), "wbrdtime errors offset");
+static_assert(wbrdtime::errors::nr::shift == WBRDTIME_ERRORS_NR_SHIFT && wbrdtime::errors::nr::mask == 0xffffffffu, "wbrdtime errors nr");
+static_assert(wbrdtime::corrections::reg::offset == offsetof(WBRDTIME_WB, CORRECTIONS), "wbrdtime corrections offset");
+static_assert(wbrdtime::corrections::nr::shift == WBRDTIME_CORRECTIONS_NR_SHIFT && wbrdtime::corrections::nr::mask == 0xffffffffu, "wbrdtime corrections nr");
+static_assert(wbrdtime::control::reg::offset == offsetof(WBRDTIME_WB, CONTROL), "wbrdtime control offset");
+static_assert(wbrdtime::control::disable::shift == WBRDTIME_CONTROL_DISABLE_SHIFT && wbrdtime::control::disable::mask == (uint32_t)WBRDTIME_CONTROL_DISABLE_MASK, "wbrdtime control disable");
+static_assert(wbrdtime::control::error::shift == WBRDTIME_CONTROL_ERROR_SHIFT && wbrdtime::control::error::mask == (uint32_t)WBRDTIME_CONTROL_ERROR_MASK, "wbrdtime control error");
+static_assert(wbrdtime::control::correction::shift == WBRDTIME_CONTROL_CORRECTION_SHIFT && wbrdtime::control::correction::mask == (uint32_t)WBRDTIME_CONTROL_CORRECTION_MASK, "wbrdtime control correction");
+static_assert(wbrdtime::control::clear::shift == WBRDTIME_CONTROL_CLEAR_SHIFT && wbrdtime::control::clear::mask == (uint32_t)WBRDTIME_CONTROL_CLEAR_MASK, "wbrdtime control clear");
+static_assert(wbrdtime::control::hist_freeze::shift == WBRDTIME_CONTROL_HIST_FREEZE_SHIFT && wbrdtime::control::hist_freeze::mask == (uint32_t)WBRDTIME_CONTROL_HIST_FREEZE_MASK, "wbrdtime control hist_freeze");
+static_assert(wbrdtime::control::hist_clear::shift == WBRDTIME_CONTROL_HIST_CLEAR_SHIFT && wbrdtime::control::hist_clear::mask == (uint32_t)WBRDTIME_CONTROL_HIST_CLEAR_MASK, "wbrdtime control hist_clear");
+static_assert(wbrdtime::size == sizeof(WBRDTIME_WB), "wbrdtime size");
+
+// Simple RS232 module
+static_assert(wbrs232::send::reg::offset == offsetof(WBRS232_WB, SEND), "wbrs232 send offset");
+static_assert(wbrs232::send::data::shift == WBRS232_SEND_DATA_SHIFT && wbrs232::send::data::mask == (uint32_t)WBRS232_SEND_DATA_MASK, "wbrs232 send data");
+static_assert(wbrs232::read::reg::offset == offsetof(WBRS232_WB, READ), "wbrs232 read offset");
+static_assert(wbrs232::read::data::shift == WBRS232_READ_DATA_SHIFT && wbrs232::read::data::mask == (uint32_t)WBRS232_READ_DATA_MASK, "wbrs232 read data");
+static_assert(wbrs232::done::reg::offset == offsetof(WBRS232_WB, DONE), "wbrs232 done offset");
+static_assert(wbrs232::done::done::shift == WBRS232_DONE_DONE_SHIFT && wbrs232::done::done::mask == 0xffffffffu, "wbrs232 done done");
+static_assert(wbrs232::status::reg::offset == offsetof(WBRS232_WB, STATUS), "wbrs232 status offset");
+static_assert(wbrs232::status::allowed::shift == WBRS232_STATUS_ALLOWED_SHIFT && wbrs232::status::allowed::mask == (uint32_t)WBRS232_STATUS_ALLOWED_MASK, "wbrs232 status allowed");
+static_assert(wbrs232::status::available::shift == WBRS232_STATUS_AVAILABLE_SHIFT && wbrs232::status::available::mask == (uint32_t)WBRS232_STATUS_AVAILABLE_MASK, "wbrs232 status available");
+static_assert(wbrs232::status::txempty::shift == WBRS232_STATUS_TXEMPTY_SHIFT && wbrs232::status::txempty::mask == (uint32_t)WBRS232_STATUS_TXEMPTY_MASK, "wbrs232 status txempty");
+static_assert(wbrs232::control::reg::offset == offsetof(WBRS232_WB, CONTROL), "wbrs232 control offset");
+static_assert(wbrs232::control::baud::shift == WBRS232_CONTROL_BAUD_SHIFT && wbrs232::control::baud::mask == (uint32_t)WBRS232_CONTROL_BAUD_MASK, "wbrs232 control baud");
+static_assert(wbrs232::control::txirq::shift == WBRS232_CONTROL_TXIRQ_SHIFT && wbrs232::control::txirq::mask == (uint32_t)WBRS232_CONTROL_TXIRQ_MASK, "wbrs232 control txirq");
+static_assert(wbrs232::control::rxirq::shift == WBRS232_CONTROL_RXIRQ_SHIFT && wbrs232::control::rxirq::mask == (uint32_t)WBRS232_CONTROL_RXIRQ_MASK, "wbrs232 control rxirq");
+static_assert(wbrs232::level::reg::offset == offsetof(WBRS232_WB, LEVEL), "wbrs232 level offset");
+static_assert(wbrs232::level::tx::shift == WBRS232_LEVEL_TX_SHIFT && wbrs232::level::tx::mask == (uint32_t)WBRS232_LEVEL_TX_MASK, "wbrs232 level tx");
+static_assert(wbrs232::level::rx::shift == WBRS232_LEVEL_RX_SHIFT && wbrs232::level::rx::mask == (uint32_t)WBRS232_LEVEL_RX_MASK, "wbrs232 level rx");
+static_assert(wbrs232::threshold::reg::offset == offsetof(WBRS232_WB, THRESHOLD), "wbrs232 threshold offset");
+static_assert(wbrs232::threshold::tx::shift == WBRS232_THRESHOLD_TX_SHIFT && wbrs232::threshold::tx::mask == (uint32_t)WBRS232_THRESHOLD_TX_MASK, "wbrs232 threshold tx");
+static_assert(wbrs232::threshold::rx::shift == WBRS232_THRESHOLD_RX_SHIFT && wbrs232::threshold::rx::mask == (uint32_t)WBRS232_THRESHOLD_RX_MASK, "wbrs232 threshold rx");
+static_assert(wbrs232::lost::reg::offset == offsetof(WBRS232_WB, LOST), "wbrs232 lost offset");
+static_assert(wbrs232::lost::count::shift == WBRS232_LOST_COUNT_SHIFT && wbrs232::lost::count::mask == 0xffffffffu, "wbrs232 lost count");
+static_assert(wbrs232::size == sizeof(WBRS232_WB), "wbrs232 size");
+
+// Single Pulse Generator
+static_assert(wbpulse::delay::reg::offset == offsetof(WBPULSE_WB, DELAY), "wbpulse delay offset");
+static_assert(wbpulse::delay::delay::shift == 0 && wbpulse::delay::delay::mask == 0xffffffffu, "wbpulse delay delay");
+static_assert(wbpulse::duration::reg::offset == offsetof(WBPULSE_WB, DURATION), "wbpulse duration offset");
+static_assert(wbpulse::duration::duration::shift == 0 && wbpulse::duration::duration::mask == 0xffffffffu, "wbpulse duration duration");
+static_assert(wbpulse::control::reg::offset == offsetof(WBPULSE_WB, CONTROL), "wbpulse control offset");
+static_assert(wbpulse::control::enable::shift == WBPULSE_CONTROL_ENABLE_SHIFT && wbpulse::control::enable::mask == (uint32_t)WBPULSE_CONTROL_ENABLE_MASK, "wbpulse control enable");
+static_assert(wbpulse::control::reserved::shift == WBPULSE_CONTROL_RESERVED_SHIFT && wbpulse::control::reserved::mask == (uint32_t)WBPULSE_CONTROL_RESERVED_MASK, "wbpulse control reserved");
+static_assert(wbpulse::control::stop::shift == WBPULSE_CONTROL_STOP_SHIFT && wbpulse::control::stop::mask == (uint32_t)WBPULSE_CONTROL_STOP_MASK, "wbpulse control stop");
+static_assert(wbpulse::control::softtrigger::shift == WBPULSE_CONTROL_SOFTTRIGGER_SHIFT && wbpulse::control::softtrigger::mask == (uint32_t)WBPULSE_CONTROL_SOFTTRIGGER_MASK, "wbpulse control softtrigger");
+static_assert(wbpulse::status::reg::offset == offsetof(WBPULSE_WB, STATUS), "wbpulse status offset");
+static_assert(wbpulse::status::pulse_busy::shift == WBPULSE_STATUS_PULSE_BUSY_SHIFT && wbpulse::status::pulse_busy::mask == (uint32_t)WBPULSE_STATUS_PULSE_BUSY_MASK, "wbpulse status pulse_busy");
+static_assert(wbpulse::status::pulse_active::shift == WBPULSE_STATUS_PULSE_ACTIVE_SHIFT && wbpulse::status::pulse_active::mask == (uint32_t)WBPULSE_STATUS_PULSE_ACTIVE_MASK, "wbpulse status pulse_active");
+static_assert(wbpulse::size == sizeof(WBPULSE_WB), "wbpulse size");
@@ -0,0 +1 @@
+g++ -std=c++11 -fsyntax-only wb_regs_check.cpp
@@ -0,0 +1,98 @@
+/*
+  Etherbone bus for the typed register access of wb_regs.hpp, for host programs
+
+  * File           : wb_regs_eb.hpp
+  * Author         : Peter Schakel
+  * Company        : KVI
+  * Created        : 2012-10-26
+  * Standard       : C++11
+
+  Each read and write is one Etherbone cycle, the same as eb_read and eb_write in the eb tools.
+  Fields of one register combined with | are still written in one cycle.
+  Errors (cycle failure or wishbone error) set the error flag, the read value is then zero.
+
+  Example, the flash update module at 0x110800:
+
+    #include "etherbone.h"
+    #include "wb_FlashUpdate.hpp"
+    #include "wb_regs_eb.hpp"
+
+    wbregs::eb_bus flash(socket, device, 0x110800, EB_BIG_ENDIAN|EB_DATA32);
+    wbregs::write(flash, wbflash::flash_access::enable::set<1>() | wbflash::flash_access::read_enable::set<1>());
+    if (flash.error) ...
+*/
+
+#ifndef WB_REGS_EB_HPP
+#define WB_REGS_EB_HPP
+
+#include "wb_regs.hpp"
+
+namespace wbregs {
+
+class eb_bus {
+public:
+  eb_socket_t socket;
+  eb_device_t device;
+  eb_address_t base;
+  eb_format_t format;
+  bool error;
+
+  eb_bus(eb_socket_t s, eb_device_t d, eb_address_t b, eb_format_t f)
+    : socket(s), device(d), base(b), format(f), error(false) {}
+
+  uint32_t read(uint32_t offset) {
+    completion c;
+    eb_cycle_t cycle;
+    if (eb_cycle_open(device, &c, &done, &cycle) != EB_OK) {
+      error = true;
+      return 0;
+    }
+    eb_cycle_read(cycle, base + offset, format, 0);
+    eb_cycle_close(cycle);
+    wait(c);
+    return (uint32_t)c.data;
+  }
+
+  void write(uint32_t offset, uint32_t v) {
+    completion c;
+    eb_cycle_t cycle;
+    if (eb_cycle_open(device, &c, &done, &cycle) != EB_OK) {
+      error = true;
+      return;
+    }
+    eb_cycle_write(cycle, base + offset, format, (eb_data_t)v);
+    eb_cycle_close(cycle);
+    wait(c);
+  }
+
+private:
+  struct completion {
+    int stop;
+    bool error;
+    eb_data_t data;
+    completion() : stop(0), error(false), data(0) {}
+  };
+
+  static void done(eb_user_data_t user, eb_device_t, eb_operation_t op, eb_status_t status) {
+    completion* c = (completion*)user;
+    c->stop = 1;
+    if (status != EB_OK) {
+      c->error = true;
+      return;
+    }
+    for (; op != EB_NULL; op = eb_operation_next(op)) {
+      if (eb_operation_had_error(op)) c->error = true;
+      if (eb_operation_is_read(op)) c->data = eb_operation_data(op);
+    }
+  }
+
+  void wait(completion& c) {
+    eb_device_flush(device);
+    while (!c.stop) eb_socket_run(socket, -1);
+    if (c.error) error = true;
+  }
+};
+
+}
+
+#endif
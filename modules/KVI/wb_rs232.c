@@ -3,7 +3,7 @@
 
   * File           : wb_rs232.c
   * Author         : auto-generated by wbgen2 from gen_rs232.wb
-  * Created        : 09/10/12 11:45:39
+  * Created        : 10/25/12 10:12:31
   * Standard       : ANSI C
 
     THIS FILE WAS GENERATED BY wbgen2 FROM SOURCE FILE gen_rs232.wb
@@ -69,6 +69,12 @@
 #define WBRS232_STATUS_AVAILABLE_W(value)     WBGEN2_GEN_WRITE(value, 1, 1)
 #define WBRS232_STATUS_AVAILABLE_R(reg)       WBGEN2_GEN_READ(reg, 1, 1)
 
+/* definitions for field: transmitter empty in reg: status */
+#define WBRS232_STATUS_TXEMPTY_MASK           WBGEN2_GEN_MASK(2, 1)
+#define WBRS232_STATUS_TXEMPTY_SHIFT          2
+#define WBRS232_STATUS_TXEMPTY_W(value)       WBGEN2_GEN_WRITE(value, 2, 1)
+#define WBRS232_STATUS_TXEMPTY_R(reg)         WBGEN2_GEN_READ(reg, 2, 1)
+
 /* definitions for register: control */
 
 /* definitions for field: baudrate in reg: control */
@@ -77,6 +83,54 @@
 #define WBRS232_CONTROL_BAUD_W(value)         WBGEN2_GEN_WRITE(value, 0, 3)
 #define WBRS232_CONTROL_BAUD_R(reg)           WBGEN2_GEN_READ(reg, 0, 3)
 
+/* definitions for field: transmit interrupt enable in reg: control */
+#define WBRS232_CONTROL_TXIRQ_MASK            WBGEN2_GEN_MASK(3, 1)
+#define WBRS232_CONTROL_TXIRQ_SHIFT           3
+#define WBRS232_CONTROL_TXIRQ_W(value)        WBGEN2_GEN_WRITE(value, 3, 1)
+#define WBRS232_CONTROL_TXIRQ_R(reg)          WBGEN2_GEN_READ(reg, 3, 1)
+
+/* definitions for field: receive interrupt enable in reg: control */
+#define WBRS232_CONTROL_RXIRQ_MASK            WBGEN2_GEN_MASK(4, 1)
+#define WBRS232_CONTROL_RXIRQ_SHIFT           4
+#define WBRS232_CONTROL_RXIRQ_W(value)        WBGEN2_GEN_WRITE(value, 4, 1)
+#define WBRS232_CONTROL_RXIRQ_R(reg)          WBGEN2_GEN_READ(reg, 4, 1)
+
+/* definitions for register: fifo level */
+
+/* definitions for field: transmit level in reg: fifo level */
+#define WBRS232_LEVEL_TX_MASK                 WBGEN2_GEN_MASK(0, 16)
+#define WBRS232_LEVEL_TX_SHIFT                0
+#define WBRS232_LEVEL_TX_W(value)             WBGEN2_GEN_WRITE(value, 0, 16)
+#define WBRS232_LEVEL_TX_R(reg)               WBGEN2_GEN_READ(reg, 0, 16)
+
+/* definitions for field: receive level in reg: fifo level */
+#define WBRS232_LEVEL_RX_MASK                 WBGEN2_GEN_MASK(16, 16)
+#define WBRS232_LEVEL_RX_SHIFT                16
+#define WBRS232_LEVEL_RX_W(value)             WBGEN2_GEN_WRITE(value, 16, 16)
+#define WBRS232_LEVEL_RX_R(reg)               WBGEN2_GEN_READ(reg, 16, 16)
+
+/* definitions for register: interrupt thresholds */
+
+/* definitions for field: transmit threshold in reg: interrupt thresholds */
+#define WBRS232_THRESHOLD_TX_MASK             WBGEN2_GEN_MASK(0, 16)
+#define WBRS232_THRESHOLD_TX_SHIFT            0
+#define WBRS232_THRESHOLD_TX_W(value)         WBGEN2_GEN_WRITE(value, 0, 16)
+#define WBRS232_THRESHOLD_TX_R(reg)           WBGEN2_GEN_READ(reg, 0, 16)
+
+/* definitions for field: receive threshold in reg: interrupt thresholds */
+#define WBRS232_THRESHOLD_RX_MASK             WBGEN2_GEN_MASK(16, 16)
+#define WBRS232_THRESHOLD_RX_SHIFT            16
+#define WBRS232_THRESHOLD_RX_W(value)         WBGEN2_GEN_WRITE(value, 16, 16)
+#define WBRS232_THRESHOLD_RX_R(reg)           WBGEN2_GEN_READ(reg, 16, 16)
+
+/* definitions for register: receive lost */
+
+/* definitions for field: lost in reg: receive lost */
+#define WBRS232_LOST_COUNT_MASK               WBGEN2_GEN_MASK(0, 32)
+#define WBRS232_LOST_COUNT_SHIFT              0
+#define WBRS232_LOST_COUNT_W(value)           WBGEN2_GEN_WRITE(value, 0, 32)
+#define WBRS232_LOST_COUNT_R(reg)             WBGEN2_GEN_READ(reg, 0, 32)
+
 PACKED struct WBRS232_WB {
   /* [0x0]: REG send data */
   uint32_t SEND;
@@ -88,6 +142,12 @@ PACKED struct WBRS232_WB {
   uint32_t STATUS;
   /* [0x10]: REG control */
   uint32_t CONTROL;
+  /* [0x14]: REG fifo level */
+  uint32_t LEVEL;
+  /* [0x18]: REG interrupt thresholds */
+  uint32_t THRESHOLD;
+  /* [0x1c]: REG receive lost */
+  uint32_t LOST;
 };
 
 #endif
@@ -0,0 +1,77 @@
+/*
+  C++ register access for slave core: Simple RS232 module
+
+  * File           : wb_rs232.hpp
+  * Author         : generated by wbgen_cpp.py from gen_rs232.wb
+  * Standard       : C++11
+
+    THIS FILE WAS GENERATED BY wbgen_cpp.py FROM SOURCE FILE gen_rs232.wb
+    DO NOT HAND-EDIT, see wb_regs.hpp for the use of the types
+
+*/
+
+#ifndef __WBGEN_CPP_GEN_RS232_WB
+#define __WBGEN_CPP_GEN_RS232_WB
+
+#include "wb_regs.hpp"
+
+namespace wbrs232 {
+
+  /* [0x0]: REG send data */
+  namespace send {
+    struct reg : wbregs::reg<0x0, wbregs::WO> {};
+    typedef wbregs::field<reg, 0, 8, wbregs::WO> data; // senddata
+  }
+
+  /* [0x4]: REG read data */
+  namespace read {
+    struct reg : wbregs::reg<0x4, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 8, wbregs::RO> data; // readdata
+  }
+
+  /* [0x8]: REG reading done */
+  namespace done {
+    struct reg : wbregs::reg<0x8, wbregs::WO> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::WO> done; // done
+  }
+
+  /* [0xc]: REG status */
+  namespace status {
+    struct reg : wbregs::reg<0xc, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 1, wbregs::RO> allowed; // sending allowed
+    typedef wbregs::field<reg, 1, 1, wbregs::RO> available; // data available
+    typedef wbregs::field<reg, 2, 1, wbregs::RO> txempty; // transmitter empty
+  }
+
+  /* [0x10]: REG control */
+  namespace control {
+    struct reg : wbregs::reg<0x10, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 3, wbregs::RW> baud; // baudrate
+    typedef wbregs::field<reg, 3, 1, wbregs::RW> txirq; // transmit interrupt enable
+    typedef wbregs::field<reg, 4, 1, wbregs::RW> rxirq; // receive interrupt enable
+  }
+
+  /* [0x14]: REG fifo level */
+  namespace level {
+    struct reg : wbregs::reg<0x14, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 16, wbregs::RO> tx; // transmit level
+    typedef wbregs::field<reg, 16, 16, wbregs::RO> rx; // receive level
+  }
+
+  /* [0x18]: REG interrupt thresholds */
+  namespace threshold {
+    struct reg : wbregs::reg<0x18, wbregs::RW> {};
+    typedef wbregs::field<reg, 0, 16, wbregs::RW> tx; // transmit threshold
+    typedef wbregs::field<reg, 16, 16, wbregs::RW> rx; // receive threshold
+  }
+
+  /* [0x1c]: REG receive lost */
+  namespace lost {
+    struct reg : wbregs::reg<0x1c, wbregs::RO> {};
+    typedef wbregs::field<reg, 0, 32, wbregs::RO> count; // lost
+  }
+
+  const uint32_t size = 0x20; // bytes
+}
+
+#endif
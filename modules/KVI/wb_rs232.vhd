@@ -3,7 +3,7 @@
 ---------------------------------------------------------------------------------------
 -- File           : wb_rs232.vhd
 -- Author         : auto-generated by wbgen2 from gen_rs232.wb
--- Created        : 09/10/12 11:45:39
+-- Created        : 10/25/12 10:12:31
 -- Standard       : VHDL'87
 ---------------------------------------------------------------------------------------
 -- THIS FILE WAS GENERATED BY wbgen2 FROM SOURCE FILE gen_rs232.wb
@@ -48,14 +48,34 @@ entity wb_rs232 is
     wbrs232_status_allowed_i                 : in     std_logic_vector(0 downto 0);
 -- Port for std_logic_vector field: 'data available' in reg: 'status'
     wbrs232_status_available_i               : in     std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'transmitter empty' in reg: 'status'
+    wbrs232_status_txempty_i                 : in     std_logic_vector(0 downto 0);
 -- Port for std_logic_vector field: 'baudrate' in reg: 'control'
-    wbrs232_control_baud_o                   : out    std_logic_vector(2 downto 0)
+    wbrs232_control_baud_o                   : out    std_logic_vector(2 downto 0);
+-- Port for std_logic_vector field: 'transmit interrupt enable' in reg: 'control'
+    wbrs232_control_txirq_o                  : out    std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'receive interrupt enable' in reg: 'control'
+    wbrs232_control_rxirq_o                  : out    std_logic_vector(0 downto 0);
+-- Port for std_logic_vector field: 'transmit level' in reg: 'fifo level'
+    wbrs232_level_tx_i                       : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'receive level' in reg: 'fifo level'
+    wbrs232_level_rx_i                       : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'transmit threshold' in reg: 'interrupt thresholds'
+    wbrs232_threshold_tx_o                   : out    std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'receive threshold' in reg: 'interrupt thresholds'
+    wbrs232_threshold_rx_o                   : out    std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'lost' in reg: 'receive lost'
+    wbrs232_lost_count_i                     : in     std_logic_vector(31 downto 0)
   );
 end wb_rs232;
 
 architecture syn of wb_rs232 is
 
 signal wbrs232_control_baud_int                 : std_logic_vector(2 downto 0);
+signal wbrs232_control_txirq_int                : std_logic_vector(0 downto 0);
+signal wbrs232_control_rxirq_int                : std_logic_vector(0 downto 0);
+signal wbrs232_threshold_tx_int                 : std_logic_vector(15 downto 0);
+signal wbrs232_threshold_rx_int                 : std_logic_vector(15 downto 0);
 signal ack_sreg                                 : std_logic_vector(9 downto 0);
 signal rddata_reg                               : std_logic_vector(31 downto 0);
 signal wrdata_reg                               : std_logic_vector(31 downto 0);
@@ -88,6 +108,10 @@ begin
       wbrs232_send_data_wr_o <= '0';
       wbrs232_done_done_wr_o <= '0';
       wbrs232_control_baud_int <= std_logic_vector(to_unsigned(0, 3));
+      wbrs232_control_txirq_int <= std_logic_vector(to_unsigned(0, 1));
+      wbrs232_control_rxirq_int <= std_logic_vector(to_unsigned(0, 1));
+      wbrs232_threshold_tx_int <= std_logic_vector(to_unsigned(0, 16));
+      wbrs232_threshold_rx_int <= std_logic_vector(to_unsigned(0, 16));
     elsif rising_edge(bus_clock_int) then
 -- advance the ACK generator shift register
       ack_sreg(8 downto 0) <= ack_sreg(9 downto 1);
@@ -215,7 +239,6 @@ begin
             ack_in_progress <= '1';
           when "011" => 
             if (wb_we_i = '1') then
-              rddata_reg(2) <= 'X';
               rddata_reg(3) <= 'X';
               rddata_reg(4) <= 'X';
               rddata_reg(5) <= 'X';
@@ -248,14 +271,15 @@ begin
             else
               rddata_reg(0 downto 0) <= wbrs232_status_allowed_i;
               rddata_reg(1 downto 1) <= wbrs232_status_available_i;
+              rddata_reg(2 downto 2) <= wbrs232_status_txempty_i;
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
           when "100" => 
             if (wb_we_i = '1') then
               wbrs232_control_baud_int <= wrdata_reg(2 downto 0);
-              rddata_reg(3) <= 'X';
-              rddata_reg(4) <= 'X';
+              wbrs232_control_txirq_int <= wrdata_reg(3 downto 3);
+              wbrs232_control_rxirq_int <= wrdata_reg(4 downto 4);
               rddata_reg(5) <= 'X';
               rddata_reg(6) <= 'X';
               rddata_reg(7) <= 'X';
@@ -285,6 +309,33 @@ begin
               rddata_reg(31) <= 'X';
             else
               rddata_reg(2 downto 0) <= wbrs232_control_baud_int;
+              rddata_reg(3 downto 3) <= wbrs232_control_txirq_int;
+              rddata_reg(4 downto 4) <= wbrs232_control_rxirq_int;
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "101" => 
+            if (wb_we_i = '1') then
+            else
+              rddata_reg(15 downto 0) <= wbrs232_level_tx_i;
+              rddata_reg(31 downto 16) <= wbrs232_level_rx_i;
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "110" => 
+            if (wb_we_i = '1') then
+              wbrs232_threshold_tx_int <= wrdata_reg(15 downto 0);
+              wbrs232_threshold_rx_int <= wrdata_reg(31 downto 16);
+            else
+              rddata_reg(15 downto 0) <= wbrs232_threshold_tx_int;
+              rddata_reg(31 downto 16) <= wbrs232_threshold_rx_int;
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "111" => 
+            if (wb_we_i = '1') then
+            else
+              rddata_reg(31 downto 0) <= wbrs232_lost_count_i;
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
@@ -310,8 +361,20 @@ begin
   wbrs232_done_done_o <= wrdata_reg(31 downto 0);
 -- sending allowed
 -- data available
+-- transmitter empty
 -- baudrate
   wbrs232_control_baud_o <= wbrs232_control_baud_int;
+-- transmit interrupt enable
+  wbrs232_control_txirq_o <= wbrs232_control_txirq_int;
+-- receive interrupt enable
+  wbrs232_control_rxirq_o <= wbrs232_control_rxirq_int;
+-- transmit level
+-- receive level
+-- transmit threshold
+  wbrs232_threshold_tx_o <= wbrs232_threshold_tx_int;
+-- receive threshold
+  wbrs232_threshold_rx_o <= wbrs232_threshold_rx_int;
+-- lost
   rwaddr_reg <= wb_addr_i;
 -- ACK signal generation. Just pass the LSB of ACK counter.
   wb_ack_o <= ack_sreg(0);
@@ -1 +1,2 @@
 lua "C:\Program Files\wishbone-gen\wbgen2" gen_rs232.wb -target pipelined -lang vhdl -vo wb_rs232.vhd -co wb_rs232.c -doco wb_rs232.html
+python wbgen_cpp.py gen_rs232.wb wb_rs232.hpp
@@ -0,0 +1,216 @@
+#!/usr/bin/env python
+# -----------------------------------------------------------------------------
+# Title      : wbgen2 to C++ register access generator
+# Project    : White Rabbit generator
+# -----------------------------------------------------------------------------
+# File       : wbgen_cpp.py
+# Author     : Peter Schakel
+# Company    : KVI
+# Created    : 2012-10-26
+# Last update: 2012-10-26
+# -----------------------------------------------------------------------------
+# Description:
+#
+# Reads a wbgen2 peripheral description (gen_*.wb) and writes a header-only
+# C++ file with the registers and fields as types (see wb_regs.hpp):
+#
+#   namespace wbpattern {
+#     namespace control {                 // [0x8]: REG Pattern control
+#       struct reg : wbregs::reg<0x8, wbregs::RW> {};
+#       typedef wbregs::field<reg, 0, 1, wbregs::RW> enable;
+#       ...
+#
+# Register addresses and field offsets are assigned the same way as wbgen2
+# does for the registers used in this project: registers are 32 bits wide and
+# placed one after another, fields are packed from bit 0 upwards and can be
+# aligned with "align". RAM and FIFO blocks are not supported.
+#
+# Usage: wbgen_cpp.py gen_PatternGenerator.wb wb_PatternGenerator.hpp
+#
+# -----------------------------------------------------------------------------
+# Copyright (c) 2012 KVI / Peter Schakel
+# -----------------------------------------------------------------------------
+
+import os
+import re
+import sys
+
+CPP_KEYWORDS = set("""and asm auto bool break case catch char class const continue default
+    delete do double else enum explicit extern false float for friend goto if inline int
+    long mutable namespace new not operator or private protected public register return
+    short signed sizeof static struct switch template this throw true try typedef typename
+    union unsigned using virtual void volatile while xor reg""".split())
+
+TOKEN_RE = re.compile(r'\s*(?:(--[^\n]*)|("(?:[^"\\]|\\.)*")|([A-Za-z_][A-Za-z0-9_]*)|(0x[0-9A-Fa-f]+|[0-9]+)|([{}=;,]))')
+
+
+class WbError(Exception):
+    pass
+
+
+def tokenize(text):
+    tokens = []
+    pos = 0
+    while True:
+        m = TOKEN_RE.match(text, pos)
+        if not m:
+            if text[pos:].strip():
+                line = text.count('\n', 0, pos) + 1
+                raise WbError("syntax error on line %d" % line)
+            break
+        pos = m.end()
+        comment, string, ident, number, punct = m.groups()
+        if comment is not None:
+            continue
+        if string is not None:
+            tokens.append(('str', string[1:-1]))
+        elif ident is not None:
+            tokens.append(('id', ident))
+        elif number is not None:
+            tokens.append(('num', int(number, 0)))
+        else:
+            tokens.append(('p', punct))
+    return tokens
+
+
+def parse_block(tokens, i):
+    """Parse the contents of a { } block, returns (dict, list of (kind, block), next index)."""
+    attrs = {}
+    children = []
+    while i < len(tokens):
+        kind, val = tokens[i]
+        if (kind, val) == ('p', '}'):
+            return attrs, children, i + 1
+        if kind == 'p':  # stray ; or ,
+            i += 1
+            continue
+        if kind != 'id':
+            raise WbError("unexpected %r" % (val,))
+        if tokens[i + 1] == ('p', '='):
+            attrs[val] = tokens[i + 2][1]
+            i += 3
+        elif tokens[i + 1] == ('p', '{'):
+            a, c, i = parse_block(tokens, i + 2)
+            children.append((val, a, c))
+        else:
+            raise WbError("expected = or { after %s" % val)
+    raise WbError("missing }")
+
+
+def parse_wb(text):
+    attrs, children, _ = parse_block(tokenize(text) + [('p', '}')], 0)
+    peripherals = [c for c in children if c[0] == 'peripheral']
+    if len(peripherals) != 1:
+        raise WbError("expected one peripheral")
+    return peripherals[0]
+
+
+def identifier(name):
+    ident = re.sub(r'[^A-Za-z0-9_]', '_', name.strip()).lower()
+    if ident[:1].isdigit():
+        ident = '_' + ident
+    if ident in CPP_KEYWORDS:
+        ident += '_'
+    return ident
+
+
+def field_access(attrs):
+    ftype = attrs.get('type', 'SLV')
+    if ftype in ('PASS_THROUGH', 'MONOSTABLE'):
+        return 'WO'
+    if ftype not in ('SLV', 'BIT', 'UNSIGNED', 'SIGNED'):
+        raise WbError("field type %s is not supported" % ftype)
+    return {'READ_WRITE': 'RW', 'READ_ONLY': 'RO', 'WRITE_ONLY': 'WO'}[attrs.get('access_bus', 'READ_WRITE')]
+
+
+def register_access(accesses):
+    if all(a == 'RO' for a in accesses):
+        return 'RO'
+    if all(a == 'WO' for a in accesses):
+        return 'WO'
+    return 'RW'
+
+
+def generate(wbname, outname, peripheral):
+    _, pattrs, pchildren = peripheral
+    namespace = identifier(pattrs['prefix'])
+    guard = '__WBGEN_CPP_' + re.sub(r'[^A-Za-z0-9]', '_', os.path.basename(wbname)).upper()
+    out = []
+    out.append('/*')
+    out.append('  C++ register access for slave core: %s' % pattrs['name'])
+    out.append('')
+    out.append('  * File           : %s' % os.path.basename(outname))
+    out.append('  * Author         : generated by wbgen_cpp.py from %s' % os.path.basename(wbname))
+    out.append('  * Standard       : C++11')
+    out.append('')
+    out.append('    THIS FILE WAS GENERATED BY wbgen_cpp.py FROM SOURCE FILE %s' % os.path.basename(wbname))
+    out.append('    DO NOT HAND-EDIT, see wb_regs.hpp for the use of the types')
+    out.append('')
+    out.append('*/')
+    out.append('')
+    out.append('#ifndef %s' % guard)
+    out.append('#define %s' % guard)
+    out.append('')
+    out.append('#include "wb_regs.hpp"')
+    out.append('')
+    out.append('namespace %s {' % namespace)
+    for kind, _, _ in pchildren:
+        if kind != 'reg':
+            raise WbError("%s blocks are not supported" % kind)
+    regnames = [identifier(r[1].get('prefix', r[1]['name'])) for r in pchildren]
+    address = 0
+    for index, (kind, rattrs, rchildren) in enumerate(pchildren):
+        regname = regnames[index]
+        if regnames.count(regname) > 1:  # same prefix used twice (wbgen2 accepts this): add the first field
+            ffirst = [f[1] for f in rchildren if f[0] == 'field'][0]
+            regname = identifier(regname + '_' + ffirst.get('prefix', ffirst['name']))
+        shift = 0
+        fields = []
+        for fkind, fattrs, _ in rchildren:
+            if fkind != 'field':
+                continue
+            size = fattrs.get('size', 1)
+            if size == 0:  # PASS_THROUGH of size 0: only a write strobe to the slave, no bits in the register
+                continue
+            align = fattrs.get('align', 1)
+            if shift % align:
+                shift += align - shift % align
+            if shift + size > 32:
+                raise WbError("register %s: field %s does not fit in 32 bits" % (regname, fattrs['name']))
+            fields.append((identifier(fattrs.get('prefix', fattrs['name'])), shift, size,
+                           field_access(fattrs), fattrs['name']))
+            shift += size
+        out.append('')
+        out.append('  /* [0x%x]: REG %s */' % (address, rattrs['name']))
+        out.append('  namespace %s {' % regname)
+        out.append('    struct reg : wbregs::reg<0x%x, wbregs::%s> {};' % (address, register_access([f[3] for f in fields])))
+        for fname, fshift, fsize, faccess, ftitle in fields:
+            out.append('    typedef wbregs::field<reg, %d, %d, wbregs::%s> %s; // %s' % (fshift, fsize, faccess, fname, ftitle))
+        out.append('  }')
+        address += 4
+    out.append('')
+    out.append('  const uint32_t size = 0x%x; // bytes' % address)
+    out.append('}')
+    out.append('')
+    out.append('#endif')
+    return '\n'.join(out) + '\n'
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write("Usage: %s <gen_*.wb> <output.hpp>\n" % argv[0])
+        return 1
+    try:
+        with open(argv[1]) as f:
+            peripheral = parse_wb(f.read())
+        text = generate(argv[1], argv[2], peripheral)
+    except (WbError, KeyError, IndexError) as e:
+        sys.stderr.write("%s: %s: %s\n" % (argv[0], argv[1], e))
+        return 1
+    with open(argv[2], 'w') as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -16,6 +16,8 @@ modules =  { "local" :
 						"wb_xilinx_fpga_loader",
 						"wb_clock_crossing",
 						"wb_dma",
+						"wb_bus_monitor",
+						"wb_pc_sampler",
 						"wbgen2"
 						 ]};
 
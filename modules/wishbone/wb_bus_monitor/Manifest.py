@@ -0,0 +1 @@
+files = [ "xwb_bus_monitor.vhd" ];
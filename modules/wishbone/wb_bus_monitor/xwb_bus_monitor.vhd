@@ -0,0 +1,241 @@
+-------------------------------------------------------------------------------
+-- Title      : Wishbone bus performance monitor
+-- Project    : General Cores Library (gencores)
+-------------------------------------------------------------------------------
+-- File       : xwb_bus_monitor.vhd
+-- Platform   : FPGA-generic
+-- Standard   : VHDL'93
+-------------------------------------------------------------------------------
+-- Description:
+--
+-- Passive taps on master/slave pairs of a pipelined Wishbone bus: connect the
+-- signals the master drives to tap_master_i and the signals the slave returns
+-- to tap_slave_i. Nothing is driven on the tapped bus.
+--
+-- Per tap t, at t*0x40:
+--   0x00 cycles with CYC high          0x14 shortest latency
+--   0x04 strobes accepted              0x18 longest latency
+--   0x08 acknowledges                  0x1C sum of the latencies
+--   0x0C cycles stalled (STB and STALL) 0x20 writes accepted
+--   0x10 errors and retries
+--   The latency is the number of cycles from the accepted strobe to its
+--   ACK/ERR/RTY. The sum is the accesses in flight counted every cycle, the
+--   average latency is the sum divided by acknowledges plus errors.
+--   Shortest and longest latency are measured while at most 2**g_fifo_log2
+--   accesses are in flight, the shortest is 0xFFFF before the first access.
+-- Global, at 0x3C0:
+--   0x3C0 control: write bit0 clears all counters, bit1 freezes them
+--   0x3C4 clock cycles counted         0x3C8 number of taps
+-- The counters stop at their maximum value.
+-------------------------------------------------------------------------------
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+use work.wishbone_pkg.all;
+
+entity xwb_bus_monitor is
+  generic(
+    g_taps      : natural := 1; -- at most 15
+    g_fifo_log2 : natural := 4);
+  port(
+    clk_sys_i    : in  std_logic;
+    rst_n_i      : in  std_logic;
+    -- Tapped busses
+    tap_master_i : in  t_wishbone_master_out_array(g_taps-1 downto 0);
+    tap_slave_i  : in  t_wishbone_master_in_array(g_taps-1 downto 0);
+    -- Read out of the counters
+    slave_i      : in  t_wishbone_slave_in;
+    slave_o      : out t_wishbone_slave_out);
+end xwb_bus_monitor;
+
+architecture rtl of xwb_bus_monitor is
+  type t_counter_array is array (natural range <>) of unsigned(31 downto 0);
+  type t_latency_array is array (natural range <>) of unsigned(15 downto 0);
+  
+  signal r_busy    : t_counter_array(g_taps-1 downto 0);
+  signal r_strobes : t_counter_array(g_taps-1 downto 0);
+  signal r_acks    : t_counter_array(g_taps-1 downto 0);
+  signal r_stalled : t_counter_array(g_taps-1 downto 0);
+  signal r_errors  : t_counter_array(g_taps-1 downto 0);
+  signal r_minlat  : t_latency_array(g_taps-1 downto 0);
+  signal r_maxlat  : t_latency_array(g_taps-1 downto 0);
+  signal r_sumlat  : t_counter_array(g_taps-1 downto 0);
+  signal r_writes  : t_counter_array(g_taps-1 downto 0);
+  signal r_cycles  : unsigned(31 downto 0);
+  signal r_time    : unsigned(15 downto 0); -- time stamps of the accepted strobes
+  signal r_freeze  : std_logic;
+  signal s_clear   : std_logic;
+  signal r_ack     : std_logic;
+  signal r_dat     : t_wishbone_data;
+  
+  function f_inc(x : unsigned) return unsigned is
+    constant c_max : unsigned(x'range) := (others => '1');
+  begin
+    if x = c_max then
+      return x;
+    else
+      return x + 1;
+    end if;
+  end f_inc;
+  
+  function f_add(x : unsigned(31 downto 0); y : unsigned) return unsigned is
+    variable sum : unsigned(32 downto 0);
+  begin
+    sum := ('0' & x) + y;
+    if sum(32) = '1' then
+      return (31 downto 0 => '1');
+    else
+      return sum(31 downto 0);
+    end if;
+  end f_add;
+begin
+  slave_o.ACK   <= r_ack;
+  slave_o.ERR   <= '0';
+  slave_o.RTY   <= '0';
+  slave_o.STALL <= '0';
+  slave_o.INT   <= '0';
+  slave_o.DAT   <= r_dat;
+  
+  s_clear <= slave_i.CYC and slave_i.STB and slave_i.WE and slave_i.DAT(0)
+             when slave_i.ADR(9 downto 2) = x"F0" else '0';
+  
+  taps : for t in g_taps-1 downto 0 generate
+    tap : block
+      type t_fifo is array (2**g_fifo_log2-1 downto 0) of unsigned(15 downto 0);
+      signal fifo      : t_fifo;
+      signal r_wr      : unsigned(g_fifo_log2 downto 0);
+      signal r_rd      : unsigned(g_fifo_log2 downto 0);
+      signal r_flight  : unsigned(15 downto 0);
+      signal r_lost    : std_logic; -- more accesses in flight than the fifo holds
+    begin
+      count : process(clk_sys_i)
+        variable accepted, done : boolean;
+        variable latency : unsigned(15 downto 0);
+      begin
+        if rising_edge(clk_sys_i) then
+          accepted := tap_master_i(t).CYC = '1' and tap_master_i(t).STB = '1' and tap_slave_i(t).STALL = '0';
+          done     := tap_master_i(t).CYC = '1' and 
+                      (tap_slave_i(t).ACK = '1' or tap_slave_i(t).ERR = '1' or tap_slave_i(t).RTY = '1');
+          
+          -- Accesses in flight, the time stamps of the accepted strobes
+          if rst_n_i = '0' or tap_master_i(t).CYC = '0' then
+            r_wr     <= (others => '0');
+            r_rd     <= (others => '0');
+            r_flight <= (others => '0');
+            r_lost   <= '0';
+          else
+            if accepted and not done then
+              r_flight <= r_flight + 1;
+            elsif done and not accepted and r_flight /= 0 then
+              r_flight <= r_flight - 1;
+            end if;
+            if accepted then
+              if r_wr - r_rd = 2**g_fifo_log2 then
+                r_lost <= '1';
+              else
+                fifo(to_integer(r_wr(g_fifo_log2-1 downto 0))) <= r_time;
+                r_wr <= r_wr + 1;
+              end if;
+            end if;
+            if done and r_wr /= r_rd then
+              r_rd <= r_rd + 1;
+            end if;
+          end if;
+          
+          if rst_n_i = '0' or s_clear = '1' then
+            r_busy(t)    <= (others => '0');
+            r_strobes(t) <= (others => '0');
+            r_acks(t)    <= (others => '0');
+            r_stalled(t) <= (others => '0');
+            r_errors(t)  <= (others => '0');
+            r_minlat(t)  <= (others => '1');
+            r_maxlat(t)  <= (others => '0');
+            r_sumlat(t)  <= (others => '0');
+            r_writes(t)  <= (others => '0');
+          elsif r_freeze = '0' then
+            if tap_master_i(t).CYC = '1' then
+              r_busy(t) <= f_inc(r_busy(t));
+            end if;
+            if accepted then
+              r_strobes(t) <= f_inc(r_strobes(t));
+              if tap_master_i(t).WE = '1' then
+                r_writes(t) <= f_inc(r_writes(t));
+              end if;
+            end if;
+            if tap_master_i(t).CYC = '1' and tap_master_i(t).STB = '1' and tap_slave_i(t).STALL = '1' then
+              r_stalled(t) <= f_inc(r_stalled(t));
+            end if;
+            if tap_master_i(t).CYC = '1' and tap_slave_i(t).ACK = '1' then
+              r_acks(t) <= f_inc(r_acks(t));
+            end if;
+            if tap_master_i(t).CYC = '1' and (tap_slave_i(t).ERR = '1' or tap_slave_i(t).RTY = '1') then
+              r_errors(t) <= f_inc(r_errors(t));
+            end if;
+            r_sumlat(t) <= f_add(r_sumlat(t), r_flight);
+            if done and r_wr /= r_rd and r_lost = '0' then
+              latency := r_time - fifo(to_integer(r_rd(g_fifo_log2-1 downto 0)));
+              if latency < r_minlat(t) then
+                r_minlat(t) <= latency;
+              end if;
+              if latency > r_maxlat(t) then
+                r_maxlat(t) <= latency;
+              end if;
+            end if;
+          end if;
+        end if;
+      end process count;
+    end block tap;
+  end generate;
+  
+  control : process(clk_sys_i)
+    variable tap, reg : integer;
+  begin
+    if rising_edge(clk_sys_i) then
+      if rst_n_i = '0' then
+        r_freeze <= '0';
+        r_ack    <= '0';
+        r_time   <= (others => '0');
+        r_cycles <= (others => '0');
+      else
+        r_time <= r_time + 1;
+        if s_clear = '1' then
+          r_cycles <= (others => '0');
+        elsif r_freeze = '0' then
+          r_cycles <= f_inc(r_cycles);
+        end if;
+        if slave_i.CYC = '1' and slave_i.STB = '1' and slave_i.WE = '1' and 
+           slave_i.ADR(9 downto 2) = x"F0" then
+          r_freeze <= slave_i.DAT(1);
+        end if;
+        r_ack <= slave_i.CYC and slave_i.STB;
+      end if;
+      
+      -- Registered read
+      tap   := to_integer(unsigned(slave_i.ADR(9 downto 6)));
+      reg   := to_integer(unsigned(slave_i.ADR(5 downto 2)));
+      r_dat <= (others => '0');
+      if tap < g_taps then
+        case reg is
+          when 0 => r_dat <= std_logic_vector(r_busy(tap));
+          when 1 => r_dat <= std_logic_vector(r_strobes(tap));
+          when 2 => r_dat <= std_logic_vector(r_acks(tap));
+          when 3 => r_dat <= std_logic_vector(r_stalled(tap));
+          when 4 => r_dat <= std_logic_vector(r_errors(tap));
+          when 5 => r_dat(15 downto 0) <= std_logic_vector(r_minlat(tap));
+          when 6 => r_dat(15 downto 0) <= std_logic_vector(r_maxlat(tap));
+          when 7 => r_dat <= std_logic_vector(r_sumlat(tap));
+          when 8 => r_dat <= std_logic_vector(r_writes(tap));
+          when others => null;
+        end case;
+      elsif tap = 15 then
+        case reg is
+          when 0 => r_dat(1) <= r_freeze;
+          when 1 => r_dat <= std_logic_vector(r_cycles);
+          when 2 => r_dat <= std_logic_vector(to_unsigned(g_taps, 32));
+          when others => null;
+        end case;
+      end if;
+    end if;
+  end process control;
+end rtl;
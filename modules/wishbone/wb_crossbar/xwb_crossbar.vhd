@@ -23,6 +23,28 @@
 -- 
 -- The implementation of this crossbar locks a master to a slave so long as
 -- CYC_O is held high. 
+--
+-- Quality of service:
+--   Masters with their bit set in g_qos_realtime win the arbitration over the
+--   other masters (the lowest numbered real-time master first).
+--   Masters with their bit set in g_qos_preempt give up their slave when a
+--   real-time master requests it: their strobes are stalled until all their
+--   accesses are acknowledged, then the slave is granted to the real-time
+--   master. The preempted master keeps CYC high and continues later, so only
+--   masters that do not need atomic cycles (like a DMA engine) may be preempted.
+--   The wait of a real-time master is bounded by the accesses in flight.
+--
+-- Statistics (g_stats = true), on the slave port stats_i/stats_o:
+--   Per master m, at m*0x40:
+--     0x00 cycles with CYC high        0x08 cycles stalled (STB and STALL)
+--     0x04 words (STB accepted)        0x0C longest wait of an access
+--     0x10..0x2C latency histogram: accesses that waited 0, 1, 2-3, 4-7, 8-15,
+--                16-31, 32-63, 64 or more cycles before STB was accepted
+--   Global, at 0x3C0:
+--     0x3C0 control: write bit0 clears all counters, bit1 freezes them
+--     0x3C4 clock cycles counted       0x3C8 number of masters
+--     0x3CC g_qos_realtime             0x3D0 g_qos_preempt
+--   The counters stop at their maximum value.
 -- 
 -- Synthesis/timing relevant facts:
 --   (m)asters, (s)laves, masked (a)ddress bits
@@ -57,7 +79,11 @@ entity xwb_crossbar is
     g_registered  : boolean := false;
     -- Address of the slaves connected
     g_address     : t_wishbone_address_array;
-    g_mask        : t_wishbone_address_array);
+    g_mask        : t_wishbone_address_array;
+    -- Quality of service, bit m is master m
+    g_qos_realtime : std_logic_vector(31 downto 0) := (others => '0');
+    g_qos_preempt  : std_logic_vector(31 downto 0) := (others => '0');
+    g_stats        : boolean := false);
   port(
     clk_sys_i     : in  std_logic;
     rst_n_i       : in  std_logic;
@@ -66,7 +92,10 @@ entity xwb_crossbar is
     slave_o       : out t_wishbone_slave_out_array(g_num_masters-1 downto 0);
     -- Slave connections (INTERCON is a master)
     master_i      : in  t_wishbone_master_in_array(g_num_slaves-1 downto 0);
-    master_o      : out t_wishbone_master_out_array(g_num_slaves-1 downto 0));
+    master_o      : out t_wishbone_master_out_array(g_num_slaves-1 downto 0);
+    -- Statistics
+    stats_i       : in  t_wishbone_slave_in := cc_dummy_slave_in;
+    stats_o       : out t_wishbone_slave_out);
 end xwb_crossbar;
 
 architecture rtl of xwb_crossbar is
@@ -100,6 +129,9 @@ architecture rtl of xwb_crossbar is
   end f_ranges_ok;
   constant c_ok : boolean := f_ranges_ok;
 
+  constant c_realtime : std_logic_vector(g_num_masters-1 downto 0) := g_qos_realtime(g_num_masters-1 downto 0);
+  constant c_preempt  : std_logic_vector(g_num_masters-1 downto 0) := g_qos_preempt(g_num_masters-1 downto 0);
+
   -- Crossbar connection matrix
   type matrix is array (g_num_masters-1 downto 0, g_num_slaves downto 0) of std_logic;
   
@@ -114,6 +146,14 @@ architecture rtl of xwb_crossbar is
   -- Either matrix_old or matrix_new, depending on g_registered
   signal granted : matrix;
   
+  -- Preemption: drain the accesses in flight, then yield the slave
+  type t_inflight_array is array (g_num_masters-1 downto 0) of unsigned(7 downto 0);
+  signal slave_oe  : t_wishbone_slave_out_array(g_num_masters-1 downto 0);
+  signal inflight  : t_inflight_array;
+  signal drain_new : std_logic_vector(g_num_masters-1 downto 0);
+  signal drain     : std_logic_vector(g_num_masters-1 downto 0);
+  signal yield     : std_logic_vector(g_num_masters-1 downto 0);
+  
   -- If any of the bits are '1', the whole thing is '1'
   -- This function makes the check explicitly have logarithmic depth.
   function vector_OR(x : std_logic_vector)
@@ -176,18 +216,44 @@ architecture rtl of xwb_crossbar is
     return output;
   end ks_OR;
   
+  -- Impure because it accesses c_{address, mask}
+  function request_logic(
+    slave_i    : t_wishbone_slave_in_array(g_num_masters-1 downto 0))
+    return matrix
+  is
+    subtype column is std_logic_vector(g_num_slaves    downto 0);
+    
+    variable tmp        : std_logic;
+    variable tmp_column : column;
+    variable request    : matrix;
+  begin
+    -- Decode the request address to see if master wants access
+    for master in g_num_masters-1 downto 0 loop
+      for slave in g_num_slaves-1 downto 0 loop
+        tmp := not vector_OR((slave_i(master).ADR and c_mask(slave)) xor c_address(slave));
+        tmp_column(slave) := tmp;
+        request(master, slave) := slave_i(master).CYC and slave_i(master).STB and tmp;
+      end loop;
+      tmp_column(g_num_slaves) := '0';
+      -- If no slaves match request, bind to 'error device'
+      request(master, g_num_slaves) := slave_i(master).CYC and slave_i(master).STB and not vector_OR(tmp_column);
+    end loop;
+    return request;
+  end request_logic;
+  
   -- Impure because it accesses c_{address, mask}
   function matrix_logic(
     matrix_old : matrix;
-    slave_i    : t_wishbone_slave_in_array(g_num_masters-1 downto 0))
+    slave_i    : t_wishbone_slave_in_array(g_num_masters-1 downto 0);
+    yield      : std_logic_vector(g_num_masters-1 downto 0))
     return matrix
   is
     subtype row    is std_logic_vector(g_num_masters-1 downto 0);
     subtype column is std_logic_vector(g_num_slaves    downto 0);
     
-    variable tmp        : std_logic;
     variable tmp_column : column;
     variable tmp_row    : row;
+    variable eligible   : row;
     
     variable request    : matrix;  -- Which slaves do the masters address log(S) 
     variable selected   : matrix;  -- Which master wins arbitration  log(M) request
@@ -196,9 +262,10 @@ architecture rtl of xwb_crossbar is
     variable matrix_new : matrix;
   begin
     -- A slave is busy iff it services an in-progress cycle
+    -- A preempted master that yields does not keep its slave
     for slave in g_num_slaves downto 0 loop
       for master in g_num_masters-1 downto 0 loop
-        tmp_row(master) := matrix_old(master, slave) and slave_i(master).CYC;
+        tmp_row(master) := matrix_old(master, slave) and slave_i(master).CYC and not yield(master);
       end loop;
       sbusy(slave) := vector_OR(tmp_row);
     end loop;
@@ -208,36 +275,30 @@ architecture rtl of xwb_crossbar is
       for slave in g_num_slaves downto 0 loop
         tmp_column(slave) := matrix_old(master, slave);
       end loop;
-      mbusy(master) := vector_OR(tmp_column) and slave_i(master).CYC;
+      mbusy(master) := vector_OR(tmp_column) and slave_i(master).CYC and not yield(master);
     end loop;
 
-    -- Decode the request address to see if master wants access
-    for master in g_num_masters-1 downto 0 loop
-      for slave in g_num_slaves-1 downto 0 loop
-        tmp := not vector_OR((slave_i(master).ADR and c_mask(slave)) xor c_address(slave));
-        tmp_column(slave) := tmp;
-        request(master, slave) := slave_i(master).CYC and slave_i(master).STB and tmp;
-      end loop;
-      tmp_column(g_num_slaves) := '0';
-      -- If no slaves match request, bind to 'error device'
-      request(master, g_num_slaves) := slave_i(master).CYC and slave_i(master).STB and not vector_OR(tmp_column);
-    end loop;
+    request := request_logic(slave_i);
 
     -- Arbitrate among the requesting masters
-    -- Policy: lowest numbered master first
+    -- Policy: real-time masters first, then lowest numbered master first
     for slave in g_num_slaves downto 0 loop
-      -- OR together all the requests by higher priority masters
       for master in 0 to g_num_masters-1 loop
-        tmp_row(master) := request(master, slave);
+        tmp_row(master) := request(master, slave) and c_realtime(master);
+      end loop;
+      for master in 0 to g_num_masters-1 loop
+        eligible(master) := request(master, slave) and (c_realtime(master) or not vector_OR(tmp_row));
       end loop;
-      tmp_row := ks_OR(tmp_row);
+      
+      -- OR together all the requests by higher priority masters
+      tmp_row := ks_OR(eligible);
       
       -- Grant to highest priority master
-      selected(0, slave) := request(0, slave); -- master 0 always wins
+      selected(0, slave) := eligible(0); -- master 0 always wins
       if g_num_masters > 1 then
         for master in 1 to g_num_masters-1 loop
           selected(master, slave) := -- only if requested and no lower requests
-            not tmp_row(master-1) and request(master, slave);
+            not tmp_row(master-1) and eligible(master);
         end loop;
       end if;
     end loop;
@@ -256,11 +317,43 @@ architecture rtl of xwb_crossbar is
     
     return matrix_new;
   end matrix_logic;
+  
+  -- A preemptible master drains when a real-time master requests its slave
+  function drain_logic(
+    matrix_old : matrix;
+    slave_i    : t_wishbone_slave_in_array(g_num_masters-1 downto 0))
+    return std_logic_vector
+  is
+    subtype row    is std_logic_vector(g_num_masters-1 downto 0);
+    subtype column is std_logic_vector(g_num_slaves    downto 0);
+    
+    variable request    : matrix;
+    variable tmp_row    : row;
+    variable tmp_column : column;
+    variable rt_request : column; -- a real-time master waits for the slave
+    variable result     : row;
+  begin
+    request := request_logic(slave_i);
+    for slave in g_num_slaves downto 0 loop
+      for master in g_num_masters-1 downto 0 loop
+        tmp_row(master) := request(master, slave) and c_realtime(master) and not matrix_old(master, slave);
+      end loop;
+      rt_request(slave) := vector_OR(tmp_row);
+    end loop;
+    for master in g_num_masters-1 downto 0 loop
+      for slave in g_num_slaves downto 0 loop
+        tmp_column(slave) := matrix_old(master, slave) and rt_request(slave);
+      end loop;
+      result(master) := c_preempt(master) and slave_i(master).CYC and vector_OR(tmp_column);
+    end loop;
+    return result;
+  end drain_logic;
 
   -- Select the master pins the slave will receive
   function slave_logic(slave   : integer;
                        granted : matrix;
-                       slave_i : t_wishbone_slave_in_array(g_num_masters-1 downto 0))
+                       slave_i : t_wishbone_slave_in_array(g_num_masters-1 downto 0);
+                       drain   : std_logic_vector(g_num_masters-1 downto 0))
     return t_wishbone_master_out
   is
     subtype row is std_logic_vector(g_num_masters-1 downto 0);
@@ -286,7 +379,7 @@ architecture rtl of xwb_crossbar is
     -- Rename all the signals ready for big_or
     for master in g_num_masters-1 downto 0 loop
       CYC_row(master) := slave_i(master).CYC and granted(master, slave);
-      STB_row(master) := slave_i(master).STB and granted(master, slave);
+      STB_row(master) := slave_i(master).STB and granted(master, slave) and not drain(master);
       for bit in c_wishbone_address_width-1 downto 0 loop
         ADR_matrix(bit)(master) := slave_i(master).ADR(bit) and granted(master, slave);
       end loop;
@@ -311,7 +404,8 @@ architecture rtl of xwb_crossbar is
   -- Select the slave pins the master will receive
   function master_logic(master    : integer;
                         granted   : matrix;
-                        master_ie : t_wishbone_master_in_array(g_num_slaves downto 0))
+                        master_ie : t_wishbone_master_in_array(g_num_slaves downto 0);
+                        drain     : std_logic)
     return t_wishbone_slave_out
   is
     subtype row is std_logic_vector(g_num_slaves downto 0);
@@ -348,7 +442,7 @@ architecture rtl of xwb_crossbar is
       ACK => vector_OR(ACK_row),
       ERR => vector_OR(ERR_row),
       RTY => vector_OR(RTY_row),
-      STALL => not vector_OR(STALL_row),
+      STALL => not vector_OR(STALL_row) or drain,
       DAT => matrix_OR(DAT_matrix),
       INT => '0');
   end master_logic;
@@ -372,28 +466,191 @@ begin
   end process virtual_error_slave;
   
   -- Copy the matrix to a register:
-  matrix_new <= matrix_logic(matrix_old, slave_i);
+  matrix_new <= matrix_logic(matrix_old, slave_i, yield);
+  drain_new  <= drain_logic(matrix_old, slave_i);
   main : process(clk_sys_i)
   begin
     if rising_edge(clk_sys_i) then
       if rst_n_i = '0' then
         matrix_old <= (others => (others => '0'));
+        drain      <= (others => '0');
       else
         matrix_old <= matrix_new;
+        drain      <= drain_new;
       end if;
     end if;
   end process main;
   
+  -- Count the accesses in flight of every master, a draining master yields at zero
+  inflight_count : process(clk_sys_i)
+    variable accepted, done : boolean;
+  begin
+    if rising_edge(clk_sys_i) then
+      for master in g_num_masters-1 downto 0 loop
+        accepted := slave_i(master).CYC = '1' and slave_i(master).STB = '1' and slave_oe(master).STALL = '0';
+        done     := slave_oe(master).ACK = '1' or slave_oe(master).ERR = '1' or slave_oe(master).RTY = '1';
+        if rst_n_i = '0' or slave_i(master).CYC = '0' then
+          inflight(master) <= (others => '0');
+        elsif accepted and not done then
+          inflight(master) <= inflight(master) + 1;
+        elsif done and not accepted then
+          inflight(master) <= inflight(master) - 1;
+        end if;
+      end loop;
+    end if;
+  end process inflight_count;
+  
+  yield_logic : for master in g_num_masters-1 downto 0 generate
+    yield(master) <= drain(master) when inflight(master) = 0 else '0';
+  end generate;
+  
   -- Is the crossbar combinatorial or registered
   granted <= matrix_old when g_registered else matrix_new;
 
   -- Make the slave connections
   slave_matrix : for slave in g_num_slaves downto 0 generate
-    master_oe(slave) <= slave_logic(slave, granted, slave_i);
+    master_oe(slave) <= slave_logic(slave, granted, slave_i, drain);
   end generate;
 
   -- Make the master connections
   master_matrix : for master in g_num_masters-1 downto 0 generate
-    slave_o(master) <= master_logic(master, granted, master_ie);
+    slave_oe(master) <= master_logic(master, granted, master_ie, drain(master));
+  end generate;
+  slave_o <= slave_oe;
+  
+  stats_on : if g_stats generate
+    stats : block
+      type t_counter_array is array (natural range <>) of unsigned(31 downto 0);
+      type t_wait_array is array (natural range <>) of unsigned(15 downto 0);
+      signal r_busy    : t_counter_array(g_num_masters-1 downto 0);
+      signal r_words   : t_counter_array(g_num_masters-1 downto 0);
+      signal r_stalled : t_counter_array(g_num_masters-1 downto 0);
+      signal r_hist    : t_counter_array(8*g_num_masters-1 downto 0);
+      signal r_wait    : t_wait_array(g_num_masters-1 downto 0); -- of the access on the bus
+      signal r_maxwait : t_wait_array(g_num_masters-1 downto 0);
+      signal r_cycles  : unsigned(31 downto 0);
+      signal r_freeze  : std_logic;
+      signal r_ack     : std_logic;
+      signal r_dat     : t_wishbone_data;
+      
+      function f_inc(x : unsigned) return unsigned is
+        constant c_max : unsigned(x'range) := (others => '1');
+      begin
+        if x = c_max then
+          return x;
+        else
+          return x + 1;
+        end if;
+      end f_inc;
+      
+      -- 0, 1, 2-3, 4-7, 8-15, 16-31, 32-63, 64+
+      function f_bin(x : unsigned(15 downto 0)) return integer is
+      begin
+        for i in 15 downto 6 loop
+          if x(i) = '1' then
+            return 7;
+          end if;
+        end loop;
+        for i in 5 downto 0 loop
+          if x(i) = '1' then
+            return i+1;
+          end if;
+        end loop;
+        return 0;
+      end f_bin;
+    begin
+      stats_o.ACK   <= r_ack;
+      stats_o.ERR   <= '0';
+      stats_o.RTY   <= '0';
+      stats_o.STALL <= '0';
+      stats_o.INT   <= '0';
+      stats_o.DAT   <= r_dat;
+      
+      count : process(clk_sys_i)
+        variable master, reg : integer;
+        variable clear       : boolean;
+      begin
+        if rising_edge(clk_sys_i) then
+          clear := stats_i.CYC = '1' and stats_i.STB = '1' and stats_i.WE = '1' and
+                   stats_i.ADR(9 downto 2) = x"F0" and stats_i.DAT(0) = '1';
+          if rst_n_i = '0' or clear then
+            r_busy    <= (others => (others => '0'));
+            r_words   <= (others => (others => '0'));
+            r_stalled <= (others => (others => '0'));
+            r_hist    <= (others => (others => '0'));
+            r_wait    <= (others => (others => '0'));
+            r_maxwait <= (others => (others => '0'));
+            r_cycles  <= (others => '0');
+          elsif r_freeze = '0' then
+            r_cycles <= f_inc(r_cycles);
+            for m in g_num_masters-1 downto 0 loop
+              if slave_i(m).CYC = '1' then
+                r_busy(m) <= f_inc(r_busy(m));
+              end if;
+              if slave_i(m).CYC = '1' and slave_i(m).STB = '1' then
+                if slave_oe(m).STALL = '1' then
+                  r_stalled(m) <= f_inc(r_stalled(m));
+                  r_wait(m)    <= f_inc(r_wait(m));
+                else
+                  r_words(m)   <= f_inc(r_words(m));
+                  r_hist(8*m + f_bin(r_wait(m))) <= f_inc(r_hist(8*m + f_bin(r_wait(m))));
+                  if r_wait(m) > r_maxwait(m) then
+                    r_maxwait(m) <= r_wait(m);
+                  end if;
+                  r_wait(m)    <= (others => '0');
+                end if;
+              end if;
+            end loop;
+          end if;
+          
+          if rst_n_i = '0' then
+            r_freeze <= '0';
+            r_ack    <= '0';
+          else
+            if stats_i.CYC = '1' and stats_i.STB = '1' and stats_i.WE = '1' and
+               stats_i.ADR(9 downto 2) = x"F0" then
+              r_freeze <= stats_i.DAT(1);
+            end if;
+            r_ack <= stats_i.CYC and stats_i.STB;
+          end if;
+          
+          -- Registered read
+          master := to_integer(unsigned(stats_i.ADR(9 downto 6)));
+          reg    := to_integer(unsigned(stats_i.ADR(5 downto 2)));
+          r_dat  <= (others => '0');
+          if master < g_num_masters then
+            case reg is
+              when 0 => r_dat <= std_logic_vector(r_busy(master));
+              when 1 => r_dat <= std_logic_vector(r_words(master));
+              when 2 => r_dat <= std_logic_vector(r_stalled(master));
+              when 3 => r_dat(15 downto 0) <= std_logic_vector(r_maxwait(master));
+              when 4 to 11 => r_dat <= std_logic_vector(r_hist(8*master + reg - 4));
+              when others => null;
+            end case;
+          elsif master = 15 then
+            case reg is
+              when 0 => r_dat(1) <= r_freeze;
+              when 1 => r_dat <= std_logic_vector(r_cycles);
+              when 2 => r_dat <= std_logic_vector(to_unsigned(g_num_masters, 32));
+              when 3 => r_dat <= g_qos_realtime;
+              when 4 => r_dat <= g_qos_preempt;
+              when others => null;
+            end case;
+          end if;
+        end if;
+      end process count;
+    end block stats;
+  end generate;
+  
+  stats_off : if not g_stats generate
+    signal r_ack : std_logic;
+  begin
+    stats_o <= (ACK => r_ack, ERR => '0', RTY => '0', STALL => '0', INT => '0', DAT => (others => '0'));
+    ack : process(clk_sys_i)
+    begin
+      if rising_edge(clk_sys_i) then
+        r_ack <= stats_i.CYC and stats_i.STB and rst_n_i;
+      end if;
+    end process;
   end generate;
 end rtl;
@@ -10,7 +10,11 @@ entity xwb_sdb_crossbar is
     g_registered  : boolean := false;
     g_wraparound  : boolean := true;
     g_layout      : t_sdb_record_array;
-    g_sdb_addr    : t_wishbone_address);
+    g_sdb_addr    : t_wishbone_address;
+    -- Quality of service and statistics, see xwb_crossbar
+    g_qos_realtime : std_logic_vector(31 downto 0) := (others => '0');
+    g_qos_preempt  : std_logic_vector(31 downto 0) := (others => '0');
+    g_stats        : boolean := false);
   port(
     clk_sys_i     : in  std_logic;
     rst_n_i       : in  std_logic;
@@ -19,7 +23,10 @@ entity xwb_sdb_crossbar is
     slave_o       : out t_wishbone_slave_out_array(g_num_masters-1 downto 0);
     -- Slave connections (INTERCON is a master)
     master_i      : in  t_wishbone_master_in_array(g_num_slaves-1 downto 0);
-    master_o      : out t_wishbone_master_out_array(g_num_slaves-1 downto 0));
+    master_o      : out t_wishbone_master_out_array(g_num_slaves-1 downto 0);
+    -- Statistics
+    stats_i       : in  t_wishbone_slave_in := cc_dummy_slave_in;
+    stats_o       : out t_wishbone_slave_out);
 end xwb_sdb_crossbar;
 
 architecture rtl of xwb_sdb_crossbar is
@@ -157,12 +164,17 @@ begin
       g_num_slaves  => g_num_slaves + 1,
       g_registered  => g_registered,
       g_address     => c_address,
-      g_mask        => c_mask)
+      g_mask        => c_mask,
+      g_qos_realtime => g_qos_realtime,
+      g_qos_preempt  => g_qos_preempt,
+      g_stats        => g_stats)
     port map(
       clk_sys_i     => clk_sys_i,
       rst_n_i       => rst_n_i,
       slave_i       => slave_i, 
       slave_o       => slave_o, 
       master_i      => master_i_1, 
-      master_o      => master_o_1);
+      master_o      => master_o_1,
+      stats_i       => stats_i,
+      stats_o       => stats_o);
 end rtl;
@@ -4,6 +4,13 @@
 -- 0x08 = read stride
 -- 0x0C = write stride
 -- 0x10 = transfer count
+-- 0x14 = descriptor address
+-- 0x18 = descriptor control/status
+--          write: bit0 start the chain at the descriptor address, bit1 stop after the current descriptor
+--          read:  bit0 chain running, bit1 stop requested, bit2 bus error, bit3 copy busy,
+--                 bits 15..8 logRingLen
+-- 0x1C = descriptors completed
+-- 0x20 = mode: 0 words, 1 pack bytes, 2 unpack bytes
 --
 -- Behaviour:
 --   While (transfer count > 0) {
@@ -13,6 +20,17 @@
 --   }
 --   interrupt = (transfer_count == 0) && (transfer_count_was == 1)
 --
+-- Addressing:
+--   Each side has its own stride: 4 increments through memory, 0 stays on one address (a FIFO
+--   register), other values skip words.
+--
+-- Byte packing, for FIFOs that take or give one byte per access in bits 7..0:
+--   mode 1 (pack):   every read gives one byte, four bytes are written as one word.
+--                    The transfer count is in reads and must be a multiple of 4.
+--   mode 2 (unpack): every word read is written as four bytes.
+--   The first byte is bits 31..24 of the word, the order of the bytes in memory (big-endian).
+--   Packing needs logRingLen >= 2. Change the mode only while no transfer is running.
+--
 -- Usage:
 --   1. Fill in the issue and stride registers
 --   2. Write non-zero to the counter to initiate transfer
@@ -20,6 +38,22 @@
 -- Status information:
 --   All registers can be inspected during the transfer
 --   Interrupt line is raised upon completion
+--
+-- Descriptor chain (scatter-gather):
+--   A descriptor is 8 words in memory, aligned to 32 bytes:
+--     0x00 read issue address    0x10 transfer count
+--     0x04 write issue address   0x14 flags: bit0 interrupt when done, bit1 no status write-back,
+--                                            bits 9..8 mode
+--     0x08 read stride           0x18 next descriptor, 0 ends the chain
+--     0x0C write stride          0x1C status, written by the DMA: bit31 done, bit30 bus error
+--   The read master fetches the descriptor into the DMA registers, the copy runs as above, then the
+--   write master writes the status word. The next descriptor follows without the CPU.
+--   The completion interrupt of single transfers is not raised for the copies of a chain, only for
+--   descriptors with flag bit0, at the end of the chain and on a bus error while fetching.
+--
+-- Usage of a chain:
+--   1. Write the descriptors, write the address of the first to the descriptor address
+--   2. Write 1 to the descriptor control to start the chain
 
 library ieee;
 use ieee.std_logic_1164.all;
@@ -76,7 +110,34 @@ architecture rtl of xwb_dma is
   signal read_stride         : t_wishbone_address;
   signal write_stride        : t_wishbone_address;
   signal transfer_count      : t_wishbone_address;
-  -- result status: fail/ok ?
+  signal transfer_error      : std_logic;
+  
+  -- Byte packing
+  constant c_mode_pack   : std_logic_vector(1 downto 0) := "01";
+  constant c_mode_unpack : std_logic_vector(1 downto 0) := "10";
+  signal mode            : std_logic_vector(1 downto 0);
+  signal write_issue_lane  : unsigned(1 downto 0); -- unpack: byte of the word that is written
+  signal write_result_lane : unsigned(1 downto 0);
+  signal write_word      : t_wishbone_data;
+  
+  -- Descriptor chain
+  type sg_state_t is (SG_IDLE, SG_FETCH, SG_COPY, SG_WRITEBACK);
+  constant c_desc_words : integer := 7; -- words fetched, the status word is only written
+  signal sg_state       : sg_state_t;
+  signal sg_address     : t_wishbone_address; -- fetch and write-back address
+  signal sg_issue       : unsigned(2 downto 0);
+  signal sg_result      : unsigned(2 downto 0);
+  signal desc_address   : t_wishbone_address;
+  signal desc_count     : t_wishbone_address; -- transfer count of the fetched descriptor
+  signal desc_flags     : t_wishbone_address;
+  signal desc_next      : t_wishbone_address;
+  signal desc_done      : t_wishbone_address;
+  signal desc_stop      : std_logic;
+  signal desc_error     : std_logic;
+  signal sg_r_CYC       : std_logic;
+  signal sg_r_STB       : std_logic;
+  signal sg_w_CYC       : std_logic;
+  signal sg_w_STB       : std_logic;
   
   -- Registered wishbone control signals
   signal r_master_o_CYC : std_logic;
@@ -124,18 +185,43 @@ begin
   slave_o.DAT   <= slave_o_DAT;
   
   -- Hard-wired master pins
-  r_master_o.CYC <= r_master_o_CYC;
-  w_master_o.CYC <= w_master_o_CYC;
-  r_master_o.STB <= r_master_o_STB;
-  w_master_o.STB <= w_master_o_STB;
-  r_master_o.ADR <= read_issue_address;
-  w_master_o.ADR <= write_issue_address;
+  -- The descriptor accesses use the masters only while the copy is idle
+  r_master_o.CYC <= r_master_o_CYC or sg_r_CYC;
+  w_master_o.CYC <= w_master_o_CYC or sg_w_CYC;
+  r_master_o.STB <= r_master_o_STB or sg_r_STB;
+  w_master_o.STB <= w_master_o_STB or sg_w_STB;
+  r_master_o.ADR <= sg_address when sg_r_CYC = '1' else read_issue_address;
+  w_master_o.ADR <= sg_address when sg_w_CYC = '1' else write_issue_address;
   r_master_o.SEL <= (others => '1');
   w_master_o.SEL <= (others => '1');
   r_master_o.WE  <= '0';
   w_master_o.WE  <= '1';
   r_master_o.DAT <= (others => '0');
-  w_master_o.DAT <= ring(index(write_issue_offset));
+  w_master_o.DAT <= write_word when sg_w_CYC = '0' else
+                    (31 => '1', 30 => transfer_error, others => '0');
+  
+  -- Data of the write master from the ring
+  write_data : process(ring, write_issue_offset, write_issue_lane, mode)
+    variable word : t_wishbone_data;
+  begin
+    word := ring(index(write_issue_offset));
+    if mode = c_mode_pack then
+      write_word <= ring(index(write_issue_offset    ))(7 downto 0) &
+                    ring(index(write_issue_offset + 1))(7 downto 0) &
+                    ring(index(write_issue_offset + 2))(7 downto 0) &
+                    ring(index(write_issue_offset + 3))(7 downto 0);
+    elsif mode = c_mode_unpack then
+      write_word <= (others => '0');
+      case write_issue_lane is
+        when "00"   => write_word(7 downto 0) <= word(31 downto 24);
+        when "01"   => write_word(7 downto 0) <= word(23 downto 16);
+        when "10"   => write_word(7 downto 0) <= word(15 downto 8);
+        when others => write_word(7 downto 0) <= word(7 downto 0);
+      end case;
+    else
+      write_word <= word;
+    end if;
+  end process;
   
   main : process(clk_i)
     variable read_issue_progress   : boolean;
@@ -154,6 +240,12 @@ begin
     variable ring_full     : boolean;
     variable ring_empty    : boolean;
     variable done_transfer : boolean;
+    
+    variable sg_issue_progress  : boolean;
+    variable sg_result_progress : boolean;
+    variable new_sg_issue       : unsigned(2 downto 0);
+    variable new_sg_result      : unsigned(2 downto 0);
+    variable sg_chain_end       : boolean;
   begin
     if (rising_edge(clk_i)) then
       if (rst_n_i = '0') then
@@ -167,6 +259,26 @@ begin
         read_stride         <= (others => '0');
         write_stride        <= (others => '0');
         transfer_count      <= (others => '0');
+        transfer_error      <= '0';
+        mode                <= (others => '0');
+        write_issue_lane    <= (others => '0');
+        write_result_lane   <= (others => '0');
+        
+        sg_state     <= SG_IDLE;
+        sg_address   <= (others => '0');
+        sg_issue     <= (others => '0');
+        sg_result    <= (others => '0');
+        desc_address <= (others => '0');
+        desc_count   <= (others => '0');
+        desc_flags   <= (others => '0');
+        desc_next    <= (others => '0');
+        desc_done    <= (others => '0');
+        desc_stop    <= '0';
+        desc_error   <= '0';
+        sg_r_CYC     <= '0';
+        sg_r_STB     <= '0';
+        sg_w_CYC     <= '0';
+        sg_w_STB     <= '0';
         
         r_master_o_CYC <= '0';
         w_master_o_CYC <= '0';
@@ -177,12 +289,24 @@ begin
         interrupt_o <= '0';
       else
         -- Output any read the user requests
-        case to_integer(unsigned(slave_i.ADR(4 downto 2))) is
+        case to_integer(unsigned(slave_i.ADR(5 downto 2))) is
           when 0 => slave_o_DAT <= read_issue_address;
           when 1 => slave_o_DAT <= write_issue_address;
           when 2 => slave_o_DAT <= read_stride;
           when 3 => slave_o_DAT <= write_stride;
           when 4 => slave_o_DAT <= transfer_count;
+          when 5 => slave_o_DAT <= desc_address;
+          when 6 =>
+            slave_o_DAT <= (others => '0');
+            slave_o_DAT(0) <= active_high(sg_state /= SG_IDLE);
+            slave_o_DAT(1) <= desc_stop;
+            slave_o_DAT(2) <= desc_error;
+            slave_o_DAT(3) <= r_master_o_CYC or w_master_o_CYC or active_high(unsigned(transfer_count) /= 0);
+            slave_o_DAT(15 downto 8) <= std_logic_vector(to_unsigned(logRingLen, 8));
+          when 7 => slave_o_DAT <= desc_done;
+          when 8 =>
+            slave_o_DAT <= (others => '0');
+            slave_o_DAT(1 downto 0) <= mode;
           when others => slave_o_DAT <= (others => '0');
         end case;
         
@@ -209,17 +333,34 @@ begin
         end if;
         
         -- Advance write pointers
+        -- pack: a write takes four ring entries; unpack: an entry is done after four writes
+        new_write_issue_offset := write_issue_offset;
         if write_issue_progress then
           write_issue_address <= std_logic_vector(unsigned(write_issue_address) + unsigned(write_stride));
-          new_write_issue_offset := write_issue_offset + 1;
-        else
-          new_write_issue_offset := write_issue_offset;
+          if mode = c_mode_pack then
+            new_write_issue_offset := write_issue_offset + 4;
+          elsif mode = c_mode_unpack then
+            write_issue_lane <= write_issue_lane + 1;
+            if write_issue_lane = 3 then
+              new_write_issue_offset := write_issue_offset + 1;
+            end if;
+          else
+            new_write_issue_offset := write_issue_offset + 1;
+          end if;
         end if;
+        new_write_result_offset := write_result_offset;
         if write_result_progress then
-          new_write_result_offset := write_result_offset + 1;
-        else
-          new_write_result_offset := write_result_offset;
-        end if; 
+          if mode = c_mode_pack then
+            new_write_result_offset := write_result_offset + 4;
+          elsif mode = c_mode_unpack then
+            write_result_lane <= write_result_lane + 1;
+            if write_result_lane = 3 then
+              new_write_result_offset := write_result_offset + 1;
+            end if;
+          else
+            new_write_result_offset := write_result_offset + 1;
+          end if;
+        end if;
         
         ring_boundary := index(new_read_issue_offset) = index(new_write_result_offset);
         ring_high     := new_read_issue_offset(logRingLen) /= new_write_result_offset(logRingLen);
@@ -234,9 +375,20 @@ begin
         r_master_o_STB <= active_high (not ring_full and not done_transfer);
         r_master_o_CYC <= active_high((not ring_full and not done_transfer) or 
                                       (new_read_result_offset  /= new_read_issue_offset));
-        w_master_o_STB <= active_high (new_write_issue_offset  /= new_read_result_offset);
+        if mode = c_mode_pack then
+          w_master_o_STB <= active_high (new_read_result_offset - new_write_issue_offset >= 4);
+        else
+          w_master_o_STB <= active_high (new_write_issue_offset  /= new_read_result_offset);
+        end if;
         w_master_o_CYC <= active_high (new_write_result_offset /= new_read_result_offset);
-        interrupt_o    <= active_high (write_result_progress and done_transfer and ring_empty);
+        interrupt_o    <= active_high (write_result_progress and done_transfer and ring_empty and 
+                                       sg_state = SG_IDLE);
+        
+        -- Remember bus errors of the copy for the status word of the descriptor
+        if (r_master_o_CYC = '1' and (r_master_i.ERR = '1' or r_master_i.RTY = '1')) or
+           (w_master_o_CYC = '1' and (w_master_i.ERR = '1' or w_master_i.RTY = '1')) then
+          transfer_error <= '1';
+        end if;
         
         transfer_count      <= new_transfer_count;
         read_issue_offset   <= new_read_issue_offset;
@@ -244,14 +396,134 @@ begin
         write_issue_offset  <= new_write_issue_offset;
         write_result_offset <= new_write_result_offset;
         
+        -- Descriptor chain
+        sg_issue_progress  := sg_r_STB = '1' and r_master_i.STALL = '0';
+        sg_result_progress := sg_r_CYC = '1' and (r_master_i.ACK = '1' or r_master_i.ERR = '1' or r_master_i.RTY = '1');
+        if sg_issue_progress then
+          new_sg_issue := sg_issue + 1;
+          sg_address   <= std_logic_vector(unsigned(sg_address) + 4);
+        else
+          new_sg_issue := sg_issue;
+        end if;
+        if sg_result_progress then
+          new_sg_result := sg_result + 1;
+        else
+          new_sg_result := sg_result;
+        end if;
+        sg_issue  <= new_sg_issue;
+        sg_result <= new_sg_result;
+        sg_chain_end := desc_stop = '1' or unsigned(desc_next) = 0;
+        
+        case sg_state is
+          when SG_IDLE => null;
+          
+          when SG_FETCH =>
+            if sg_result_progress then
+              case to_integer(sg_result) is
+                when 0 => read_issue_address  <= r_master_i.DAT;
+                when 1 => write_issue_address <= r_master_i.DAT;
+                when 2 => read_stride         <= r_master_i.DAT;
+                when 3 => write_stride        <= r_master_i.DAT;
+                when 4 => desc_count          <= r_master_i.DAT;
+                when 5 => desc_flags          <= r_master_i.DAT;
+                          mode                <= r_master_i.DAT(9 downto 8);
+                when others => desc_next      <= r_master_i.DAT;
+              end case;
+              if r_master_i.ACK = '0' then
+                desc_error <= '1';
+              end if;
+            end if;
+            sg_r_STB <= active_high(new_sg_issue < c_desc_words);
+            sg_r_CYC <= active_high(new_sg_result < c_desc_words);
+            if new_sg_result = c_desc_words then
+              if desc_error = '1' or (sg_result_progress and r_master_i.ACK = '0') then
+                sg_state    <= SG_IDLE;
+                interrupt_o <= '1';
+              else
+                sg_state       <= SG_COPY;
+                transfer_count <= desc_count;
+                transfer_error <= '0';
+              end if;
+            end if;
+          
+          when SG_COPY =>
+            -- The copy is done when the count is zero and every write was acknowledged
+            if unsigned(transfer_count) = 0 and ring_empty and r_master_o_CYC = '0' then
+              if desc_flags(1) = '0' then
+                sg_state   <= SG_WRITEBACK;
+                sg_address <= std_logic_vector(unsigned(desc_address) + 16#1C#);
+                sg_w_CYC   <= '1';
+                sg_w_STB   <= '1';
+              else
+                desc_done   <= std_logic_vector(unsigned(desc_done) + 1);
+                interrupt_o <= active_high(desc_flags(0) = '1' or sg_chain_end);
+                if sg_chain_end then
+                  sg_state <= SG_IDLE;
+                else
+                  sg_state     <= SG_FETCH;
+                  desc_address <= desc_next;
+                  sg_address   <= desc_next;
+                  sg_issue     <= (others => '0');
+                  sg_result    <= (others => '0');
+                  sg_r_CYC     <= '1';
+                  sg_r_STB     <= '1';
+                end if;
+              end if;
+            end if;
+          
+          when SG_WRITEBACK =>
+            if sg_w_STB = '1' and w_master_i.STALL = '0' then
+              sg_w_STB <= '0';
+            end if;
+            if sg_w_CYC = '1' and (w_master_i.ACK = '1' or w_master_i.ERR = '1' or w_master_i.RTY = '1') then
+              sg_w_CYC    <= '0';
+              desc_done   <= std_logic_vector(unsigned(desc_done) + 1);
+              interrupt_o <= active_high(desc_flags(0) = '1' or sg_chain_end);
+              if sg_chain_end then
+                sg_state <= SG_IDLE;
+              else
+                sg_state     <= SG_FETCH;
+                desc_address <= desc_next;
+                sg_address   <= desc_next;
+                sg_issue     <= (others => '0');
+                sg_result    <= (others => '0');
+                sg_r_CYC     <= '1';
+                sg_r_STB     <= '1';
+              end if;
+            end if;
+        end case;
+        
         -- Control logic
         if (slave_i.CYC = '1' and slave_i.STB = '1' and slave_i.WE = '1') then
-          case to_integer(unsigned(slave_i.ADR(4 downto 2))) is
+          case to_integer(unsigned(slave_i.ADR(5 downto 2))) is
             when 0 => update(read_issue_address);
             when 1 => update(write_issue_address);
             when 2 => update(read_stride);
             when 3 => update(write_stride);
             when 4 => update(transfer_count);
+            when 5 => update(desc_address);
+            when 6 =>
+              if slave_i.SEL(0) = '1' then
+                if slave_i.DAT(0) = '1' and sg_state = SG_IDLE and unsigned(desc_address) /= 0 and
+                   unsigned(transfer_count) = 0 and r_master_o_CYC = '0' and w_master_o_CYC = '0' then
+                  sg_state   <= SG_FETCH;
+                  sg_address <= desc_address;
+                  sg_issue   <= (others => '0');
+                  sg_result  <= (others => '0');
+                  sg_r_CYC   <= '1';
+                  sg_r_STB   <= '1';
+                  desc_stop  <= '0';
+                  desc_error <= '0';
+                end if;
+                if slave_i.DAT(1) = '1' and sg_state /= SG_IDLE then
+                  desc_stop <= '1';
+                end if;
+              end if;
+            when 7 => update(desc_done);
+            when 8 =>
+              if slave_i.SEL(0) = '1' then
+                mode <= slave_i.DAT(1 downto 0);
+              end if;
             when others => null;
           end case;
         end if;
@@ -152,7 +152,9 @@ def gen_vhdl_component(f, profile_name):
    D_WE_O   : out std_logic;
    D_CTI_O  : out std_logic_vector(2 downto 0);
    D_LOCK_O : out std_logic;
-   D_BTE_O  : out std_logic_vector(1 downto 0));
+   D_BTE_O  : out std_logic_vector(1 downto 0);
+   profile_pc_o : out std_logic_vector(31 downto 0);
+   profile_ra_o : out std_logic_vector(31 downto 0));
 end component;
 """);
 
@@ -182,7 +184,10 @@ irq_i : in  std_logic_vector(31 downto 0);
 dwb_o  : out t_wishbone_master_out;
 dwb_i  : in  t_wishbone_master_in;
 iwb_o  : out t_wishbone_master_out;
-iwb_i  : in  t_wishbone_master_in);
+iwb_i  : in  t_wishbone_master_in;
+-- Program counter sampling: oldest instruction not yet committed, last return address
+pc_o   : out t_wishbone_address;
+ra_o   : out t_wishbone_address);
 end xwb_lm32;
 architecture rtl of xwb_lm32 is \n""");
 	gen_burst_eval_func(f, prof, "i");
@@ -295,7 +300,10 @@ port map(
       I_CTI_O	=> I_CTI,
       D_ADR_O	=> D_ADR,
       D_CYC_O	=> D_CYC,
-      D_CTI_O	=> D_CTI);
+      D_CTI_O	=> D_CTI,
+      -- Program counter sampling
+      profile_pc_o => pc_o,
+      profile_ra_o => ra_o);
 """);
 		f.write("end generate gen_profile_"+p[0]+";\n")
 
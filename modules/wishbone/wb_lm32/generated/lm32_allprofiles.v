@@ -639,7 +639,10 @@ module lm32_top_full_debug (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc_o,
+    profile_ra_o
     );
 
 
@@ -730,6 +733,11 @@ output D_LOCK_O;
 wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
+
+output [ (32-1):0] profile_pc_o;           
+wire   [ (32-1):0] profile_pc_o;
+output [ (32-1):0] profile_ra_o;           
+wire   [ (32-1):0] profile_ra_o;
   
 
 
@@ -915,7 +923,10 @@ lm32_cpu_full_debug cpu (
     .D_WE_O                (D_WE_O),
     .D_CTI_O               (D_CTI_O),
     .D_LOCK_O              (D_LOCK_O),
-    .D_BTE_O               (D_BTE_O)
+    .D_BTE_O               (D_BTE_O),
+    
+    .profile_pc            (profile_pc_o),
+    .profile_ra            (profile_ra_o)
     );
    
   
@@ -2061,7 +2072,10 @@ module lm32_cpu_full_debug (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc,
+    profile_ra
     );
 
 
@@ -2261,6 +2275,11 @@ wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
 
+output [ (32-1):0] profile_pc;             
+reg    [ (32-1):0] profile_pc;
+output [ (32-1):0] profile_ra;             
+reg    [ (32-1):0] profile_ra;
+
 
 
 
@@ -5141,6 +5160,23 @@ end
 
 
 
+
+
+always @(posedge clk_i  )
+begin
+    if (rst_i ==  1'b1)
+    begin
+        profile_pc <= {32{1'b0}};
+        profile_ra <= {32{1'b0}};
+    end
+    else
+    begin
+        if (valid_m ==  1'b1)
+            profile_pc <= {pc_m, 2'b00};
+        if ((reg_write_enable_q_w ==  1'b1) && (write_idx_w ==  5'd29))
+            profile_ra <= w_result;
+    end
+end
 
 initial
 begin
@@ -13534,7 +13570,10 @@ module lm32_top_full (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc_o,
+    profile_ra_o
     );
 
 
@@ -13625,6 +13664,11 @@ output D_LOCK_O;
 wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
+
+output [ (32-1):0] profile_pc_o;           
+wire   [ (32-1):0] profile_pc_o;
+output [ (32-1):0] profile_ra_o;           
+wire   [ (32-1):0] profile_ra_o;
   
 
 
@@ -13807,7 +13851,10 @@ lm32_cpu_full cpu (
     .D_WE_O                (D_WE_O),
     .D_CTI_O               (D_CTI_O),
     .D_LOCK_O              (D_LOCK_O),
-    .D_BTE_O               (D_BTE_O)
+    .D_BTE_O               (D_BTE_O),
+    
+    .profile_pc            (profile_pc_o),
+    .profile_ra            (profile_ra_o)
     );
    
   		   
@@ -14950,7 +14997,10 @@ module lm32_cpu_full (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc,
+    profile_ra
     );
 
 
@@ -15147,6 +15197,11 @@ wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
 
+output [ (32-1):0] profile_pc;             
+reg    [ (32-1):0] profile_pc;
+output [ (32-1):0] profile_ra;             
+reg    [ (32-1):0] profile_ra;
+
 
 
 
@@ -17949,6 +18004,23 @@ end
 
 
 
+
+
+always @(posedge clk_i  )
+begin
+    if (rst_i ==  1'b1)
+    begin
+        profile_pc <= {32{1'b0}};
+        profile_ra <= {32{1'b0}};
+    end
+    else
+    begin
+        if (valid_m ==  1'b1)
+            profile_pc <= {pc_m, 2'b00};
+        if ((reg_write_enable_q_w ==  1'b1) && (write_idx_w ==  5'd29))
+            profile_ra <= w_result;
+    end
+end
 
 initial
 begin
@@ -26163,7 +26235,10 @@ module lm32_top_medium_debug (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc_o,
+    profile_ra_o
     );
 
 
@@ -26254,6 +26329,11 @@ output D_LOCK_O;
 wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
+
+output [ (32-1):0] profile_pc_o;           
+wire   [ (32-1):0] profile_pc_o;
+output [ (32-1):0] profile_ra_o;           
+wire   [ (32-1):0] profile_ra_o;
   
 
 
@@ -26439,7 +26519,10 @@ lm32_cpu_medium_debug cpu (
     .D_WE_O                (D_WE_O),
     .D_CTI_O               (D_CTI_O),
     .D_LOCK_O              (D_LOCK_O),
-    .D_BTE_O               (D_BTE_O)
+    .D_BTE_O               (D_BTE_O),
+    
+    .profile_pc            (profile_pc_o),
+    .profile_ra            (profile_ra_o)
     );
    
   
@@ -27575,7 +27658,10 @@ module lm32_cpu_medium_debug (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc,
+    profile_ra
     );
 
 
@@ -27775,6 +27861,11 @@ wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
 
+output [ (32-1):0] profile_pc;             
+reg    [ (32-1):0] profile_pc;
+output [ (32-1):0] profile_ra;             
+reg    [ (32-1):0] profile_ra;
+
 
 
 
@@ -30593,6 +30684,23 @@ end
 
 
 
+
+
+always @(posedge clk_i  )
+begin
+    if (rst_i ==  1'b1)
+    begin
+        profile_pc <= {32{1'b0}};
+        profile_ra <= {32{1'b0}};
+    end
+    else
+    begin
+        if (valid_m ==  1'b1)
+            profile_pc <= {pc_m, 2'b00};
+        if ((reg_write_enable_q_w ==  1'b1) && (write_idx_w ==  5'd29))
+            profile_ra <= w_result;
+    end
+end
 
 initial
 begin
@@ -38876,7 +38984,10 @@ module lm32_top_medium_icache_debug (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc_o,
+    profile_ra_o
     );
 
 
@@ -38967,6 +39078,11 @@ output D_LOCK_O;
 wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
+
+output [ (32-1):0] profile_pc_o;           
+wire   [ (32-1):0] profile_pc_o;
+output [ (32-1):0] profile_ra_o;           
+wire   [ (32-1):0] profile_ra_o;
   
 
 
@@ -39152,7 +39268,10 @@ lm32_cpu_medium_icache_debug cpu (
     .D_WE_O                (D_WE_O),
     .D_CTI_O               (D_CTI_O),
     .D_LOCK_O              (D_LOCK_O),
-    .D_BTE_O               (D_BTE_O)
+    .D_BTE_O               (D_BTE_O),
+    
+    .profile_pc            (profile_pc_o),
+    .profile_ra            (profile_ra_o)
     );
    
   
@@ -40288,7 +40407,10 @@ module lm32_cpu_medium_icache_debug (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc,
+    profile_ra
     );
 
 
@@ -40488,6 +40610,11 @@ wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
 
+output [ (32-1):0] profile_pc;             
+reg    [ (32-1):0] profile_pc;
+output [ (32-1):0] profile_ra;             
+reg    [ (32-1):0] profile_ra;
+
 
 
 
@@ -43306,6 +43433,23 @@ end
 
 
 
+
+
+always @(posedge clk_i  )
+begin
+    if (rst_i ==  1'b1)
+    begin
+        profile_pc <= {32{1'b0}};
+        profile_ra <= {32{1'b0}};
+    end
+    else
+    begin
+        if (valid_m ==  1'b1)
+            profile_pc <= {pc_m, 2'b00};
+        if ((reg_write_enable_q_w ==  1'b1) && (write_idx_w ==  5'd29))
+            profile_ra <= w_result;
+    end
+end
 
 initial
 begin
@@ -51566,7 +51710,10 @@ module lm32_top_medium_icache (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc_o,
+    profile_ra_o
     );
 
 
@@ -51657,6 +51804,11 @@ output D_LOCK_O;
 wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
+
+output [ (32-1):0] profile_pc_o;           
+wire   [ (32-1):0] profile_pc_o;
+output [ (32-1):0] profile_ra_o;           
+wire   [ (32-1):0] profile_ra_o;
   
 
 
@@ -51839,7 +51991,10 @@ lm32_cpu_medium_icache cpu (
     .D_WE_O                (D_WE_O),
     .D_CTI_O               (D_CTI_O),
     .D_LOCK_O              (D_LOCK_O),
-    .D_BTE_O               (D_BTE_O)
+    .D_BTE_O               (D_BTE_O),
+    
+    .profile_pc            (profile_pc_o),
+    .profile_ra            (profile_ra_o)
     );
    
   		   
@@ -52972,7 +53127,10 @@ module lm32_cpu_medium_icache (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc,
+    profile_ra
     );
 
 
@@ -53169,6 +53327,11 @@ wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
 
+output [ (32-1):0] profile_pc;             
+reg    [ (32-1):0] profile_pc;
+output [ (32-1):0] profile_ra;             
+reg    [ (32-1):0] profile_ra;
+
 
 
 
@@ -55913,6 +56076,23 @@ end
 
 
 
+
+
+always @(posedge clk_i  )
+begin
+    if (rst_i ==  1'b1)
+    begin
+        profile_pc <= {32{1'b0}};
+        profile_ra <= {32{1'b0}};
+    end
+    else
+    begin
+        if (valid_m ==  1'b1)
+            profile_pc <= {pc_m, 2'b00};
+        if ((reg_write_enable_q_w ==  1'b1) && (write_idx_w ==  5'd29))
+            profile_ra <= w_result;
+    end
+end
 
 initial
 begin
@@ -63985,7 +64165,10 @@ module lm32_top_medium (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc_o,
+    profile_ra_o
     );
 
 
@@ -64076,6 +64259,11 @@ output D_LOCK_O;
 wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
+
+output [ (32-1):0] profile_pc_o;           
+wire   [ (32-1):0] profile_pc_o;
+output [ (32-1):0] profile_ra_o;           
+wire   [ (32-1):0] profile_ra_o;
   
 
 
@@ -64258,7 +64446,10 @@ lm32_cpu_medium cpu (
     .D_WE_O                (D_WE_O),
     .D_CTI_O               (D_CTI_O),
     .D_LOCK_O              (D_LOCK_O),
-    .D_BTE_O               (D_BTE_O)
+    .D_BTE_O               (D_BTE_O),
+    
+    .profile_pc            (profile_pc_o),
+    .profile_ra            (profile_ra_o)
     );
    
   		   
@@ -65391,7 +65582,10 @@ module lm32_cpu_medium (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc,
+    profile_ra
     );
 
 
@@ -65588,6 +65782,11 @@ wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
 
+output [ (32-1):0] profile_pc;             
+reg    [ (32-1):0] profile_pc;
+output [ (32-1):0] profile_ra;             
+reg    [ (32-1):0] profile_ra;
+
 
 
 
@@ -68325,6 +68524,23 @@ end
 
 
 
+
+
+always @(posedge clk_i  )
+begin
+    if (rst_i ==  1'b1)
+    begin
+        profile_pc <= {32{1'b0}};
+        profile_ra <= {32{1'b0}};
+    end
+    else
+    begin
+        if (valid_m ==  1'b1)
+            profile_pc <= {pc_m, 2'b00};
+        if ((reg_write_enable_q_w ==  1'b1) && (write_idx_w ==  5'd29))
+            profile_ra <= w_result;
+    end
+end
 
 initial
 begin
@@ -76305,7 +76521,10 @@ module lm32_top_minimal (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc_o,
+    profile_ra_o
     );
 
 
@@ -76396,6 +76615,11 @@ output D_LOCK_O;
 wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
+
+output [ (32-1):0] profile_pc_o;           
+wire   [ (32-1):0] profile_pc_o;
+output [ (32-1):0] profile_ra_o;           
+wire   [ (32-1):0] profile_ra_o;
   
 
 
@@ -76578,7 +76802,10 @@ lm32_cpu_minimal cpu (
     .D_WE_O                (D_WE_O),
     .D_CTI_O               (D_CTI_O),
     .D_LOCK_O              (D_LOCK_O),
-    .D_BTE_O               (D_BTE_O)
+    .D_BTE_O               (D_BTE_O),
+    
+    .profile_pc            (profile_pc_o),
+    .profile_ra            (profile_ra_o)
     );
    
   		   
@@ -77711,7 +77938,10 @@ module lm32_cpu_minimal (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    
+    profile_pc,
+    profile_ra
     );
 
 
@@ -77908,6 +78138,11 @@ wire   D_LOCK_O;
 output [ (2-1):0] D_BTE_O;               
 wire   [ (2-1):0] D_BTE_O;
 
+output [ (32-1):0] profile_pc;             
+reg    [ (32-1):0] profile_pc;
+output [ (32-1):0] profile_ra;             
+reg    [ (32-1):0] profile_ra;
+
 
 
 
@@ -80618,6 +80853,23 @@ end
 
 
 
+
+
+always @(posedge clk_i  )
+begin
+    if (rst_i ==  1'b1)
+    begin
+        profile_pc <= {32{1'b0}};
+        profile_ra <= {32{1'b0}};
+    end
+    else
+    begin
+        if (valid_m ==  1'b1)
+            profile_pc <= {pc_m, 2'b00};
+        if ((reg_write_enable_q_w ==  1'b1) && (write_idx_w ==  5'd29))
+            profile_ra <= w_result;
+    end
+end
 
 initial
 begin
@@ -12,7 +12,10 @@ irq_i : in  std_logic_vector(31 downto 0);
 dwb_o  : out t_wishbone_master_out;
 dwb_i  : in  t_wishbone_master_in;
 iwb_o  : out t_wishbone_master_out;
-iwb_i  : in  t_wishbone_master_in);
+iwb_i  : in  t_wishbone_master_in;
+-- Program counter sampling: oldest instruction not yet committed, last return address
+pc_o   : out t_wishbone_address;
+ra_o   : out t_wishbone_address);
 end xwb_lm32;
 architecture rtl of xwb_lm32 is 
 function f_eval_i_burst_length(profile_name:string) return natural is
@@ -67,7 +70,9 @@ component lm32_top_minimal is port (
    D_WE_O   : out std_logic;
    D_CTI_O  : out std_logic_vector(2 downto 0);
    D_LOCK_O : out std_logic;
-   D_BTE_O  : out std_logic_vector(1 downto 0));
+   D_BTE_O  : out std_logic_vector(1 downto 0);
+   profile_pc_o : out std_logic_vector(31 downto 0);
+   profile_ra_o : out std_logic_vector(31 downto 0));
 end component;
 component lm32_top_medium is port (
  
@@ -99,7 +104,9 @@ component lm32_top_medium is port (
    D_WE_O   : out std_logic;
    D_CTI_O  : out std_logic_vector(2 downto 0);
    D_LOCK_O : out std_logic;
-   D_BTE_O  : out std_logic_vector(1 downto 0));
+   D_BTE_O  : out std_logic_vector(1 downto 0);
+   profile_pc_o : out std_logic_vector(31 downto 0);
+   profile_ra_o : out std_logic_vector(31 downto 0));
 end component;
 component lm32_top_medium_icache is port (
  
@@ -131,7 +138,9 @@ component lm32_top_medium_icache is port (
    D_WE_O   : out std_logic;
    D_CTI_O  : out std_logic_vector(2 downto 0);
    D_LOCK_O : out std_logic;
-   D_BTE_O  : out std_logic_vector(1 downto 0));
+   D_BTE_O  : out std_logic_vector(1 downto 0);
+   profile_pc_o : out std_logic_vector(31 downto 0);
+   profile_ra_o : out std_logic_vector(31 downto 0));
 end component;
 component lm32_top_medium_debug is port (
  
@@ -163,7 +172,9 @@ component lm32_top_medium_debug is port (
    D_WE_O   : out std_logic;
    D_CTI_O  : out std_logic_vector(2 downto 0);
    D_LOCK_O : out std_logic;
-   D_BTE_O  : out std_logic_vector(1 downto 0));
+   D_BTE_O  : out std_logic_vector(1 downto 0);
+   profile_pc_o : out std_logic_vector(31 downto 0);
+   profile_ra_o : out std_logic_vector(31 downto 0));
 end component;
 component lm32_top_medium_icache_debug is port (
  
@@ -195,7 +206,9 @@ component lm32_top_medium_icache_debug is port (
    D_WE_O   : out std_logic;
    D_CTI_O  : out std_logic_vector(2 downto 0);
    D_LOCK_O : out std_logic;
-   D_BTE_O  : out std_logic_vector(1 downto 0));
+   D_BTE_O  : out std_logic_vector(1 downto 0);
+   profile_pc_o : out std_logic_vector(31 downto 0);
+   profile_ra_o : out std_logic_vector(31 downto 0));
 end component;
 component lm32_top_full is port (
  
@@ -227,7 +240,9 @@ component lm32_top_full is port (
    D_WE_O   : out std_logic;
    D_CTI_O  : out std_logic_vector(2 downto 0);
    D_LOCK_O : out std_logic;
-   D_BTE_O  : out std_logic_vector(1 downto 0));
+   D_BTE_O  : out std_logic_vector(1 downto 0);
+   profile_pc_o : out std_logic_vector(31 downto 0);
+   profile_ra_o : out std_logic_vector(31 downto 0));
 end component;
 component lm32_top_full_debug is port (
  
@@ -259,7 +274,9 @@ component lm32_top_full_debug is port (
    D_WE_O   : out std_logic;
    D_CTI_O  : out std_logic_vector(2 downto 0);
    D_LOCK_O : out std_logic;
-   D_BTE_O  : out std_logic_vector(1 downto 0));
+   D_BTE_O  : out std_logic_vector(1 downto 0);
+   profile_pc_o : out std_logic_vector(31 downto 0);
+   profile_ra_o : out std_logic_vector(31 downto 0));
 end component;
 
   function pick(first : boolean;
@@ -362,7 +379,10 @@ port map(
       I_CTI_O	=> I_CTI,
       D_ADR_O	=> D_ADR,
       D_CYC_O	=> D_CYC,
-      D_CTI_O	=> D_CTI);
+      D_CTI_O	=> D_CTI,
+      -- Program counter sampling
+      profile_pc_o => pc_o,
+      profile_ra_o => ra_o);
 end generate gen_profile_minimal;
 gen_profile_medium: if (g_profile = "medium") generate
 U_Wrapped_LM32: lm32_top_medium
@@ -403,7 +423,10 @@ port map(
       I_CTI_O	=> I_CTI,
       D_ADR_O	=> D_ADR,
       D_CYC_O	=> D_CYC,
-      D_CTI_O	=> D_CTI);
+      D_CTI_O	=> D_CTI,
+      -- Program counter sampling
+      profile_pc_o => pc_o,
+      profile_ra_o => ra_o);
 end generate gen_profile_medium;
 gen_profile_medium_icache: if (g_profile = "medium_icache") generate
 U_Wrapped_LM32: lm32_top_medium_icache
@@ -444,7 +467,10 @@ port map(
       I_CTI_O	=> I_CTI,
       D_ADR_O	=> D_ADR,
       D_CYC_O	=> D_CYC,
-      D_CTI_O	=> D_CTI);
+      D_CTI_O	=> D_CTI,
+      -- Program counter sampling
+      profile_pc_o => pc_o,
+      profile_ra_o => ra_o);
 end generate gen_profile_medium_icache;
 gen_profile_medium_debug: if (g_profile = "medium_debug") generate
 U_Wrapped_LM32: lm32_top_medium_debug
@@ -485,7 +511,10 @@ port map(
       I_CTI_O	=> I_CTI,
       D_ADR_O	=> D_ADR,
       D_CYC_O	=> D_CYC,
-      D_CTI_O	=> D_CTI);
+      D_CTI_O	=> D_CTI,
+      -- Program counter sampling
+      profile_pc_o => pc_o,
+      profile_ra_o => ra_o);
 end generate gen_profile_medium_debug;
 gen_profile_medium_icache_debug: if (g_profile = "medium_icache_debug") generate
 U_Wrapped_LM32: lm32_top_medium_icache_debug
@@ -526,7 +555,10 @@ port map(
       I_CTI_O	=> I_CTI,
       D_ADR_O	=> D_ADR,
       D_CYC_O	=> D_CYC,
-      D_CTI_O	=> D_CTI);
+      D_CTI_O	=> D_CTI,
+      -- Program counter sampling
+      profile_pc_o => pc_o,
+      profile_ra_o => ra_o);
 end generate gen_profile_medium_icache_debug;
 gen_profile_full: if (g_profile = "full") generate
 U_Wrapped_LM32: lm32_top_full
@@ -567,7 +599,10 @@ port map(
       I_CTI_O	=> I_CTI,
       D_ADR_O	=> D_ADR,
       D_CYC_O	=> D_CYC,
-      D_CTI_O	=> D_CTI);
+      D_CTI_O	=> D_CTI,
+      -- Program counter sampling
+      profile_pc_o => pc_o,
+      profile_ra_o => ra_o);
 end generate gen_profile_full;
 gen_profile_full_debug: if (g_profile = "full_debug") generate
 U_Wrapped_LM32: lm32_top_full_debug
@@ -608,7 +643,10 @@ port map(
       I_CTI_O	=> I_CTI,
       D_ADR_O	=> D_ADR,
       D_CYC_O	=> D_CYC,
-      D_CTI_O	=> D_CTI);
+      D_CTI_O	=> D_CTI,
+      -- Program counter sampling
+      profile_pc_o => pc_o,
+      profile_ra_o => ra_o);
 end generate gen_profile_full_debug;
 
    -- Cycle durations always match in our adapter
@@ -145,7 +145,10 @@ module lm32_cpu (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    // Program counter sampling
+    profile_pc,
+    profile_ra
     );
 
 /////////////////////////////////////////////////////
@@ -261,6 +264,11 @@ reg    trace_bret;
 `endif
 `endif
 
+output [`LM32_WORD_RNG] profile_pc;             // Address of the oldest instruction not yet committed
+reg    [`LM32_WORD_RNG] profile_pc;
+output [`LM32_WORD_RNG] profile_ra;             // Last value written to the return address register
+reg    [`LM32_WORD_RNG] profile_ra;
+
 `ifdef CFG_JTAG_ENABLED
 output [`LM32_BYTE_RNG] jtag_reg_d;
 wire   [`LM32_BYTE_RNG] jtag_reg_d;
@@ -2701,6 +2709,25 @@ begin
     end
 end
 `endif
+
+// Program counter sampling logic. The instruction in the M stage is the oldest one not yet
+// committed: a load or store waiting for the data bus stays there. The return address
+// register is copied when it is written, it gives the caller of a leaf function.
+always @(posedge clk_i `CFG_RESET_SENSITIVITY)
+begin
+    if (rst_i == `TRUE)
+    begin
+        profile_pc <= {`LM32_WORD_WIDTH{1'b0}};
+        profile_ra <= {`LM32_WORD_WIDTH{1'b0}};
+    end
+    else
+    begin
+        if (valid_m == `TRUE)
+            profile_pc <= {pc_m, 2'b00};
+        if ((reg_write_enable_q_w == `TRUE) && (write_idx_w == `LM32_RA_REG))
+            profile_ra <= w_result;
+    end
+end
       
 /////////////////////////////////////////////////////
 // Behavioural Logic
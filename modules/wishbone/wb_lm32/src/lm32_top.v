@@ -86,7 +86,10 @@ module lm32_top (
     D_WE_O,
     D_CTI_O,
     D_LOCK_O,
-    D_BTE_O
+    D_BTE_O,
+    // Program counter sampling
+    profile_pc_o,
+    profile_ra_o
     );
 
 /////////////////////////////////////////////////////
@@ -171,6 +174,11 @@ output D_LOCK_O;                                // Date Wishbone interface lock
 wire   D_LOCK_O;
 output [`LM32_BTYPE_RNG] D_BTE_O;               // Data Wishbone interface burst type 
 wire   [`LM32_BTYPE_RNG] D_BTE_O;
+
+output [`LM32_WORD_RNG] profile_pc_o;           // Address of the oldest instruction not yet committed
+wire   [`LM32_WORD_RNG] profile_pc_o;
+output [`LM32_WORD_RNG] profile_ra_o;           // Last value written to the return address register
+wire   [`LM32_WORD_RNG] profile_ra_o;
   
 /////////////////////////////////////////////////////
 // Internal nets and registers 
@@ -287,7 +295,10 @@ lm32_cpu cpu (
     .D_WE_O                (D_WE_O),
     .D_CTI_O               (D_CTI_O),
     .D_LOCK_O              (D_LOCK_O),
-    .D_BTE_O               (D_BTE_O)
+    .D_BTE_O               (D_BTE_O),
+    // Program counter sampling
+    .profile_pc            (profile_pc_o),
+    .profile_ra            (profile_ra_o)
     );
    
 `ifdef CFG_JTAG_ENABLED		   
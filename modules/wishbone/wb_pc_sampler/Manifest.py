@@ -0,0 +1 @@
+files = [ "xwb_pc_sampler.vhd" ];
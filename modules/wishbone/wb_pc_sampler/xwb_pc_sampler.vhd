@@ -0,0 +1,206 @@
+-------------------------------------------------------------------------------
+-- Title      : LM32 program counter sampler
+-- Project    : General Cores Library (gencores)
+-------------------------------------------------------------------------------
+-- File       : xwb_pc_sampler.vhd
+-- Platform   : FPGA-generic
+-- Standard   : VHDL'93
+-------------------------------------------------------------------------------
+-- Description:
+--
+-- Takes a sample of the program counter of an LM32 (pc_o and ra_o of xwb_lm32)
+-- every period and stores it in a FIFO, the host drains the FIFO while the
+-- firmware runs. A sample is the address of the oldest instruction not yet
+-- committed and the last value written into the return address register r29.
+-- The profiler symbolises the samples against the ELF of the firmware.
+--
+-- Register map:
+-- 0x00 = control: bit0 sampling enabled, bit2 random period;
+--        write bit1 clears the FIFO and the counters
+-- 0x04 = period in clock cycles minus 1
+--        with random period a random value of 0..255 is added to every period,
+--        so that loops with the same period as the sampler are not aliased
+-- 0x08 = status: bits 15..0 samples in the FIFO, bits 23..16 log2 of the FIFO depth
+-- 0x0C = samples lost because the FIFO was full
+-- 0x10 = samples taken
+-- 0x14 = pc: a read takes the oldest sample from the FIFO, 0 when it is empty
+-- 0x18 = ra: return address of the sample taken by the last read of pc
+-- The counters stop at their maximum value.
+-------------------------------------------------------------------------------
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+use work.wishbone_pkg.all;
+
+entity xwb_pc_sampler is
+  generic(
+    g_fifo_log2 : natural := 10);
+  port(
+    clk_sys_i : in  std_logic;
+    rst_n_i   : in  std_logic;
+    -- From xwb_lm32
+    pc_i      : in  t_wishbone_address;
+    ra_i      : in  t_wishbone_address;
+    -- Control and read out of the samples
+    slave_i   : in  t_wishbone_slave_in;
+    slave_o   : out t_wishbone_slave_out);
+end xwb_pc_sampler;
+
+architecture rtl of xwb_pc_sampler is
+  type t_fifo is array (2**g_fifo_log2-1 downto 0) of t_wishbone_address;
+  
+  signal fifo_pc   : t_fifo;
+  signal fifo_ra   : t_fifo;
+  signal r_wr      : unsigned(g_fifo_log2 downto 0);
+  signal r_wr_q    : unsigned(g_fifo_log2 downto 0); -- the sample is in the RAM
+  signal r_rd      : unsigned(g_fifo_log2 downto 0);
+  signal s_rd_next : unsigned(g_fifo_log2 downto 0);
+  signal r_fifo_pc : t_wishbone_address;
+  signal r_fifo_ra : t_wishbone_address;
+  signal r_enable  : std_logic;
+  signal r_random  : std_logic;
+  signal r_period  : unsigned(31 downto 0);
+  signal r_count   : unsigned(31 downto 0);
+  signal r_lfsr    : std_logic_vector(15 downto 0);
+  signal r_lost    : unsigned(31 downto 0);
+  signal r_taken   : unsigned(31 downto 0);
+  signal r_ra      : t_wishbone_address;
+  signal r_ack     : std_logic;
+  signal r_dat     : t_wishbone_data;
+  signal s_level   : unsigned(g_fifo_log2 downto 0);
+  signal s_avail   : unsigned(g_fifo_log2 downto 0);
+  signal s_pc_read : std_logic;
+  signal s_clear   : std_logic;
+  
+  function f_inc(x : unsigned) return unsigned is
+    constant c_max : unsigned(x'range) := (others => '1');
+  begin
+    if x = c_max then
+      return x;
+    else
+      return x + 1;
+    end if;
+  end f_inc;
+begin
+  slave_o.ACK   <= r_ack;
+  slave_o.ERR   <= '0';
+  slave_o.RTY   <= '0';
+  slave_o.STALL <= '0';
+  slave_o.INT   <= '0';
+  slave_o.DAT   <= r_dat;
+  
+  s_level   <= r_wr - r_rd;
+  s_avail   <= r_wr_q - r_rd;
+  s_pc_read <= slave_i.CYC and slave_i.STB and not slave_i.WE
+               when slave_i.ADR(4 downto 2) = "101" else '0';
+  s_clear   <= slave_i.CYC and slave_i.STB and slave_i.WE and slave_i.DAT(1)
+               when slave_i.ADR(4 downto 2) = "000" else '0';
+  s_rd_next <= (others => '0') when rst_n_i = '0' or s_clear = '1' else
+               r_rd + 1 when s_pc_read = '1' and s_avail /= 0 else
+               r_rd;
+  
+  -- The FIFO is a simple dual port RAM, written by the sampler and read by the bus.
+  -- The oldest sample is read ahead, a new sample can be read one cycle after it is written.
+  fifo : process(clk_sys_i)
+  begin
+    if rising_edge(clk_sys_i) then
+      if r_enable = '1' and r_count = 0 and s_level /= 2**g_fifo_log2 then
+        fifo_pc(to_integer(r_wr(g_fifo_log2-1 downto 0))) <= pc_i;
+        fifo_ra(to_integer(r_wr(g_fifo_log2-1 downto 0))) <= ra_i;
+      end if;
+      r_fifo_pc <= fifo_pc(to_integer(s_rd_next(g_fifo_log2-1 downto 0)));
+      r_fifo_ra <= fifo_ra(to_integer(s_rd_next(g_fifo_log2-1 downto 0)));
+    end if;
+  end process fifo;
+  
+  sampler : process(clk_sys_i)
+  begin
+    if rising_edge(clk_sys_i) then
+      r_rd <= s_rd_next;
+      if rst_n_i = '0' then
+        r_enable <= '0';
+        r_random <= '0';
+        r_period <= to_unsigned(12499, 32); -- 10 kHz at 125 MHz
+        r_count  <= (others => '0');
+        r_lfsr   <= (others => '1');
+        r_wr     <= (others => '0');
+        r_wr_q   <= (others => '0');
+        r_lost   <= (others => '0');
+        r_taken  <= (others => '0');
+        r_ra     <= (others => '0');
+        r_ack    <= '0';
+        r_dat    <= (others => '0');
+      else
+        -- Galois LFSR, x^16 + x^14 + x^13 + x^11 + 1
+        if r_lfsr(0) = '1' then
+          r_lfsr <= ('0' & r_lfsr(15 downto 1)) xor x"B400";
+        else
+          r_lfsr <= '0' & r_lfsr(15 downto 1);
+        end if;
+        
+        -- Take a sample every period
+        if r_enable = '0' then
+          r_count <= r_period;
+        elsif r_count /= 0 then
+          r_count <= r_count - 1;
+        else
+          if r_random = '1' then
+            r_count <= r_period + unsigned(r_lfsr(7 downto 0));
+          else
+            r_count <= r_period;
+          end if;
+          r_taken <= f_inc(r_taken);
+          if s_level /= 2**g_fifo_log2 then
+            r_wr <= r_wr + 1;
+          else
+            r_lost <= f_inc(r_lost);
+          end if;
+        end if;
+        
+        -- Registered read, the pc register takes the sample
+        r_ack <= slave_i.CYC and slave_i.STB;
+        r_dat <= (others => '0');
+        if s_pc_read = '1' then
+          if s_avail /= 0 then
+            r_dat <= r_fifo_pc;
+            r_ra  <= r_fifo_ra;
+          else
+            r_ra  <= (others => '0');
+          end if;
+        end if;
+        case slave_i.ADR(4 downto 2) is
+          when "000" =>
+            r_dat(0) <= r_enable;
+            r_dat(2) <= r_random;
+          when "001" => r_dat <= std_logic_vector(r_period);
+          when "010" =>
+            r_dat(g_fifo_log2 downto 0) <= std_logic_vector(s_avail);
+            r_dat(23 downto 16) <= std_logic_vector(to_unsigned(g_fifo_log2, 8));
+          when "011" => r_dat <= std_logic_vector(r_lost);
+          when "100" => r_dat <= std_logic_vector(r_taken);
+          when "110" => r_dat <= r_ra;
+          when others => null;
+        end case;
+        
+        -- Control
+        if slave_i.CYC = '1' and slave_i.STB = '1' and slave_i.WE = '1' then
+          case slave_i.ADR(4 downto 2) is
+            when "000" =>
+              r_enable <= slave_i.DAT(0);
+              r_random <= slave_i.DAT(2);
+            when "001" => r_period <= unsigned(slave_i.DAT);
+            when others => null;
+          end case;
+        end if;
+        r_wr_q <= r_wr;
+        if s_clear = '1' then
+          r_wr    <= (others => '0');
+          r_wr_q  <= (others => '0');
+          r_lost  <= (others => '0');
+          r_taken <= (others => '0');
+        end if;
+      end if;
+    end if;
+  end process sampler;
+end rtl;
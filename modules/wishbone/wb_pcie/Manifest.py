@@ -5,6 +5,7 @@ files = [
   "altera_pcie.vhd",
   "pcie_altera.vhd",
   "pcie_tlp.vhd",
+  "pcie_dma.vhd",
   "pcie_wb.vhd",
   "pcie_wb_pkg.vhd",
   "altera_pcie.qip"]
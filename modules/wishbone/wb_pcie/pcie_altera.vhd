@@ -15,6 +15,13 @@ entity pcie_altera is
     pcie_tx_o     : out std_logic_vector(3 downto 0);
     
     cfg_busdev_o  : out std_logic_vector(12 downto 0); -- Configured Bus#:Dev#
+    cfg_msicsr_o  : out std_logic_vector(15 downto 0); -- MSI control, bit 0: enabled by the host
+    
+    -- Interrupts: MSI when enabled, else the legacy INTx level
+    app_msi_req_i : in  std_logic; -- hold until ack_o
+    app_msi_num_i : in  std_logic_vector(4 downto 0);
+    app_msi_ack_o : out std_logic;
+    app_int_sts_i : in  std_logic;
     
     -- Simplified wishbone output stream
     wb_clk_o      : out std_logic;
@@ -216,6 +223,7 @@ architecture rtl of pcie_altera is
   signal tl_cfg_add   : std_logic_vector(3 downto 0);
   signal tl_cfg_ctl   : std_logic_vector(31 downto 0);
   signal tl_cfg_delay : std_logic_vector(3 downto 0);
+  signal tl_msi_delay : std_logic_vector(3 downto 0);
   
   signal l2_exit, hotrst_exit, dlup_exit : std_logic;
   signal npor, crst, srst, rst_reg : std_logic;
@@ -229,11 +237,22 @@ architecture rtl of pcie_altera is
   signal rx_st_bardec0 : std_logic_vector(7 downto 0);
   
   signal r64_ready : std_logic_vector(1 downto 0); -- length must equal the latency of the Avalon RX bus
-  signal r64_dat, s64_dat : std_logic_vector(63 downto 0);
-  signal s64_need_refill, s64_filling, s64_valid, s64_advance, r64_full, r64_skip, s64_skip : std_logic;
+  signal s64_dat : std_logic_vector(63 downto 0);
+  signal s64_bar : std_logic_vector(2 downto 0);
+  signal s64_filling, s64_valid, s64_advance, s64_skip : std_logic;
+  
+  -- Small input FIFO: fetches are issued back-to-back while there is room for the data
+  -- in flight, so a write burst resumes at full rate after a wishbone stall.
+  constant rx_fifo_bits : integer := 2;
+  type rx_fifo_t is array(2**rx_fifo_bits-1 downto 0) of std_logic_vector(67 downto 0); -- bar, skip, data
+  signal rx_fifo : rx_fifo_t;
+  signal r_rx_wr, r_rx_rd, s_rx_level : unsigned(rx_fifo_bits downto 0);
+  signal s_rx_inflight : unsigned(rx_fifo_bits downto 0);
+  signal s_rx_wbar : std_logic_vector(2 downto 0);
   
   signal r32_word, s32_word, s32_progress, r32_full, s32_need_refill, r32_skip, s32_enter0 : std_logic;
   signal r32_dat0, r32_dat1 : std_logic_vector(31 downto 0);
+  signal r32_bar : std_logic_vector(2 downto 0);
   
   -- TX registers and signals
   
@@ -397,13 +416,13 @@ begin
       rate_ext             => open,
       
       -- PCIe interrupts (for endpoint)
-      app_int_sts          => '0',
-      app_msi_num          => (others => '0'), -- 4 downto 0
-      app_msi_req          => '0',
+      app_int_sts          => app_int_sts_i,
+      app_msi_num          => app_msi_num_i, -- 4 downto 0
+      app_msi_req          => app_msi_req_i,
       app_msi_tc           => (others => '0'), -- 2 downto 0
       pex_msi_num          => (others => '0'), --  4 downto 0
       app_int_ack          => open,
-      app_msi_ack          => open,
+      app_msi_ack          => app_msi_ack_o,
       
       -- PCIe configuration space
       hpg_ctrler           => (others => '0'), --  4 downto 0
@@ -462,7 +481,7 @@ begin
   rstn <= rstn_i or rst_reg;
   rstn_o <= rstn;
   
-  -- Recover bus:device IDs from config space
+  -- Recover bus:device IDs and the MSI control from config space
   cfg : process(core_clk_out)
   begin
     if rising_edge(core_clk_out) then
@@ -479,17 +498,30 @@ begin
       if tl_cfg_delay(tl_cfg_delay'left) = '1' and is_zero(tl_cfg_delay(tl_cfg_delay'left-1 downto 0)) = '1' then
         cfg_busdev_o <= tl_cfg_ctl(12 downto 0);
       end if;
+      
+      -- Address 0xE holds the MSI control register in the low half
+      tl_msi_delay(tl_msi_delay'left downto 1) <= tl_msi_delay(tl_msi_delay'left-1 downto 0);
+      if tl_cfg_add = x"e" then
+        tl_msi_delay(0) <= '0';
+      else
+        tl_msi_delay(0) <= '1';
+      end if;
+      
+      if tl_msi_delay(tl_msi_delay'left) = '1' and is_zero(tl_msi_delay(tl_msi_delay'left-1 downto 0)) = '1' then
+        cfg_msicsr_o <= tl_cfg_ctl(15 downto 0);
+      end if;
     end if;
   end process;
   
-  -- Decode one-hot
-  rx_wb_bar_o(0) <= (rx_st_bardec0(1) or rx_st_bardec0(3) or rx_st_bardec0(5) or rx_st_bardec0(7));
-  rx_wb_bar_o(1) <= (rx_st_bardec0(2) or rx_st_bardec0(3) or rx_st_bardec0(6) or rx_st_bardec0(7));
-  rx_wb_bar_o(2) <= (rx_st_bardec0(4) or rx_st_bardec0(5) or rx_st_bardec0(6) or rx_st_bardec0(7));
+  -- Decode one-hot, stored with the data in the input FIFO
+  s_rx_wbar(0) <= (rx_st_bardec0(1) or rx_st_bardec0(3) or rx_st_bardec0(5) or rx_st_bardec0(7));
+  s_rx_wbar(1) <= (rx_st_bardec0(2) or rx_st_bardec0(3) or rx_st_bardec0(6) or rx_st_bardec0(7));
+  s_rx_wbar(2) <= (rx_st_bardec0(4) or rx_st_bardec0(5) or rx_st_bardec0(6) or rx_st_bardec0(7));
   
   -- Stream rx data out as wishbone
   rx_wb_stb_o <= r32_full;
   rx_wb_dat_o <= r32_dat0;
+  rx_wb_bar_o <= r32_bar;
   
   -- Advance state if the WB RX bus made progress
   s32_progress <= r32_full and not rx_wb_stall_i;
@@ -517,6 +549,7 @@ begin
         r32_dat0 <= s64_dat(31 downto 0);
         r32_dat1 <= s64_dat(63 downto 32);
         r32_skip <= s64_skip;
+        r32_bar  <= s64_bar;
       end if;
       
       if s32_word = '1' then
@@ -528,30 +561,42 @@ begin
   -- Is the Avalon bus filling data this cycle?
   s64_filling <= rx_st_valid0 and r64_ready(r64_ready'length-1);
   -- Can we provide data to the 32-bit layer on this cycle?
-  s64_valid <= r64_full or s64_filling;
-  -- We need to refill our buffer if we were empty or just got drained
-  s64_need_refill <= s64_advance or not s64_valid;
+  s_rx_level <= r_rx_wr - r_rx_rd;
+  s64_valid <= active_high(s_rx_level /= 0);
   
-  -- Supply the 64-bit data to the 32-bit stream with possible asynchronous bypass
-  s64_dat <= r64_dat when r64_full = '1' else rx_st_data0;
-  s64_skip <= r64_skip when r64_full = '1' else is_zero(rx_st_be0(7 downto 4));
+  -- Supply the 64-bit data to the 32-bit stream from the FIFO
+  s64_dat  <= rx_fifo(to_integer(r_rx_rd(rx_fifo_bits-1 downto 0)))(63 downto 0);
+  s64_skip <= rx_fifo(to_integer(r_rx_rd(rx_fifo_bits-1 downto 0)))(64);
+  s64_bar  <= rx_fifo(to_integer(r_rx_rd(rx_fifo_bits-1 downto 0)))(67 downto 65);
   
-  -- Issue a fetch only if we need refill and no fetch is pending
-  rx_st_ready0 <= s64_need_refill and is_zero(r64_ready(r64_ready'length-2 downto 0));
+  -- Issue a fetch only if the FIFO has room for its data and the data of all pending fetches
+  with r64_ready select s_rx_inflight <=
+    "000" when "00",
+    "010" when "11",
+    "001" when others;
+  rx_st_ready0 <= active_high(s_rx_level + s_rx_inflight < 2**rx_fifo_bits);
   
   rx_data64 : process(core_clk_out)
   begin
     if rising_edge(core_clk_out) then
       if rstn = '0' then
-        r64_full <= '0';
+        r_rx_wr <= (others => '0');
+        r_rx_rd <= (others => '0');
         r64_ready <= (others => '0');
       else
-        r64_full <= not s64_need_refill;
         r64_ready <= r64_ready(r64_ready'length-2 downto 0) & rx_st_ready0;
+        if s64_filling = '1' then
+          r_rx_wr <= r_rx_wr + 1;
+        end if;
+        if s64_advance = '1' then
+          r_rx_rd <= r_rx_rd + 1;
+        end if;
       end if;
       
-      r64_dat <= s64_dat;
-      r64_skip <= s64_skip;
+      if s64_filling = '1' then
+        rx_fifo(to_integer(r_rx_wr(rx_fifo_bits-1 downto 0))) <= 
+          s_rx_wbar & is_zero(rx_st_be0(7 downto 4)) & rx_st_data0;
+      end if;
     end if;
   end process;
   
@@ -0,0 +1,452 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+-- Bus-mastering DMA from the FPGA into host memory.
+--
+-- Words written into the data window are collected in a fifo and sent as posted
+-- memory write TLPs into a ring of host buffers. The host gives the physical
+-- address of every buffer (descriptor table), reads the data behind the write
+-- pointer and returns the space by writing the read pointer. The write pointer is
+-- also written into host memory (write-back address) when a buffer is full or
+-- when the flush time expires, so the host never has to read over PCIe.
+-- Memory writes are strictly ordered: the write-back arrives after the data.
+--
+-- Registers (byte offsets):
+--   0x000 control  rw  bit0 enable, bit1 clear pointers and fifo (write '1')
+--   0x004 status   r   bits 15..0 words in the fifo, bit16 sending, bit17 ring full
+--   0x008 config   rw  bits 3..0 log2 buffer size in bytes (7..12),
+--                      bits 11..8 log2 number of buffers (0..g_buffer_bits)
+--   0x00c flush    rw  clock cycles before a partial TLP or the write-back is sent,
+--                      0: only full TLPs, write-back when a buffer is full
+--   0x010 wrptr    r   bytes written into the ring, free running
+--   0x014 rdptr    rw  bytes consumed by the host, free running
+--   0x018 wb_lo    rw  host address of the write-back, 0: no write-back
+--   0x01c wb_hi    rw
+--   0x020 tlps     r   data TLPs sent
+--   0x200+8*n      w   host address of buffer n, low word, aligned to the buffer size
+--   0x204+8*n      w   host address of buffer n, high word, 0: 3DW header
+--   0x400..0x7ff   w   data window, every write pushes one word
+--
+-- A data TLP carries at most c_max_words: the TX queue of pcie_altera must hold the
+-- whole TLP (header, pad and payload are allocated per word) before it is sent.
+-- Buffers of at most 4KB aligned to their size never cross a 4KB boundary.
+
+entity pcie_dma is
+  generic(
+    g_buffer_bits : natural := 6;  -- 2**g_buffer_bits descriptors
+    g_fifo_bits   : natural := 9); -- 2**g_fifo_bits words of data fifo
+  port(
+    clk_i         : in  std_logic;
+    rstn_i        : in  std_logic;
+
+    -- Registers and data window
+    wb_cyc_i      : in  std_logic;
+    wb_stb_i      : in  std_logic;
+    wb_adr_i      : in  std_logic_vector(31 downto 0);
+    wb_we_i       : in  std_logic;
+    wb_sel_i      : in  std_logic_vector(3 downto 0);
+    wb_dat_i      : in  std_logic_vector(31 downto 0);
+    wb_stall_o    : out std_logic;
+    wb_ack_o      : out std_logic;
+    wb_dat_o      : out std_logic_vector(31 downto 0);
+
+    -- TX arbitration with the completions of pcie_tlp
+    tx_busy_i     : in  std_logic; -- pcie_tlp is sending a completion
+    tx_block_o    : out std_logic; -- pcie_tlp may not start a completion
+
+    tx_rdy_i      : in  std_logic;
+    tx_alloc_o    : out std_logic;
+    tx_en_o       : out std_logic;
+    tx_dat_o      : out std_logic_vector(31 downto 0);
+    tx_eop_o      : out std_logic;
+    tx_pad_o      : out std_logic;
+
+    cfg_busdev_i  : in  std_logic_vector(12 downto 0);
+    irq_o         : out std_logic); -- write pointer written back
+end pcie_dma;
+
+architecture rtl of pcie_dma is
+  type dma_state_type is (d_idle, d_arb, d_h0, d_h1, d_h2, d_h3, d_pad, d_data);
+
+  constant c_max_words : natural := 32; -- 128 bytes, the smallest max payload size
+
+  type fifo_type is array(2**g_fifo_bits-1 downto 0) of std_logic_vector(31 downto 0);
+  type desc_type is array(2**g_buffer_bits-1 downto 0) of std_logic_vector(31 downto 0);
+
+  signal dma_state : dma_state_type := d_idle;
+
+  -- Data fifo
+  signal fifo : fifo_type;
+  signal r_fifo_w, r_fifo_r, s_fifo_rd, s_level : unsigned(g_fifo_bits downto 0);
+  signal r_fifo_q : std_logic_vector(31 downto 0);
+  signal s_push, s_pop, s_full : std_logic;
+
+  -- Descriptor table
+  signal desc_lo, desc_hi : desc_type;
+  signal r_desc_lo, r_desc_hi : std_logic_vector(31 downto 0);
+  signal s_desc_we : std_logic;
+
+  -- Wishbone slave
+  signal s_stb, s_data_win, s_stall : std_logic;
+  signal r_ack : std_logic;
+
+  -- Registers
+  signal r_enable, r_clear, r_clear_done : std_logic;
+  signal r_buf_log2   : unsigned(3 downto 0);
+  signal r_ring_log2  : unsigned(3 downto 0);
+  signal r_buf_mask   : unsigned(31 downto 0);
+  signal r_ring_mask  : unsigned(31 downto 0);
+  signal r_flush      : unsigned(31 downto 0);
+  signal r_wrptr, r_rdptr, r_wb_ptr : unsigned(31 downto 0);
+  signal r_wb_addr    : std_logic_vector(63 downto 0);
+  signal r_tlps       : unsigned(31 downto 0);
+
+  -- Common subexpressions:
+  signal s_used, s_free, s_buf_left : unsigned(31 downto 0);
+  signal s_limit, s_len, s_free_words, s_level_words : unsigned(9 downto 0);
+  signal s_ring_idx : unsigned(g_buffer_bits-1 downto 0);
+  signal s_timeout, s_ring_full : boolean;
+
+  -- TLP being sent
+  signal r_wb, r_4dw, r_partial : std_logic;
+  signal r_len, r_left : unsigned(9 downto 0);
+  signal r_addr : std_logic_vector(63 downto 0);
+  signal r_timer : unsigned(31 downto 0);
+  signal r_wb_pending : std_logic;
+
+  signal r_tx_en, r_block : std_logic;
+
+  function f_min(a, b : unsigned) return unsigned is
+  begin
+    if a < b then
+      return a;
+    else
+      return b;
+    end if;
+  end f_min;
+begin
+  ----------------- Wishbone slave --------------------
+  s_stb      <= wb_cyc_i and wb_stb_i;
+  s_data_win <= wb_adr_i(10);
+  s_stall    <= s_data_win and s_full;
+  s_push     <= s_stb and wb_we_i and s_data_win and not s_full;
+  s_desc_we  <= s_stb and wb_we_i and not wb_adr_i(10) and wb_adr_i(9);
+
+  wb_stall_o <= s_stall;
+  wb_ack_o   <= r_ack;
+
+  slave : process(clk_i)
+  begin
+    if rising_edge(clk_i) then
+      if rstn_i = '0' then
+        r_ack       <= '0';
+        r_enable    <= '0';
+        r_clear     <= '0';
+        r_buf_log2  <= to_unsigned(12, 4);
+        r_ring_log2 <= to_unsigned(0, 4);
+        r_flush     <= to_unsigned(256, 32);
+        r_rdptr     <= (others => '0');
+        r_wb_addr   <= (others => '0');
+      else
+        r_ack <= s_stb and not s_stall;
+
+        if r_clear_done = '1' then
+          r_clear <= '0';
+          r_rdptr <= (others => '0');
+        end if;
+
+        if s_stb = '1' and wb_we_i = '1' and wb_adr_i(10 downto 9) = "00" then
+          case wb_adr_i(5 downto 2) is
+            when "0000" =>
+              r_enable <= wb_dat_i(0);
+              if wb_dat_i(1) = '1' then
+                r_clear <= '1';
+              end if;
+            when "0010" =>
+              -- Keep the buffer size between 128 bytes and 4KB
+              if unsigned(wb_dat_i(3 downto 0)) < 7 then
+                r_buf_log2 <= to_unsigned(7, 4);
+              elsif unsigned(wb_dat_i(3 downto 0)) > 12 then
+                r_buf_log2 <= to_unsigned(12, 4);
+              else
+                r_buf_log2 <= unsigned(wb_dat_i(3 downto 0));
+              end if;
+              if unsigned(wb_dat_i(11 downto 8)) > g_buffer_bits then
+                r_ring_log2 <= to_unsigned(g_buffer_bits, 4);
+              else
+                r_ring_log2 <= unsigned(wb_dat_i(11 downto 8));
+              end if;
+            when "0011" => r_flush <= unsigned(wb_dat_i);
+            when "0101" => r_rdptr <= unsigned(wb_dat_i);
+            when "0110" => r_wb_addr(31 downto  2) <= wb_dat_i(31 downto 2);
+            when "0111" => r_wb_addr(63 downto 32) <= wb_dat_i;
+            when others => null;
+          end case;
+        end if;
+
+        wb_dat_o <= (others => '0');
+        if wb_adr_i(10 downto 9) = "00" then
+          case wb_adr_i(5 downto 2) is
+            when "0000" => wb_dat_o(1 downto 0) <= r_clear & r_enable;
+            when "0001" =>
+              wb_dat_o(15 downto 0) <= std_logic_vector(resize(s_level, 16));
+              if dma_state /= d_idle then
+                wb_dat_o(16) <= '1';
+              end if;
+              if s_ring_full then
+                wb_dat_o(17) <= '1';
+              end if;
+            when "0010" =>
+              wb_dat_o( 3 downto 0) <= std_logic_vector(r_buf_log2);
+              wb_dat_o(11 downto 8) <= std_logic_vector(r_ring_log2);
+            when "0011" => wb_dat_o <= std_logic_vector(r_flush);
+            when "0100" => wb_dat_o <= std_logic_vector(r_wrptr);
+            when "0101" => wb_dat_o <= std_logic_vector(r_rdptr);
+            when "0110" => wb_dat_o <= r_wb_addr(31 downto  0);
+            when "0111" => wb_dat_o <= r_wb_addr(63 downto 32);
+            when "1000" => wb_dat_o <= std_logic_vector(r_tlps);
+            when others => null;
+          end case;
+        end if;
+      end if;
+
+      -- buffer and ring masks follow the config register
+      r_buf_mask  <= shift_left(to_unsigned(1, 32), to_integer(r_buf_log2)) - 1;
+      r_ring_mask <= shift_left(to_unsigned(1, 32), to_integer(r_buf_log2 + r_ring_log2)) - 1;
+    end if;
+  end process;
+
+  descriptors : process(clk_i)
+  begin
+    if rising_edge(clk_i) then
+      if s_desc_we = '1' then
+        if wb_adr_i(2) = '0' then
+          desc_lo(to_integer(unsigned(wb_adr_i(g_buffer_bits+2 downto 3)))) <= wb_dat_i;
+        else
+          desc_hi(to_integer(unsigned(wb_adr_i(g_buffer_bits+2 downto 3)))) <= wb_dat_i;
+        end if;
+      end if;
+      r_desc_lo <= desc_lo(to_integer(s_ring_idx));
+      r_desc_hi <= desc_hi(to_integer(s_ring_idx));
+    end if;
+  end process;
+
+  ----------------- Data fifo --------------------
+  -- r_fifo_q is the word at r_fifo_r; a word is read again every cycle, so it is
+  -- valid one cycle after it was written (the header takes longer than that)
+  s_level   <= r_fifo_w - r_fifo_r;
+  s_full    <= s_level(g_fifo_bits);
+  s_pop     <= tx_rdy_i when dma_state = d_data and r_wb = '0' else '0';
+  s_fifo_rd <= r_fifo_r + 1 when s_pop = '1' else r_fifo_r;
+
+  data_fifo : process(clk_i)
+  begin
+    if rising_edge(clk_i) then
+      if rstn_i = '0' then
+        r_fifo_w <= (others => '0');
+      else
+        if s_push = '1' then
+          fifo(to_integer(r_fifo_w(g_fifo_bits-1 downto 0))) <= wb_dat_i;
+          r_fifo_w <= r_fifo_w + 1;
+        end if;
+      end if;
+      r_fifo_q <= fifo(to_integer(s_fifo_rd(g_fifo_bits-1 downto 0)));
+    end if;
+  end process;
+
+  ----------------- Ring state --------------------
+  s_used      <= r_wrptr - r_rdptr;
+  s_free      <= (others => '0') when s_used > r_ring_mask else r_ring_mask + 1 - s_used;
+  s_ring_full <= s_free < 4;
+  s_buf_left  <= r_buf_mask + 1 - (r_wrptr and r_buf_mask);
+  s_ring_idx  <= resize(shift_right(r_wrptr and r_ring_mask, to_integer(r_buf_log2)), g_buffer_bits);
+
+  -- Words in the next TLP: a full TLP ends at the max payload or the end of the buffer
+  s_free_words  <= to_unsigned(c_max_words, 10) when s_free(31 downto 2) > c_max_words else
+                   resize(s_free(11 downto 2), 10);
+  s_level_words <= to_unsigned(c_max_words, 10) when s_level > c_max_words else
+                   resize(s_level, 10);
+  s_limit       <= to_unsigned(c_max_words, 10) when s_buf_left(31 downto 2) > c_max_words else
+                   resize(s_buf_left(11 downto 2), 10);
+  s_len         <= f_min(f_min(s_limit, s_level_words), s_free_words);
+  s_timeout <= r_flush /= 0 and r_timer >= r_flush;
+
+  tx_en_o    <= r_tx_en;
+  tx_alloc_o <= r_tx_en;
+  tx_block_o <= r_block;
+
+  dma_state_machine : process(clk_i) is
+    variable next_state : dma_state_type;
+  begin
+    if rising_edge(clk_i) then
+      if rstn_i = '0' then
+        dma_state    <= d_idle;
+        r_fifo_r     <= (others => '0');
+        r_wrptr      <= (others => '0');
+        r_wb_ptr     <= (others => '0');
+        r_tlps       <= (others => '0');
+        r_timer      <= (others => '0');
+        r_wb_pending <= '0';
+        r_clear_done <= '0';
+        r_block      <= '0';
+        r_tx_en      <= '0';
+        irq_o        <= '0';
+      else
+        r_clear_done <= '0';
+        r_tx_en  <= '0';
+        irq_o    <= '0';
+        tx_eop_o <= '0';
+        tx_pad_o <= '0';
+        tx_dat_o <= (others => '-');
+
+        if s_pop = '1' then
+          r_fifo_r <= r_fifo_r + 1;
+        end if;
+
+        next_state := dma_state;
+        case dma_state is
+          when d_idle =>
+            if (s_level /= 0 or r_wb_ptr /= r_wrptr) and r_enable = '1' and not s_timeout then
+              r_timer <= r_timer + 1;
+            end if;
+
+            if r_clear = '1' and r_clear_done = '0' then
+              r_clear_done <= '1';
+              r_fifo_r     <= r_fifo_w;
+              r_wrptr      <= (others => '0');
+              r_wb_ptr     <= (others => '0');
+              r_timer      <= (others => '0');
+              r_wb_pending <= '0';
+            elsif r_enable = '0' then
+              null;
+            elsif r_wb_pending = '1' or
+                  (r_wb_ptr /= r_wrptr and r_wb_addr /= x"0000000000000000" and s_timeout and s_len = 0) then
+              -- Write-back of the write pointer
+              r_wb   <= '1';
+              r_len  <= to_unsigned(1, 10);
+              r_left <= to_unsigned(1, 10);
+              r_block <= '1';
+              next_state := d_arb;
+            elsif s_len /= 0 and (s_len = s_limit or s_timeout) then
+              r_wb   <= '0';
+              r_partial <= '0';
+              if s_len /= s_limit then
+                r_partial <= '1';
+              end if;
+              r_len  <= s_len;
+              r_left <= s_len;
+              r_block <= '1';
+              next_state := d_arb;
+            end if;
+
+          when d_arb =>
+            -- r_block is seen by pcie_tlp: a completion in progress is finished first
+            if tx_busy_i = '0' then
+              if r_wb = '1' then
+                r_addr <= r_wb_addr;
+              else
+                r_addr <= r_desc_hi & (r_desc_lo or std_logic_vector(r_wrptr and r_buf_mask));
+              end if;
+              next_state := d_h0;
+            end if;
+            r_timer <= (others => '0');
+            r_4dw <= '1';
+            if r_wb = '1' and r_wb_addr(63 downto 32) = x"00000000" then
+              r_4dw <= '0';
+            end if;
+            if r_wb = '0' and r_desc_hi = x"00000000" then
+              r_4dw <= '0';
+            end if;
+
+          when d_h0 =>
+            -- Memory write, no TC, strict ordering
+            tx_dat_o <= "01" & r_4dw & "00000" & x"00" & "000000" & std_logic_vector(r_len);
+            if tx_rdy_i = '1' then
+              r_tx_en <= '1';
+              next_state := d_h1;
+            end if;
+
+          when d_h1 =>
+            tx_dat_o <= cfg_busdev_i & "000" & x"00" & "0000" & "1111";
+            if r_len /= 1 then
+              tx_dat_o(7 downto 4) <= "1111";
+            end if;
+            if tx_rdy_i = '1' then
+              r_tx_en <= '1';
+              next_state := d_h2;
+            end if;
+
+          when d_h2 =>
+            if r_4dw = '1' then
+              tx_dat_o <= r_addr(63 downto 32);
+            else
+              tx_dat_o <= r_addr(31 downto 2) & "00";
+              -- Qword aligned data starts in the next qword
+              tx_pad_o <= not r_addr(2);
+            end if;
+            if tx_rdy_i = '1' then
+              r_tx_en <= '1';
+              if r_4dw = '1' then
+                next_state := d_h3;
+              else
+                next_state := d_data;
+              end if;
+            end if;
+
+          when d_h3 =>
+            tx_dat_o <= r_addr(31 downto 2) & "00";
+            if tx_rdy_i = '1' then
+              r_tx_en <= '1';
+              if r_addr(2) = '1' then
+                next_state := d_pad;
+              else
+                next_state := d_data;
+              end if;
+            end if;
+
+          when d_pad =>
+            -- Misaligned data after a 4DW header starts in the upper half of a qword
+            tx_dat_o <= (others => '0');
+            if tx_rdy_i = '1' then
+              r_tx_en <= '1';
+              next_state := d_data;
+            end if;
+
+          when d_data =>
+            if r_wb = '1' then
+              tx_dat_o <= std_logic_vector(r_wrptr);
+            else
+              tx_dat_o <= r_fifo_q;
+            end if;
+            if r_left = 1 then
+              tx_eop_o <= '1';
+            end if;
+            if tx_rdy_i = '1' then
+              r_tx_en <= '1';
+              r_left  <= r_left - 1;
+              if r_left = 1 then
+                r_block <= '0';
+                next_state := d_idle;
+                if r_wb = '1' then
+                  r_wb_ptr     <= r_wrptr;
+                  r_wb_pending <= '0';
+                  irq_o        <= '1';
+                else
+                  r_wrptr <= r_wrptr + (r_len & "00");
+                  r_tlps  <= r_tlps + 1;
+                  -- Buffer full or data flushed: tell the host
+                  if ((r_wrptr + (r_len & "00") and r_buf_mask) = 0 or r_partial = '1') and
+                     r_wb_addr /= x"0000000000000000" then
+                    r_wb_pending <= '1';
+                  end if;
+                end if;
+              end if;
+            end if;
+        end case;
+
+        dma_state <= next_state;
+      end if;
+    end if;
+  end process;
+end rtl;
@@ -18,6 +18,8 @@ entity pcie_tlp is
     tx_dat_o      : out std_logic_vector(31 downto 0);
     tx_eop_o      : out std_logic;
     tx_pad_o      : out std_logic;
+    tx_busy_o     : out std_logic; -- a completion is being sent
+    tx_block_i    : in  std_logic; -- do not start a completion (pcie_dma)
     
     cfg_busdev_i  : in  std_logic_vector(12 downto 0);
     
@@ -34,8 +36,13 @@ entity pcie_tlp is
     wb_dat_i      : in  std_logic_vector(31 downto 0));
 end pcie_tlp;
 
+-- Reads of more than one word are pipelined on the wishbone bus (one strobe per
+-- cycle while not stalled). The completion is split at 128 byte boundaries, the
+-- smallest max payload size: every completion fits in the TX queue of pcie_altera,
+-- and every completion but the last ends on a read completion boundary.
+
 architecture rtl of pcie_tlp is
-  type rx_state_type is (h0, h_completion1, h_completion2, h_request, h_high_addr, h_low_addr, p_w0, p_wx, p_we, p_rs, p_r0, p_rx, p_re);
+  type rx_state_type is (h0, h_completion1, h_completion2, h_request, h_high_addr, h_low_addr, p_w0, p_wx, p_we, p_rs, p_r0, p_rx, p_re, p_rn);
   type tx_state_type is (c0, c1, c2, c_block, c_queue);
   
   signal rx_state : rx_state_type := h0;
@@ -50,6 +57,8 @@ architecture rtl of pcie_tlp is
   signal s_last_be     : std_logic_vector(3 downto 0);
   signal s_first_be    : std_logic_vector(3 downto 0);
   
+  constant c_cpl_words : natural := 32; -- 128 bytes
+  
   signal s_missing     : unsigned(2 downto 0);
   signal s_bytes       : std_logic_vector(11 downto 0);
   signal s_low_addr    : std_logic_vector(6 downto 0);
@@ -69,6 +78,9 @@ architecture rtl of pcie_tlp is
   signal s_length_eq1, s_length_eq2 : boolean;
   signal s_address_p4 : std_logic_vector(63 downto 0);
   signal s_fmt_is_read : boolean;
+  signal s_cpl_max, s_cpl_length : unsigned(9 downto 0);
+  signal s_cpl_boundary : boolean;
+  signal s_rx_have_addr : boolean;
   
   -- Stall and strobe bypass mux
   signal r_always_stall, r_never_stall : std_logic;
@@ -76,7 +88,7 @@ architecture rtl of pcie_tlp is
   
   -- Inflight reads and writes
   signal wb_stb : std_logic;
-  signal r_flight_count : unsigned(4 downto 0);
+  signal r_flight_count : unsigned(5 downto 0);
   
   signal r_tx_en, r_tx_alloc, r_rx_alloc : std_logic;
   signal r_pending_ack : unsigned(9 downto 0);
@@ -105,6 +117,12 @@ begin
   s_length_eq1 <= r_length = 1;
   s_length_eq2 <= r_length = 2;
   
+  -- Words up to the next 128 byte boundary, the length of this completion
+  s_cpl_max <= to_unsigned(c_cpl_words, 10) - unsigned(r_address(6 downto 2));
+  s_cpl_length <= s_cpl_max when r_length = 0 or r_length > s_cpl_max else r_length;
+  s_cpl_boundary <= r_address(6 downto 2) = "11111";
+  s_rx_have_addr <= rx_state /= h_request and rx_state /= h_high_addr and rx_state /= h_low_addr;
+  
   s_address_p4 <= r_address(63 downto 24) & 
                   std_logic_vector(unsigned(r_address(23 downto 0)) + to_unsigned(4, 24));
   
@@ -143,6 +161,7 @@ begin
           when p_r0 => null;
           when p_rx => null;
           when p_re => null;
+          when p_rn => null;
         end case;
               
         ----------------- Transition rules --------------------
@@ -193,6 +212,8 @@ begin
                 next_state := p_rs;
               end if;
             end if;
+          -- Memory write: each data word of the TLP is one pipelined strobe, a stall of the
+          -- bus holds the RX stream (the input FIFO of pcie_altera keeps the burst going)
           when p_w0 =>
             if (rx_wb_stb_i and not wb_stall_i) = '1' then
               if s_length_eq1 then
@@ -222,9 +243,11 @@ begin
               next_state := p_r0;
             end if;
           when p_r0 =>
-            if (not wb_stall_i) = '1' then
+            if (wb_stb and not wb_stall_i) = '1' then
               if s_length_eq1 then
                 next_state := h0;
+              elsif s_cpl_boundary then
+                next_state := p_rn;
               elsif s_length_eq2 then
                 next_state := p_re;
               else
@@ -232,19 +255,37 @@ begin
               end if;
               r_length <= s_length_m1;
               r_address <= s_address_p4;
+              -- The next completion starts with a whole word, or with the last word
+              if s_length_eq2 then
+                r_first_be <= r_last_be;
+              else
+                r_first_be <= x"f";
+              end if;
             end if;
           when p_rx =>
-            if (not wb_stall_i) = '1' then
-              if s_length_eq2 then
+            if (wb_stb and not wb_stall_i) = '1' then
+              if s_cpl_boundary then
+                next_state := p_rn;
+              elsif s_length_eq2 then
                 next_state := p_re;
               end if;
               r_length <= s_length_m1;
               r_address <= s_address_p4;
+              if s_length_eq2 then
+                r_first_be <= r_last_be;
+              else
+                r_first_be <= x"f";
+              end if;
             end if;
           when p_re =>
-            if (not wb_stall_i) = '1' then
+            if (wb_stb and not wb_stall_i) = '1' then
               next_state := h0;
             end if;
+          when p_rn =>
+            -- The data of this completion is queued, send the next header
+            if tx_state /= c_queue then
+              next_state := p_rs;
+            end if;
         end case;
         
         ----------------- Post-transition actions --------------------
@@ -283,7 +324,10 @@ begin
             r_never_stb <= '0';
             wb_sel_o <= r_last_be;
             wb_we_o <= '1';
-          when p_rs => null;
+          -- No RX words while the completion header is queued, the request has no data
+          -- and the next TLP must wait for h0
+          when p_rs =>
+            r_always_stall <= '1';
           when p_r0 =>
             r_always_stall <= '1';
             r_always_stb <= tx_rdy_i;
@@ -302,6 +346,8 @@ begin
             r_rx_alloc <= tx_rdy_i;
             wb_sel_o <= r_last_be;
             wb_we_o <= '0';
+          when p_rn =>
+            r_always_stall <= '1';
         end case;
       end if;
     end if;
@@ -349,6 +395,7 @@ begin
   
   -- register: tx_en_o and tx_alloc_o
   tx_en_o <= r_tx_en;
+  tx_busy_o <= '1' when tx_state /= c0 or r_tx_en = '1' else '0';
   tx_alloc_o <= r_tx_alloc or r_rx_alloc;
   tx_state_machine : process(clk_i) is
     variable next_state : tx_state_type;
@@ -398,17 +445,20 @@ begin
         tx_state <= next_state;
         case next_state is
           when c0 =>
-            r_pending_ack <= r_length;
+            r_pending_ack <= s_cpl_length;
             -- r_length, r_tc, r_attr: all set on exit of h0
+            -- s_cpl_length: also depends on the address when more than one word is read
             tx_dat_o <= "01001010" -- Completion with data
                       & "0" & r_tc & "0" & r_attr(2 downto 2) & "00"
-                      & "00" & r_attr(1 downto 0) & "00" & std_logic_vector(r_length);
-            if s_fmt_is_read and rx_state /= h0 and tx_rdy_i = '1' then
+                      & "00" & r_attr(1 downto 0) & "00" & std_logic_vector(s_cpl_length);
+            if s_fmt_is_read and rx_state /= h0 and (s_length_eq1 or s_rx_have_addr) and
+               tx_rdy_i = '1' and tx_block_i = '0' then
               r_tx_alloc <= '1';
               r_tx_en <= '1';
             end if;
           when c1 =>
             -- s_bytes: depends on first_be/last_be: set on exit of h_request
+            -- byte count: the bytes left of the request, also in the later completions
             tx_dat_o <= cfg_busdev_i & "0000000" & s_bytes;
             if rx_state /= h_request and tx_rdy_i = '1' then
               r_tx_alloc <= '1';
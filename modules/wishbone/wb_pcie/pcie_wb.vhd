@@ -21,7 +21,10 @@ entity pcie_wb is
     
     wb_clk        : in  std_logic; -- Whatever clock you want these signals on:
     master_o      : out t_wishbone_master_out;
-    master_i      : in  t_wishbone_master_in);
+    master_i      : in  t_wishbone_master_in;
+    dma_slave_i   : in  t_wishbone_slave_in := cc_dummy_slave_in; -- pcie_dma, on wb_clk
+    dma_slave_o   : out t_wishbone_slave_out;
+    irq_i         : in  std_logic_vector(30 downto 0) := (others => '0')); -- to the host, on wb_clk
 end pcie_wb;
 
 architecture rtl of pcie_wb is
@@ -36,23 +39,48 @@ architecture rtl of pcie_wb is
   signal tx_rdy, tx_alloc, tx_en, tx_eop, tx_pad : std_logic;
   signal tx_dat : std_logic_vector(31 downto 0);
   
+  -- TX of the completions (pcie_tlp) and the DMA writes (pcie_dma)
+  signal tlp_alloc, tlp_en, tlp_eop, tlp_pad, tlp_busy : std_logic;
+  signal dma_alloc, dma_en, dma_eop, dma_pad, dma_block : std_logic;
+  signal tlp_dat, dma_dat : std_logic_vector(31 downto 0);
+  
+  signal dma_i : t_wishbone_slave_in;
+  signal dma_o : t_wishbone_slave_out;
+  
   signal wb_stb, wb_ack, wb_stall : std_logic;
   signal wb_adr : std_logic_vector(63 downto 0);
   signal wb_bar : std_logic_vector(2 downto 0);
   signal wb_dat : std_logic_vector(31 downto 0);
   
   signal cfg_busdev : std_logic_vector(12 downto 0);
+  signal cfg_msicsr : std_logic_vector(15 downto 0);
+  
+  -- Interrupts to the host: bit 31 is pcie_dma, bits 30..0 are irq_i
+  signal dma_irq, msi_ack, s_irq_active : std_logic;
+  signal r_irq_toggle : std_logic_vector(30 downto 0) := (others => '0'); -- wb_clk
+  signal r_irq_in     : std_logic_vector(30 downto 0) := (others => '0'); -- wb_clk
+  signal r_irq_sync0, r_irq_sync1, r_irq_sync2 : std_logic_vector(30 downto 0) := (others => '0');
+  signal s_irq_new    : std_logic_vector(31 downto 0);
   
   signal slave_i : t_wishbone_slave_in;
   signal slave_o : t_wishbone_slave_out;
   
   -- timing registers
-  signal r_sdb, r_high, r_ack : std_logic;
+  signal r_sdb, r_high, r_ack, r_irq : std_logic;
+  signal r_irq_sel : std_logic_vector(1 downto 0);
   
   -- control registers
   signal r_cyc   : std_logic;
   signal r_addr  : std_logic_vector(31 downto 16);
   signal r_error : std_logic_vector(63 downto  0);
+  
+  -- interrupt registers
+  signal r_irq_pending : std_logic_vector(31 downto 0) := (others => '0');
+  signal r_irq_mask    : std_logic_vector(31 downto 0) := (others => '0');
+  signal r_irq_enable  : std_logic := '0';
+  signal r_msi_req     : std_logic;
+  signal r_msi_armed   : std_logic;
+  signal r_msi_count   : unsigned(15 downto 0);
 begin
 
   pcie_phy : pcie_altera port map(
@@ -66,6 +94,12 @@ begin
     pcie_tx_o     => pcie_tx_o,
 
     cfg_busdev_o  => cfg_busdev,
+    cfg_msicsr_o  => cfg_msicsr,
+    
+    app_msi_req_i => r_msi_req,
+    app_msi_num_i => (others => '0'),
+    app_msi_ack_o => msi_ack,
+    app_int_sts_i => s_irq_active and not cfg_msicsr(0),
 
     wb_clk_o      => internal_wb_clk,
     
@@ -91,11 +125,13 @@ begin
     rx_wb_stall_o => rx_wb_stall,
     
     tx_rdy_i      => tx_rdy,
-    tx_alloc_o    => tx_alloc,
-    tx_en_o       => tx_en,
-    tx_dat_o      => tx_dat,
-    tx_eop_o      => tx_eop,
-    tx_pad_o      => tx_pad,
+    tx_alloc_o    => tlp_alloc,
+    tx_en_o       => tlp_en,
+    tx_dat_o      => tlp_dat,
+    tx_eop_o      => tlp_eop,
+    tx_pad_o      => tlp_pad,
+    tx_busy_o     => tlp_busy,
+    tx_block_i    => dma_block,
     
     cfg_busdev_i  => cfg_busdev,
       
@@ -111,19 +147,75 @@ begin
     wb_rty_i      => slave_o.rty,
     wb_dat_i      => wb_dat);
   
-  clock_crossing : xwb_clock_crossing port map(
+  -- Deep enough for the reads of a whole completion (128 bytes) in flight
+  clock_crossing : xwb_clock_crossing
+    generic map(
+      log2fifo    => 5)
+    port map(
+      rst_n_i       => rstn,
+      slave_clk_i   => internal_wb_clk,
+      slave_i       => slave_i,
+      slave_o       => slave_o,
+      master_clk_i  => wb_clk, 
+      master_i      => master_i,
+      master_o      => master_o);
+  
+  dma_crossing : xwb_clock_crossing port map(
     rst_n_i       => rstn,
-    slave_clk_i   => internal_wb_clk,
-    slave_i       => slave_i,
-    slave_o       => slave_o,
-    master_clk_i  => wb_clk, 
-    master_i      => master_i,
-    master_o      => master_o);
+    slave_clk_i   => wb_clk,
+    slave_i       => dma_slave_i,
+    slave_o       => dma_slave_o,
+    master_clk_i  => internal_wb_clk,
+    master_i      => dma_o,
+    master_o      => dma_i);
+  
+  pcie_dma_logic : pcie_dma port map(
+    clk_i         => internal_wb_clk,
+    rstn_i        => rstn,
+    
+    wb_cyc_i      => dma_i.cyc,
+    wb_stb_i      => dma_i.stb,
+    wb_adr_i      => dma_i.adr,
+    wb_we_i       => dma_i.we,
+    wb_sel_i      => dma_i.sel,
+    wb_dat_i      => dma_i.dat,
+    wb_stall_o    => dma_o.stall,
+    wb_ack_o      => dma_o.ack,
+    wb_dat_o      => dma_o.dat,
+    
+    tx_busy_i     => tlp_busy,
+    tx_block_o    => dma_block,
+    
+    tx_rdy_i      => tx_rdy,
+    tx_alloc_o    => dma_alloc,
+    tx_en_o       => dma_en,
+    tx_dat_o      => dma_dat,
+    tx_eop_o      => dma_eop,
+    tx_pad_o      => dma_pad,
+    
+    cfg_busdev_i  => cfg_busdev,
+    irq_o         => dma_irq);
+  
+  dma_o.err <= '0';
+  dma_o.rty <= '0';
+  dma_o.int <= '0';
+  
+  -- pcie_dma only sends while pcie_tlp is blocked and idle: the TLPs never interleave
+  tx_alloc <= tlp_alloc or dma_alloc;
+  tx_en    <= tlp_en    or dma_en;
+  tx_dat   <= dma_dat when dma_en = '1' else tlp_dat;
+  tx_eop   <= dma_eop when dma_en = '1' else tlp_eop;
+  tx_pad   <= dma_pad when dma_en = '1' else tlp_pad;
   
   slave_i.stb <= wb_stb        when wb_bar = "001" else '0';
   wb_stall    <= slave_o.stall when wb_bar = "001" else '0';
   wb_ack      <= slave_o.ack   when wb_bar = "001" else r_ack;
   wb_dat      <= slave_o.dat   when wb_bar = "001" else
+                 r_irq_pending         when r_irq = '1' and r_irq_sel = "00" else
+                 r_irq_mask            when r_irq = '1' and r_irq_sel = "01" else
+                 std_logic_vector(r_msi_count) & x"000" & '0' & r_irq_enable & r_msi_req & cfg_msicsr(0)
+                                       when r_irq = '1' and r_irq_sel = "10" else
+                 x"00000000"           when r_irq = '1' else
                  r_error(63 downto 32) when r_sdb = '0' and r_high = '1' else
                  r_error(31 downto  0) when r_sdb = '0' and r_high = '0' else
                  sdb_addr              when r_sdb = '1' and r_high = '0' else
@@ -133,9 +225,62 @@ begin
   slave_i.adr(r_addr'range) <= r_addr;
   slave_i.adr(r_addr'right-1 downto 0)  <= wb_adr(r_addr'right-1 downto 0);
   
+  -- An edge of irq_i toggles a bit that survives the clock crossing
+  irq_edge : process(wb_clk)
+  begin
+    if rising_edge(wb_clk) then
+      r_irq_in     <= irq_i;
+      r_irq_toggle <= r_irq_toggle xor (irq_i and not r_irq_in);
+    end if;
+  end process;
+  
+  irq_sync : process(internal_wb_clk)
+  begin
+    if rising_edge(internal_wb_clk) then
+      r_irq_sync0 <= r_irq_toggle;
+      r_irq_sync1 <= r_irq_sync0;
+      r_irq_sync2 <= r_irq_sync1;
+    end if;
+  end process;
+  
+  s_irq_new <= dma_irq & (r_irq_sync1 xor r_irq_sync2);
+  s_irq_active <= r_irq_enable when (r_irq_pending and r_irq_mask) /= x"00000000" else '0';
+  
+  -- One MSI per interrupt: re-armed when the host clears the pending bits.
+  -- Without MSI the pending bits drive the legacy INTx level.
+  msi : process(internal_wb_clk)
+  begin
+    if rising_edge(internal_wb_clk) then
+      if rstn = '0' then
+        r_msi_req   <= '0';
+        r_msi_armed <= '1';
+        r_msi_count <= (others => '0');
+      else
+        if r_msi_req = '1' then
+          if msi_ack = '1' then
+            r_msi_req   <= '0';
+            r_msi_count <= r_msi_count + 1;
+          end if;
+        elsif s_irq_active = '1' and cfg_msicsr(0) = '1' and r_msi_armed = '1' then
+          r_msi_req   <= '1';
+          r_msi_armed <= '0';
+        end if;
+        
+        -- A write to the status or control register re-arms the MSI
+        if wb_bar = "000" and wb_stb = '1' and slave_i.we = '1' and
+           (wb_adr(6 downto 2) = "01000" or wb_adr(6 downto 2) = "01010") then
+          r_msi_armed <= '1';
+        end if;
+      end if;
+    end if;
+  end process;
+  
   control : process(internal_wb_clk)
+    variable v_irq_clear : std_logic_vector(31 downto 0);
   begin
     if rising_edge(internal_wb_clk) then
+      v_irq_clear := (others => '0');
+      
       -- Shift in the error register
       if slave_o.ack = '1' or slave_o.err = '1' or slave_o.rty = '1' then
         r_error <= r_error(r_error'length-2 downto 0) & (slave_o.err or slave_o.rty);
@@ -147,6 +292,8 @@ begin
         r_ack <= wb_stb;
         r_high <= not wb_adr(2);
         r_sdb <= wb_adr(4);
+        r_irq <= wb_adr(5);
+        r_irq_sel <= wb_adr(3 downto 2);
         
         -- Is this a write to the register space?
         if wb_stb = '1' and slave_i.we = '1' then
@@ -163,8 +310,23 @@ begin
               r_addr(24 downto 16) <= slave_i.dat(24 downto 16);
             end if;
           end if;
+          -- Address 32 clears the pending interrupts written as '1'
+          if wb_adr(6 downto 2) = "01000" then
+            v_irq_clear := slave_i.dat;
+          end if;
+          -- Address 36 is the interrupt mask
+          if wb_adr(6 downto 2) = "01001" then
+            r_irq_mask <= slave_i.dat;
+          end if;
+          -- Address 40 bit 2 enables the interrupts
+          if wb_adr(6 downto 2) = "01010" then
+            r_irq_enable <= slave_i.dat(2);
+          end if;
         end if;
       end if;
+      
+      -- New interrupts win over the clear
+      r_irq_pending <= (r_irq_pending and not v_irq_clear) or s_irq_new;
     end if;
   end process;
 end rtl;
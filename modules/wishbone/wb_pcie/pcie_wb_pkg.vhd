@@ -19,7 +19,10 @@ package pcie_wb_pkg is
       
       wb_clk        : in  std_logic; -- Whatever clock you want these signals on:
       master_o      : out t_wishbone_master_out;
-      master_i      : in  t_wishbone_master_in);
+      master_i      : in  t_wishbone_master_in;
+      dma_slave_i   : in  t_wishbone_slave_in := cc_dummy_slave_in; -- pcie_dma, on wb_clk
+      dma_slave_o   : out t_wishbone_slave_out;
+      irq_i         : in  std_logic_vector(30 downto 0) := (others => '0')); -- to the host, on wb_clk
   end component;
   
   component pcie_altera is
@@ -35,6 +38,13 @@ package pcie_wb_pkg is
       pcie_tx_o     : out std_logic_vector(3 downto 0);
       
       cfg_busdev_o  : out std_logic_vector(12 downto 0); -- Configured Bus#:Dev#
+      cfg_msicsr_o  : out std_logic_vector(15 downto 0); -- MSI control, bit 0: enabled by the host
+      
+      -- Interrupts: MSI when enabled, else the legacy INTx level
+      app_msi_req_i : in  std_logic; -- hold until ack_o
+      app_msi_num_i : in  std_logic_vector(4 downto 0);
+      app_msi_ack_o : out std_logic;
+      app_int_sts_i : in  std_logic;
       
       -- Simplified wishbone output stream
       wb_clk_o      : out std_logic;
@@ -71,6 +81,8 @@ package pcie_wb_pkg is
       tx_dat_o      : out std_logic_vector(31 downto 0);
       tx_eop_o      : out std_logic;
       tx_pad_o      : out std_logic;
+      tx_busy_o     : out std_logic; -- a completion is being sent
+      tx_block_i    : in  std_logic; -- do not start a completion (pcie_dma)
       
       cfg_busdev_i  : in  std_logic_vector(12 downto 0);
       
@@ -86,4 +98,36 @@ package pcie_wb_pkg is
       wb_rty_i      : in  std_logic;
       wb_dat_i      : in  std_logic_vector(31 downto 0));
   end component;
+  
+  component pcie_dma is
+    generic(
+      g_buffer_bits : natural := 6;  -- 2**g_buffer_bits descriptors
+      g_fifo_bits   : natural := 9); -- 2**g_fifo_bits words of data fifo
+    port(
+      clk_i         : in  std_logic;
+      rstn_i        : in  std_logic;
+      
+      wb_cyc_i      : in  std_logic;
+      wb_stb_i      : in  std_logic;
+      wb_adr_i      : in  std_logic_vector(31 downto 0);
+      wb_we_i       : in  std_logic;
+      wb_sel_i      : in  std_logic_vector(3 downto 0);
+      wb_dat_i      : in  std_logic_vector(31 downto 0);
+      wb_stall_o    : out std_logic;
+      wb_ack_o      : out std_logic;
+      wb_dat_o      : out std_logic_vector(31 downto 0);
+      
+      tx_busy_i     : in  std_logic; -- pcie_tlp is sending a completion
+      tx_block_o    : out std_logic; -- pcie_tlp may not start a completion
+      
+      tx_rdy_i      : in  std_logic;
+      tx_alloc_o    : out std_logic;
+      tx_en_o       : out std_logic;
+      tx_dat_o      : out std_logic_vector(31 downto 0);
+      tx_eop_o      : out std_logic;
+      tx_pad_o      : out std_logic;
+      
+      cfg_busdev_i  : in  std_logic_vector(12 downto 0);
+      irq_o         : out std_logic); -- write pointer written back
+  end component;
 end pcie_wb_pkg;
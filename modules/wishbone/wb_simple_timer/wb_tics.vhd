@@ -6,7 +6,7 @@
 -- Author     : Grzegorz Daniluk
 -- Company    : Elproma
 -- Created    : 2011-04-03
--- Last update: 2011-10-04
+-- Last update: 2012-10-25
 -- Platform   : FPGA-generics
 -- Standard   : VHDL'93
 -------------------------------------------------------------------------------
@@ -14,6 +14,15 @@
 -- WB_TICS is a simple counter with wishbone interface. Each step of a counter
 -- takes 1 usec. It is used by ptp-noposix as a replace of gettimeofday()
 -- function.
+-- Optionally it generates a periodic interrupt: IRQ_PERIOD sets the interrupt
+-- period in tics (0 disables the interrupt). irq_o stays high until the
+-- interrupt is acknowledged by writing 1 to bit 0 of IRQ_STATUS.
+--
+-- Registers (word addresses):
+--   0 TICS       : usec counter (read only)
+--   1 IRQ_PERIOD : interrupt period in tics, 0 = interrupt disabled
+--   2 IRQ_STATUS : bit 0 = interrupt pending, write 1 to acknowledge
+--                  bits 31..16 = number of missed (not acknowledged) interrupts
 -------------------------------------------------------------------------------
 -- Copyright (c) 2011 Grzegorz Daniluk
 -------------------------------------------------------------------------------
@@ -21,6 +30,7 @@
 -- Date        Version  Author          Description
 -- 2011-04-03  1.0      greg.d          Created
 -- 2011-10-04  1.1      twlostow        added wishbone adapter
+-- 2012-10-25  1.2      P.Schakel       added periodic interrupt
 -------------------------------------------------------------------------------
 
 library ieee;
@@ -49,18 +59,27 @@ entity wb_tics is
     wb_stb_i  : in  std_logic;
     wb_we_i   : in  std_logic;
     wb_ack_o  : out std_logic;
-    wb_stall_o: out std_logic
+    wb_stall_o: out std_logic;
+
+    irq_o     : out std_logic
     );
 end wb_tics;
 
 architecture behaviour of wb_tics is
 
-  constant c_TICS_REG : std_logic_vector(1 downto 0) := "00";
+  constant c_TICS_REG       : std_logic_vector(1 downto 0) := "00";
+  constant c_IRQ_PERIOD_REG : std_logic_vector(1 downto 0) := "01";
+  constant c_IRQ_STATUS_REG : std_logic_vector(1 downto 0) := "10";
 
   signal cntr_div      : unsigned(23 downto 0);
   signal cntr_tics     : unsigned(31 downto 0);
   signal cntr_overflow : std_logic;
 
+  signal irq_period    : unsigned(31 downto 0);
+  signal cntr_irq      : unsigned(31 downto 0);
+  signal irq_pending   : std_logic;
+  signal irq_missed    : unsigned(15 downto 0);
+
   signal wb_in  : t_wishbone_slave_in;
   signal wb_out : t_wishbone_slave_out;
 
@@ -123,6 +142,40 @@ begin
     end if;
   end process;
 
+  --periodic interrupt
+  process(clk_sys_i)
+  begin
+    if rising_edge(clk_sys_i) then
+      if(rst_n_i = '0') then
+        cntr_irq    <= (others => '0');
+        irq_pending <= '0';
+        irq_missed  <= (others => '0');
+      else
+        -- acknowledge, a new interrupt in the same cycle has priority
+        if(wb_in.stb = '1' and wb_in.cyc = '1' and wb_in.we = '1' and
+           wb_in.adr(1 downto 0) = c_IRQ_STATUS_REG and wb_in.dat(0) = '1') then
+          irq_pending <= '0';
+        end if;
+        if(irq_period = 0) then
+          cntr_irq    <= (others => '0');
+          irq_pending <= '0';
+        elsif(cntr_overflow = '1') then
+          if(cntr_irq >= irq_period-1) then
+            cntr_irq    <= (others => '0');
+            irq_pending <= '1';
+            if(irq_pending = '1' and irq_missed /= 16#ffff#) then
+              irq_missed <= irq_missed + 1;
+            end if;
+          else
+            cntr_irq <= cntr_irq + 1;
+          end if;
+        end if;
+      end if;
+    end if;
+  end process;
+
+  irq_o <= irq_pending;
+
   --Wishbone interface
   process(clk_sys_i)
   begin
@@ -130,15 +183,26 @@ begin
       if(rst_n_i = '0') then
         wb_out.ack  <= '0';
         wb_out.dat <= (others => '0');
+        irq_period <= (others => '0');
       else
         if(wb_in.stb = '1' and wb_in.cyc = '1') then
           if(wb_in.we = '0') then
             case wb_in.adr(1 downto 0) is
               when c_TICS_REG =>
                 wb_out.dat <= std_logic_vector(cntr_tics);
+              when c_IRQ_PERIOD_REG =>
+                wb_out.dat <= std_logic_vector(irq_period);
+              when c_IRQ_STATUS_REG =>
+                wb_out.dat(31 downto 16) <= std_logic_vector(irq_missed);
+                wb_out.dat(15 downto 1)  <= (others => '0');
+                wb_out.dat(0)            <= irq_pending;
               when others =>
                 wb_out.dat <= (others => '0');
             end case;
+          else
+            if(wb_in.adr(1 downto 0) = c_IRQ_PERIOD_REG) then
+              irq_period <= unsigned(wb_in.dat);
+            end if;
           end if;
           wb_out.ack <= '1';
         else
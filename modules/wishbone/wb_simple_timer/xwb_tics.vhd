@@ -1,4 +1,4 @@
--- todo: configurable interrupt, output compare, PWM?
+-- todo: output compare, PWM?
 
 library ieee;
 use ieee.std_logic_1164.all;
@@ -19,7 +19,10 @@ entity xwb_tics is
     -- Wishbone
     slave_i : in  t_wishbone_slave_in;
     slave_o : out t_wishbone_slave_out;
-    desc_o  : out t_wishbone_device_descriptor
+    desc_o  : out t_wishbone_device_descriptor;
+
+    -- periodic interrupt, see wb_tics
+    irq_o   : out std_logic
 
     );
 
@@ -43,8 +46,11 @@ architecture rtl of xwb_tics is
       wb_stb_i   : in  std_logic;
       wb_we_i    : in  std_logic;
       wb_ack_o   : out std_logic;
-      wb_stall_o : out std_logic);
+      wb_stall_o : out std_logic;
+      irq_o      : out std_logic);
   end component;
+
+  signal irq_s : std_logic;
   
 begin
 
@@ -64,10 +70,12 @@ begin
       wb_stb_i   => slave_i.stb,
       wb_we_i    => slave_i.we,
       wb_ack_o   => slave_o.ack,
-      wb_stall_o => slave_o.stall);
+      wb_stall_o => slave_o.stall,
+      irq_o      => irq_s);
 
   slave_o.err <= '0';
-  slave_o.int <= '0';
+  slave_o.int <= irq_s;
+  irq_o       <= irq_s;
   slave_o.rty <= '0';
   
 end rtl;
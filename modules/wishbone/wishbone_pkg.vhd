@@ -239,15 +239,69 @@ package wishbone_pkg is
       g_num_slaves  : integer;
       g_registered  : boolean;
       g_address     : t_wishbone_address_array;
-      g_mask        : t_wishbone_address_array);
+      g_mask        : t_wishbone_address_array;
+      g_qos_realtime : std_logic_vector(31 downto 0) := (others => '0');
+      g_qos_preempt  : std_logic_vector(31 downto 0) := (others => '0');
+      g_stats        : boolean := false);
     port (
       clk_sys_i     : in  std_logic;
       rst_n_i       : in  std_logic;
       slave_i       : in  t_wishbone_slave_in_array(g_num_masters-1 downto 0);
       slave_o       : out t_wishbone_slave_out_array(g_num_masters-1 downto 0);
       master_i      : in  t_wishbone_master_in_array(g_num_slaves-1 downto 0);
-      master_o      : out t_wishbone_master_out_array(g_num_slaves-1 downto 0));
+      master_o      : out t_wishbone_master_out_array(g_num_slaves-1 downto 0);
+      stats_i       : in  t_wishbone_slave_in := cc_dummy_slave_in;
+      stats_o       : out t_wishbone_slave_out);
   end component;
+  
+  -- Statistics slave of xwb_crossbar (g_stats = true)
+  constant c_xwb_crossbar_stats_sdb : t_sdb_device := (
+    abi_class     => x"0000", -- undocumented device
+    abi_ver_major => x"01",
+    abi_ver_minor => x"00",
+    wbd_endian    => c_sdb_endian_big,
+    wbd_width     => x"4", -- 32-bit port granularity
+    sdb_component => (
+    addr_first    => x"0000000000000000",
+    addr_last     => x"00000000000003ff",
+    product => (
+    vendor_id     => x"0000000000000651", -- GSI
+    device_id     => x"35aa6b9f",
+    version       => x"00000001",
+    date          => x"20261019",
+    name          => "WB4-Crossbar-Stats ")));
+
+  constant c_xwb_bus_monitor_sdb : t_sdb_device := (
+    abi_class     => x"0000", -- undocumented device
+    abi_ver_major => x"01",
+    abi_ver_minor => x"00",
+    wbd_endian    => c_sdb_endian_big,
+    wbd_width     => x"4", -- 32-bit port granularity
+    sdb_component => (
+    addr_first    => x"0000000000000000",
+    addr_last     => x"00000000000003ff",
+    product => (
+    vendor_id     => x"0000000000000651", -- GSI
+    device_id     => x"35aa6ba0",
+    version       => x"00000001",
+    date          => x"20261019",
+    name          => "WB4-Bus-Monitor    ")));
+
+  constant c_xwb_pc_sampler_sdb : t_sdb_device := (
+    abi_class     => x"0000", -- undocumented device
+    abi_ver_major => x"01",
+    abi_ver_minor => x"00",
+    wbd_endian    => c_sdb_endian_big,
+    wbd_width     => x"4", -- 32-bit port granularity
+    sdb_component => (
+    addr_first    => x"0000000000000000",
+    addr_last     => x"000000000000003f",
+    product => (
+    vendor_id     => x"0000000000000651", -- GSI
+    device_id     => x"35aa6ba1",
+    version       => x"00000001",
+    date          => x"20261019",
+    name          => "WB4-LM32-PC-Sampler")));
 
   -- Use the f_xwb_bridge_*_sdb to bridge a crossbar to another
   function f_xwb_bridge_manual_sdb( -- take a manual bus size
@@ -266,14 +320,19 @@ package wishbone_pkg is
       g_registered  : boolean := false;
       g_wraparound  : boolean := true;
       g_layout      : t_sdb_record_array;
-      g_sdb_addr    : t_wishbone_address);
+      g_sdb_addr    : t_wishbone_address;
+      g_qos_realtime : std_logic_vector(31 downto 0) := (others => '0');
+      g_qos_preempt  : std_logic_vector(31 downto 0) := (others => '0');
+      g_stats        : boolean := false);
     port (
       clk_sys_i     : in  std_logic;
       rst_n_i       : in  std_logic;
       slave_i       : in  t_wishbone_slave_in_array(g_num_masters-1 downto 0);
       slave_o       : out t_wishbone_slave_out_array(g_num_masters-1 downto 0);
       master_i      : in  t_wishbone_master_in_array(g_num_slaves-1 downto 0);
-      master_o      : out t_wishbone_master_out_array(g_num_slaves-1 downto 0));
+      master_o      : out t_wishbone_master_out_array(g_num_slaves-1 downto 0);
+      stats_i       : in  t_wishbone_slave_in := cc_dummy_slave_in;
+      stats_o       : out t_wishbone_slave_out);
   end component;
 
   component sdb_rom is
@@ -289,17 +348,17 @@ package wishbone_pkg is
   constant c_xwb_dma_sdb : t_sdb_device := (
     abi_class     => x"0000", -- undocumented device
     abi_ver_major => x"01",
-    abi_ver_minor => x"00",
+    abi_ver_minor => x"02", -- descriptor chains, byte packing
     wbd_endian    => c_sdb_endian_big,
     wbd_width     => x"7", -- 8/16/32-bit port granularity
     sdb_component => (
     addr_first    => x"0000000000000000",
-    addr_last     => x"000000000000001f",
+    addr_last     => x"000000000000003f",
     product => (
     vendor_id     => x"0000000000000651", -- GSI
     device_id     => x"cababa56",
-    version       => x"00000001",
-    date          => x"20120518",
+    version       => x"00000003",
+    date          => x"20261019",
     name          => "WB4-Streaming-DMA_0")));
   component xwb_dma is
     generic(
@@ -329,6 +388,31 @@ package wishbone_pkg is
     );
   end component;
   
+  component xwb_bus_monitor is
+    generic(
+      g_taps      : natural := 1;
+      g_fifo_log2 : natural := 4);
+    port(
+      clk_sys_i    : in  std_logic;
+      rst_n_i      : in  std_logic;
+      tap_master_i : in  t_wishbone_master_out_array(g_taps-1 downto 0);
+      tap_slave_i  : in  t_wishbone_master_in_array(g_taps-1 downto 0);
+      slave_i      : in  t_wishbone_slave_in;
+      slave_o      : out t_wishbone_slave_out);
+  end component;
+  
+  component xwb_pc_sampler is
+    generic(
+      g_fifo_log2 : natural := 10);
+    port(
+      clk_sys_i : in  std_logic;
+      rst_n_i   : in  std_logic;
+      pc_i      : in  t_wishbone_address;
+      ra_i      : in  t_wishbone_address;
+      slave_i   : in  t_wishbone_slave_in;
+      slave_o   : out t_wishbone_slave_out);
+  end component;
+  
   component xwb_clock_crossing is
     generic(
       sync_depth : natural := 3;
@@ -465,7 +549,9 @@ package wishbone_pkg is
       dwb_o     : out t_wishbone_master_out;
       dwb_i     : in  t_wishbone_master_in;
       iwb_o     : out t_wishbone_master_out;
-      iwb_i     : in  t_wishbone_master_in);
+      iwb_i     : in  t_wishbone_master_in;
+      pc_o      : out t_wishbone_address;
+      ra_o      : out t_wishbone_address);
   end component;
 
   component wb_onewire_master
@@ -605,7 +691,8 @@ package wishbone_pkg is
       wb_stb_i   : in  std_logic;
       wb_we_i    : in  std_logic;
       wb_ack_o   : out std_logic;
-      wb_stall_o : out std_logic);
+      wb_stall_o : out std_logic;
+      irq_o      : out std_logic);
   end component;
 
   component xwb_tics
@@ -618,7 +705,8 @@ package wishbone_pkg is
       rst_n_i   : in  std_logic;
       slave_i   : in  t_wishbone_slave_in;
       slave_o   : out t_wishbone_slave_out;
-      desc_o    : out t_wishbone_device_descriptor);
+      desc_o    : out t_wishbone_device_descriptor;
+      irq_o     : out std_logic);
   end component;
 
   component wb_vic
@@ -0,0 +1,34 @@
+// Registers of the bus performance monitor (modules/wishbone/wb_bus_monitor/xwb_bus_monitor.vhd)
+// Every tap watches one master/slave pair of the bus and counts, for the accesses on it:
+// cycles with CYC high, strobes accepted, acknowledges, cycles stalled, errors and the latency
+// from the accepted strobe to its acknowledge. The average latency is BUSMON_SUMLAT divided by
+// the acknowledges and errors, the sum is the number of accesses in flight counted every cycle.
+// Taps of wishbone_demo_top.vhd: 0 PCIe, 1 LM32 data, 2 DMA read, 3 DMA write (master ports),
+// 4 RAM, 5 flash (slave ports).
+// In wishbone_demo_top.vhd the monitor is slave 1 of the debug bus, the bridge at slave 13 of the
+// top crossbar (0x112000): base address 0x112800.
+// The counters stop at 0xffffffff, freeze them while reading a consistent set.
+
+#ifndef BUS_MONITOR_H
+#define BUS_MONITOR_H
+
+#define BUSMON_TAP(t) ((t)*0x40) // block of tap t
+#define BUSMON_BUSY 0x00 // cycles with CYC high
+#define BUSMON_STROBES 0x04 // strobes accepted
+#define BUSMON_ACKS 0x08 // acknowledges
+#define BUSMON_STALLED 0x0c // cycles with STB and STALL
+#define BUSMON_ERRORS 0x10 // ERR and RTY
+#define BUSMON_MINLAT 0x14 // shortest latency in cycles, 0xffff before the first access
+#define BUSMON_MAXLAT 0x18 // longest latency in cycles
+#define BUSMON_SUMLAT 0x1c // sum of the latencies in cycles
+#define BUSMON_WRITES 0x20 // writes accepted
+
+#define BUSMON_CONTROL 0x3c0 // bit0 clear the counters (write), bit1 freeze
+#define BUSMON_CYCLES 0x3c4 // clock cycles counted
+#define BUSMON_TAPS 0x3c8 // number of taps
+#define BUSMON_MAXTAPS 15
+
+#define BUSMON_CONTROL_CLEAR 0x1
+#define BUSMON_CONTROL_FREEZE 0x2
+
+#endif
@@ -0,0 +1,36 @@
+// Statistics of the top crossbar (modules/wishbone/wb_crossbar/xwb_crossbar.vhd, g_stats)
+// Every master of the crossbar has a block of counters, measured at the master port:
+// cycles with CYC high, words transferred, cycles stalled and a histogram of the wait of
+// an access (the cycles from STB until the crossbar or the slave accepted it). The wait
+// includes the arbitration, so the histogram shows the contention between the masters.
+// Masters of wishbone_demo_top.vhd: 0 PCIe, 1 LM32 data, 2 LM32 instructions, 3 DMA read,
+// 4 DMA write. The LM32 is real-time (wins the arbitration), the DMA is preempted for it.
+// In wishbone_demo_top.vhd the statistics are slave 0 of the debug bus, the bridge at slave 13 of
+// the top crossbar (0x112000): base address 0x112400.
+// The counters stop at 0xffffffff, freeze them while reading a consistent set.
+
+#ifndef CBAR_STATS_H
+#define CBAR_STATS_H
+
+#define CBARSTATS_MASTER(m) ((m)*0x40) // block of master m
+#define CBARSTATS_BUSY 0x00 // cycles with CYC high
+#define CBARSTATS_WORDS 0x04 // strobes accepted
+#define CBARSTATS_STALLED 0x08 // cycles with STB and STALL
+#define CBARSTATS_MAXWAIT 0x0c // longest wait of an access in cycles
+#define CBARSTATS_HIST(bin) (0x10+(bin)*4) // accesses that waited 0, 1, 2-3, 4-7, 8-15, 16-31, 32-63, 64+ cycles
+#define CBARSTATS_HISTBINS 8
+
+#define CBARSTATS_CONTROL 0x3c0 // bit0 clear the counters (write), bit1 freeze
+#define CBARSTATS_CYCLES 0x3c4 // clock cycles counted
+#define CBARSTATS_MASTERS 0x3c8 // number of masters
+#define CBARSTATS_REALTIME 0x3cc // bit m: master m is real-time
+#define CBARSTATS_PREEMPT 0x3d0 // bit m: master m may be preempted
+#define CBARSTATS_MAXMASTERS 15
+
+#define CBARSTATS_CONTROL_CLEAR 0x1
+#define CBARSTATS_CONTROL_FREEZE 0x2
+
+// lowest wait in cycles of a histogram bin
+#define CBARSTATS_BINSTART(bin) ((bin)==0 ? 0 : 1 << ((bin)-1))
+
+#endif
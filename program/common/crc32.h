@@ -0,0 +1,26 @@
+// CRC-32 for the frames on the rs232 line (telemetry, firmware update), firmware and host programs
+// The CRC-32 is the same as the default gc_crc_gen (Ethernet CRC): polynomial 0x04C11DB7,
+// initial value 0xffffffff, bits shifted in least significant bit first, result inverted.
+
+#ifndef CRC32_H
+#define CRC32_H
+
+// CRC-32 calculation with a 16 entry table, 4 bits at a time
+//   Parameters :
+//      unsigned int crc : CRC of the previous bytes, start with 0xffffffff
+//      const unsigned char *data : bytes to add to the CRC
+//      int len : number of bytes
+//      return : new CRC, invert for the final value
+static inline unsigned int crc32_update(unsigned int crc, const unsigned char *data, int len) {
+	static const unsigned int table[16] = {
+		0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+		0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c };
+	while (len-->0) {
+		crc ^= *data++;
+		crc = (crc >> 4) ^ table[crc & 0xf];
+		crc = (crc >> 4) ^ table[crc & 0xf];
+	}
+	return crc;
+}
+
+#endif
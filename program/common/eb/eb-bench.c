@@ -0,0 +1,464 @@
+/** @file eb-bench.c
+ *  @brief A program which measures the read and write throughput of the Pexaria2a Pcie card.
+ *
+ *  Copyright (C) 2011-2012 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  A complete skeleton of an application using the Etherbone library.
+ *
+ *  @author Wesley W. Terpstra <w.terpstra@gsi.de>
+ *  adjusted for benchmarking the Pexaria2a Pcie card by Peter Schakel <p.schakel@rug.nl>
+ *
+ *  A block of the wishbone bus (default the LM32 RAM, found in the SDB records) is read
+ *  repeatedly with Etherbone cycles, every word is a separate PCIe read.
+ *  With -m the same block is also read through a mapping of BAR1 of the card, with loads
+ *  of 4, 8 or 16 bytes: the CPU sends one memory read of that size, pcie_wb pipelines the
+ *  wishbone reads and returns the data in one completion. The data of both is compared,
+ *  hold the LM32 in reset when it runs from the RAM that is read.
+ *  With -W the block is also written through BAR1 with stores of the same size and read back
+ *  with Etherbone. BAR1 is mapped write-combined (resource1_wc) when the kernel offers it, so the
+ *  CPU merges the stores into large memory writes; pcie_wb streams the data words of a memory
+ *  write into a pipelined wishbone burst. Else the uncached mapping is used. The write test
+ *  overwrites the block.
+ *
+ *  The direct mapping uses the registers of pcie_wb in BAR0 (cycle line and the 64KB address
+ *  window of BAR1), the Etherbone device may not be used by other programs meanwhile.
+ *  The PCI device is the name in /sys/bus/pci/devices, for example 0000:05:00.0 (lspci -D).
+ *  Needs root for the resource files.
+ *
+ *  @bug None!
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+
+#include <unistd.h> /* getopt */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#include "../etherbone.h"
+#include "../glue/version.h"
+#include "common.h"
+#include "../../common/sdb.h"
+#include "../../common/ebtool.h"
+
+#define OPERATIONS_PER_CYCLE 256
+
+// registers of pcie_wb in BAR0
+#define PCIEWB_CONTROL 0x00 // bit31: wishbone cycle line
+#define PCIEWB_WINDOW 0x14 // bits 31..16: address of the BAR1 window
+#define PCIEWB_CONTROL_CYC 0x80000000
+#define PCIEWB_WINDOWSIZE 0x10000
+
+typedef uint32_t v4u32 __attribute__((vector_size(16)));
+
+static void help(void) {
+  fprintf(stderr, "Usage: %s [OPTION] <proto/host/port> [address]\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -a <width>     acceptable address bus widths     (8/16/32/64)\n");
+  fprintf(stderr, "  -d <width>     acceptable data bus widths        (8/16/32/64)\n");
+  fprintf(stderr, "  -r <retries>   number of times to attempt autonegotiation (3)\n");
+  fprintf(stderr, "  -s <bytes>     size of the block (4096, at most %d)\n", PCIEWB_WINDOWSIZE);
+  fprintf(stderr, "  -n <count>     number of times the block is read (100)\n");
+  fprintf(stderr, "  -m <pcidev>    also read through a mapping of BAR1 of this PCI device\n");
+  fprintf(stderr, "  -w <bytes>     size of the loads and stores through the mapping (4/8/16, 16)\n");
+  fprintf(stderr, "  -W             also write the block through the mapping (overwrites it)\n");
+  fprintf(stderr, "  -v             verbose operation\n");
+  fprintf(stderr, "  -q             quiet: do not display warnings\n");
+  fprintf(stderr, "  -h             display this help and exit\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Without address the LM32 RAM is found in the SDB records at 0x%x.\n", SDB_ADDRESS);
+  fprintf(stderr, "The block may not cross a %dKB boundary.\n", PCIEWB_WINDOWSIZE >> 10);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Report Etherbone bugs to <etherbone-core@ohwr.org>\n");
+  fprintf(stderr, "Version %"PRIx32" (%s). Licensed under the LGPL v3.\n", EB_VERSION_SHORT, EB_DATE_FULL);
+}
+
+static eb_socket_t socket;
+static eb_format_t format = EB_BIG_ENDIAN|EB_DATA32;
+
+// Read words with one Etherbone cycle
+//   Parameters :
+//      eb_address_t address : address of the first word
+//      unsigned int *data : the words read
+//      unsigned int count : number of words, at most OPERATIONS_PER_CYCLE
+static void eb_readblock(eb_device_t device, eb_address_t address, unsigned int *data, unsigned int count) {
+  eb_cycle_t cycle;
+  eb_status_t status;
+  struct ebtool_result r;
+  unsigned int i;
+  r.stop = 0;
+  r.data = data;
+  if ((status = eb_cycle_open(device, &r, &ebtool_read_done, &cycle)) != EB_OK) {
+    fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+    exit(1);
+  }
+  for (i = 0; i < count; i++)
+    eb_cycle_read(cycle, address + i*4, format, 0);
+  eb_cycle_close(cycle);
+  eb_device_flush(device);
+  while (!r.stop) { eb_socket_run(socket, -1); }
+}
+
+// Map a BAR of the card
+//   Parameters :
+//      const char *pcidev : PCI device in /sys/bus/pci/devices
+//      const char *resource : resource file of the BAR
+//      size_t size : bytes to map
+//      int optional : return 0 if the resource cannot be mapped
+//      return : the mapping, exits on failure unless optional
+static volatile void *map_bar(const char *pcidev, const char *resource, size_t size, int optional) {
+  char path[256];
+  void *map;
+  int fd;
+  snprintf(path, sizeof(path), "/sys/bus/pci/devices/%s/%s", pcidev, resource);
+  if ((fd = open(path, O_RDWR|O_SYNC)) < 0) {
+    if (optional) return 0;
+    fprintf(stderr, "%s: cannot open %s: %s\n", program, path, strerror(errno));
+    exit(1);
+  }
+  map = mmap(0, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    if (optional) return 0;
+    fprintf(stderr, "%s: cannot map %s: %s\n", program, path, strerror(errno));
+    exit(1);
+  }
+  return map;
+}
+
+// Read a block through the BAR1 mapping with loads of width bytes
+static void read_direct(volatile unsigned char *bar1, unsigned int *data, unsigned int bytes, int width) {
+  unsigned int i;
+  switch (width) {
+  case 4:
+    for (i = 0; i < bytes; i += 4)
+      data[i/4] = *(volatile uint32_t*)(bar1 + i);
+    break;
+  case 8:
+    for (i = 0; i < bytes; i += 8)
+      *(uint64_t*)&data[i/4] = *(volatile uint64_t*)(bar1 + i);
+    break;
+  default:
+    for (i = 0; i < bytes; i += 16)
+      *(v4u32*)&data[i/4] = *(volatile v4u32*)(bar1 + i);
+    break;
+  }
+}
+
+// Write a block through the BAR1 mapping with stores of width bytes
+// The fence drains the write-combining buffers, the read returns after all writes arrived.
+static void write_direct(volatile unsigned char *bar1, const unsigned int *data, unsigned int bytes, int width) {
+  unsigned int i;
+  switch (width) {
+  case 4:
+    for (i = 0; i < bytes; i += 4)
+      *(volatile uint32_t*)(bar1 + i) = data[i/4];
+    break;
+  case 8:
+    for (i = 0; i < bytes; i += 8)
+      *(volatile uint64_t*)(bar1 + i) = *(const uint64_t*)&data[i/4];
+    break;
+  default:
+    for (i = 0; i < bytes; i += 16)
+      *(volatile v4u32*)(bar1 + i) = *(const v4u32*)&data[i/4];
+    break;
+  }
+  __sync_synchronize();
+  (void)*(volatile uint32_t*)bar1;
+}
+
+static void report(const char *what, unsigned long long bytes, double seconds) {
+  fprintf(stdout, "%-24s %10llu bytes in %8.3f s, %8.2f MB/s\n", what, bytes, seconds,
+                  seconds > 0 ? bytes / seconds / 1e6 : 0.0);
+}
+
+int main(int argc, char** argv) {
+  long value;
+  char* value_end;
+  int opt, error, width, writetest;
+  unsigned long size, count, i, k, errors, werrors;
+  unsigned int *ebdata, *directdata;
+  double tstart;
+  char what[32];
+  volatile uint32_t *bar0;
+  volatile unsigned char *bar1, *bar1wc;
+
+  eb_status_t status;
+  eb_device_t device;
+  eb_width_t line_width;
+  eb_address_t address;
+  struct sdb_devices table;
+  const struct sdb_entry *e;
+
+  /* Specific command-line options */
+  int attempts, discover;
+  const char* netaddress;
+  const char* pcidev;
+
+  /* Default arguments */
+  program = argv[0];
+  address_width = EB_ADDRX;
+  data_width = EB_DATAX;
+  attempts = 3;
+  quiet = 0;
+  verbose = 0;
+  error = 0;
+  size = 4096;
+  count = 100;
+  width = 16;
+  writetest = 0;
+  pcidev = 0;
+
+  /* Process the command-line arguments */
+  while ((opt = getopt(argc, argv, "a:d:r:s:n:m:w:Wvqh")) != -1) {
+    switch (opt) {
+    case 'a':
+      value = parse_width(optarg);
+      if (value < 0) {
+        fprintf(stderr, "%s: invalid address width -- '%s'\n", program, optarg);
+        return 1;
+      }
+      address_width = value << 4;
+      break;
+    case 'd':
+      value = parse_width(optarg);
+      if (value < 0) {
+        fprintf(stderr, "%s: invalid data width -- '%s'\n", program, optarg);
+        return 1;
+      }
+      data_width = value;
+      break;
+    case 'r':
+      value = strtol(optarg, &value_end, 0);
+      if (*value_end || value < 0 || value > 100) {
+        fprintf(stderr, "%s: invalid number of retries -- '%s'\n", program, optarg);
+        return 1;
+      }
+      attempts = value;
+      break;
+    case 's':
+      size = strtoul(optarg, &value_end, 0);
+      if (*value_end || size == 0 || (size & 15) || size > PCIEWB_WINDOWSIZE) {
+        fprintf(stderr, "%s: invalid block size, a multiple of 16 bytes -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'n':
+      count = strtoul(optarg, &value_end, 0);
+      if (*value_end || count == 0) {
+        fprintf(stderr, "%s: invalid count -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'm':
+      pcidev = optarg;
+      break;
+    case 'w':
+      width = strtol(optarg, &value_end, 0);
+      if (*value_end || (width != 4 && width != 8 && width != 16)) {
+        fprintf(stderr, "%s: invalid load size -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'W':
+      writetest = 1;
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    case 'q':
+      quiet = 1;
+      break;
+    case 'h':
+      help();
+      return 1;
+    case ':':
+    case '?':
+      error = 1;
+      break;
+    default:
+      fprintf(stderr, "%s: bad getopt result\n", program);
+      return 1;
+    }
+  }
+
+  if (error) return 1;
+
+  if (writetest && !pcidev) {
+    fprintf(stderr, "%s: the write test needs the PCI device (-m)\n", program);
+    return 1;
+  }
+
+  if ((optind + 1 != argc) && (optind + 2 != argc)) {
+    fprintf(stderr, "%s: expecting one or two non-optional arguments: <proto/host/port> [address]\n", program);
+    return 1;
+  }
+  netaddress = argv[optind];
+  discover = (optind + 1 == argc);
+  address = 0;
+  if (!discover) {
+    address = strtoull(argv[optind+1], &value_end, 0);
+    if (*value_end != 0 || (address & 15)) {
+      fprintf(stderr, "%s: argument is not an address aligned to 16 bytes -- '%s'\n",
+                      program, argv[optind+1]);
+      return 1;
+    }
+  }
+
+  ebdata = malloc(size);
+  directdata = malloc(size);
+  if (ebdata == 0 || directdata == 0) {
+    fprintf(stderr, "%s: cannot allocate memory\n", program);
+    return 1;
+  }
+
+  if (verbose)
+    fprintf(stdout, "Opening socket with %s-bit address and %s-bit data widths\n",
+                    width_str[address_width>>4], width_str[data_width]);
+
+  if ((status = eb_socket_open(EB_ABI_CODE, 0, address_width|data_width, &socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if (verbose)
+    fprintf(stdout, "Connecting to '%s' with %d retry attempts...\n", netaddress, attempts);
+
+  if ((status = eb_device_open(socket, netaddress, EB_ADDRX|EB_DATAX, attempts, &device)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone device: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  line_width = eb_device_width(device);
+  if (verbose)
+    fprintf(stdout, "  negotiated %s-bit address and %s-bit data session.\n",
+                    width_str[line_width >> 4], width_str[line_width & EB_DATAX]);
+  if ((line_width & EB_DATAX) < EB_DATA32) {
+    fprintf(stderr, "%s: error: 32-bit data access needed, the session is %s-bit\n", program, width_str[line_width & EB_DATAX]);
+    return 1;
+  }
+
+  if (discover) {
+    struct ebtool_bus bus = { socket, device, format };
+    if (sdb_scan(&table, SDB_ADDRESS, &ebtool_sdb_read, &bus) < 0) {
+      fprintf(stderr, "%s: no SDB records found at 0x%x, give the address\n", program, SDB_ADDRESS);
+      return 1;
+    }
+    e = sdb_find(&table, SDB_VENDOR_CERN, SDB_DEVICE_DPRAM, 0);
+    if (e == 0) {
+      fprintf(stderr, "%s: LM32 RAM not found in the SDB records, give the address\n", program);
+      return 1;
+    }
+    address = e->base;
+    if (size > e->last - e->base + 1) size = e->last - e->base + 1;
+    if (verbose)
+      fprintf(stdout, "  found LM32 RAM at 0x%x\n", e->base);
+  }
+  if ((address & (PCIEWB_WINDOWSIZE-1)) + size > PCIEWB_WINDOWSIZE) {
+    fprintf(stderr, "%s: the block crosses a %dKB boundary\n", program, PCIEWB_WINDOWSIZE >> 10);
+    return 1;
+  }
+
+  /* Etherbone: one PCIe read per word */
+  tstart = ebtool_now();
+  for (i = 0; i < count; i++)
+    for (k = 0; k < size/4; k += OPERATIONS_PER_CYCLE)
+      eb_readblock(device, address + k*4, ebdata + k,
+                   size/4 - k < OPERATIONS_PER_CYCLE ? size/4 - k : OPERATIONS_PER_CYCLE);
+  report("etherbone", (unsigned long long)size * count, ebtool_now() - tstart);
+
+  /* BAR1: one PCIe read per load */
+  errors = 0;
+  if (pcidev) {
+    bar0 = (volatile uint32_t*)map_bar(pcidev, "resource0", 4096, 0);
+    bar1 = (volatile unsigned char*)map_bar(pcidev, "resource1", PCIEWB_WINDOWSIZE, 0);
+    bar0[PCIEWB_WINDOW/4] = address & ~(PCIEWB_WINDOWSIZE-1);
+    bar0[PCIEWB_CONTROL/4] = PCIEWB_CONTROL_CYC;
+    bar1 += address & (PCIEWB_WINDOWSIZE-1);
+    tstart = ebtool_now();
+    for (i = 0; i < count; i++)
+      read_direct(bar1, directdata, size, width);
+    snprintf(what, sizeof(what), "BAR1, %d byte loads", width);
+    report(what, (unsigned long long)size * count, ebtool_now() - tstart);
+    bar0[PCIEWB_CONTROL/4] = 0;
+
+    for (k = 0; k < size/4; k++) {
+      if (ebdata[k] != directdata[k]) {
+        if (errors++ < 10 && !quiet)
+          fprintf(stderr, "%s: word at 0x%"EB_ADDR_FMT" is 0x%08x, etherbone read 0x%08x\n",
+                          program, address + k*4, directdata[k], ebdata[k]);
+      }
+    }
+    if (errors)
+      fprintf(stderr, "%s: %lu words differ\n", program, errors);
+  }
+
+  /* BAR1: stores merged into memory writes */
+  if (writetest) {
+    werrors = 0;
+    bar1wc = (volatile unsigned char*)map_bar(pcidev, "resource1_wc", PCIEWB_WINDOWSIZE, 1);
+    if (bar1wc == 0 && !quiet)
+      fprintf(stderr, "%s: warning: BAR1 has no write-combined mapping, using the uncached one\n", program);
+    bar1 = (volatile unsigned char*)map_bar(pcidev, "resource1", PCIEWB_WINDOWSIZE, 0);
+    if (bar1wc) bar1 = bar1wc;
+    bar1 += address & (PCIEWB_WINDOWSIZE-1);
+    for (k = 0; k < size/4; k++)
+      directdata[k] = 0x5a000000 ^ (unsigned int)(address + k*4);
+    bar0[PCIEWB_WINDOW/4] = address & ~(PCIEWB_WINDOWSIZE-1);
+    bar0[PCIEWB_CONTROL/4] = PCIEWB_CONTROL_CYC;
+    tstart = ebtool_now();
+    for (i = 0; i < count; i++)
+      write_direct(bar1, directdata, size, width);
+    snprintf(what, sizeof(what), "BAR1%s, %d byte stores", bar1wc ? " WC" : "", width);
+    report(what, (unsigned long long)size * count, ebtool_now() - tstart);
+    bar0[PCIEWB_CONTROL/4] = 0;
+
+    for (k = 0; k < size/4; k += OPERATIONS_PER_CYCLE)
+      eb_readblock(device, address + k*4, ebdata + k,
+                   size/4 - k < OPERATIONS_PER_CYCLE ? size/4 - k : OPERATIONS_PER_CYCLE);
+    for (k = 0; k < size/4; k++) {
+      if (ebdata[k] != directdata[k]) {
+        if (werrors++ < 10 && !quiet)
+          fprintf(stderr, "%s: word at 0x%"EB_ADDR_FMT" is 0x%08x, written 0x%08x\n",
+                          program, address + k*4, ebdata[k], directdata[k]);
+      }
+    }
+    if (werrors)
+      fprintf(stderr, "%s: %lu words differ after the write\n", program, werrors);
+    errors += werrors;
+  }
+
+  if ((status = eb_device_close(device)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone device: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if ((status = eb_socket_close(socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  free(ebdata);
+  free(directdata);
+  return errors ? 1 : 0;
+}
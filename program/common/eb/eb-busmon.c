@@ -0,0 +1,395 @@
+/** @file eb-busmon.c
+ *  @brief A program which shows the load and the latency of the wishbone busses of the FPGA.
+ *
+ *  Copyright (C) 2011-2012 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  A complete skeleton of an application using the Etherbone library.
+ *
+ *  @author Wesley W. Terpstra <w.terpstra@gsi.de>
+ *  adjusted for the bus monitor of the Pexaria2a Pcie card by Peter Schakel <p.schakel@rug.nl>
+ *
+ *  The bus monitor (xwb_bus_monitor) and the statistics of the top crossbar are found in the SDB
+ *  records. Every interval the counters are frozen, read in one Etherbone cycle per block and
+ *  cleared, which also starts the next interval. Per tap of the bus monitor the bandwidth, the
+ *  load (cycles with CYC high), the stall cycles, the errors and the shortest, average and longest
+ *  latency are shown. Per master of the crossbar the load, the stall cycles and the histogram of
+ *  the arbitration wait are shown.
+ *
+ *  The latencies are measured in the FPGA in clock cycles, so the Etherbone accesses of this program
+ *  do not change them; they are only seen as a small load on the PCIe tap.
+ *
+ *  @bug None!
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <unistd.h> /* getopt */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include "../etherbone.h"
+#include "../glue/version.h"
+#include "common.h"
+#include "../../common/sdb.h"
+#include "../../common/ebtool.h"
+#include "../../common/bus_monitor.h"
+#include "../../common/cbar_stats.h"
+
+#define BLOCK_WORDS 16 // registers of a tap or a master
+
+/* Taps and masters of wishbone_demo_top.vhd */
+static const char *tap_names[BUSMON_MAXTAPS] = {
+  "PCIe", "LM32 data", "DMA read", "DMA write", "RAM", "flash"
+};
+static const char *master_names[CBARSTATS_MAXMASTERS] = {
+  "PCIe", "LM32 data", "LM32 instr", "DMA read", "DMA write"
+};
+
+static void help(void) {
+  fprintf(stderr, "Usage: %s [OPTION] <proto/host/port>\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -a <width>     acceptable address bus widths     (8/16/32/64)\n");
+  fprintf(stderr, "  -d <width>     acceptable data bus widths        (8/16/32/64)\n");
+  fprintf(stderr, "  -r <retries>   number of times to attempt autonegotiation (3)\n");
+  fprintf(stderr, "  -f <MHz>       clock frequency of the wishbone bus (125)\n");
+  fprintf(stderr, "  -i <seconds>   interval between two reports (1)\n");
+  fprintf(stderr, "  -c <count>     stop after this many reports (0: until interrupted)\n");
+  fprintf(stderr, "  -m             show only the bus monitor, not the crossbar\n");
+  fprintf(stderr, "  -v             verbose operation\n");
+  fprintf(stderr, "  -q             quiet: do not display warnings\n");
+  fprintf(stderr, "  -h             display this help and exit\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "The bus monitor and the crossbar statistics are found in the SDB records at 0x%x.\n", SDB_ADDRESS);
+  fprintf(stderr, "Latencies are in clock cycles: from the accepted strobe to the acknowledge.\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Report Etherbone bugs to <etherbone-core@ohwr.org>\n");
+  fprintf(stderr, "Version %"PRIx32" (%s). Licensed under the LGPL v3.\n", EB_VERSION_SHORT, EB_DATE_FULL);
+}
+
+static eb_socket_t socket;
+static eb_format_t format = EB_BIG_ENDIAN|EB_DATA32;
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig) {
+  stop = 1;
+}
+
+// Read consecutive registers in one cycle
+//   Parameters :
+//      eb_address_t address : first register
+//      unsigned int *data : the values read
+//      int n : number of registers
+static void eb_readblock(eb_device_t device, eb_address_t address, unsigned int *data, int n) {
+  eb_cycle_t cycle;
+  eb_status_t status;
+  struct ebtool_result r;
+  int i;
+  r.stop = 0;
+  r.data = data;
+  if ((status = eb_cycle_open(device, &r, &ebtool_read_done, &cycle)) != EB_OK) {
+    fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+    exit(1);
+  }
+  for (i = 0; i < n; i++)
+    eb_cycle_read(cycle, address + i*4, format, 0);
+  eb_cycle_close(cycle);
+  eb_device_flush(device);
+  while (!r.stop) { eb_socket_run(socket, -1); }
+}
+
+static void eb_writeword(eb_device_t device, eb_address_t address, unsigned int data) {
+  eb_cycle_t cycle;
+  eb_status_t status;
+  struct ebtool_result r;
+  r.stop = 0;
+  r.data = 0;
+  if ((status = eb_cycle_open(device, &r, &ebtool_read_done, &cycle)) != EB_OK) {
+    fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+    exit(1);
+  }
+  eb_cycle_write(cycle, address, format, (eb_data_t)data);
+  eb_cycle_close(cycle);
+  eb_device_flush(device);
+  while (!r.stop) { eb_socket_run(socket, -1); }
+}
+
+static double percent(unsigned int part, unsigned int cycles) {
+  return cycles ? 100.0 * part / cycles : 0.0;
+}
+
+// Show the counters of the bus monitor
+//   Parameters :
+//      eb_address_t base : bus monitor
+//      double mhz : clock frequency
+static void report_monitor(eb_device_t device, eb_address_t base, double mhz) {
+  unsigned int r[BLOCK_WORDS], taps, cycles, done;
+  double seconds;
+  int t;
+
+  eb_readblock(device, base + BUSMON_CONTROL, r, 3);
+  cycles = r[(BUSMON_CYCLES - BUSMON_CONTROL)/4];
+  taps = r[(BUSMON_TAPS - BUSMON_CONTROL)/4];
+  if (taps > BUSMON_MAXTAPS) taps = BUSMON_MAXTAPS;
+  seconds = cycles / (mhz * 1e6);
+
+  fprintf(stdout, "bus monitor, %u cycles (%.3f s)\n", cycles, seconds);
+  fprintf(stdout, "  %-12s %9s %6s %6s %6s %7s %6s %8s %6s\n",
+                  "tap", "MB/s", "busy%", "stall%", "write%", "errors", "minlat", "avglat", "maxlat");
+  for (t = 0; t < (int)taps; t++) {
+    eb_readblock(device, base + BUSMON_TAP(t), r, 9);
+    done = r[BUSMON_ACKS/4] + r[BUSMON_ERRORS/4];
+    fprintf(stdout, "  %-12s %9.2f %6.1f %6.1f %6.1f %7u",
+                    tap_names[t] ? tap_names[t] : "",
+                    seconds > 0 ? r[BUSMON_STROBES/4] * 4.0 / seconds / 1e6 : 0.0,
+                    percent(r[BUSMON_BUSY/4], cycles),
+                    percent(r[BUSMON_STALLED/4], cycles),
+                    r[BUSMON_STROBES/4] ? 100.0 * r[BUSMON_WRITES/4] / r[BUSMON_STROBES/4] : 0.0,
+                    r[BUSMON_ERRORS/4]);
+    if (done)
+      fprintf(stdout, " %6u %8.2f %6u\n", r[BUSMON_MINLAT/4] & 0xffff,
+                      (double)r[BUSMON_SUMLAT/4] / done, r[BUSMON_MAXLAT/4] & 0xffff);
+    else
+      fprintf(stdout, " %6s %8s %6s\n", "-", "-", "-");
+  }
+}
+
+// Show the statistics of the crossbar masters
+//   Parameters :
+//      eb_address_t base : crossbar statistics
+static void report_crossbar(eb_device_t device, eb_address_t base) {
+  unsigned int r[BLOCK_WORDS], masters, cycles, realtime, preempt;
+  int m, b;
+
+  eb_readblock(device, base + CBARSTATS_CONTROL, r, 5);
+  cycles = r[(CBARSTATS_CYCLES - CBARSTATS_CONTROL)/4];
+  masters = r[(CBARSTATS_MASTERS - CBARSTATS_CONTROL)/4];
+  realtime = r[(CBARSTATS_REALTIME - CBARSTATS_CONTROL)/4];
+  preempt = r[(CBARSTATS_PREEMPT - CBARSTATS_CONTROL)/4];
+  if (masters > CBARSTATS_MAXMASTERS) masters = CBARSTATS_MAXMASTERS;
+
+  fprintf(stdout, "crossbar, %u cycles, wait histogram in cycles\n", cycles);
+  fprintf(stdout, "  %-12s %2s %6s %6s %7s", "master", "", "busy%", "stall%", "maxwait");
+  for (b = 0; b < CBARSTATS_HISTBINS; b++)
+    fprintf(stdout, " %8u+", CBARSTATS_BINSTART(b));
+  fprintf(stdout, "\n");
+  for (m = 0; m < (int)masters; m++) {
+    eb_readblock(device, base + CBARSTATS_MASTER(m), r, 4 + CBARSTATS_HISTBINS);
+    fprintf(stdout, "  %-12s %c%c %6.1f %6.1f %7u",
+                    master_names[m] ? master_names[m] : "",
+                    (realtime >> m) & 1 ? 'R' : ' ', (preempt >> m) & 1 ? 'P' : ' ',
+                    percent(r[CBARSTATS_BUSY/4], cycles),
+                    percent(r[CBARSTATS_STALLED/4], cycles),
+                    r[CBARSTATS_MAXWAIT/4]);
+    for (b = 0; b < CBARSTATS_HISTBINS; b++)
+      fprintf(stdout, " %9u", r[CBARSTATS_HIST(b)/4]);
+    fprintf(stdout, "\n");
+  }
+}
+
+int main(int argc, char** argv) {
+  long value;
+  char* value_end;
+  int opt, error, monitoronly, reports;
+  double mhz, interval;
+  unsigned long count;
+
+  eb_status_t status;
+  eb_device_t device;
+  eb_width_t line_width;
+  struct sdb_devices table;
+  struct ebtool_bus bus;
+  const struct sdb_entry *busmon, *cbar;
+
+  /* Specific command-line options */
+  int attempts;
+  const char* netaddress;
+
+  /* Default arguments */
+  program = argv[0];
+  address_width = EB_ADDRX;
+  data_width = EB_DATAX;
+  attempts = 3;
+  quiet = 0;
+  verbose = 0;
+  error = 0;
+  mhz = 125.0;
+  interval = 1.0;
+  count = 0;
+  monitoronly = 0;
+
+  /* Process the command-line arguments */
+  while ((opt = getopt(argc, argv, "a:d:r:f:i:c:mvqh")) != -1) {
+    switch (opt) {
+    case 'a':
+      value = parse_width(optarg);
+      if (value < 0) {
+        fprintf(stderr, "%s: invalid address width -- '%s'\n", program, optarg);
+        return 1;
+      }
+      address_width = value << 4;
+      break;
+    case 'd':
+      value = parse_width(optarg);
+      if (value < 0) {
+        fprintf(stderr, "%s: invalid data width -- '%s'\n", program, optarg);
+        return 1;
+      }
+      data_width = value;
+      break;
+    case 'r':
+      value = strtol(optarg, &value_end, 0);
+      if (*value_end || value < 0 || value > 100) {
+        fprintf(stderr, "%s: invalid number of retries -- '%s'\n", program, optarg);
+        return 1;
+      }
+      attempts = value;
+      break;
+    case 'f':
+      mhz = strtod(optarg, &value_end);
+      if (*value_end || mhz <= 0) {
+        fprintf(stderr, "%s: invalid clock frequency -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'i':
+      interval = strtod(optarg, &value_end);
+      if (*value_end || interval <= 0 || interval * mhz * 1e6 > 4e9) {
+        fprintf(stderr, "%s: invalid interval -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'c':
+      count = strtoul(optarg, &value_end, 0);
+      if (*value_end) {
+        fprintf(stderr, "%s: invalid count -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'm':
+      monitoronly = 1;
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    case 'q':
+      quiet = 1;
+      break;
+    case 'h':
+      help();
+      return 1;
+    case ':':
+    case '?':
+      error = 1;
+      break;
+    default:
+      fprintf(stderr, "%s: bad getopt result\n", program);
+      return 1;
+    }
+  }
+
+  if (error) return 1;
+
+  if (optind + 1 != argc) {
+    fprintf(stderr, "%s: expecting one non-optional argument: <proto/host/port>\n", program);
+    return 1;
+  }
+  netaddress = argv[optind];
+
+  if (verbose)
+    fprintf(stdout, "Opening socket with %s-bit address and %s-bit data widths\n",
+                    width_str[address_width>>4], width_str[data_width]);
+
+  if ((status = eb_socket_open(EB_ABI_CODE, 0, address_width|data_width, &socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if (verbose)
+    fprintf(stdout, "Connecting to '%s' with %d retry attempts...\n", netaddress, attempts);
+
+  if ((status = eb_device_open(socket, netaddress, EB_ADDRX|EB_DATAX, attempts, &device)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone device: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  line_width = eb_device_width(device);
+  if (verbose)
+    fprintf(stdout, "  negotiated %s-bit address and %s-bit data session.\n",
+                    width_str[line_width >> 4], width_str[line_width & EB_DATAX]);
+  if ((line_width & EB_DATAX) < EB_DATA32) {
+    fprintf(stderr, "%s: error: 32-bit data access needed, the session is %s-bit\n", program, width_str[line_width & EB_DATAX]);
+    return 1;
+  }
+
+  bus.socket = socket;
+  bus.device = device;
+  bus.format = format;
+  if (sdb_scan(&table, SDB_ADDRESS, &ebtool_sdb_read, &bus) < 0) {
+    fprintf(stderr, "%s: no SDB records found at 0x%x\n", program, SDB_ADDRESS);
+    return 1;
+  }
+  busmon = sdb_find(&table, SDB_VENDOR_GSI, SDB_DEVICE_BUSMON, 0);
+  cbar = monitoronly ? 0 : sdb_find(&table, SDB_VENDOR_GSI, SDB_DEVICE_CBARSTATS, 0);
+  if (busmon == 0 && cbar == 0) {
+    fprintf(stderr, "%s: no bus monitor found in the SDB records\n", program);
+    return 1;
+  }
+  if (busmon == 0 && !quiet)
+    fprintf(stderr, "%s: warning: no bus monitor, only the crossbar statistics are shown\n", program);
+  if (verbose) {
+    if (busmon) fprintf(stdout, "  found the bus monitor at 0x%x\n", busmon->base);
+    if (cbar) fprintf(stdout, "  found the crossbar statistics at 0x%x\n", cbar->base);
+  }
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  /* Start the first interval */
+  if (busmon) eb_writeword(device, busmon->base + BUSMON_CONTROL, BUSMON_CONTROL_CLEAR);
+  if (cbar) eb_writeword(device, cbar->base + CBARSTATS_CONTROL, CBARSTATS_CONTROL_CLEAR);
+
+  for (reports = 0; !stop && (count == 0 || reports < (int)count); reports++) {
+    usleep((useconds_t)(interval * 1e6));
+    if (stop) break;
+
+    /* A consistent set: freeze, read, then clear (which also unfreezes) for the next interval */
+    if (busmon) eb_writeword(device, busmon->base + BUSMON_CONTROL, BUSMON_CONTROL_FREEZE);
+    if (cbar) eb_writeword(device, cbar->base + CBARSTATS_CONTROL, CBARSTATS_CONTROL_FREEZE);
+    if (busmon) report_monitor(device, busmon->base, mhz);
+    if (cbar) report_crossbar(device, cbar->base);
+    fprintf(stdout, "\n");
+    fflush(stdout);
+    if (busmon) eb_writeword(device, busmon->base + BUSMON_CONTROL, BUSMON_CONTROL_CLEAR);
+    if (cbar) eb_writeword(device, cbar->base + CBARSTATS_CONTROL, CBARSTATS_CONTROL_CLEAR);
+  }
+
+  if ((status = eb_device_close(device)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone device: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if ((status = eb_socket_close(socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  return 0;
+}
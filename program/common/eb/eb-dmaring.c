@@ -0,0 +1,470 @@
+/** @file eb-dmaring.c
+ *  @brief A program which receives the data the FPGA writes into host memory with pcie_dma.
+ *
+ *  Copyright (C) 2011-2012 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  A complete skeleton of an application using the Etherbone library.
+ *
+ *  @author Wesley W. Terpstra <w.terpstra@gsi.de>
+ *  adjusted for the DMA ring of the Pexaria2a Pcie card by Peter Schakel <p.schakel@rug.nl>
+ *
+ *  A ring of buffers is allocated in this process and locked in memory. The physical address of
+ *  every buffer is looked up in /proc/self/pagemap and written in the descriptor table of pcie_dma,
+ *  found in the SDB records. The FPGA writes the data with PCIe memory writes into the buffers and
+ *  the write pointer into a write-back word, also in this process. The ring is consumed by polling
+ *  the write-back word: no PCIe read is needed while receiving. The space is returned by writing the
+ *  read pointer over Etherbone.
+ *
+ *  The physical addresses of /proc/self/pagemap are only shown to root (CAP_SYS_ADMIN), and they are
+ *  only the bus addresses when the IOMMU is off or in passthrough mode (iommu=pt).
+ *  Each buffer is one page; the pages do not have to be contiguous.
+ *
+ *  Without a data source in the FPGA, -g writes a counter into the data window over Etherbone
+ *  (slow, for testing); -c checks that the received words are such a counter.
+ *
+ *  @bug None!
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#define _XOPEN_SOURCE 500 /* pread */
+#define _BSD_SOURCE /* MAP_ANONYMOUS, MAP_LOCKED */
+#define _DEFAULT_SOURCE
+
+#include <unistd.h> /* getopt */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#include "../etherbone.h"
+#include "../glue/version.h"
+#include "common.h"
+#include "../../common/sdb.h"
+#include "../../common/ebtool.h"
+#include "../../common/pcie_dma.h"
+
+#define OPERATIONS_PER_CYCLE 256
+#define CYCLES_IN_FLIGHT 16 // cycles sent before waiting for the result of the first one
+#define PAGEMAP_PRESENT (1ULL << 63)
+#define PAGEMAP_PFN ((1ULL << 55) - 1)
+
+static void help(void) {
+  fprintf(stderr, "Usage: %s [OPTION] <proto/host/port>\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -a <width>     acceptable address bus widths     (8/16/32/64)\n");
+  fprintf(stderr, "  -d <width>     acceptable data bus widths        (8/16/32/64)\n");
+  fprintf(stderr, "  -r <retries>   number of times to attempt autonegotiation (3)\n");
+  fprintf(stderr, "  -n <buffers>   number of buffers in the ring, power of 2 (16, at most %d)\n", 1 << PCIEDMA_MAXRINGLOG2);
+  fprintf(stderr, "  -s <bytes>     buffer size, power of 2 (4096, %d..%d)\n", 1 << PCIEDMA_MINBUFLOG2, 1 << PCIEDMA_MAXBUFLOG2);
+  fprintf(stderr, "  -t <cycles>    flush time in PCIe clock cycles of partial memory writes (256)\n");
+  fprintf(stderr, "  -b <bytes>     stop after receiving this many bytes (0: until interrupted)\n");
+  fprintf(stderr, "  -o <file>      write the received data to a file, '-' for stdout\n");
+  fprintf(stderr, "  -g <words>     generate: write a counter of this many words into the data window\n");
+  fprintf(stderr, "  -c             check that the received words are a counter starting at 0\n");
+  fprintf(stderr, "  -v             verbose operation\n");
+  fprintf(stderr, "  -q             quiet: do not display warnings\n");
+  fprintf(stderr, "  -h             display this help and exit\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "The DMA is found in the SDB records at 0x%x. Needs root for the physical addresses,\n", SDB_ADDRESS);
+  fprintf(stderr, "and the IOMMU off or in passthrough mode.\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Report Etherbone bugs to <etherbone-core@ohwr.org>\n");
+  fprintf(stderr, "Version %"PRIx32" (%s). Licensed under the LGPL v3.\n", EB_VERSION_SHORT, EB_DATE_FULL);
+}
+
+static eb_socket_t socket;
+static eb_format_t format = EB_BIG_ENDIAN|EB_DATA32;
+static int inflight = 0;
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig) {
+  stop = 1;
+}
+
+static int log2_exact(unsigned long value) {
+  int n = 0;
+  if (value == 0 || (value & (value-1))) return -1;
+  while ((1UL << n) != value) n++;
+  return n;
+}
+
+// Write a word; with wait=0 the cycle is only sent, it is finished by a later call or write_wait
+static void eb_writeword(eb_device_t device, eb_address_t address, unsigned int data, int wait) {
+  eb_cycle_t cycle;
+  eb_status_t status;
+  while (inflight >= CYCLES_IN_FLIGHT) {
+    eb_device_flush(device);
+    eb_socket_run(socket, -1);
+  }
+  if ((status = eb_cycle_open(device, &inflight, &ebtool_write_done, &cycle)) != EB_OK) {
+    fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+    exit(1);
+  }
+  eb_cycle_write(cycle, address, format, (eb_data_t)data);
+  eb_cycle_close(cycle);
+  inflight++;
+  eb_device_flush(device);
+  while (wait && inflight) { eb_socket_run(socket, -1); }
+}
+
+static void write_wait(eb_device_t device) {
+  eb_device_flush(device);
+  while (inflight) { eb_socket_run(socket, -1); }
+}
+
+// Write the next words of the counter into the data window, one cycle
+//   Parameters :
+//      unsigned int *next : next counter value, updated
+//      unsigned int end : last counter value + 1
+static void generate(eb_device_t device, eb_address_t window, unsigned int *next, unsigned int end) {
+  eb_cycle_t cycle;
+  eb_status_t status;
+  unsigned int i;
+  if (*next >= end) return;
+  while (inflight >= CYCLES_IN_FLIGHT) {
+    eb_device_flush(device);
+    eb_socket_run(socket, -1);
+  }
+  if ((status = eb_cycle_open(device, &inflight, &ebtool_write_done, &cycle)) != EB_OK) {
+    fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+    exit(1);
+  }
+  for (i = 0; (i < OPERATIONS_PER_CYCLE) && (*next < end); i++, (*next)++)
+    eb_cycle_write(cycle, window + i*4, format, (eb_data_t)*next);
+  eb_cycle_close(cycle);
+  inflight++;
+  eb_device_flush(device);
+}
+
+// Physical address of a locked page of this process
+//   Parameters :
+//      int pagemap : open /proc/self/pagemap
+//      const void *page : page aligned address
+//      return : physical address, 0 if not known
+static unsigned long long physical_address(int pagemap, const void *page, long pagesize) {
+  uint64_t entry;
+  off_t offset = ((uintptr_t)page / pagesize) * sizeof(entry);
+  if (pread(pagemap, &entry, sizeof(entry), offset) != sizeof(entry)) return 0;
+  if (!(entry & PAGEMAP_PRESENT)) return 0;
+  return (entry & PAGEMAP_PFN) * (unsigned long long)pagesize;
+}
+
+int main(int argc, char** argv) {
+  long value;
+  char* value_end;
+  int opt, error, i, check, pagemap, buflog2, ringlog2;
+  unsigned long nrofbuffers, bufsize, flush, generatewords;
+  unsigned long long total, received, physical;
+  unsigned int rdptr, wrptr, returned, next, expect, errors, n, offset, k;
+  long pagesize;
+  double tstart, seconds;
+  unsigned char *ring;
+  volatile unsigned int *writeback;
+  const unsigned int *words;
+  FILE *out;
+
+  eb_status_t status;
+  eb_device_t device;
+  eb_width_t line_width;
+  struct sdb_devices table;
+  struct ebtool_bus bus;
+  const struct sdb_entry *dma;
+
+  /* Specific command-line options */
+  int attempts;
+  const char* netaddress;
+  const char* outfile;
+
+  /* Default arguments */
+  program = argv[0];
+  address_width = EB_ADDRX;
+  data_width = EB_DATAX;
+  attempts = 3;
+  quiet = 0;
+  verbose = 0;
+  error = 0;
+  nrofbuffers = 16;
+  bufsize = 4096;
+  flush = 256;
+  total = 0;
+  generatewords = 0;
+  check = 0;
+  outfile = 0;
+
+  /* Process the command-line arguments */
+  while ((opt = getopt(argc, argv, "a:d:r:n:s:t:b:o:g:cvqh")) != -1) {
+    switch (opt) {
+    case 'a':
+      value = parse_width(optarg);
+      if (value < 0) {
+        fprintf(stderr, "%s: invalid address width -- '%s'\n", program, optarg);
+        return 1;
+      }
+      address_width = value << 4;
+      break;
+    case 'd':
+      value = parse_width(optarg);
+      if (value < 0) {
+        fprintf(stderr, "%s: invalid data width -- '%s'\n", program, optarg);
+        return 1;
+      }
+      data_width = value;
+      break;
+    case 'r':
+      value = strtol(optarg, &value_end, 0);
+      if (*value_end || value < 0 || value > 100) {
+        fprintf(stderr, "%s: invalid number of retries -- '%s'\n", program, optarg);
+        return 1;
+      }
+      attempts = value;
+      break;
+    case 'n':
+      nrofbuffers = strtoul(optarg, &value_end, 0);
+      if (*value_end || log2_exact(nrofbuffers) < 0 || log2_exact(nrofbuffers) > PCIEDMA_MAXRINGLOG2) {
+        fprintf(stderr, "%s: invalid number of buffers -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 's':
+      bufsize = strtoul(optarg, &value_end, 0);
+      if (*value_end || log2_exact(bufsize) < PCIEDMA_MINBUFLOG2 || log2_exact(bufsize) > PCIEDMA_MAXBUFLOG2) {
+        fprintf(stderr, "%s: invalid buffer size -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 't':
+      flush = strtoul(optarg, &value_end, 0);
+      if (*value_end) {
+        fprintf(stderr, "%s: invalid flush time -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'b':
+      total = strtoull(optarg, &value_end, 0);
+      if (*value_end) {
+        fprintf(stderr, "%s: invalid number of bytes -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'o':
+      outfile = optarg;
+      break;
+    case 'g':
+      generatewords = strtoul(optarg, &value_end, 0);
+      if (*value_end) {
+        fprintf(stderr, "%s: invalid number of words -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'c':
+      check = 1;
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    case 'q':
+      quiet = 1;
+      break;
+    case 'h':
+      help();
+      return 1;
+    case ':':
+    case '?':
+      error = 1;
+      break;
+    default:
+      fprintf(stderr, "%s: bad getopt result\n", program);
+      return 1;
+    }
+  }
+
+  if (error) return 1;
+
+  if (optind + 1 != argc) {
+    fprintf(stderr, "%s: expecting one non-optional argument: <proto/host/port>\n", program);
+    return 1;
+  }
+  netaddress = argv[optind];
+  if (generatewords && total == 0) total = (unsigned long long)generatewords * 4;
+  buflog2 = log2_exact(bufsize);
+  ringlog2 = log2_exact(nrofbuffers);
+
+  out = 0;
+  if (outfile) {
+    out = strcmp(outfile, "-") ? fopen(outfile, "wb") : stdout;
+    if (out == 0) {
+      fprintf(stderr, "%s: cannot open %s: %s\n", program, outfile, strerror(errno));
+      return 1;
+    }
+  }
+
+  /* The ring: one page per buffer and one page for the write-back word, locked in memory */
+  pagesize = sysconf(_SC_PAGESIZE);
+  if ((unsigned long)pagesize < bufsize) {
+    fprintf(stderr, "%s: the buffer size is larger than a page (%ld bytes)\n", program, pagesize);
+    return 1;
+  }
+  ring = mmap(0, (nrofbuffers+1) * pagesize, PROT_READ|PROT_WRITE,
+              MAP_PRIVATE|MAP_ANONYMOUS|MAP_LOCKED|MAP_POPULATE, -1, 0);
+  if (ring == MAP_FAILED) {
+    fprintf(stderr, "%s: cannot allocate the ring: %s\n", program, strerror(errno));
+    return 1;
+  }
+  memset(ring, 0, (nrofbuffers+1) * pagesize); // no copy-on-write page left
+  writeback = (volatile unsigned int*)(ring + nrofbuffers * pagesize);
+  if ((pagemap = open("/proc/self/pagemap", O_RDONLY)) < 0) {
+    fprintf(stderr, "%s: cannot open /proc/self/pagemap: %s\n", program, strerror(errno));
+    return 1;
+  }
+
+  if (verbose)
+    fprintf(stdout, "Opening socket with %s-bit address and %s-bit data widths\n",
+                    width_str[address_width>>4], width_str[data_width]);
+
+  if ((status = eb_socket_open(EB_ABI_CODE, 0, address_width|data_width, &socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if (verbose)
+    fprintf(stdout, "Connecting to '%s' with %d retry attempts...\n", netaddress, attempts);
+
+  if ((status = eb_device_open(socket, netaddress, EB_ADDRX|EB_DATAX, attempts, &device)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone device: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  line_width = eb_device_width(device);
+  if (verbose)
+    fprintf(stdout, "  negotiated %s-bit address and %s-bit data session.\n",
+                    width_str[line_width >> 4], width_str[line_width & EB_DATAX]);
+  if ((line_width & EB_DATAX) < EB_DATA32) {
+    fprintf(stderr, "%s: error: 32-bit data access needed, the session is %s-bit\n", program, width_str[line_width & EB_DATAX]);
+    return 1;
+  }
+
+  bus.socket = socket;
+  bus.device = device;
+  bus.format = format;
+  if (sdb_scan(&table, SDB_ADDRESS, &ebtool_sdb_read, &bus) < 0) {
+    fprintf(stderr, "%s: no SDB records found at 0x%x\n", program, SDB_ADDRESS);
+    return 1;
+  }
+  dma = ebtool_find_sdb(&table, SDB_VENDOR_GSI, SDB_DEVICE_PCIEDMA, "PCIe DMA");
+
+  /* Stop, clear and configure the DMA */
+  eb_writeword(device, dma->base + PCIEDMA_CONTROL, 0, 1);
+  eb_writeword(device, dma->base + PCIEDMA_CONTROL, PCIEDMA_CONTROL_CLEAR, 1);
+  eb_writeword(device, dma->base + PCIEDMA_CONFIG, PCIEDMA_CONFIG_VALUE(buflog2, ringlog2), 1);
+  eb_writeword(device, dma->base + PCIEDMA_FLUSH, flush, 1);
+  for (i = 0; i < (int)nrofbuffers; i++) {
+    physical = physical_address(pagemap, ring + i*pagesize, pagesize);
+    if (physical == 0) {
+      fprintf(stderr, "%s: no physical address of buffer %d, not running as root?\n", program, i);
+      return 1;
+    }
+    if (verbose) fprintf(stdout, "  buffer %2d at 0x%llx\n", i, physical);
+    eb_writeword(device, dma->base + PCIEDMA_DESC + i*8, (unsigned int)physical, 0);
+    eb_writeword(device, dma->base + PCIEDMA_DESC + i*8 + 4, (unsigned int)(physical >> 32), 0);
+  }
+  physical = physical_address(pagemap, (const void*)writeback, pagesize);
+  if (physical == 0) {
+    fprintf(stderr, "%s: no physical address of the write-back page\n", program);
+    return 1;
+  }
+  eb_writeword(device, dma->base + PCIEDMA_WBADDR_LO, (unsigned int)physical, 0);
+  eb_writeword(device, dma->base + PCIEDMA_WBADDR_HI, (unsigned int)(physical >> 32), 0);
+  write_wait(device);
+  close(pagemap);
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+  eb_writeword(device, dma->base + PCIEDMA_CONTROL, PCIEDMA_CONTROL_ENABLE, 1);
+  if (verbose)
+    fprintf(stdout, "Receiving in %lu buffers of %lu bytes\n", nrofbuffers, bufsize);
+
+  /* Consume the ring */
+  tstart = ebtool_now();
+  received = 0;
+  rdptr = returned = 0;
+  next = expect = errors = 0;
+  while (!stop && (total == 0 || received < total)) {
+    if (generatewords) generate(device, dma->base + PCIEDMA_DATA, &next, generatewords);
+
+    wrptr = *writeback;
+    __sync_synchronize(); // the data is read after the pointer
+    while (rdptr != wrptr) {
+      offset = rdptr & (bufsize-1);
+      n = bufsize - offset;
+      if (n > wrptr - rdptr) n = wrptr - rdptr;
+      words = (const unsigned int*)(ring + ((rdptr >> buflog2) & (nrofbuffers-1)) * pagesize + offset);
+      if (out && fwrite(words, 1, n, out) != n) {
+        fprintf(stderr, "%s: cannot write %s: %s\n", program, outfile, strerror(errno));
+        return 1;
+      }
+      if (check) {
+        for (k = 0; k < n/4; k++, expect++) {
+          if (words[k] != expect) {
+            if (errors++ < 10 && !quiet)
+              fprintf(stderr, "%s: word %u is 0x%08x\n", program, expect, words[k]);
+            expect = words[k];
+          }
+        }
+      }
+      rdptr += n;
+      received += n;
+    }
+
+    /* Return the space when half the ring is consumed, or all of it when nothing more arrives */
+    if (rdptr - returned >= (nrofbuffers * bufsize) / 2 || (rdptr != returned && wrptr == *writeback)) {
+      eb_writeword(device, dma->base + PCIEDMA_RDPTR, rdptr, 0);
+      returned = rdptr;
+    }
+    if (inflight) {
+      eb_device_flush(device);
+      eb_socket_run(socket, 0);
+    }
+  }
+  seconds = ebtool_now() - tstart;
+
+  write_wait(device);
+  eb_writeword(device, dma->base + PCIEDMA_CONTROL, 0, 1);
+  if (out && out != stdout) fclose(out);
+
+  fprintf(stderr, "%s: %llu bytes received in %.3f s, %.1f MB/s, %u TLPs%s\n", program, received, seconds,
+                  seconds > 0 ? received / seconds / 1e6 : 0.0,
+                  ebtool_readword(&bus, dma->base + PCIEDMA_TLPS), stop ? ", interrupted" : "");
+  if (check)
+    fprintf(stderr, "%s: %u words out of sequence\n", program, errors);
+
+  if ((status = eb_device_close(device)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone device: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if ((status = eb_socket_close(socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  munmap(ring, (nrofbuffers+1) * pagesize);
+  return (check && errors) ? 1 : 0;
+}
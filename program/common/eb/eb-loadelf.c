@@ -0,0 +1,566 @@
+/** @file eb-loadelf.c
+ *  @brief A program which loads an LM32 firmware ELF file into the program memory of a running FPGA.
+ *
+ *  Copyright (C) 2011-2012 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  A complete skeleton of an application using the Etherbone library.
+ *
+ *  @author Wesley W. Terpstra <w.terpstra@gsi.de>
+ *  adjusted for loading the LM32 firmware on the Pexaria2a Pcie card by Peter Schakel <p.schakel@rug.nl>
+ *
+ *  The LM32 is held in reset with the cpu reset register of the gpio slave, the sections of the
+ *  ELF file are written in the dual ported RAM (f_xwb_dpram, at address 0) and the reset is released.
+ *  The firmware is loaded without an FPGA build (genraminit) and without reprogramming the flash.
+ *  The writes are batched in Etherbone cycles and several cycles are kept in flight.
+ *
+ *  Read-only sections (.text, .rodata) that have not changed since the last load are skipped:
+ *  the hash of each loaded section is kept in a cache file, and a few words of a skipped section
+ *  are read back to check that the RAM still holds it (the FPGA may have been reloaded meanwhile).
+ *  Writable sections (.data) are always loaded, the firmware changes them while running;
+ *  .bss is cleared by crt0.
+ *
+ *  @bug None!
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200112L /* strtoull */
+
+#include <unistd.h> /* getopt */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "../etherbone.h"
+#include "../glue/version.h"
+#include "common.h"
+#include "../../common/sdb.h"
+#include "../../common/ebtool.h"
+
+#define OPERATIONS_PER_CYCLE 256
+#define CYCLES_IN_FLIGHT 16 // cycles sent before waiting for the result of the first one
+#define SPOTCHECKS 16 // words read back from a section that is skipped
+#define MAXSECTIONS 32
+#define MAXCACHE 256
+
+#define GPIO_CPURESET 0x4 // cpu reset register of the gpio slave, bit 0 = LM32 held in reset
+
+// ELF32, only what is needed for the sections
+#define ELF_EM_LM32 138
+#define ELF_SHT_NOBITS 8
+#define ELF_SHF_WRITE 0x1
+#define ELF_SHF_ALLOC 0x2
+
+#define DEFAULT_CACHE ".eb-loadelf.cache" // in the home directory
+
+static void help(void) {
+  fprintf(stderr, "Usage: %s [OPTION] <proto/host/port> <firmware.elf>\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -a <width>     acceptable address bus widths     (8/16/32/64)\n");
+  fprintf(stderr, "  -d <width>     acceptable data bus widths        (8/16/32/64)\n");
+  fprintf(stderr, "  -r <retries>   number of times to attempt autonegotiation (3)\n");
+  fprintf(stderr, "  -f             force; load all sections, ignore the cache\n");
+  fprintf(stderr, "  -c <file>      cache file with the hashes of the loaded sections (~/%s)\n", DEFAULT_CACHE);
+  fprintf(stderr, "  -k             keep the LM32 in reset after loading\n");
+  fprintf(stderr, "  -V             verify: read back all loaded sections\n");
+  fprintf(stderr, "  -v             verbose operation\n");
+  fprintf(stderr, "  -q             quiet: do not display warnings\n");
+  fprintf(stderr, "  -h             display this help and exit\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "The LM32 reset register and the RAM are found in the SDB records at 0x%x.\n", SDB_ADDRESS);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Report Etherbone bugs to <etherbone-core@ohwr.org>\n");
+  fprintf(stderr, "Version %"PRIx32" (%s). Licensed under the LGPL v3.\n", EB_VERSION_SHORT, EB_DATE_FULL);
+}
+
+struct section {
+  char name[32];
+  unsigned int address;
+  unsigned int size; // bytes
+  unsigned int words; // size rounded up to 32-bit words
+  int writable;
+  unsigned char *data; // words*4 bytes, padded with zeros
+  unsigned long long hash;
+  int skip;
+};
+
+struct cacheentry {
+  char device[256];
+  unsigned int address;
+  unsigned int size;
+  unsigned long long hash;
+};
+
+static struct section sections[MAXSECTIONS];
+static int nrofsections = 0;
+static struct cacheentry cache[MAXCACHE];
+static int nrofcache = 0;
+
+static int force;
+static eb_socket_t socket;
+static eb_format_t format = EB_BIG_ENDIAN|EB_DATA32; // LM32 is big-endian
+static int inflight = 0;
+
+static unsigned int get16(const unsigned char *p) {
+  return (p[0] << 8) | p[1];
+}
+
+static unsigned int get32(const unsigned char *p) {
+  return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+// FNV-1a, 64 bits
+static unsigned long long hash64(const unsigned char *data, unsigned int len, unsigned int address) {
+  unsigned long long h = 0xcbf29ce484222325ULL;
+  unsigned int i;
+  for (i = 0; i < 4; i++) { h ^= (address >> (i*8)) & 0xff; h *= 0x100000001b3ULL; }
+  for (i = 0; i < len; i++) { h ^= data[i]; h *= 0x100000001b3ULL; }
+  return h;
+}
+
+// Read the loadable sections of an ELF file
+//   Parameters :
+//      const char *filename : LM32 ELF file, big-endian 32 bits
+//      return : zero on ok
+static int read_elf(const char *filename) {
+  FILE *f;
+  long filesize;
+  unsigned char *elf = 0, *sh;
+  unsigned int shoff, shentsize, shnum, shstrndx, strtab, strsize, name, type, flags, offset, size, n, i;
+  struct section *s;
+  int rval = -1;
+
+  if ((f = fopen(filename, "rb")) == 0) {
+    fprintf(stderr, "%s: fopen, %s -- '%s'\n", program, strerror(errno), filename);
+    return -1;
+  }
+  fseek(f, 0, SEEK_END);
+  filesize = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  if (filesize < 52) {
+    fprintf(stderr, "%s: '%s' is too short for an ELF file\n", program, filename);
+    goto done;
+  }
+  elf = malloc(filesize);
+  if ((elf == 0) || (fread(elf, 1, filesize, f) != (size_t)filesize)) {
+    fprintf(stderr, "%s: cannot read '%s'\n", program, filename);
+    goto done;
+  }
+
+  if (memcmp(elf, "\177ELF", 4) != 0 || elf[4] != 1 || elf[5] != 2) {
+    fprintf(stderr, "%s: '%s' is not a 32-bit big-endian ELF file\n", program, filename);
+    goto done;
+  }
+  if (get16(&elf[0x12]) != ELF_EM_LM32 && !quiet)
+    fprintf(stderr, "%s: warning: '%s' is not an LM32 ELF file\n", program, filename);
+  shoff = get32(&elf[0x20]);
+  shentsize = get16(&elf[0x2e]);
+  shnum = get16(&elf[0x30]);
+  shstrndx = get16(&elf[0x32]);
+  if ((shnum == 0) || (shstrndx >= shnum) || (shentsize < 0x28) ||
+      (shoff > (unsigned long)filesize) || (shnum*shentsize > (unsigned long)filesize - shoff)) {
+    fprintf(stderr, "%s: '%s' has no valid section table\n", program, filename);
+    goto done;
+  }
+  strtab = get32(&elf[shoff + shstrndx*shentsize + 0x10]);
+  strsize = get32(&elf[shoff + shstrndx*shentsize + 0x14]);
+  if ((strtab > (unsigned long)filesize) || (strsize > (unsigned long)filesize - strtab)) {
+    fprintf(stderr, "%s: '%s' has no valid section name table\n", program, filename);
+    goto done;
+  }
+
+  for (i = 0; i < shnum; i++) {
+    sh = &elf[shoff + i*shentsize];
+    name = get32(&sh[0x00]);
+    type = get32(&sh[0x04]);
+    flags = get32(&sh[0x08]);
+    offset = get32(&sh[0x10]);
+    size = get32(&sh[0x14]);
+    if (!(flags & ELF_SHF_ALLOC) || (type == ELF_SHT_NOBITS) || (size == 0)) continue;
+    if ((offset > (unsigned long)filesize) || (size > (unsigned long)filesize - offset)) {
+      fprintf(stderr, "%s: section %u outside of '%s'\n", program, i, filename);
+      goto done;
+    }
+    if (name >= strsize) {
+      fprintf(stderr, "%s: name of section %u outside of the section name table of '%s'\n", program, i, filename);
+      goto done;
+    }
+    if (nrofsections == MAXSECTIONS) {
+      fprintf(stderr, "%s: too many sections in '%s'\n", program, filename);
+      goto done;
+    }
+    s = &sections[nrofsections++];
+    n = strsize - name; // the name ends at the end of the table if it has no terminating zero
+    if (n > sizeof(s->name)-1) n = sizeof(s->name)-1;
+    strncpy(s->name, (const char*)&elf[strtab + name], n);
+    s->name[n] = 0;
+    s->address = get32(&sh[0x0c]);
+    s->size = size;
+    s->words = (size+3)/4;
+    s->writable = (flags & ELF_SHF_WRITE) != 0;
+    if ((s->data = calloc(s->words, 4)) == 0) {
+      fprintf(stderr, "%s: out of memory for section %s\n", program, s->name);
+      goto done;
+    }
+    memcpy(s->data, &elf[offset], size);
+    s->hash = hash64(s->data, s->words*4, s->address);
+    if (s->address & 3) {
+      fprintf(stderr, "%s: section %s at 0x%x is not 32-bit aligned\n", program, s->name, s->address);
+      goto done;
+    }
+  }
+  rval = 0;
+done:
+  free(elf);
+  fclose(f);
+  return rval;
+}
+
+static void read_cache(const char *filename) {
+  FILE *f;
+  struct cacheentry *e;
+  if ((f = fopen(filename, "r")) == 0) return;
+  while (nrofcache < MAXCACHE) {
+    e = &cache[nrofcache];
+    if (fscanf(f, "%255s %x %x %llx", e->device, &e->address, &e->size, &e->hash) != 4) break;
+    nrofcache++;
+  }
+  fclose(f);
+}
+
+// Write the cache file: the entries of other devices and the sections just loaded
+static void write_cache(const char *filename, const char *device) {
+  FILE *f;
+  int i;
+  if ((f = fopen(filename, "w")) == 0) {
+    if (!quiet) fprintf(stderr, "%s: warning: cannot write cache '%s': %s\n", program, filename, strerror(errno));
+    return;
+  }
+  for (i = 0; i < nrofcache; i++)
+    if (strcmp(cache[i].device, device) != 0)
+      fprintf(f, "%s %x %x %llx\n", cache[i].device, cache[i].address, cache[i].size, cache[i].hash);
+  for (i = 0; i < nrofsections; i++)
+    if (!sections[i].writable)
+      fprintf(f, "%s %x %x %llx\n", device, sections[i].address, sections[i].size, sections[i].hash);
+  fclose(f);
+}
+
+static int in_cache(const char *device, const struct section *s) {
+  int i;
+  for (i = 0; i < nrofcache; i++)
+    if ((strcmp(cache[i].device, device) == 0) && (cache[i].address == s->address) &&
+        (cache[i].size == s->size) && (cache[i].hash == s->hash)) return 1;
+  return 0;
+}
+
+// Read words in one cycle
+//   Parameters :
+//      eb_device_t device : Etherbone device
+//      const eb_address_t *address : addresses of the words
+//      int n : number of words, at most OPERATIONS_PER_CYCLE
+//      unsigned int *data : the words read
+static void eb_readwords(eb_device_t device, const eb_address_t *address, int n, unsigned int *data) {
+  eb_cycle_t cycle;
+  eb_status_t status;
+  struct ebtool_result r;
+  int i;
+  r.stop = 0;
+  r.data = data;
+  if ((status = eb_cycle_open(device, &r, &ebtool_read_done, &cycle)) != EB_OK) {
+    fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+    exit(1);
+  }
+  for (i = 0; i < n; i++) eb_cycle_read(cycle, address[i], format, 0);
+  eb_cycle_close(cycle);
+  eb_device_flush(device);
+  while (!r.stop) { eb_socket_run(socket, -1); }
+}
+
+static void eb_writeword(eb_device_t device, eb_address_t address, unsigned int data) {
+  eb_cycle_t cycle;
+  eb_status_t status;
+  if ((status = eb_cycle_open(device, &inflight, &ebtool_write_done, &cycle)) != EB_OK) {
+    fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+    exit(1);
+  }
+  eb_cycle_write(cycle, address, format, (eb_data_t)data);
+  eb_cycle_close(cycle);
+  inflight++;
+  eb_device_flush(device);
+  while (inflight) { eb_socket_run(socket, -1); }
+}
+
+// Write a section in cycles of OPERATIONS_PER_CYCLE words, CYCLES_IN_FLIGHT cycles are sent
+// before waiting for the result of the first one
+static void write_section(eb_device_t device, const struct section *s) {
+  eb_cycle_t cycle;
+  eb_status_t status;
+  unsigned int i, j, n;
+  for (i = 0; i < s->words; i += n) {
+    while (inflight >= CYCLES_IN_FLIGHT) {
+      eb_device_flush(device);
+      eb_socket_run(socket, -1);
+    }
+    if ((status = eb_cycle_open(device, &inflight, &ebtool_write_done, &cycle)) != EB_OK) {
+      fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+      exit(1);
+    }
+    n = s->words - i;
+    if (n > OPERATIONS_PER_CYCLE) n = OPERATIONS_PER_CYCLE;
+    for (j = i; j < i+n; j++)
+      eb_cycle_write(cycle, s->address + j*4, format, (eb_data_t)get32(&s->data[j*4]));
+    eb_cycle_close(cycle);
+    inflight++;
+  }
+}
+
+static void write_wait(eb_device_t device) {
+  eb_device_flush(device);
+  while (inflight) { eb_socket_run(socket, -1); }
+}
+
+// Compare words of a section with the RAM
+//   Parameters :
+//      int step : compare every step-th word, 1 for all words
+//      return : number of words that differ
+static int compare_section(eb_device_t device, const struct section *s, unsigned int step) {
+  eb_address_t address[OPERATIONS_PER_CYCLE];
+  unsigned int data[OPERATIONS_PER_CYCLE];
+  unsigned int word[OPERATIONS_PER_CYCLE];
+  unsigned int i;
+  int n, k, differ = 0;
+  for (i = 0; i < s->words; ) {
+    for (n = 0; (n < OPERATIONS_PER_CYCLE) && (i < s->words); n++, i += step) {
+      address[n] = s->address + i*4;
+      word[n] = get32(&s->data[i*4]);
+    }
+    eb_readwords(device, address, n, data);
+    for (k = 0; k < n; k++) {
+      if (data[k] != word[k]) {
+        if (verbose) fprintf(stdout, "  0x%08x: 0x%08x, expected 0x%08x\n", (unsigned int)address[k], data[k], word[k]);
+        differ++;
+      }
+    }
+  }
+  return differ;
+}
+
+int main(int argc, char** argv) {
+  long value;
+  char* value_end;
+  int opt, error, i, keepreset, verify, loaded, skipped, differ;
+  unsigned int bytes;
+  double tstart;
+  char cachefile[1024];
+
+  eb_status_t status;
+  eb_device_t device;
+  eb_width_t line_width;
+  struct sdb_devices table;
+  const struct sdb_entry *gpio, *ram;
+  struct ebtool_bus bus;
+
+  /* Specific command-line options */
+  int attempts;
+  const char* netaddress;
+  const char* firmware;
+
+  /* Default arguments */
+  program = argv[0];
+  address_width = EB_ADDRX;
+  data_width = EB_DATAX;
+  attempts = 3;
+  quiet = 0;
+  verbose = 0;
+  error = 0;
+  force = 0;
+  keepreset = 0;
+  verify = 0;
+  cachefile[0] = 0;
+
+  /* Process the command-line arguments */
+  while ((opt = getopt(argc, argv, "a:d:r:fc:kVvqh")) != -1) {
+    switch (opt) {
+    case 'a':
+      value = parse_width(optarg);
+      if (value < 0) {
+        fprintf(stderr, "%s: invalid address width -- '%s'\n", program, optarg);
+        return 1;
+      }
+      address_width = value << 4;
+      break;
+    case 'd':
+      value = parse_width(optarg);
+      if (value < 0) {
+        fprintf(stderr, "%s: invalid data width -- '%s'\n", program, optarg);
+        return 1;
+      }
+      data_width = value;
+      break;
+    case 'r':
+      value = strtol(optarg, &value_end, 0);
+      if (*value_end || value < 0 || value > 100) {
+        fprintf(stderr, "%s: invalid number of retries -- '%s'\n", program, optarg);
+        return 1;
+      }
+      attempts = value;
+      break;
+    case 'f':
+      force = 1;
+      break;
+    case 'c':
+      strncpy(cachefile, optarg, sizeof(cachefile)-1);
+      cachefile[sizeof(cachefile)-1] = 0;
+      break;
+    case 'k':
+      keepreset = 1;
+      break;
+    case 'V':
+      verify = 1;
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    case 'q':
+      quiet = 1;
+      break;
+    case 'h':
+      help();
+      return 1;
+    case ':':
+    case '?':
+      error = 1;
+      break;
+    default:
+      fprintf(stderr, "%s: bad getopt result\n", program);
+      return 1;
+    }
+  }
+
+  if (error) return 1;
+
+  if (optind + 2 != argc) {
+    fprintf(stderr, "%s: expecting two non-optional arguments: <proto/host/port> <firmware.elf>\n", program);
+    return 1;
+  }
+  netaddress = argv[optind];
+  firmware = argv[optind+1];
+  if (cachefile[0] == 0)
+    snprintf(cachefile, sizeof(cachefile), "%s/%s", getenv("HOME") ? getenv("HOME") : ".", DEFAULT_CACHE);
+
+  if (read_elf(firmware)) return 1;
+  if (!force) read_cache(cachefile);
+
+  tstart = ebtool_now();
+  if (verbose)
+    fprintf(stdout, "Opening socket with %s-bit address and %s-bit data widths\n",
+                    width_str[address_width>>4], width_str[data_width]);
+
+  if ((status = eb_socket_open(EB_ABI_CODE, 0, address_width|data_width, &socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if (verbose)
+    fprintf(stdout, "Connecting to '%s' with %d retry attempts...\n", netaddress, attempts);
+
+  if ((status = eb_device_open(socket, netaddress, EB_ADDRX|EB_DATAX, attempts, &device)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone device: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  line_width = eb_device_width(device);
+  if (verbose)
+    fprintf(stdout, "  negotiated %s-bit address and %s-bit data session.\n",
+                    width_str[line_width >> 4], width_str[line_width & EB_DATAX]);
+  if ((line_width & EB_DATAX) < EB_DATA32) {
+    fprintf(stderr, "%s: error: 32-bit data access needed, the session is %s-bit\n", program, width_str[line_width & EB_DATAX]);
+    return 1;
+  }
+
+  bus.socket = socket;
+  bus.device = device;
+  bus.format = format;
+  if (sdb_scan(&table, SDB_ADDRESS, &ebtool_sdb_read, &bus) < 0) {
+    fprintf(stderr, "%s: no SDB records found at 0x%x\n", program, SDB_ADDRESS);
+    return 1;
+  }
+  gpio = ebtool_find_sdb(&table, SDB_VENDOR_GSI, SDB_DEVICE_GPIO, "gpio slave with the LM32 reset");
+  ram = ebtool_find_sdb(&table, SDB_VENDOR_CERN, SDB_DEVICE_DPRAM, "LM32 RAM");
+
+  for (i = 0; i < nrofsections; i++) {
+    if ((sections[i].address < ram->base) || (sections[i].address + sections[i].words*4 - 1 > ram->last)) {
+      fprintf(stderr, "%s: section %s 0x%x..0x%x outside of the RAM 0x%x..0x%x\n", program, sections[i].name,
+                      sections[i].address, sections[i].address + sections[i].size - 1, ram->base, ram->last);
+      return 1;
+    }
+  }
+
+  // decide which sections to load; the skipped sections are checked while the old firmware still runs
+  for (i = 0; i < nrofsections; i++) {
+    sections[i].skip = 0;
+    if (force || sections[i].writable || !in_cache(netaddress, &sections[i])) continue;
+    differ = compare_section(device, &sections[i], (sections[i].words + SPOTCHECKS - 1) / SPOTCHECKS);
+    sections[i].skip = (differ == 0);
+    if (verbose && differ) fprintf(stdout, "  %s: in the cache but not in the RAM\n", sections[i].name);
+  }
+
+  // halt the LM32, load, release
+  eb_writeword(device, gpio->base + GPIO_CPURESET, 1);
+  loaded = skipped = 0;
+  bytes = 0;
+  for (i = 0; i < nrofsections; i++) {
+    if (verbose)
+      fprintf(stdout, "  %-10s 0x%05x %6u bytes %s\n", sections[i].name, sections[i].address, sections[i].size,
+                      sections[i].skip ? "unchanged, skipped" : "loading");
+    if (sections[i].skip) {
+      skipped++;
+      continue;
+    }
+    write_section(device, &sections[i]);
+    loaded++;
+    bytes += sections[i].size;
+  }
+  write_wait(device);
+
+  if (verify) {
+    for (i = 0, differ = 0; i < nrofsections; i++)
+      if (!sections[i].skip) differ += compare_section(device, &sections[i], 1);
+    if (differ) {
+      fprintf(stderr, "%s: verify failed, %d words differ, the LM32 is kept in reset\n", program, differ);
+      return 1;
+    }
+  }
+
+  if (!keepreset) eb_writeword(device, gpio->base + GPIO_CPURESET, 0);
+  write_cache(cachefile, netaddress);
+
+  fprintf(stdout, "%s: %d sections loaded (%u bytes), %d unchanged, %.3f s%s\n", program, loaded, bytes, skipped,
+                  ebtool_now() - tstart, keepreset ? ", LM32 kept in reset" : "");
+
+  if ((status = eb_device_close(device)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone device: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if ((status = eb_socket_close(socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,625 @@
+/** @file eb-profile.c
+ *  @brief A program which profiles the LM32 firmware with the program counter sampler of the FPGA.
+ *
+ *  Copyright (C) 2011-2012 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  A complete skeleton of an application using the Etherbone library.
+ *
+ *  @author Wesley W. Terpstra <w.terpstra@gsi.de>
+ *  adjusted for profiling the LM32 firmware on the Pexaria2a Pcie card by Peter Schakel <p.schakel@rug.nl>
+ *
+ *  The sampler (xwb_pc_sampler) is found in the SDB records. It takes the program counter of the
+ *  running LM32 every period, the samples are drained from its FIFO over Etherbone while sampling,
+ *  many samples per cycle. At the end the samples are symbolised against the symbol table of the
+ *  firmware ELF file (the file loaded with eb-loadelf, not stripped).
+ *
+ *  The flat profile shows the samples per function, the time spent in the function itself.
+ *  With -A the hottest instruction addresses are shown as well, for objdump -d.
+ *  With -g the samples are written as folded stacks ("caller;function count" lines), the input of
+ *  flamegraph.pl. The caller comes from the return address register: it is known in leaf functions
+ *  only, so the stacks are at most two functions deep.
+ *
+ *  @bug None!
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <unistd.h> /* getopt */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+
+#include "../etherbone.h"
+#include "../glue/version.h"
+#include "common.h"
+#include "../../common/sdb.h"
+#include "../../common/ebtool.h"
+#include "../../common/pc_sampler.h"
+
+#define SAMPLES_PER_CYCLE 128 // samples read in one Etherbone cycle, two reads each
+
+// ELF32, only what is needed for the symbol table
+#define ELF_EM_LM32 138
+#define ELF_SHT_SYMTAB 2
+#define ELF_STT_NOTYPE 0
+#define ELF_STT_FUNC 2
+
+#define UNKNOWN (-1) // symbol index of an address outside of all functions
+
+static void help(void) {
+  fprintf(stderr, "Usage: %s [OPTION] <proto/host/port> <firmware.elf>\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -a <width>     acceptable address bus widths     (8/16/32/64)\n");
+  fprintf(stderr, "  -d <width>     acceptable data bus widths        (8/16/32/64)\n");
+  fprintf(stderr, "  -r <retries>   number of times to attempt autonegotiation (3)\n");
+  fprintf(stderr, "  -t <seconds>   sample this long (10, 0: until interrupted)\n");
+  fprintf(stderr, "  -F <Hz>        sample rate (10000)\n");
+  fprintf(stderr, "  -f <MHz>       clock frequency of the LM32 (125)\n");
+  fprintf(stderr, "  -R             random sample period against aliasing with periodic loops\n");
+  fprintf(stderr, "  -n <lines>     show the top functions only (30, 0: all)\n");
+  fprintf(stderr, "  -A <lines>     show the hottest instruction addresses as well\n");
+  fprintf(stderr, "  -g <file>      write folded stacks for flamegraph.pl, '-' for stdout\n");
+  fprintf(stderr, "  -v             verbose operation\n");
+  fprintf(stderr, "  -q             quiet: do not display warnings\n");
+  fprintf(stderr, "  -h             display this help and exit\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "The sampler is found in the SDB records at 0x%x. The ELF file must have its symbols.\n", SDB_ADDRESS);
+  fprintf(stderr, "  %s -g out.folded dev/wbm0 main.elf && flamegraph.pl out.folded > main.svg\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Report Etherbone bugs to <etherbone-core@ohwr.org>\n");
+  fprintf(stderr, "Version %"PRIx32" (%s). Licensed under the LGPL v3.\n", EB_VERSION_SHORT, EB_DATE_FULL);
+}
+
+struct symbol {
+  unsigned int address;
+  unsigned int size; // 0: up to the next symbol
+  const char *name;
+  unsigned long samples; // in the function itself
+};
+
+// Counter of a key in a hash table: an address, or a pair of symbols
+struct counter {
+  unsigned long long key;
+  unsigned long count;
+};
+
+struct countertable {
+  struct counter *c;
+  unsigned long size; // power of 2
+  unsigned long used;
+};
+
+static struct symbol *symbols = 0;
+static int nrofsymbols = 0;
+static char *strings = 0;
+
+static eb_socket_t socket;
+static eb_format_t format = EB_BIG_ENDIAN|EB_DATA32; // LM32 is big-endian
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig) {
+  stop = 1;
+}
+
+static unsigned int get16(const unsigned char *p) {
+  return (p[0] << 8) | p[1];
+}
+
+static unsigned int get32(const unsigned char *p) {
+  return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+static int compare_symbols(const void *a, const void *b) {
+  const struct symbol *x = (const struct symbol*)a, *y = (const struct symbol*)b;
+  if (x->address != y->address) return x->address < y->address ? -1 : 1;
+  return (y->size > 0) - (x->size > 0); // functions before labels at the same address
+}
+
+// Read the function symbols of an ELF file
+//   Parameters :
+//      const char *filename : LM32 ELF file, big-endian 32 bits
+//      return : zero on ok
+static int read_symbols(const char *filename) {
+  FILE *f;
+  long filesize;
+  unsigned char *elf, *sh, *sym;
+  unsigned int shoff, shentsize, shnum, i, j, offset, size, link, stroff, strsize, name, type;
+  int n;
+
+  if ((f = fopen(filename, "rb")) == 0) {
+    fprintf(stderr, "%s: fopen, %s -- '%s'\n", program, strerror(errno), filename);
+    return -1;
+  }
+  fseek(f, 0, SEEK_END);
+  filesize = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  elf = malloc(filesize > 0 ? filesize : 1);
+  if ((elf == 0) || (filesize < 52) || (fread(elf, 1, filesize, f) != (size_t)filesize)) {
+    fprintf(stderr, "%s: cannot read '%s'\n", program, filename);
+    return -1;
+  }
+  fclose(f);
+
+  if (memcmp(elf, "\177ELF", 4) != 0 || elf[4] != 1 || elf[5] != 2) {
+    fprintf(stderr, "%s: '%s' is not a 32-bit big-endian ELF file\n", program, filename);
+    return -1;
+  }
+  if (get16(&elf[0x12]) != ELF_EM_LM32 && !quiet)
+    fprintf(stderr, "%s: warning: '%s' is not an LM32 ELF file\n", program, filename);
+  shoff = get32(&elf[0x20]);
+  shentsize = get16(&elf[0x2e]);
+  shnum = get16(&elf[0x30]);
+  if ((shnum == 0) || (shoff + shnum*shentsize > (unsigned long)filesize)) {
+    fprintf(stderr, "%s: '%s' has no valid section table\n", program, filename);
+    return -1;
+  }
+
+  for (i = 0; i < shnum; i++) {
+    sh = &elf[shoff + i*shentsize];
+    if (get32(&sh[0x04]) != ELF_SHT_SYMTAB) continue;
+    offset = get32(&sh[0x10]);
+    size = get32(&sh[0x14]);
+    link = get32(&sh[0x18]);
+    if (link >= shnum || offset + size > (unsigned long)filesize) break;
+    stroff = get32(&elf[shoff + link*shentsize + 0x10]);
+    strsize = get32(&elf[shoff + link*shentsize + 0x14]);
+    if (stroff + strsize > (unsigned long)filesize || strsize == 0) break;
+
+    /* The names are kept, the ELF file is freed */
+    strings = malloc(strsize + 1);
+    memcpy(strings, &elf[stroff], strsize);
+    strings[strsize] = 0;
+    symbols = calloc(size/16 + 1, sizeof(struct symbol));
+    for (j = 0, n = 0; j + 16 <= size; j += 16) {
+      sym = &elf[offset + j];
+      name = get32(&sym[0x00]);
+      type = sym[0x0c] & 0xf;
+      if ((type != ELF_STT_FUNC && type != ELF_STT_NOTYPE) || get16(&sym[0x0e]) == 0 || name == 0 || name >= strsize)
+        continue;
+      // local labels of the assembler and the mapping symbols are not functions
+      if (strings[name] == '.' || strings[name] == '$') continue;
+      symbols[n].address = get32(&sym[0x04]);
+      symbols[n].size = type == ELF_STT_FUNC ? get32(&sym[0x08]) : 0;
+      symbols[n].name = &strings[name];
+      n++;
+    }
+    nrofsymbols = n;
+    break;
+  }
+  free(elf);
+  if (nrofsymbols == 0) {
+    fprintf(stderr, "%s: no function symbols in '%s', is it stripped?\n", program, filename);
+    return -1;
+  }
+  qsort(symbols, nrofsymbols, sizeof(struct symbol), compare_symbols);
+  return 0;
+}
+
+// The function of an instruction address
+//   Parameters :
+//      unsigned int address : instruction address
+//      return : index in symbols, UNKNOWN if the address is not in a function
+static int lookup(unsigned int address) {
+  int low = 0, high = nrofsymbols - 1, mid, i;
+  if (nrofsymbols == 0 || address < symbols[0].address) return UNKNOWN;
+  while (low < high) { // last symbol at or below the address
+    mid = (low + high + 1) / 2;
+    if (symbols[mid].address <= address) low = mid;
+    else high = mid - 1;
+  }
+  // a label inside a function belongs to the function
+  for (i = low; i >= 0 && symbols[i].size == 0 && low - i < 8; i--)
+    ;
+  if (i >= 0 && symbols[i].size != 0 && address < symbols[i].address + symbols[i].size) return i;
+  if (symbols[low].size != 0 && address >= symbols[low].address + symbols[low].size) return UNKNOWN;
+  return low;
+}
+
+static const char *symbol_name(int index) {
+  return index == UNKNOWN ? "[unknown]" : symbols[index].name;
+}
+
+static void counter_add(struct countertable *t, unsigned long long key, unsigned long count) {
+  unsigned long i, oldsize;
+  struct counter *old;
+  if (2*(t->used + 1) > t->size) {
+    old = t->c;
+    oldsize = t->size;
+    t->size = t->size ? 2*t->size : 1024;
+    t->c = calloc(t->size, sizeof(struct counter));
+    t->used = 0;
+    for (i = 0; i < oldsize; i++)
+      if (old[i].count) counter_add(t, old[i].key, old[i].count);
+    free(old);
+  }
+  i = (unsigned long)((key * 0x9e3779b97f4a7c15ULL) >> 20) & (t->size - 1);
+  while (t->c[i].count && t->c[i].key != key) i = (i + 1) & (t->size - 1);
+  if (t->c[i].count == 0) {
+    t->c[i].key = key;
+    t->used++;
+  }
+  t->c[i].count += count;
+}
+
+static int compare_counters(const void *a, const void *b) {
+  const struct counter *x = (const struct counter*)a, *y = (const struct counter*)b;
+  if (x->count != y->count) return x->count > y->count ? -1 : 1;
+  return x->key < y->key ? -1 : x->key > y->key;
+}
+
+// Sorted entries of a table, the table is emptied
+static unsigned long counter_sort(struct countertable *t) {
+  unsigned long i, n = 0;
+  for (i = 0; i < t->size; i++)
+    if (t->c[i].count) t->c[n++] = t->c[i];
+  qsort(t->c, n, sizeof(struct counter), compare_counters);
+  return n;
+}
+
+static void eb_writeword(eb_device_t device, eb_address_t address, unsigned int data) {
+  eb_cycle_t cycle;
+  eb_status_t status;
+  struct ebtool_result r;
+  r.stop = 0;
+  r.data = 0;
+  if ((status = eb_cycle_open(device, &r, &ebtool_read_done, &cycle)) != EB_OK) {
+    fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+    exit(1);
+  }
+  eb_cycle_write(cycle, address, format, (eb_data_t)data);
+  eb_cycle_close(cycle);
+  eb_device_flush(device);
+  while (!r.stop) { eb_socket_run(socket, -1); }
+}
+
+// Take samples from the FIFO of the sampler, one cycle
+//   Parameters :
+//      eb_address_t base : sampler
+//      unsigned int *data : pc and ra of every sample
+//      int n : samples to read, at most the number in the FIFO
+static void read_samples(eb_device_t device, eb_address_t base, unsigned int *data, int n) {
+  eb_cycle_t cycle;
+  eb_status_t status;
+  struct ebtool_result r;
+  int i;
+  r.stop = 0;
+  r.data = data;
+  if ((status = eb_cycle_open(device, &r, &ebtool_read_done, &cycle)) != EB_OK) {
+    fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+    exit(1);
+  }
+  for (i = 0; i < n; i++) {
+    eb_cycle_read(cycle, base + PCSAMPLER_PC, format, 0);
+    eb_cycle_read(cycle, base + PCSAMPLER_RA, format, 0);
+  }
+  eb_cycle_close(cycle);
+  eb_device_flush(device);
+  while (!r.stop) { eb_socket_run(socket, -1); }
+}
+
+int main(int argc, char** argv) {
+  long value;
+  char* value_end;
+  int opt, error, random, lines, addrlines, fifolog2, n, i, function, caller;
+  double seconds, rate, mhz, tstart, elapsed, wait, cumulative;
+  unsigned int level, period, data[2*SAMPLES_PER_CYCLE], pc, ra, lost, taken;
+  unsigned long long samples, unknown;
+  unsigned long k, m, shown;
+  struct countertable addresses, stacks, functions;
+  FILE *folded;
+
+  eb_status_t status;
+  eb_device_t device;
+  eb_width_t line_width;
+  struct sdb_devices table;
+  struct ebtool_bus bus;
+  const struct sdb_entry *sampler;
+
+  /* Specific command-line options */
+  int attempts;
+  const char* netaddress;
+  const char* firmware;
+  const char* foldedfile;
+
+  /* Default arguments */
+  program = argv[0];
+  address_width = EB_ADDRX;
+  data_width = EB_DATAX;
+  attempts = 3;
+  quiet = 0;
+  verbose = 0;
+  error = 0;
+  seconds = 10.0;
+  rate = 10000.0;
+  mhz = 125.0;
+  random = 0;
+  lines = 30;
+  addrlines = 0;
+  foldedfile = 0;
+
+  /* Process the command-line arguments */
+  while ((opt = getopt(argc, argv, "a:d:r:t:F:f:Rn:A:g:vqh")) != -1) {
+    switch (opt) {
+    case 'a':
+      value = parse_width(optarg);
+      if (value < 0) {
+        fprintf(stderr, "%s: invalid address width -- '%s'\n", program, optarg);
+        return 1;
+      }
+      address_width = value << 4;
+      break;
+    case 'd':
+      value = parse_width(optarg);
+      if (value < 0) {
+        fprintf(stderr, "%s: invalid data width -- '%s'\n", program, optarg);
+        return 1;
+      }
+      data_width = value;
+      break;
+    case 'r':
+      value = strtol(optarg, &value_end, 0);
+      if (*value_end || value < 0 || value > 100) {
+        fprintf(stderr, "%s: invalid number of retries -- '%s'\n", program, optarg);
+        return 1;
+      }
+      attempts = value;
+      break;
+    case 't':
+      seconds = strtod(optarg, &value_end);
+      if (*value_end || seconds < 0) {
+        fprintf(stderr, "%s: invalid time -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'F':
+      rate = strtod(optarg, &value_end);
+      if (*value_end || rate <= 0) {
+        fprintf(stderr, "%s: invalid sample rate -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'f':
+      mhz = strtod(optarg, &value_end);
+      if (*value_end || mhz <= 0) {
+        fprintf(stderr, "%s: invalid clock frequency -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'R':
+      random = 1;
+      break;
+    case 'n':
+      lines = strtol(optarg, &value_end, 0);
+      if (*value_end || lines < 0) {
+        fprintf(stderr, "%s: invalid number of lines -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'A':
+      addrlines = strtol(optarg, &value_end, 0);
+      if (*value_end || addrlines < 0) {
+        fprintf(stderr, "%s: invalid number of lines -- '%s'\n", program, optarg);
+        return 1;
+      }
+      break;
+    case 'g':
+      foldedfile = optarg;
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    case 'q':
+      quiet = 1;
+      break;
+    case 'h':
+      help();
+      return 1;
+    case ':':
+    case '?':
+      error = 1;
+      break;
+    default:
+      fprintf(stderr, "%s: bad getopt result\n", program);
+      return 1;
+    }
+  }
+
+  if (error) return 1;
+
+  if (optind + 2 != argc) {
+    fprintf(stderr, "%s: expecting two non-optional arguments: <proto/host/port> <firmware.elf>\n", program);
+    return 1;
+  }
+  netaddress = argv[optind];
+  firmware = argv[optind+1];
+
+  if (mhz * 1e6 / rate < 2 || mhz * 1e6 / rate > 4e9) {
+    fprintf(stderr, "%s: sample rate out of range for a %g MHz clock\n", program, mhz);
+    return 1;
+  }
+  period = (unsigned int)(mhz * 1e6 / rate + 0.5) - 1;
+  if (random) period = period > 128 ? period - 128 : 0; // the random part adds 128 on average
+
+  if (read_symbols(firmware)) return 1;
+  if (verbose)
+    fprintf(stdout, "%d symbols in '%s'\n", nrofsymbols, firmware);
+
+  folded = 0;
+  if (foldedfile) {
+    folded = strcmp(foldedfile, "-") ? fopen(foldedfile, "w") : stdout;
+    if (folded == 0) {
+      fprintf(stderr, "%s: cannot open %s: %s\n", program, foldedfile, strerror(errno));
+      return 1;
+    }
+  }
+
+  if (verbose)
+    fprintf(stdout, "Opening socket with %s-bit address and %s-bit data widths\n",
+                    width_str[address_width>>4], width_str[data_width]);
+
+  if ((status = eb_socket_open(EB_ABI_CODE, 0, address_width|data_width, &socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if (verbose)
+    fprintf(stdout, "Connecting to '%s' with %d retry attempts...\n", netaddress, attempts);
+
+  if ((status = eb_device_open(socket, netaddress, EB_ADDRX|EB_DATAX, attempts, &device)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone device: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  line_width = eb_device_width(device);
+  if (verbose)
+    fprintf(stdout, "  negotiated %s-bit address and %s-bit data session.\n",
+                    width_str[line_width >> 4], width_str[line_width & EB_DATAX]);
+  if ((line_width & EB_DATAX) < EB_DATA32) {
+    fprintf(stderr, "%s: error: 32-bit data access needed, the session is %s-bit\n", program, width_str[line_width & EB_DATAX]);
+    return 1;
+  }
+
+  bus.socket = socket;
+  bus.device = device;
+  bus.format = format;
+  if (sdb_scan(&table, SDB_ADDRESS, &ebtool_sdb_read, &bus) < 0) {
+    fprintf(stderr, "%s: no SDB records found at 0x%x\n", program, SDB_ADDRESS);
+    return 1;
+  }
+  sampler = sdb_find(&table, SDB_VENDOR_GSI, SDB_DEVICE_PCSAMPLER, 0);
+  if (sampler == 0) {
+    fprintf(stderr, "%s: no program counter sampler found in the SDB records\n", program);
+    return 1;
+  }
+  if (verbose)
+    fprintf(stdout, "  found the program counter sampler at 0x%x\n", sampler->base);
+
+  /* Start sampling */
+  eb_writeword(device, sampler->base + PCSAMPLER_CONTROL, PCSAMPLER_CONTROL_CLEAR);
+  eb_writeword(device, sampler->base + PCSAMPLER_PERIOD, period);
+  fifolog2 = PCSAMPLER_STATUS_FIFOLOG2(ebtool_readword(&bus, sampler->base + PCSAMPLER_STATUS));
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+  eb_writeword(device, sampler->base + PCSAMPLER_CONTROL,
+               PCSAMPLER_CONTROL_ENABLE | (random ? PCSAMPLER_CONTROL_RANDOM : 0));
+  if (verbose)
+    fprintf(stdout, "Sampling every %u cycles for %g s, FIFO of %d samples\n", period+1, seconds, 1 << fifolog2);
+
+  memset(&addresses, 0, sizeof(addresses));
+  memset(&stacks, 0, sizeof(stacks));
+  samples = 0;
+  tstart = ebtool_now();
+  for (;;) {
+    elapsed = ebtool_now() - tstart;
+    if (stop || (seconds > 0 && elapsed >= seconds))
+      eb_writeword(device, sampler->base + PCSAMPLER_CONTROL, 0);
+
+    /* Drain the FIFO */
+    level = PCSAMPLER_STATUS_LEVEL(ebtool_readword(&bus, sampler->base + PCSAMPLER_STATUS));
+    while (level > 0) {
+      n = level < SAMPLES_PER_CYCLE ? level : SAMPLES_PER_CYCLE;
+      read_samples(device, sampler->base, data, n);
+      for (i = 0; i < n; i++) {
+        pc = data[2*i];
+        ra = data[2*i+1];
+        function = lookup(pc);
+        caller = ra >= 4 ? lookup(ra - 4) : UNKNOWN;  // ra is the address after the call
+        if (caller == function) caller = UNKNOWN;      // a call of this function has returned
+        if (function != UNKNOWN) symbols[function].samples++;
+        counter_add(&addresses, pc, 1);
+        counter_add(&stacks, ((unsigned long long)(unsigned int)caller << 32) | (unsigned int)function, 1);
+      }
+      samples += n;
+      level -= n;
+    }
+
+    if (stop || (seconds > 0 && elapsed >= seconds)) break;
+    /* Wait until the FIFO is about a quarter full */
+    wait = 1e6 * (1 << fifolog2) / 4 / rate;
+    usleep(wait > 100000 ? 100000 : (useconds_t)wait);
+  }
+  elapsed = ebtool_now() - tstart;
+  lost = ebtool_readword(&bus, sampler->base + PCSAMPLER_LOST);
+  taken = ebtool_readword(&bus, sampler->base + PCSAMPLER_TAKEN);
+
+  if ((status = eb_device_close(device)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone device: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if ((status = eb_socket_close(socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if (lost && !quiet)
+    fprintf(stderr, "%s: warning: %u of %u samples lost, lower the sample rate\n", program, lost, taken);
+  if (samples == 0) {
+    fprintf(stderr, "%s: no samples\n", program);
+    return 1;
+  }
+
+  /* Flat profile */
+  unknown = samples;
+  for (i = 0; i < nrofsymbols; i++) unknown -= symbols[i].samples;
+  fprintf(stdout, "%llu samples in %.1f s (%.0f samples/s)\n", samples, elapsed, samples / elapsed);
+  fprintf(stdout, "%7s %7s %10s  %s\n", "self%", "total%", "samples", "function");
+  memset(&functions, 0, sizeof(functions));
+  for (i = 0; i < nrofsymbols; i++)
+    if (symbols[i].samples) counter_add(&functions, (unsigned long long)i, symbols[i].samples);
+  if (unknown) counter_add(&functions, (unsigned long long)(unsigned int)UNKNOWN, unknown);
+  m = counter_sort(&functions);
+  shown = lines == 0 || (unsigned long)lines > m ? m : (unsigned long)lines;
+  cumulative = 0;
+  for (k = 0; k < shown; k++) {
+    cumulative += 100.0 * functions.c[k].count / samples;
+    fprintf(stdout, "%6.2f%% %6.2f%% %10lu  %s\n", 100.0 * functions.c[k].count / samples, cumulative,
+            functions.c[k].count, symbol_name((int)(unsigned int)functions.c[k].key));
+  }
+
+  /* Hottest instructions */
+  if (addrlines) {
+    m = counter_sort(&addresses);
+    shown = (unsigned long)addrlines > m ? m : (unsigned long)addrlines;
+    fprintf(stdout, "\n%7s %10s  %-10s  %s\n", "self%", "samples", "address", "function");
+    for (k = 0; k < shown; k++) {
+      pc = (unsigned int)addresses.c[k].key;
+      function = lookup(pc);
+      fprintf(stdout, "%6.2f%% %10lu  0x%08x  %s", 100.0 * addresses.c[k].count / samples,
+              addresses.c[k].count, pc, symbol_name(function));
+      if (function != UNKNOWN) fprintf(stdout, "+0x%x", pc - symbols[function].address);
+      fprintf(stdout, "\n");
+    }
+  }
+
+  /* Folded stacks */
+  if (folded) {
+    m = counter_sort(&stacks);
+    for (k = 0; k < m; k++) {
+      caller = (int)(unsigned int)(stacks.c[k].key >> 32);
+      function = (int)(unsigned int)stacks.c[k].key;
+      if (caller != UNKNOWN) fprintf(folded, "%s;", symbol_name(caller));
+      fprintf(folded, "%s %lu\n", symbol_name(function), stacks.c[k].count);
+    }
+    if (folded != stdout) fclose(folded);
+  }
+
+  return 0;
+}
@@ -0,0 +1,810 @@
+/** @file eb-simulator.c
+ *  @brief An Etherbone server which simulates the KVI modules of the Pexaria2a card.
+ *
+ *  Copyright (C) 2011-2012 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  A complete skeleton of an application using the Etherbone library.
+ *
+ *  @author Wesley W. Terpstra <w.terpstra@gsi.de>
+ *  adjusted as a stand-in for the Pexaria2a Pcie card by Peter Schakel <p.schakel@rug.nl>
+ *
+ *  The host programs can be run without a card: they connect to udp/localhost/<port> instead of
+ *  dev/pcie_wb0. The simulator attaches one slave to the Etherbone socket for the whole address
+ *  space, the accesses are decoded as in wishbone_demo_top.vhd:
+ *      0x100000 : SDB ROM with the simulated modules, sdb_scan finds them as on the card
+ *      0x110000 : SinglePulseGenerator, 125MHz clock, soft trigger
+ *      0x110400 : PatternGenerator, 8 outputs, 128 words
+ *      0x110700 : readTimestampModule, a burst every 10us (100kHz BuTiS T0), link histograms
+ *      0x110800 : FlashUpdateModule, 16MiB flash with 64KiB sectors and 256 byte pages
+ *  Other addresses give a wishbone error. The registers are 32-bit big-endian as on the card.
+ *
+ *  The flash follows the register interface of FlashUpdateModule.vhd: bytes written to the data
+ *  register go to the 256 byte write fifo, disabling the write access programs them as one page
+ *  (the address wraps inside the page, bits can only be cleared). A sector is erased by a write
+ *  with the erase access. Reading streams the flash into the 1024 byte read fifo at the serial
+ *  rate, every write to the data register takes the next byte. The module is busy during the
+ *  page program and the sector erase, like the card the host has to poll the busy bit. The
+ *  default latencies are in the range of the serial flash of the card, -s scales them (0: none).
+ *
+ *  Every request is recorded: the accesses handled in one pass of the Etherbone socket, one
+ *  packet of a synchronous tool like eb-loadflash. The gap is the time from the previous reply
+ *  to this request, the time the host needed for its side of the round trip. With -L every
+ *  request is written as a line to a CSV file, at the end a summary with the round trips and
+ *  the flash throughput is shown. With -t the simulator stops when the host is done, for scripts:
+ *      eb-simulator -t 2 -o flash.bin -L requests.csv &
+ *      eb-loadflash -m udp/localhost/60368 0x00800000 wishbone_demo.rbf
+ *
+ *  @bug The interrupt of the flash module is not simulated: use the host programs without -i.
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <unistd.h> /* getopt */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+
+#include "../etherbone.h"
+#include "../glue/version.h"
+#include "common.h"
+#include "../../common/sdb.h"
+#include "../../common/ebtool.h"
+
+#define DEFAULT_PORT "60368"
+#define SIMULATOR_DEVICE 0x35aa6ba2 // the simulated bus in the Etherbone config space
+
+/* Base addresses of wishbone_demo_top.vhd */
+#define SINGLEPULSE_BASE 0x110000
+#define PATTERN_BASE 0x110400
+#define READTIMESTAMP_BASE 0x110700
+#define FLASH_BASE 0x110800
+
+/* FlashUpdateModule */
+#define FLASHSIZE 16777216
+#define SECTORSIZE 65536
+#define PAGESIZE 256
+#define RDFIFOSIZE 1024 // g_flash_rdfifosize
+#define FLASH_ID 0x18 // silicon id of the EPCS128/EPCQ128
+
+#define FLASH_PARAMETERS 0x0
+#define FLASH_PARAMETERS_READ 0x4
+#define FLASH_DATA 0x8
+#define FLASH_READ 0xc
+#define FLASH_ACCESS 0x10
+
+#define PARAMS_WRITE 0x08000000
+#define PARAMS_REQUEST 0x10000000
+#define PARAMS_RECONF(v) (((v) >> 29) & 0x7)
+#define READ_VALID 0x100
+#define READ_BUSY 0x200
+#define ACCESS_ENABLE 0x1
+#define ACCESS_READ 0x2
+#define ACCESS_WRITE(v) (((v) >> 2) & 0x7) // 0b101 enables
+#define ACCESS_ERASE(v) (((v) >> 5) & 0x7) // 0b101 enables
+#define ACCESS_ID 0x100
+#define ACCESS_STATUS 0x200
+
+/* PatternGenerator and SinglePulseGenerator */
+#define CONTROL_ENABLE 0x1
+#define CONTROL_LOAD 0x2
+#define CONTROL_STOP 0x4
+#define CONTROL_SOFTTRIGGER 0x8
+#define PATTERN_OUTPUTS 8 // g_nrofoutputs
+#define PATTERN_DEPTHBITS 7 // g_patterndepthbits
+#define CLOCK_MHZ 125.0
+
+/* readTimestampModule */
+#define T0_PERIOD_US 10.0 // BuTiS T0, g_BuTis_ratio=2000 C2 clocks of 200MHz
+#define HIST_PERIOD_BIN 7 // bin of a T0 period without deviation, g_BuTis_T0_precision=100
+#define RDTIME_DISABLE 0x1
+#define RDTIME_CLEAR 0x8
+#define RDTIME_HIST_FREEZE 0x10
+#define RDTIME_HIST_CLEAR 0x20
+
+#define RT_BINS 24 // round trip histogram: bin 0 below 1us, bin n from 2^(n-1)us
+
+static void help(void) {
+  fprintf(stderr, "Usage: %s [OPTION]\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -p <port>      Etherbone port to listen on (%s)\n", DEFAULT_PORT);
+  fprintf(stderr, "  -s <factor>    scale the flash latencies, 0 for none (1.0)\n");
+  fprintf(stderr, "  -e <ms>        sector erase time (250)\n");
+  fprintf(stderr, "  -w <us>        page program time (400)\n");
+  fprintf(stderr, "  -R <kB/s>      serial flash read rate (2500)\n");
+  fprintf(stderr, "  -i <file>      initial contents of the flash from address 0 (erased)\n");
+  fprintf(stderr, "  -o <file>      write the contents of the flash to file at the end\n");
+  fprintf(stderr, "  -L <file>      write every request to a CSV file\n");
+  fprintf(stderr, "  -t <seconds>   stop when idle this long after the first request (0: until interrupted)\n");
+  fprintf(stderr, "  -v             verbose operation, show every flash command\n");
+  fprintf(stderr, "  -q             quiet: do not display warnings\n");
+  fprintf(stderr, "  -h             display this help and exit\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "The host programs connect to udp/localhost/<port>, the modules are found in the SDB records at 0x%x.\n", SDB_ADDRESS);
+  fprintf(stderr, "A request is the set of accesses handled in one pass, the gap is the host side of the round trip.\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Report Etherbone bugs to <etherbone-core@ohwr.org>\n");
+  fprintf(stderr, "Version %"PRIx32" (%s). Licensed under the LGPL v3.\n", EB_VERSION_SHORT, EB_DATE_FULL);
+}
+
+static eb_socket_t socket;
+static volatile sig_atomic_t stop = 0;
+static double t_start; // us
+
+static void on_signal(int sig) {
+  stop = 1;
+}
+
+// Time since the start of the simulator
+//   Parameters :
+//      return : time in us
+static double now(void) {
+  return ebtool_now()*1e6 - t_start;
+}
+
+/* Flash latencies in us, multiplied by timescale */
+static double timescale = 1.0;
+static double erase_us = 250000.0;
+static double program_us = 400.0;
+static double read_rate = 2500.0; // kB/s
+
+static struct {
+  unsigned char *mem;
+  unsigned int access; // FLASH_ACCESS register
+  unsigned int params[8]; // altremote_update parameters
+  unsigned int params_written; // FLASH_PARAMETERS register
+  unsigned int params_read; // data and index of the last parameter request
+  double busy_until; // page program or sector erase in progress
+  /* write fifo */
+  unsigned char wrfifo[PAGESIZE];
+  int wrcount;
+  unsigned int wraddress;
+  /* read fifo */
+  int reading;
+  unsigned int rdaddress;
+  double rdstart;
+  int rdpopped;
+  unsigned int data; // data of FLASH_READ
+  /* statistics */
+  unsigned long programmed, pages, sectors, bytesread, polls, busypolls, lost;
+} flash;
+
+static struct {
+  unsigned int delay, duration, control;
+  double trigger; // us, <0: not triggered
+} pulse;
+
+static struct {
+  unsigned int period, control;
+  unsigned char mem[1 << PATTERN_DEPTHBITS];
+  int wraddress, written, values;
+  double trigger; // us, <0: not triggered
+} pattern;
+
+static struct {
+  unsigned int control, high, low, errors, corrections;
+  double base; // wall clock at the start of the simulator, us
+  unsigned long long hist_start, hist_frozen;
+} rdtime;
+
+/* Requests: the accesses of one pass of eb_socket_run */
+static struct {
+  unsigned long reads, writes;
+  unsigned int address; // first address
+  double first, last;
+} cur;
+
+static struct {
+  unsigned long requests, reads, writes, errors;
+  double first, end, gaptotal, gapmax, servicetotal;
+  unsigned long hist[RT_BINS];
+} rt;
+
+static FILE* log_f;
+static const char* logfile;
+
+// Decide the state of the flash module from the access register, as FlashUpdateModule.vhd:
+// enable with bit0, one of reading (bit1), writing (0b101 in bit4..2) or erasing (0b101 in bit7..5)
+static int flash_writing(unsigned int access) {
+  return (access & ACCESS_ENABLE) && (ACCESS_WRITE(access) == 5) && !(access & ACCESS_READ) && (ACCESS_ERASE(access) != 5);
+}
+
+static int flash_reading(unsigned int access) {
+  return (access & ACCESS_ENABLE) && (access & ACCESS_READ) && (ACCESS_WRITE(access) != 5) && (ACCESS_ERASE(access) != 5);
+}
+
+static int flash_erasing(unsigned int access) {
+  return (access & ACCESS_ENABLE) && (ACCESS_ERASE(access) == 5) && (ACCESS_WRITE(access) != 5) && !(access & ACCESS_READ);
+}
+
+// Bytes streamed into the read fifo since the read started, at most the fifo size
+//   Parameters :
+//      double t : current time in us
+//      return : number of bytes read from the flash
+static int flash_streamed(double t) {
+  double bytetime = timescale*1000.0/read_rate;
+  double n;
+  if (!flash.reading) return 0;
+  if (bytetime <= 0) return RDFIFOSIZE;
+  n = (t - flash.rdstart)/bytetime;
+  return (n >= RDFIFOSIZE) ? RDFIFOSIZE : (int)n;
+}
+
+static int flash_busy(double t) {
+  return (t < flash.busy_until) || (flash.wrcount >= PAGESIZE) ||
+         (flash.reading && (flash_streamed(t) < RDFIFOSIZE));
+}
+
+// Program the bytes of the write fifo as one page, the address wraps at the end of the page
+static void flash_program(double t) {
+  int i;
+  unsigned int page = flash.wraddress & ~(PAGESIZE-1);
+  for (i = 0; i < flash.wrcount; i++)
+    flash.mem[page | ((flash.wraddress + i) & (PAGESIZE-1))] &= flash.wrfifo[i];
+  if (verbose)
+    fprintf(stdout, "flash: program %d bytes at 0x%06x\n", flash.wrcount, flash.wraddress);
+  flash.programmed += flash.wrcount;
+  flash.pages++;
+  flash.wrcount = 0;
+  flash.busy_until = t + timescale*program_us;
+}
+
+static void flash_reset(void) {
+  flash.access = 0;
+  flash.wrcount = 0;
+  flash.reading = 0;
+  flash.params_read = 0;
+}
+
+static void flash_write(unsigned int offset, unsigned int value, double t) {
+  unsigned int address = (value >> 8) & (FLASHSIZE-1);
+  int i;
+  switch (offset) {
+  case FLASH_PARAMETERS:
+    flash.params_written = value;
+    if (PARAMS_RECONF(value) == 5) {
+      if (!quiet) fprintf(stderr, "%s: warning: reconfiguration of the FPGA requested, ignored\n", program);
+    } else if (PARAMS_RECONF(value) == 7) {
+      if (verbose) fprintf(stdout, "flash: reset of the update module\n");
+      flash_reset();
+    } else {
+      i = (value >> 24) & 0x7;
+      if ((value & PARAMS_WRITE) && (i >= 2)) flash.params[i] = value & 0x00ffffff;
+      if (value & PARAMS_REQUEST) flash.params_read = (i << 24) | flash.params[i];
+    }
+    break;
+  case FLASH_DATA:
+    if (flash_writing(flash.access)) {
+      if (flash.wrcount >= PAGESIZE) {
+        flash.lost++; // write fifo full: the byte is lost, as on the card
+      } else {
+        if (flash.wrcount == 0) flash.wraddress = address;
+        flash.wrfifo[flash.wrcount++] = value & 0xff;
+      }
+    } else if (flash_erasing(flash.access)) {
+      if (t < flash.busy_until) break; // the erase command is not accepted while busy
+      address &= ~(SECTORSIZE-1);
+      memset(flash.mem + address, 0xff, SECTORSIZE);
+      if (verbose) fprintf(stdout, "flash: erase sector 0x%06x\n", address);
+      flash.sectors++;
+      flash.busy_until = t + timescale*erase_us;
+    } else if (flash_reading(flash.access)) {
+      if (!flash.reading) { // the first write gives the address, the next ones take a byte
+        if (verbose) fprintf(stdout, "flash: read from 0x%06x\n", address);
+        flash.reading = 1;
+        flash.rdaddress = address;
+        flash.rdstart = t;
+        flash.rdpopped = 0;
+      } else if (flash.rdpopped < flash_streamed(t)) {
+        flash.data = flash.mem[(flash.rdaddress + flash.rdpopped++) & (FLASHSIZE-1)];
+        flash.bytesread++;
+      }
+    }
+    break;
+  case FLASH_ACCESS:
+    if (flash_writing(flash.access) && !flash_writing(value) && (flash.wrcount > 0)) flash_program(t);
+    if (!flash_reading(value)) flash.reading = 0; // the read fifo is cleared when not reading
+    flash.access = value;
+    if ((value & ACCESS_ENABLE) && !flash_reading(value) && !flash_writing(value)) {
+      if (value & ACCESS_ID) flash.data = FLASH_ID;
+      else if (value & ACCESS_STATUS) flash.data = (t < flash.busy_until) ? 0x03 : 0x00; // WIP and WEL
+    }
+    break;
+  }
+}
+
+static unsigned int flash_read(unsigned int offset, double t) {
+  unsigned int value;
+  switch (offset) {
+  case FLASH_PARAMETERS:
+    return flash.params_written;
+  case FLASH_PARAMETERS_READ:
+    return flash.params_read; // no busy, the flash is never protected: no illegal write or erase error
+  case FLASH_DATA:
+    return 0;
+  case FLASH_READ:
+    value = flash.data & 0xff;
+    if (flash.reading && (flash.rdpopped < flash_streamed(t))) value |= READ_VALID;
+    flash.polls++;
+    if (flash_busy(t)) {
+      value |= READ_BUSY;
+      flash.busypolls++;
+    }
+    return value;
+  case FLASH_ACCESS:
+    return flash.access;
+  }
+  return 0;
+}
+
+// Pulse generator: after a soft trigger 'delay' clock cycles busy, then 'duration' cycles active
+static void pulse_write(unsigned int offset, unsigned int value, double t) {
+  switch (offset) {
+  case 0x0: pulse.delay = value; break;
+  case 0x4: pulse.duration = value; break;
+  case 0x8:
+    pulse.control = value & CONTROL_ENABLE;
+    if (value & CONTROL_STOP) pulse.trigger = -1;
+    else if (value & CONTROL_SOFTTRIGGER) pulse.trigger = t;
+    break;
+  }
+}
+
+static unsigned int pulse_read(unsigned int offset, double t) {
+  double cycles;
+  unsigned int status = 0;
+  switch (offset) {
+  case 0x0: return pulse.delay;
+  case 0x4: return pulse.duration;
+  case 0x8: return pulse.control;
+  case 0xc:
+    if (pulse.trigger < 0) return 0;
+    cycles = (t - pulse.trigger)*CLOCK_MHZ;
+    if (cycles < (double)pulse.delay + pulse.duration) status |= 0x1; // busy
+    if ((cycles >= pulse.delay) && (cycles < (double)pulse.delay + pulse.duration)) status |= 0x2; // active
+    return status;
+  }
+  return 0;
+}
+
+// Pattern generator: words written while 'load' is set form the pattern, the number of words
+// is its length. A soft trigger outputs it, 'period' clock cycles for each word.
+static void pattern_write(unsigned int offset, unsigned int value, double t) {
+  switch (offset) {
+  case 0x0:
+    if (pattern.control & CONTROL_LOAD) {
+      pattern.mem[pattern.wraddress] = value & ((1 << PATTERN_OUTPUTS)-1);
+      pattern.wraddress = (pattern.wraddress+1) & ((1 << PATTERN_DEPTHBITS)-1);
+      pattern.written = 1;
+    }
+    break;
+  case 0x4: pattern.period = value; break;
+  case 0x8:
+    if ((pattern.control & CONTROL_LOAD) && !(value & CONTROL_LOAD)) {
+      if (pattern.written) pattern.values = pattern.wraddress ? pattern.wraddress : (1 << PATTERN_DEPTHBITS);
+      pattern.wraddress = 0;
+      pattern.written = 0;
+    }
+    pattern.control = value & (CONTROL_ENABLE|CONTROL_LOAD);
+    if (value & CONTROL_STOP) pattern.trigger = -1;
+    else if ((value & CONTROL_SOFTTRIGGER) && (pattern.trigger < 0)) pattern.trigger = t;
+    break;
+  }
+}
+
+static unsigned int pattern_read(unsigned int offset, double t) {
+  unsigned int period, status;
+  switch (offset) {
+  case 0x4: return pattern.period;
+  case 0x8: return pattern.control;
+  case 0xc:
+    status = (PATTERN_DEPTHBITS << 24) | (PATTERN_OUTPUTS << 16);
+    period = pattern.period & 0xffff; // g_periodbits
+    if (period == 0) period = 1;
+    if ((pattern.trigger >= 0) && ((t - pattern.trigger)*CLOCK_MHZ < (double)pattern.values*period)) status |= 0x1;
+    else pattern.trigger = -1;
+    return status;
+  }
+  return 0;
+}
+
+// Timestamp receiver: a burst every T0 with the time in ns, received without errors
+static unsigned long long rdtime_bursts(double t) {
+  return (unsigned long long)(t/T0_PERIOD_US);
+}
+
+static unsigned int rdtime_hist(unsigned long long n) {
+  return (n > 0xffffffffULL) ? 0xffffffff : (unsigned int)n;
+}
+
+static void rdtime_latch(double t) {
+  unsigned long long ns;
+  if (rdtime.control & RDTIME_DISABLE) return;
+  ns = (unsigned long long)((rdtime.base + rdtime_bursts(t)*T0_PERIOD_US)*1000.0);
+  rdtime.high = (unsigned int)(ns >> 32);
+  rdtime.low = (unsigned int)ns;
+}
+
+static void rdtime_write(unsigned int offset, unsigned int value, double t) {
+  if (offset != 0x10) return;
+  rdtime_latch(t);
+  if (value & RDTIME_CLEAR) rdtime.errors = rdtime.corrections = 0;
+  if (value & RDTIME_HIST_CLEAR) {
+    rdtime.hist_start = rdtime_bursts(t);
+    rdtime.hist_frozen = 0;
+  }
+  if ((value & RDTIME_HIST_FREEZE) && !(rdtime.control & RDTIME_HIST_FREEZE))
+    rdtime.hist_frozen = rdtime_bursts(t) - rdtime.hist_start;
+  if (!(value & RDTIME_HIST_FREEZE) && (rdtime.control & RDTIME_HIST_FREEZE))
+    rdtime.hist_start = rdtime_bursts(t) - rdtime.hist_frozen;
+  rdtime.control = value & (RDTIME_DISABLE|RDTIME_HIST_FREEZE);
+}
+
+static unsigned int rdtime_read(unsigned int offset, double t) {
+  unsigned long long bursts;
+  rdtime_latch(t);
+  switch (offset) {
+  case 0x00: return rdtime.high;
+  case 0x04: return rdtime.low;
+  case 0x08: return rdtime.errors;
+  case 0x0c: return rdtime.corrections;
+  case 0x10: return rdtime.control;
+  }
+  if (offset < 0x80) return 0;
+  bursts = (rdtime.control & RDTIME_HIST_FREEZE) ? rdtime.hist_frozen : rdtime_bursts(t) - rdtime.hist_start;
+  switch ((offset - 0x80) >> 2) {
+  case 0: return rdtime_hist(bursts); // no corrected symbols
+  case 8 + HIST_PERIOD_BIN: return rdtime_hist(bursts); // T0 period without deviation
+  case 24: return rdtime_hist(bursts ? bursts-1 : 0); // no jitter, not for the first burst
+  }
+  return 0;
+}
+
+/* Simulated modules, the SDB ROM is built from this table */
+struct simdevice {
+  unsigned int device, base, last, date;
+  const char *name; // 19 characters
+  void (*write)(unsigned int offset, unsigned int value, double t);
+  unsigned int (*read)(unsigned int offset, double t);
+};
+
+static const struct simdevice simdevices[] = {
+  { SDB_DEVICE_SINGLEPULSE, SINGLEPULSE_BASE, 0x0f, 0x20120830, "KVI_SINGLEPULSE    ", pulse_write, pulse_read },
+  { SDB_DEVICE_PATTERN, PATTERN_BASE, 0x0f, 0x20120830, "KVI_PATTERNGEN     ", pattern_write, pattern_read },
+  { SDB_DEVICE_READTIMESTAMP, READTIMESTAMP_BASE, 0xff, 0x20120830, "KVI_READTIMESTAMP  ", rdtime_write, rdtime_read },
+  { SDB_DEVICE_FLASH, FLASH_BASE, 0x1f, 0x20120830, "KVI_FLASHUPDATE    ", flash_write, flash_read }
+};
+#define SIMDEVICES (sizeof(simdevices)/sizeof(simdevices[0]))
+#define SDB_WORDS ((SIMDEVICES+1)*SDB_RECORDSIZE/4)
+
+static unsigned int sdb_rom[SDB_WORDS];
+
+// Fill one SDB record: the product part is the same for the interconnect and the devices
+//   Parameters :
+//      unsigned int *rec : 16 words of the record
+//      unsigned long long vendor, unsigned int device, unsigned int date : product
+//      const char *name : 19 characters
+//      unsigned int type : record type
+static void sdb_record(unsigned int *rec, unsigned long long vendor, unsigned int device,
+                        unsigned int date, const char *name, unsigned int type) {
+  unsigned char bytes[20];
+  int i;
+  rec[6] = (unsigned int)(vendor >> 32);
+  rec[7] = (unsigned int)vendor;
+  rec[8] = device;
+  rec[9] = 1; // version
+  rec[10] = date;
+  memcpy(bytes, name, 19);
+  bytes[19] = type;
+  for (i = 0; i < 5; i++)
+    rec[11+i] = (bytes[4*i] << 24) | (bytes[4*i+1] << 16) | (bytes[4*i+2] << 8) | bytes[4*i+3];
+}
+
+static void sdb_build(void) {
+  unsigned int *rec;
+  unsigned int i;
+  rec = sdb_rom;
+  rec[0] = SDB_MAGIC;
+  rec[1] = ((SIMDEVICES+1) << 16) | (1 << 8); // records, version 1, wishbone
+  rec[5] = 0x001fffff; // addr_last
+  sdb_record(rec, SDB_VENDOR_CERN, 0xe6a542c9, 0x20120305, "WB4-Crossbar-GSI   ", SDB_RECORD_INTERCONNECT);
+  for (i = 0; i < SIMDEVICES; i++) {
+    rec = sdb_rom + (i+1)*SDB_RECORDSIZE/4;
+    rec[0] = 0x00000100; // abi class 0, version 1.0
+    rec[1] = 0x4; // big-endian, 32-bit
+    rec[3] = simdevices[i].base;
+    rec[5] = simdevices[i].base + simdevices[i].last;
+    sdb_record(rec, SDB_VENDOR_GSI, simdevices[i].device, simdevices[i].date, simdevices[i].name, SDB_RECORD_DEVICE);
+  }
+}
+
+// Find the module of an address
+//   Parameters :
+//      eb_address_t address : bus address
+//      return : the module, 0 if none
+static const struct simdevice *decode(eb_address_t address) {
+  unsigned int i;
+  for (i = 0; i < SIMDEVICES; i++)
+    if ((address >= simdevices[i].base) && (address <= simdevices[i].base + simdevices[i].last))
+      return &simdevices[i];
+  return 0;
+}
+
+static void count_access(eb_address_t address, int write, double t) {
+  if (cur.reads + cur.writes == 0) {
+    cur.first = t;
+    cur.address = (unsigned int)address;
+  }
+  if (write) cur.writes++; else cur.reads++;
+  cur.last = t;
+}
+
+static eb_status_t sim_read(eb_user_data_t user, eb_address_t address, eb_width_t width, eb_data_t* data) {
+  const struct simdevice *d;
+  double t = now();
+  count_access(address, 0, t);
+  *data = 0;
+  if ((address >= SDB_ADDRESS) && (address < SDB_ADDRESS + SDB_WORDS*4)) {
+    *data = sdb_rom[(address - SDB_ADDRESS) >> 2];
+    return EB_OK;
+  }
+  d = decode(address);
+  if ((d == 0) || ((width & EB_DATAX) != EB_DATA32) || (address & 3)) {
+    rt.errors++;
+    return EB_SEGFAULT;
+  }
+  *data = d->read((unsigned int)(address - d->base), t);
+  return EB_OK;
+}
+
+static eb_status_t sim_write(eb_user_data_t user, eb_address_t address, eb_width_t width, eb_data_t data) {
+  const struct simdevice *d;
+  double t = now();
+  count_access(address, 1, t);
+  d = decode(address);
+  if ((d == 0) || ((width & EB_DATAX) != EB_DATA32) || (address & 3)) {
+    rt.errors++;
+    return EB_SEGFAULT;
+  }
+  d->write((unsigned int)(address - d->base), (unsigned int)data, t);
+  return EB_OK;
+}
+
+// Close the current request: the accesses handled since the previous pass of the socket
+static void end_request(void) {
+  double t = now();
+  double gap = rt.requests ? cur.first - rt.end : 0;
+  double service = t - cur.first;
+  int bin;
+  if (rt.requests == 0) rt.first = cur.first;
+  rt.requests++;
+  rt.reads += cur.reads;
+  rt.writes += cur.writes;
+  rt.gaptotal += gap;
+  if (gap > rt.gapmax) rt.gapmax = gap;
+  rt.servicetotal += service;
+  for (bin = 0; (bin < RT_BINS-1) && ((1 << bin) <= gap+service); bin++);
+  rt.hist[bin]++;
+  if (log_f)
+    fprintf(log_f, "%lu,%.1f,%.1f,%.1f,%lu,%lu,0x%x\n", rt.requests, cur.first, gap, service,
+                   cur.reads, cur.writes, cur.address);
+  rt.end = t;
+  cur.reads = cur.writes = 0;
+}
+
+static void summary(void) {
+  double active = (rt.end - rt.first)/1e6;
+  int bin;
+  fprintf(stdout, "requests      %10lu, %lu reads, %lu writes, %lu errors\n", rt.requests, rt.reads, rt.writes, rt.errors);
+  if (rt.requests == 0) return;
+  fprintf(stdout, "per request   %10.1f accesses\n", (double)(rt.reads + rt.writes)/rt.requests);
+  fprintf(stdout, "active        %10.3f s, %.0f requests/s\n", active, active > 0 ? rt.requests/active : 0.0);
+  fprintf(stdout, "round trip    %10.1f us average (host %.1f us, simulator %.1f us), longest gap %.1f us\n",
+                  (rt.gaptotal + rt.servicetotal)/rt.requests, rt.gaptotal/rt.requests, rt.servicetotal/rt.requests, rt.gapmax);
+  for (bin = 0; bin < RT_BINS; bin++)
+    if (rt.hist[bin])
+      fprintf(stdout, "  %8u us %10lu\n", bin ? 1 << (bin-1) : 0, rt.hist[bin]);
+  fprintf(stdout, "flash         %10lu bytes programmed in %lu pages, %lu sectors erased, %lu bytes read\n",
+                  flash.programmed, flash.pages, flash.sectors, flash.bytesread);
+  fprintf(stdout, "flash polls   %10lu, %lu while busy\n", flash.polls, flash.busypolls);
+  if (flash.lost) fprintf(stdout, "flash lost    %10lu bytes written to the full write fifo\n", flash.lost);
+  if (active > 0)
+    fprintf(stdout, "throughput    %10.1f kB/s programmed, %.1f kB/s read\n",
+                    flash.programmed/active/1000.0, flash.bytesread/active/1000.0);
+}
+
+int main(int argc, char** argv) {
+  char* value_end;
+  int opt, error;
+  double idle, value;
+  FILE* f;
+  size_t n;
+
+  eb_status_t status;
+  struct sdb_device device;
+  struct eb_handler handler;
+
+  /* Specific command-line options */
+  const char* port;
+  const char* initfile;
+  const char* outfile;
+
+  /* Default arguments */
+  program = argv[0];
+  quiet = 0;
+  verbose = 0;
+  error = 0;
+  port = DEFAULT_PORT;
+  initfile = 0;
+  outfile = 0;
+  logfile = 0;
+  idle = 0;
+
+  /* Process the command-line arguments */
+  while ((opt = getopt(argc, argv, "p:s:e:w:R:i:o:L:t:vqh")) != -1) {
+    switch (opt) {
+    case 'p':
+      port = optarg;
+      break;
+    case 's':
+    case 'e':
+    case 'w':
+    case 'R':
+    case 't':
+      value = strtod(optarg, &value_end);
+      if (*value_end || value < 0 || ((opt == 'R') && (value == 0))) {
+        fprintf(stderr, "%s: invalid value -- '%s'\n", program, optarg);
+        return 1;
+      }
+      if (opt == 's') timescale = value;
+      else if (opt == 'e') erase_us = value*1000.0;
+      else if (opt == 'w') program_us = value;
+      else if (opt == 'R') read_rate = value;
+      else idle = value;
+      break;
+    case 'i':
+      initfile = optarg;
+      break;
+    case 'o':
+      outfile = optarg;
+      break;
+    case 'L':
+      logfile = optarg;
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    case 'q':
+      quiet = 1;
+      break;
+    case 'h':
+      help();
+      return 1;
+    case ':':
+    case '?':
+      error = 1;
+      break;
+    default:
+      fprintf(stderr, "%s: bad getopt result\n", program);
+      return 1;
+    }
+  }
+
+  if (error) return 1;
+
+  if (optind != argc) {
+    fprintf(stderr, "%s: expecting no non-optional arguments\n", program);
+    return 1;
+  }
+
+  /* Initial state of the modules */
+  t_start = ebtool_now()*1e6;
+  rdtime.base = t_start;
+  pulse.trigger = -1;
+  pattern.trigger = -1;
+  sdb_build();
+
+  if ((flash.mem = (unsigned char*)malloc(FLASHSIZE)) == 0) {
+    fprintf(stderr, "%s: cannot allocate memory for the flash\n", program);
+    return 1;
+  }
+  memset(flash.mem, 0xff, FLASHSIZE);
+  if (initfile) {
+    if ((f = fopen(initfile, "r")) == 0) {
+      fprintf(stderr, "%s: fopen, %s -- '%s'\n", program, strerror(errno), initfile);
+      return 1;
+    }
+    n = fread(flash.mem, 1, FLASHSIZE, f);
+    fclose(f);
+    if (verbose) fprintf(stdout, "Loaded %lu bytes into the flash from '%s'\n", (unsigned long)n, initfile);
+  }
+
+  if (logfile) {
+    if ((log_f = fopen(logfile, "w")) == 0) {
+      fprintf(stderr, "%s: fopen, %s -- '%s'\n", program, strerror(errno), logfile);
+      return 1;
+    }
+    fprintf(log_f, "request,start_us,gap_us,service_us,reads,writes,address\n");
+  }
+
+  if ((status = eb_socket_open(EB_ABI_CODE, port, EB_ADDR32|EB_DATA32, &socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone socket on port %s: %s\n", program, port, eb_status(status));
+    return 1;
+  }
+
+  /* One slave for the whole address space, the addresses are decoded by the simulator */
+  memset(&device, 0, sizeof(device));
+  device.abi_class = 0;
+  device.abi_ver_major = 1;
+  device.abi_ver_minor = 0;
+  device.bus_specific = EB_DATA32; // big-endian, 32-bit
+  device.sdb_component.addr_first = 0;
+  device.sdb_component.addr_last = 0xffffffffULL;
+  device.sdb_component.product.vendor_id = SDB_VENDOR_GSI;
+  device.sdb_component.product.device_id = SIMULATOR_DEVICE;
+  device.sdb_component.product.version = 1;
+  device.sdb_component.product.date = 0x20261019;
+  memcpy(device.sdb_component.product.name, "KVI_PEXARIA2A_SIM  ", 19);
+  device.sdb_component.product.record_type = sdb_record_device;
+
+  handler.device = &device;
+  handler.data = 0;
+  handler.read = &sim_read;
+  handler.write = &sim_write;
+
+  if ((status = eb_socket_attach(socket, &handler)) != EB_OK) {
+    fprintf(stderr, "%s: failed to attach the simulated bus: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if (verbose)
+    fprintf(stdout, "Simulating the Pexaria2a on udp/localhost/%s, SDB records at 0x%x\n", port, SDB_ADDRESS);
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  while (!stop) {
+    eb_socket_run(socket, 100000);
+    if (cur.reads + cur.writes) end_request();
+    else if ((idle > 0) && rt.requests && (now() - rt.end > idle*1e6)) break;
+  }
+
+  summary();
+
+  if (log_f) fclose(log_f);
+
+  if (outfile) {
+    if ((f = fopen(outfile, "w")) == 0) {
+      fprintf(stderr, "%s: fopen, %s -- '%s'\n", program, strerror(errno), outfile);
+      return 1;
+    }
+    if (fwrite(flash.mem, 1, FLASHSIZE, f) != FLASHSIZE) {
+      fprintf(stderr, "%s: error writing to '%s'\n", program, outfile);
+      return 1;
+    }
+    fclose(f);
+  }
+
+  if ((status = eb_socket_close(socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+// Helpers shared by the Etherbone host programs (eb/eb-*.c)
+// Include after etherbone.h, the common.h of the etherbone tools (program, verbose) and sdb.h.
+// An Etherbone or wishbone error ends the program with a message, as in the rest of the tools.
+//
+//     struct ebtool_bus bus = { socket, device, EB_BIG_ENDIAN|EB_DATA32 };
+//     base = ebtool_find_base(&bus, SDB_VENDOR_GSI, SDB_DEVICE_FLASH, "flash update module");
+
+#ifndef EBTOOL_H
+#define EBTOOL_H
+
+#include <sys/time.h>
+
+// Etherbone connection for the blocking accesses and the SDB scan
+struct ebtool_bus {
+	eb_socket_t socket;
+	eb_device_t device;
+	eb_format_t format;
+};
+
+// user data of ebtool_read_done
+struct ebtool_result {
+	int stop; // set when the cycle has finished
+	unsigned int *data; // the words read are stored here, can be 0 for a write cycle
+};
+
+// Completion of a cycle, the user data is a struct ebtool_result
+static inline void ebtool_read_done(eb_user_data_t user, eb_device_t dev, eb_operation_t op, eb_status_t status) {
+	struct ebtool_result *r = (struct ebtool_result*)user;
+	unsigned int *p = r->data;
+	r->stop = 1;
+	if (status != EB_OK) {
+		fprintf(stderr, "%s: etherbone cycle error: %s\n", program, eb_status(status));
+		exit(1);
+	}
+	for (; op != EB_NULL; op = eb_operation_next(op)) {
+		if (eb_operation_had_error(op)) {
+			fprintf(stderr, "%s: wishbone segfault %s address 0x%"EB_ADDR_FMT"\n",
+				program, eb_operation_is_read(op) ? "reading from" : "writing to", eb_operation_address(op));
+			exit(1);
+		}
+		if (p && eb_operation_is_read(op)) *p++ = (unsigned int)eb_operation_data(op);
+	}
+}
+
+// Completion of a write cycle sent without waiting for it, the user data is the number of
+// cycles in flight (int *), counted down here
+static inline void ebtool_write_done(eb_user_data_t user, eb_device_t dev, eb_operation_t op, eb_status_t status) {
+	int *inflight = (int*)user;
+	(*inflight)--;
+	if (status != EB_OK) {
+		fprintf(stderr, "%s: etherbone cycle error: %s\n", program, eb_status(status));
+		exit(1);
+	}
+	for (; op != EB_NULL; op = eb_operation_next(op)) {
+		if (eb_operation_had_error(op)) {
+			fprintf(stderr, "%s: wishbone segfault writing to address 0x%"EB_ADDR_FMT"\n", program, eb_operation_address(op));
+			exit(1);
+		}
+	}
+}
+
+// Read one word in a cycle of its own and wait for it
+//   Parameters :
+//      const struct ebtool_bus *bus : Etherbone connection
+//      eb_address_t address : address of the word
+//      return : the word read
+static inline unsigned int ebtool_readword(const struct ebtool_bus *bus, eb_address_t address) {
+	eb_cycle_t cycle;
+	eb_status_t status;
+	struct ebtool_result r;
+	unsigned int data;
+	r.stop = 0;
+	r.data = &data;
+	if ((status = eb_cycle_open(bus->device, &r, &ebtool_read_done, &cycle)) != EB_OK) {
+		fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+		exit(1);
+	}
+	eb_cycle_read(cycle, address, bus->format, 0);
+	eb_cycle_close(cycle);
+	eb_device_flush(bus->device);
+	while (!r.stop) { eb_socket_run(bus->socket, -1); }
+	return data;
+}
+
+// Bus access for sdb_scan, the context is a struct ebtool_bus
+static inline unsigned int ebtool_sdb_read(void *ctx, unsigned int address) {
+	return ebtool_readword((const struct ebtool_bus*)ctx, address);
+}
+
+// Find a device in the scanned table, exits if it is not there
+//   Parameters :
+//      const struct sdb_devices *table : the scanned table
+//      unsigned long long vendor : vendor id
+//      unsigned int devid : device id
+//      const char *name : name of the device for the messages
+//      return : the device
+static inline const struct sdb_entry *ebtool_find_sdb(const struct sdb_devices *table, unsigned long long vendor, unsigned int devid, const char *name) {
+	const struct sdb_entry *e = sdb_find(table, vendor, devid, 0);
+	if (e == 0) {
+		fprintf(stderr, "%s: %s not found in the SDB records\n", program, name);
+		exit(1);
+	}
+	if (verbose)
+		fprintf(stdout, "  found %s at 0x%x\n", name, e->base);
+	return e;
+}
+
+// Scan the SDB ROM of the remote bus and find the base address of a module, for the programs
+// that also take the base address as an argument; exits if it is not found
+//   Parameters :
+//      const struct ebtool_bus *bus : Etherbone connection
+//      unsigned long long vendor : vendor id
+//      unsigned int devid : device id
+//      const char *name : name of the module for the messages
+//      return : base address of the module
+static inline eb_address_t ebtool_find_base(const struct ebtool_bus *bus, unsigned long long vendor, unsigned int devid, const char *name) {
+	struct sdb_devices table;
+	const struct sdb_entry *e;
+	if (sdb_scan(&table, SDB_ADDRESS, &ebtool_sdb_read, (void*)bus) < 0) {
+		fprintf(stderr, "%s: no SDB records found at 0x%x, give the base address\n", program, SDB_ADDRESS);
+		exit(1);
+	}
+	e = sdb_find(&table, vendor, devid, 0);
+	if (e == 0) {
+		fprintf(stderr, "%s: %s not found in the SDB records, give the base address\n", program, name);
+		exit(1);
+	}
+	if (verbose)
+		fprintf(stdout, "  found %s at 0x%x\n", name, e->base);
+	return e->base;
+}
+
+// Wall clock time in seconds, for the transfer rates
+static inline double ebtool_now(void) {
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec + tv.tv_usec*1e-6;
+}
+
+#endif
@@ -0,0 +1,121 @@
+// Number formatting for the LM32 firmware, see format.h
+
+#include "format.h"
+
+static const char format_hexdigits[16] = {'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'};
+
+static const unsigned int format_pow10[10] = {
+	1000000000,100000000,10000000,1000000,100000,10000,1000,100,10,1};
+
+static const unsigned long long format_pow10_64[20] = {
+	10000000000000000000ULL,1000000000000000000ULL,100000000000000000ULL,10000000000000000ULL,
+	1000000000000000ULL,100000000000000ULL,10000000000000ULL,1000000000000ULL,100000000000ULL,
+	10000000000ULL,1000000000ULL,100000000ULL,10000000ULL,1000000ULL,100000ULL,10000ULL,
+	1000ULL,100ULL,10ULL,1ULL};
+
+// Unsigned decimal
+//   Parameters :
+//      char *buf : result, at least FORMAT_INTSIZE characters
+//      unsigned int value : value to format
+//      return : number of characters
+int format_uint(char *buf, unsigned int value) {
+	char *p=buf;
+	unsigned int t,d;
+	int i;
+	for (i=0; (i<9) && (value<format_pow10[i]); i++); // skip leading zeros
+	if (i==0) { // 10^9: the digit is at most 4, 8*10^9 does not fit in 32 bits
+		t=format_pow10[0];
+		d=0;
+		if (value>=(t<<2)) { value-=t<<2; d=4; }
+		if (value>=(t<<1)) { value-=t<<1; d+=2; }
+		if (value>=t) { value-=t; d+=1; }
+		*p++='0'+d;
+		i++;
+	}
+	for (; i<10; i++) {
+		t=format_pow10[i];
+		d=0;
+		if (value>=(t<<3)) { value-=t<<3; d=8; }
+		if (value>=(t<<2)) { value-=t<<2; d+=4; }
+		if (value>=(t<<1)) { value-=t<<1; d+=2; }
+		if (value>=t) { value-=t; d+=1; }
+		*p++='0'+d;
+	}
+	*p=0;
+	return p-buf;
+}
+
+// Signed decimal
+//   Parameters :
+//      char *buf : result, at least FORMAT_INTSIZE characters
+//      int value : value to format
+//      return : number of characters
+int format_int(char *buf, int value) {
+	if (value<0) {
+		*buf='-';
+		return 1+format_uint(buf+1,0u-(unsigned int)value);
+	}
+	return format_uint(buf,(unsigned int)value);
+}
+
+// Unsigned 64-bit decimal, for instance a timestamp in ns
+//   Parameters :
+//      char *buf : result, at least FORMAT_UINT64SIZE characters
+//      unsigned int hw : high word
+//      unsigned int lw : low word
+//      return : number of characters
+int format_uint64(char *buf, unsigned int hw, unsigned int lw) {
+	unsigned long long value=((unsigned long long)hw << 32) | lw;
+	unsigned long long t,t2,t4,t8;
+	unsigned int d;
+	char *p=buf;
+	int i;
+	if (hw==0) return format_uint(buf,lw);
+	for (i=0; value<format_pow10_64[i]; i++); // skip leading zeros, hw!=0 so value>=10^9
+	if (i==0) { // 10^19: the digit is at most 1
+		value-=format_pow10_64[0];
+		*p++='1';
+		i++;
+	}
+	for (; i<20; i++) {
+		t=format_pow10_64[i];
+		t2=t+t;
+		t4=t2+t2;
+		t8=t4+t4;
+		d=0;
+		if (value>=t8) { value-=t8; d=8; }
+		if (value>=t4) { value-=t4; d+=4; }
+		if (value>=t2) { value-=t2; d+=2; }
+		if (value>=t) { value-=t; d+=1; }
+		*p++='0'+d;
+	}
+	*p=0;
+	return p-buf;
+}
+
+// Hexadecimal with a fixed number of digits, upper case
+//   Parameters :
+//      char *buf : result, at least digits+1 characters
+//      unsigned int value : value to format, only the lower digits*4 bits are used
+//      int digits : number of digits (1..8)
+//      return : number of characters
+int format_hex(char *buf, unsigned int value, int digits) {
+	int i;
+	for (i=digits-1; i>=0; i--) {
+		buf[i]=format_hexdigits[value & 0xf];
+		value>>=4;
+	}
+	buf[digits]=0;
+	return digits;
+}
+
+// 64-bit timestamp as 16 hexadecimal digits
+//   Parameters :
+//      char *buf : result, at least FORMAT_TIMESTAMPSIZE characters
+//      unsigned int hw : high word
+//      unsigned int lw : low word
+//      return : number of characters
+int format_timestamp(char *buf, unsigned int hw, unsigned int lw) {
+	format_hex(buf,hw,8);
+	return 8+format_hex(buf+8,lw,8);
+}
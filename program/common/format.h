@@ -0,0 +1,26 @@
+// Number formatting for the LM32 firmware, decimal and hexadecimal
+// The LM32 profiles used in the designs have no hardware divider: a % or / by 10 is a libgcc
+// call of a few hundred cycles per digit. The decimal conversion here subtracts 8,4,2,1 times
+// the power of ten for each digit, so a 32-bit value takes at most 40 compare and subtract steps.
+// Hexadecimal digits are taken from a 16-entry table, without a compare per digit.
+//
+// All functions write into a buffer of the caller and are reentrant (usable in interrupt handlers).
+// The result is terminated with a '\0', the return value is the number of characters without the '\0':
+//     char buf[FORMAT_INTSIZE];
+//     format_int(buf,rval); writestring(buf);
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#define FORMAT_INTSIZE 12 // buffer size for format_int and format_uint, "-2147483648"
+#define FORMAT_UINT64SIZE 21 // buffer size for format_uint64, "18446744073709551615"
+#define FORMAT_HEXSIZE 9 // buffer size for format_hex, 8 digits
+#define FORMAT_TIMESTAMPSIZE 17 // buffer size for format_timestamp, 16 digits
+
+int format_uint(char *buf, unsigned int value);
+int format_int(char *buf, int value);
+int format_uint64(char *buf, unsigned int hw, unsigned int lw);
+int format_hex(char *buf, unsigned int value, int digits);
+int format_timestamp(char *buf, unsigned int hw, unsigned int lw);
+
+#endif
@@ -0,0 +1,98 @@
+// Interrupt handling for the LM32 with the vectored interrupt controller (wb_vic)
+// The address of the handler for each VIC input is stored in the vector table of the VIC.
+// On an interrupt the VIC puts the address of the handler of the pending interrupt with the
+// highest priority in the vector address register, _irq_entry calls this handler and
+// acknowledges the interrupt in the VIC.
+
+#include "sdb.h"
+#include "irq.h"
+
+// addresses for the vectored interrupt controller, defaults if the SDB ROM does not list it
+#define VIC_ADDRESS 0x110a00
+volatile unsigned int* vic_control = (unsigned int*)0x110a00; // control bit 0,1 = enable, output polarity (1=active high)
+volatile unsigned int* vic_status = (unsigned int*)0x110a04; // raw interrupt status, bit n = input n
+volatile unsigned int* vic_enable = (unsigned int*)0x110a08; // write 1 on bit n enables input n
+volatile unsigned int* vic_disable = (unsigned int*)0x110a0c; // write 1 on bit n disables input n
+volatile unsigned int* vic_mask = (unsigned int*)0x110a10; // bit n set : input n enabled
+volatile unsigned int* vic_vector = (unsigned int*)0x110a14; // handler address of the pending interrupt
+volatile unsigned int* vic_software = (unsigned int*)0x110a18; // write 1 on bit n emulates interrupt on input n
+volatile unsigned int* vic_endofinterrupt = (unsigned int*)0x110a1c; // any write acknowledges the pending interrupt
+volatile unsigned int* vic_vectortable = (unsigned int*)0x110a80; // handler address for each input
+
+// handler for inputs without handler: disable the input to prevent an interrupt storm
+static void irq_unhandled(void) {
+	*vic_disable = *vic_status;
+}
+
+// Set the addresses of the VIC registers
+//   Parameters :
+//      unsigned int base : base address of the VIC
+static void vic_setbase(unsigned int base) {
+	vic_control = (unsigned int*)(base+0x00);
+	vic_status = (unsigned int*)(base+0x04);
+	vic_enable = (unsigned int*)(base+0x08);
+	vic_disable = (unsigned int*)(base+0x0c);
+	vic_mask = (unsigned int*)(base+0x10);
+	vic_vector = (unsigned int*)(base+0x14);
+	vic_software = (unsigned int*)(base+0x18);
+	vic_endofinterrupt = (unsigned int*)(base+0x1c);
+	vic_vectortable = (unsigned int*)(base+0x80);
+}
+
+// Initialize the VIC: all inputs disabled, enable VIC and LM32 interrupt 0
+// The address of the VIC is taken from the SDB ROM, sdb_init must be called before
+void vic_init(void) {
+	int i;
+	irq_disable();
+	vic_setbase(sdb_base(SDB_VENDOR_CERN,SDB_DEVICE_VIC,VIC_ADDRESS));
+	*vic_control = 0;
+	*vic_disable = 0xffffffff;
+	for (i=0; i<VIC_INTERRUPTS; i++) vic_vectortable[i] = (unsigned int)irq_unhandled;
+	*vic_control = 0x3; // enable, active high
+	asm volatile ("wcsr im, %0" :: "r"(1)); // only LM32 interrupt 0 is used
+	irq_enable();
+}
+
+// Set the handler for a VIC input
+//   Parameters :
+//      int irq : VIC input number
+//      irq_handler_t handler : function called on the interrupt, runs with interrupts disabled
+void vic_sethandler(int irq, irq_handler_t handler) {
+	if ((irq<0) || (irq>=VIC_INTERRUPTS)) return;
+	vic_vectortable[irq] = (unsigned int)handler;
+}
+
+void vic_enableirq(int irq) {
+	*vic_enable = 1 << irq;
+}
+
+void vic_disableirq(int irq) {
+	*vic_disable = 1 << irq;
+}
+
+void irq_enable(void) {
+	unsigned int ie;
+	asm volatile ("rcsr %0, ie" : "=r"(ie));
+	ie |= 1;
+	asm volatile ("wcsr ie, %0" :: "r"(ie));
+}
+
+// Disable LM32 interrupts, returns the previous state for irq_restore
+unsigned int irq_disable(void) {
+	unsigned int ie;
+	asm volatile ("rcsr %0, ie" : "=r"(ie));
+	asm volatile ("wcsr ie, %0" :: "r"(ie & ~1));
+	return ie & 1;
+}
+
+void irq_restore(unsigned int ie) {
+	if (ie) irq_enable();
+}
+
+// called from the interrupt handler in crt0.S
+void _irq_entry(void) {
+	irq_handler_t handler = (irq_handler_t)*vic_vector;
+	handler();
+	*vic_endofinterrupt = 0;
+	asm volatile ("wcsr ip, %0" :: "r"(1)); // clear pending LM32 interrupt 0, the VIC sets it again for the next interrupt
+}
@@ -0,0 +1,31 @@
+// Interrupt handling for the LM32 with the vectored interrupt controller (wb_vic)
+// The VIC is connected to LM32 interrupt 0, the VIC inputs are:
+//     0 : DMA controller
+//     1 : simple rs232 module, transmit fifo level below threshold
+//     2 : simple rs232 module, receive fifo level above threshold
+//     3 : tics timer, periodic interrupt
+//     4 : flash update module, read data available or ready for the next command
+
+#ifndef IRQ_H
+#define IRQ_H
+
+#define VIC_INTERRUPTS 8 // number of interrupt inputs of the VIC
+
+#define VIC_IRQ_DMA 0
+#define VIC_IRQ_RS232TX 1
+#define VIC_IRQ_RS232RX 2
+#define VIC_IRQ_TIMER 3
+#define VIC_IRQ_FLASH 4
+
+typedef void (*irq_handler_t)(void);
+
+void vic_init(void);
+void vic_sethandler(int irq, irq_handler_t handler);
+void vic_enableirq(int irq);
+void vic_disableirq(int irq);
+
+void irq_enable(void);
+unsigned int irq_disable(void);
+void irq_restore(unsigned int ie);
+
+#endif
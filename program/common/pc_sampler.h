@@ -0,0 +1,32 @@
+// Registers of the LM32 program counter sampler (modules/wishbone/wb_pc_sampler/xwb_pc_sampler.vhd)
+// Every period the sampler stores the address of the oldest instruction the LM32 has not yet
+// committed and the last value written into the return address register (r29) in a FIFO. A load
+// or store waiting for the bus is the sampled instruction while it waits. The return address
+// gives the caller of a leaf function; in other functions it points into the function itself
+// once a call has returned, then the caller is not known.
+// The FIFO is drained while sampling: read PCSAMPLER_STATUS for the number of samples, then for
+// every sample PCSAMPLER_PC followed by PCSAMPLER_RA (one Etherbone cycle for many samples).
+// In wishbone_demo_top.vhd the sampler is slave 2 of the debug bus, the bridge at slave 13 of the
+// top crossbar (0x112000): base address 0x112c00.
+
+#ifndef PC_SAMPLER_H
+#define PC_SAMPLER_H
+
+#define PCSAMPLER_CONTROL 0x00 // see below
+#define PCSAMPLER_PERIOD 0x04 // sample period in clock cycles minus 1
+#define PCSAMPLER_STATUS 0x08 // see below
+#define PCSAMPLER_LOST 0x0c // samples lost because the FIFO was full
+#define PCSAMPLER_TAKEN 0x10 // samples taken, including the lost ones
+#define PCSAMPLER_PC 0x14 // read: take the oldest sample from the FIFO, its pc (0 when empty)
+#define PCSAMPLER_RA 0x18 // return address of the sample taken by the last read of PCSAMPLER_PC
+
+// PCSAMPLER_CONTROL
+#define PCSAMPLER_CONTROL_ENABLE 0x1 // sampling enabled
+#define PCSAMPLER_CONTROL_CLEAR 0x2 // write: empty the FIFO, clear the counters
+#define PCSAMPLER_CONTROL_RANDOM 0x4 // add a random 0..255 cycles to every period against aliasing
+
+// PCSAMPLER_STATUS
+#define PCSAMPLER_STATUS_LEVEL(x) ((x) & 0xffff) // samples in the FIFO
+#define PCSAMPLER_STATUS_FIFOLOG2(x) (((x) >> 16) & 0xff) // log2 of the FIFO depth
+
+#endif
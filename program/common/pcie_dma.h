@@ -0,0 +1,35 @@
+// Registers of pcie_dma (modules/wishbone/wb_pcie/pcie_dma.vhd): DMA from the FPGA into host memory
+// Words written in the data window are sent with PCIe memory writes into a ring of host buffers.
+// The write pointer and read pointer count the bytes written and consumed, they are free running;
+// the write pointer is also written at the write-back address in host memory.
+// Used by the host programs and by firmware that writes data into the window.
+
+#ifndef PCIE_DMA_H
+#define PCIE_DMA_H
+
+#define PCIEDMA_CONTROL 0x000 // bit0 enable, bit1 clear pointers and fifo
+#define PCIEDMA_STATUS 0x004 // bits 15..0 words in the fifo, bit16 sending, bit17 ring full
+#define PCIEDMA_CONFIG 0x008 // bits 3..0 log2 buffer size in bytes, bits 11..8 log2 number of buffers
+#define PCIEDMA_FLUSH 0x00c // clock cycles before a partial memory write or the write-back is sent
+#define PCIEDMA_WRPTR 0x010
+#define PCIEDMA_RDPTR 0x014
+#define PCIEDMA_WBADDR_LO 0x018 // host address of the write-back, 0: no write-back
+#define PCIEDMA_WBADDR_HI 0x01c
+#define PCIEDMA_TLPS 0x020 // memory writes with data sent
+#define PCIEDMA_DESC 0x200 // host address of buffer n: 0x200+8*n low word, 0x204+8*n high word
+#define PCIEDMA_DATA 0x400 // data window 0x400..0x7ff, every write adds one word
+
+#define PCIEDMA_CONTROL_ENABLE 0x1
+#define PCIEDMA_CONTROL_CLEAR 0x2
+#define PCIEDMA_STATUS_LEVEL 0xffff
+#define PCIEDMA_STATUS_SENDING 0x10000
+#define PCIEDMA_STATUS_FULL 0x20000
+
+#define PCIEDMA_MINBUFLOG2 7 // 128 bytes
+#define PCIEDMA_MAXBUFLOG2 12 // 4KB, a buffer never crosses a 4KB boundary
+#define PCIEDMA_MAXRINGLOG2 6 // 64 buffers
+#define PCIEDMA_DATASIZE 0x400
+
+#define PCIEDMA_CONFIG_VALUE(buflog2,ringlog2) (((buflog2) & 0xf) | (((ringlog2) & 0xf) << 8))
+
+#endif
@@ -0,0 +1,131 @@
+// Interrupts from the FPGA to the host through pcie_wb (modules/wishbone/wb_pcie/pcie_wb.vhd)
+// A rising edge of an interrupt input sets its bit in the pending register of BAR0. While the
+// interrupts are enabled and a pending bit is unmasked, pcie_wb sends one MSI (or holds the legacy
+// INTx line when the host did not enable MSI). The MSI is armed again when the host writes the
+// status or control register, so the host gets one MSI per clear.
+// The inputs are the interrupts of the VIC (see irq.h), bit 31 is the write-back of pcie_dma.
+//
+// Host programs wait for the interrupt on a UIO device (/dev/uioN): the driver of the card registers
+// the interrupt as a UIO device with BAR0 as memory map 0. A read of the device blocks until the
+// next interrupt, the registers of BAR0 are accessed directly, no Etherbone cycle is needed.
+//     struct pcie_event ev;
+//     if (pcie_event_open(&ev,"/dev/uio0")<0) ... // fall back to polling
+//     pcie_event_clear(&ev,PCIE_IRQ_FLASH);
+//     ... start the flash operation ...
+//     if (pcie_event_wait(&ev,PCIE_IRQ_FLASH,1000)==0) ... // timeout
+
+#ifndef PCIE_IRQ_H
+#define PCIE_IRQ_H
+
+#define PCIE_IRQ_STATUS 0x20 // BAR0, read pending interrupts, write '1' to clear and re-arm the MSI
+#define PCIE_IRQ_MASK 0x24 // BAR0, '1' enables the interrupt
+#define PCIE_IRQ_CONTROL 0x28 // BAR0, see below, a write re-arms the MSI
+
+#define PCIE_IRQ_CONTROL_MSI 0x1 // MSI enabled by the host (read only)
+#define PCIE_IRQ_CONTROL_REQUEST 0x2 // MSI requested, not yet sent (read only)
+#define PCIE_IRQ_CONTROL_ENABLE 0x4 // send interrupts to the host
+#define PCIE_IRQ_CONTROL_COUNT(x) (((x) >> 16) & 0xffff) // MSIs sent (read only)
+
+// interrupt bits, the VIC inputs of wishbone_demo_top.vhd
+#define PCIE_IRQ_DMA 0x01 // xwb_dma
+#define PCIE_IRQ_RS232TX 0x02
+#define PCIE_IRQ_RS232RX 0x04
+#define PCIE_IRQ_TIMER 0x08
+#define PCIE_IRQ_FLASH 0x10 // flash update module, rising edge: ready for the next command
+#define PCIE_IRQ_PCIEDMA 0x80000000 // pcie_dma wrote the write pointer into host memory
+
+#ifndef __lm32__
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#define PCIE_IRQ_MAPSIZE 4096
+
+struct pcie_event {
+	int fd; // UIO device
+	volatile uint32_t *bar0; // registers of pcie_wb
+};
+
+static inline uint32_t pcie_event_read(struct pcie_event *ev, unsigned int reg) {
+	return ev->bar0[reg/4];
+}
+
+static inline void pcie_event_write(struct pcie_event *ev, unsigned int reg, uint32_t value) {
+	ev->bar0[reg/4]=value;
+}
+
+// Open the UIO device of the card
+//   Parameters :
+//      struct pcie_event *ev : opened device
+//      const char *uiodev : UIO device, for example /dev/uio0
+//      return : 0 if ok, -1 if the device cannot be opened or mapped (errno is set)
+static inline int pcie_event_open(struct pcie_event *ev, const char *uiodev) {
+	void *map;
+	ev->fd=open(uiodev,O_RDWR);
+	if (ev->fd<0) return -1;
+	map=mmap(0,PCIE_IRQ_MAPSIZE,PROT_READ|PROT_WRITE,MAP_SHARED,ev->fd,0); // map 0: BAR0
+	if (map==MAP_FAILED) {
+		close(ev->fd);
+		ev->fd=-1;
+		return -1;
+	}
+	ev->bar0=(volatile uint32_t *)map;
+	return 0;
+}
+
+// Clear pending interrupts, before starting the operation that raises them
+//   Parameters :
+//      struct pcie_event *ev : opened device
+//      unsigned int mask : interrupt bits to clear
+static inline void pcie_event_clear(struct pcie_event *ev, unsigned int mask) {
+	pcie_event_write(ev,PCIE_IRQ_STATUS,mask);
+}
+
+// Wait for one of the interrupts in mask
+// The pending bits that are returned are cleared, the other pending bits are kept.
+//   Parameters :
+//      struct pcie_event *ev : opened device
+//      unsigned int mask : interrupt bits to wait for
+//      int timeout_ms : timeout in ms, -1 waits forever
+//      return : the pending bits of mask, 0 on timeout, -1 on error (errno is set)
+static inline long pcie_event_wait(struct pcie_event *ev, unsigned int mask, int timeout_ms) {
+	struct pollfd pfd;
+	uint32_t pending, count;
+	int32_t on=1;
+	int rval;
+	pcie_event_write(ev,PCIE_IRQ_MASK,mask);
+	for (;;) {
+		// the UIO interrupt is enabled before the status is read: no interrupt gets lost
+		if (write(ev->fd,&on,sizeof(on))!=sizeof(on)) return -1;
+		pcie_event_write(ev,PCIE_IRQ_CONTROL,PCIE_IRQ_CONTROL_ENABLE);
+		pending=pcie_event_read(ev,PCIE_IRQ_STATUS) & mask;
+		if (pending) {
+			pcie_event_clear(ev,pending);
+			return pending;
+		}
+		pfd.fd=ev->fd;
+		pfd.events=POLLIN;
+		rval=poll(&pfd,1,timeout_ms);
+		if (rval<0) return -1;
+		if (rval==0) return 0;
+		if (read(ev->fd,&count,sizeof(count))!=sizeof(count)) return -1;
+	}
+}
+
+// Disable the interrupts and close the device
+//   Parameters :
+//      struct pcie_event *ev : opened device
+static inline void pcie_event_close(struct pcie_event *ev) {
+	if (ev->fd<0) return;
+	pcie_event_write(ev,PCIE_IRQ_CONTROL,0);
+	munmap((void *)ev->bar0,PCIE_IRQ_MAPSIZE);
+	close(ev->fd);
+	ev->fd=-1;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,32 @@
+// Device discovery for the LM32 firmware with the SDB ROM of the crossbar, see sdb.h
+
+#include "sdb.h"
+
+static struct sdb_devices sdb_table_s;
+static int sdb_found = 0;
+
+static unsigned int sdb_mmio_read(void *ctx, unsigned int address) {
+	return *(volatile unsigned int*)address;
+}
+
+// Scan the SDB ROM, call once at startup before the init functions of the modules
+//   Parameters :
+//      return : number of devices found, -1 if no SDB ROM found
+int sdb_init(void) {
+	int n=sdb_scan(&sdb_table_s,SDB_ADDRESS,sdb_mmio_read,0);
+	sdb_found=(n>0);
+	return n;
+}
+
+// Base address of a device
+//   Parameters :
+//      unsigned long long vendor : vendor id
+//      unsigned int device : device id
+//      unsigned int defaultaddress : returned if the device is not found or sdb_init has not found the ROM
+//      return : base address
+unsigned int sdb_base(unsigned long long vendor, unsigned int device, unsigned int defaultaddress) {
+	const struct sdb_entry *e;
+	if (!sdb_found) return defaultaddress;
+	e=sdb_find(&sdb_table_s,vendor,device,0);
+	return e ? e->base : defaultaddress;
+}
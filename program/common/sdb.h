@@ -0,0 +1,130 @@
+// Device discovery with the self-describing wishbone bus (SDB) ROM of the crossbar
+// The SDB ROM lists every slave with vendor id, device id and address range.
+// The table is scanned once at startup and the base addresses are looked up by device id,
+// so that the programs keep working when the address map of the top level changes.
+//
+// The scanner is shared by the LM32 firmware (sdb.c, reads the ROM directly) and the
+// host programs (reads over Etherbone), the bus access is a callback:
+//     unsigned int read(void *ctx, unsigned int address) : 32-bit big-endian word at address
+//
+// Firmware, see sdb.c:
+//     sdb_init();
+//     base=sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_RS232,0x110600); // default if not found
+
+#ifndef SDB_H
+#define SDB_H
+
+#define SDB_ADDRESS 0x100000 // address of the SDB ROM, c_sdb_address of the top level
+#define SDB_MAXDEVICES 32
+#define SDB_MAXDEPTH 4 // bridges nested deeper are not scanned
+
+#define SDB_MAGIC 0x5344422D // "SDB-"
+#define SDB_RECORDSIZE 64
+#define SDB_RECORD_INTERCONNECT 0x00
+#define SDB_RECORD_DEVICE 0x01
+#define SDB_RECORD_BRIDGE 0x02
+
+// vendor and device ids, as in the sdb records of wishbone_demo_top.vhd
+#define SDB_VENDOR_GSI 0x00000651ULL
+#define SDB_VENDOR_CERN 0x0000CE42ULL
+#define SDB_DEVICE_GPIO 0x35aa6b95
+#define SDB_DEVICE_SINGLEPULSE 0x35aa6b96
+#define SDB_DEVICE_PATTERN 0x35aa6b97
+#define SDB_DEVICE_BUTIS 0x35aa6b98
+#define SDB_DEVICE_RS232 0x35aa6b99
+#define SDB_DEVICE_READTIMESTAMP 0x35aa6b9a
+#define SDB_DEVICE_FLASH 0x35aa6b9b
+#define SDB_DEVICE_INPUTCAPTURE 0x35aa6b9c
+#define SDB_DEVICE_TICS 0x35aa6b9d
+#define SDB_DEVICE_PCIEDMA 0x35aa6b9e
+#define SDB_DEVICE_CBARSTATS 0x35aa6b9f // statistics of the top crossbar
+#define SDB_DEVICE_BUSMON 0x35aa6ba0 // bus performance monitor
+#define SDB_DEVICE_PCSAMPLER 0x35aa6ba1 // LM32 program counter sampler
+#define SDB_DEVICE_DMA 0xcababa56 // xwb_dma, wishbone to wishbone copies
+#define SDB_DEVICE_VIC 0x00000013 // CERN
+#define SDB_DEVICE_DPRAM 0x66cfeb52 // CERN, LM32 program and data memory
+
+struct sdb_entry {
+	unsigned long long vendor;
+	unsigned int device;
+	unsigned int version;
+	unsigned int base; // first address
+	unsigned int last; // last address
+};
+
+// not sdb_table: etherbone.h has its own struct sdb_table with the raw records
+struct sdb_devices {
+	int count;
+	struct sdb_entry entry[SDB_MAXDEVICES];
+};
+
+typedef unsigned int (*sdb_read_t)(void *ctx, unsigned int address);
+
+// Scan one bus and the busses behind its bridges, the devices are added to the table
+//   Parameters :
+//      struct sdb_devices *table : table to add the devices to
+//      unsigned int base : base address of the bus, added to the addresses in the records
+//      unsigned int address : address of the SDB records of the bus
+//      sdb_read_t read : bus access
+//      void *ctx : passed to read
+//      int depth : bridge nesting depth, 0 for the top bus
+//      return : 0 if ok, -1 if no SDB records found at the address or the table is full
+static inline int sdb_scanbus(struct sdb_devices *table, unsigned int base, unsigned int address,
+	sdb_read_t read, void *ctx, int depth) {
+	unsigned int records,i,rec,type;
+	struct sdb_entry *e;
+	if (read(ctx,address)!=SDB_MAGIC) return -1;
+	records=read(ctx,address+0x04) >> 16;
+	for (i=1; i<records; i++) {
+		rec=address+i*SDB_RECORDSIZE;
+		type=read(ctx,rec+0x3c) & 0xff;
+		if (type==SDB_RECORD_BRIDGE) {
+			if ((depth+1<SDB_MAXDEPTH) && (sdb_scanbus(table,base+read(ctx,rec+0x0c),
+				base+read(ctx,rec+0x04),read,ctx,depth+1)<0)) return -1;
+		} else if (type==SDB_RECORD_DEVICE) {
+			if (table->count>=SDB_MAXDEVICES) return -1;
+			e=&table->entry[table->count++];
+			e->base=base+read(ctx,rec+0x0c); // 64-bit addresses, the low word is used
+			e->last=base+read(ctx,rec+0x14);
+			e->vendor=((unsigned long long)read(ctx,rec+0x18) << 32) | read(ctx,rec+0x1c);
+			e->device=read(ctx,rec+0x20);
+			e->version=read(ctx,rec+0x24);
+		}
+	}
+	return 0;
+}
+
+// Scan the SDB ROM at address
+//   Parameters :
+//      struct sdb_devices *table : table with the devices found
+//      unsigned int address : address of the SDB ROM, normally SDB_ADDRESS
+//      sdb_read_t read : bus access
+//      void *ctx : passed to read
+//      return : number of devices found, -1 if no SDB ROM found at the address
+static inline int sdb_scan(struct sdb_devices *table, unsigned int address, sdb_read_t read, void *ctx) {
+	table->count=0;
+	if (sdb_scanbus(table,0,address,read,ctx,0)<0 && table->count==0) return -1;
+	return table->count;
+}
+
+// Find a device in the scanned table
+//   Parameters :
+//      const struct sdb_devices *table : the scanned table
+//      unsigned long long vendor : vendor id
+//      unsigned int device : device id
+//      int instance : 0 for the first device with these ids, 1 for the second, etc.
+//      return : the device, 0 if not found
+static inline const struct sdb_entry *sdb_find(const struct sdb_devices *table,
+	unsigned long long vendor, unsigned int device, int instance) {
+	int i;
+	for (i=0; i<table->count; i++)
+		if ((table->entry[i].vendor==vendor) && (table->entry[i].device==device) && (instance-- == 0))
+			return &table->entry[i];
+	return 0;
+}
+
+// firmware, sdb.c
+int sdb_init(void);
+unsigned int sdb_base(unsigned long long vendor, unsigned int device, unsigned int defaultaddress);
+
+#endif
@@ -0,0 +1,41 @@
+// Time base for the LM32 firmware with the usec tics counter (wb_tics), see timer.h
+
+#include "timer.h"
+#include "sdb.h"
+
+volatile unsigned int* timer_counter = (unsigned int*)(TIMER_TICS_ADDRESS+TIMER_TICS);
+volatile unsigned int* timer_period = (unsigned int*)(TIMER_TICS_ADDRESS+TIMER_PERIOD);
+volatile unsigned int* timer_status = (unsigned int*)(TIMER_TICS_ADDRESS+TIMER_STATUS);
+
+// Set the addresses of the tics counter from the SDB ROM, sdb_init must be called before
+void timer_init(void) {
+	unsigned int base=sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_TICS,TIMER_TICS_ADDRESS);
+	timer_counter = (unsigned int*)(base+TIMER_TICS);
+	timer_period = (unsigned int*)(base+TIMER_PERIOD);
+	timer_status = (unsigned int*)(base+TIMER_STATUS);
+}
+
+// Wait the given number of microseconds
+//   Parameters :
+//      unsigned int usec : time to wait, maximum 2^31 usec
+void timer_sleep(unsigned int usec) {
+	unsigned int t=timer_timeout(usec);
+	while (!timer_expired(t))
+		asm("# noop"); /* no-op the compiler can't optimize away */
+}
+
+// Set the period of the timer interrupt, 0 disables the interrupt
+//   Parameters :
+//      unsigned int usec : interrupt period in microseconds
+void timer_setperiod(unsigned int usec) {
+	*timer_period = usec;
+	*timer_status = 1;
+}
+
+// Acknowledge the timer interrupt, called by the interrupt handler
+//   Parameters :
+//      return : number of missed interrupts since reset (interrupts that came before the previous one was acknowledged)
+unsigned int timer_ack(void) {
+	*timer_status = 1;
+	return *timer_status >> 16;
+}
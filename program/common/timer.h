@@ -0,0 +1,47 @@
+// Time base for the LM32 firmware with the usec tics counter (wb_tics)
+// The tics counter counts microseconds, independent of compiler optimisation and cpu load.
+// Sleep and timeout functions poll the counter and need no interrupts;
+// they are shared by all programs (test_generator, test_flash access_flash.c).
+// The periodic interrupt of wb_tics is used by the scheduler (test_generator/sched.c).
+//
+// timer_init finds the address of the counter in the SDB ROM (call sdb_init first).
+//
+// Timeouts are absolute tics values, compared with wrap-around:
+//     unsigned int t=timer_timeout(1000); // 1ms
+//     while (busy()) if (timer_expired(t)) return -1;
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#define TIMER_TICS_PER_SECOND 1000000 // tics are microseconds
+#define TIMER_TICS_PER_MS 1000
+
+// default address of the tics counter, used if the SDB ROM does not list it
+#define TIMER_TICS_ADDRESS 0x110b00
+// register offsets
+#define TIMER_TICS 0x0 // usec counter, 32 bits
+#define TIMER_PERIOD 0x4 // interrupt period in tics, 0 = interrupt disabled
+#define TIMER_STATUS 0x8 // bit 0 = interrupt pending (write 1 to acknowledge), bit 31..16 = missed interrupts
+
+extern volatile unsigned int* timer_counter;
+
+static inline unsigned int timer_tics(void) {
+	return *timer_counter;
+}
+
+// Absolute timeout value: now + usec
+static inline unsigned int timer_timeout(unsigned int usec) {
+	return timer_tics()+usec;
+}
+
+// Returns non-zero if the timeout has passed, valid up to 2^31 usec (35 minutes)
+static inline int timer_expired(unsigned int timeout) {
+	return (int)(timer_tics()-timeout)>=0;
+}
+
+void timer_init(void);
+void timer_sleep(unsigned int usec);
+void timer_setperiod(unsigned int usec);
+unsigned int timer_ack(void);
+
+#endif
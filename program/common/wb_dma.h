@@ -0,0 +1,61 @@
+// Registers of xwb_dma (modules/wishbone/wb_dma/xwb_dma.vhd): copies on the wishbone bus
+// A single transfer copies count words: the read address and the write address advance by their
+// stride after every word, the transfer starts when the count is written. A stride of 0 stays on
+// a FIFO register, with WBDMA_MODE_PACK/UNPACK the bytes of FIFOs with 8-bit data are packed into
+// words or unpacked from them.
+// A descriptor chain is a linked list of transfers in memory that the DMA fetches itself, the
+// status word of every descriptor is written when its copy is done.
+// Used by the firmware and by host programs over Etherbone.
+//     struct wb_dma_desc *d=... // 32-byte aligned, in the LM32 RAM
+//     d[0].read=...; d[0].write=...; d[0].read_stride=4; d[0].write_stride=4; d[0].count=n;
+//     d[0].flags=0; d[0].next=(unsigned int)&d[1]; d[0].status=0;
+//     ...
+//     *(volatile unsigned int *)(base+WBDMA_DESC)=(unsigned int)d;
+//     *(volatile unsigned int *)(base+WBDMA_DESC_CONTROL)=WBDMA_DESC_START;
+
+#ifndef WB_DMA_H
+#define WB_DMA_H
+
+#define WBDMA_READ 0x00 // read issue address
+#define WBDMA_WRITE 0x04 // write issue address
+#define WBDMA_READ_STRIDE 0x08
+#define WBDMA_WRITE_STRIDE 0x0c
+#define WBDMA_COUNT 0x10 // words left, writing a non-zero value starts a single transfer
+#define WBDMA_DESC 0x14 // address of the current descriptor
+#define WBDMA_DESC_CONTROL 0x18 // see below
+#define WBDMA_DESC_DONE 0x1c // descriptors completed, writable
+#define WBDMA_MODE 0x20 // see below, change it only while no transfer is running
+
+// WBDMA_DESC_CONTROL
+#define WBDMA_DESC_START 0x1 // write: start the chain at WBDMA_DESC; read: chain running
+#define WBDMA_DESC_STOP 0x2 // write: stop after the current descriptor; read: stop requested
+#define WBDMA_DESC_ERROR 0x4 // read: bus error while fetching a descriptor
+#define WBDMA_DESC_BUSY 0x8 // read: a copy is running
+#define WBDMA_DESC_RINGLOG2(x) (((x) >> 8) & 0xff) // read: log2 of the words in flight
+
+// WBDMA_MODE, the first byte is bits 31..24 of the word
+#define WBDMA_MODE_WORD 0
+#define WBDMA_MODE_PACK 1 // a read gives a byte in bits 7..0, 4 bytes are written as one word; count in bytes, multiple of 4
+#define WBDMA_MODE_UNPACK 2 // a word read is written as 4 bytes in bits 7..0; count in words
+
+// descriptor in memory, 32-byte aligned, the words are big-endian as seen by the LM32
+struct wb_dma_desc {
+	unsigned int read;
+	unsigned int write;
+	unsigned int read_stride;
+	unsigned int write_stride;
+	unsigned int count; // words to copy
+	unsigned int flags;
+	unsigned int next; // address of the next descriptor, 0 ends the chain
+	unsigned int status; // written by the DMA when done
+};
+
+#define WBDMA_FLAG_IRQ 0x1 // interrupt when this descriptor is done
+#define WBDMA_FLAG_NOSTATUS 0x2 // do not write the status word
+#define WBDMA_FLAG_MODE(mode) ((mode) << 8) // WBDMA_MODE of the copy
+#define WBDMA_STATUS_DONE 0x80000000
+#define WBDMA_STATUS_ERROR 0x40000000 // a read or write of the copy failed
+
+#define WBDMA_DESC_SIZE 32
+
+#endif
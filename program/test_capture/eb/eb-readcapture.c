@@ -0,0 +1,536 @@
+/** @file eb-readcapture.c
+ *  @brief A program which reads the timestamped events of the input capture module.
+ *
+ *  Copyright (C) 2011-2012 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  A complete skeleton of an application using the Etherbone library.
+ *
+ *  @author Wesley W. Terpstra <w.terpstra@gsi.de>
+ *  adjusted for reading the input capture fifo on Pexaria2a Pcie card by Peter Schakel <p.schakel@rug.nl>
+ *
+ *  @bug None!
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200112L /* strtoull */
+
+#include <unistd.h> /* getopt */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+
+
+#include "../etherbone.h"
+#include "../glue/version.h"
+#include "common.h"
+#include "../../common/sdb.h"
+#include "../../common/ebtool.h"
+
+// addresses for input capture
+#define CAPTURE_CONTROL 0x0
+	// 8-bits rising edge enable, 8-bits falling edge enable, clear
+
+#define CAPTURE_STATUS 0x4
+	// 16-bits fifo count, full, overflow, timestamp valid
+
+#define CAPTURE_LOST 0x8
+	// 32-bits lost events counter
+
+#define CAPTURE_EVENTS 0xc
+	// 32-bits events counter
+
+#define CAPTURE_FIFO 0x80
+	// 16 events of 2 words: timestamp bits 31..0, then valid,rising,3-bits channel,2-bits fine,timestamp valid,timestamp bits 55..32
+
+#define EVENTS_PER_CYCLE 16
+
+unsigned long long strtoull (const char * nptr, char ** endptr, int base);
+
+static void help(void) {
+  fprintf(stderr, "Usage: %s [OPTION] <proto/host/port> [baseaddress] <events>\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -a <width>     acceptable address bus widths     (8/16/32/64)\n");
+  fprintf(stderr, "  -d <width>     acceptable data bus widths        (8/16/32/64)\n");
+  fprintf(stderr, "  -b             big-endian operation                    (auto)\n");
+  fprintf(stderr, "  -l             little-endian operation                 (auto)\n");
+  fprintf(stderr, "  -r <retries>   number of times to attempt autonegotiation (3)\n");
+  fprintf(stderr, "  -f             force; ignore remote segfaults\n");
+  fprintf(stderr, "  -p             disable self-describing wishbone device probe\n");
+  fprintf(stderr, "  -v             verbose operation\n");
+  fprintf(stderr, "  -q             quiet: do not display warnings\n");
+  fprintf(stderr, "  -R <mask>      enable rising edges on channels in mask   (0xff)\n");
+  fprintf(stderr, "  -F <mask>      enable falling edges on channels in mask  (0x00)\n");
+  fprintf(stderr, "  -o <file>      write events to file instead of stdout\n");
+  fprintf(stderr, "  -k             keep the events already in the fifo\n");
+  fprintf(stderr, "  -h             display this help and exit\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Reads <events> events (0: until interrupted), one line per event: channel, edge, time in ns\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Without baseaddress the input capture module is found in the SDB records at 0x%x.\n", SDB_ADDRESS);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Report Etherbone bugs to <etherbone-core@ohwr.org>\n");
+  fprintf(stderr, "Version %"PRIx32" (%s). Licensed under the LGPL v3.\n", EB_VERSION_SHORT, EB_DATE_FULL);
+}
+
+static FILE* output_f;
+static int force;
+static eb_socket_t socket;
+
+/* Data of the last cycle */
+static eb_data_t readdata;
+static eb_data_t blockdata[2*EVENTS_PER_CYCLE+1];
+static void set_stop_read(eb_user_data_t user, eb_device_t dev, eb_operation_t op, eb_status_t status) {
+  int* stop = (int*)user;
+  *stop = 1;
+
+  if (status != EB_OK) {
+    fprintf(stderr, "%s: etherbone cycle error_1: %s\n",
+                    program, eb_status(status));
+    exit(1);
+  } else {
+    readdata = 0;
+    for (; op != EB_NULL; op = eb_operation_next(op)) {
+      /* We read low bits first */
+      readdata <<= (eb_operation_format(op) & EB_DATAX) * 8;
+      readdata |= eb_operation_data(op);
+
+      if (eb_operation_had_error(op))
+        fprintf(stderr, "%s: wishbone segfault reading %s %s bits from address 0x%"EB_ADDR_FMT"\n",
+                        program, width_str[eb_operation_format(op) & EB_DATAX],
+                        endian_str[eb_operation_format(op) >> 4], eb_operation_address(op));
+    }
+  }
+}
+
+static void set_stop_block(eb_user_data_t user, eb_device_t dev, eb_operation_t op, eb_status_t status) {
+  int* stop = (int*)user;
+  int i;
+  *stop = 1;
+
+  if (status != EB_OK) {
+    fprintf(stderr, "%s: etherbone cycle error_3: %s\n",
+                    program, eb_status(status));
+    exit(1);
+  }
+  for (i = 0; op != EB_NULL; op = eb_operation_next(op)) {
+    if (eb_operation_had_error(op))
+      fprintf(stderr, "%s: wishbone segfault reading %s %s bits from address 0x%"EB_ADDR_FMT"\n",
+                      program, width_str[eb_operation_format(op) & EB_DATAX],
+                      endian_str[eb_operation_format(op) >> 4], eb_operation_address(op));
+    if (i < 2*EVENTS_PER_CYCLE+1) blockdata[i++] = eb_operation_data(op);
+  }
+}
+
+static void set_stop_write(eb_user_data_t user, eb_device_t dev, eb_operation_t op, eb_status_t status) {
+	int* stop = (int*)user;
+	*stop = 1;
+	if (status != EB_OK) {
+		fprintf(stderr, "%s: etherbone cycle error_2: %s\n",
+		program, eb_status(status));
+		exit(1);
+	}
+	for (; op != EB_NULL; op = eb_operation_next(op)) {
+		if (eb_operation_had_error(op)) {
+			fprintf(stderr, "%s: wishbone segfault %s %s %s bits to address 0x%"EB_ADDR_FMT"\n",
+				program, eb_operation_is_read(op)?"reading":"writing",
+				width_str[eb_operation_format(op) & EB_DATAX],
+				endian_str[eb_operation_format(op) >> 4], eb_operation_address(op));
+			exit(1);
+		}
+	}
+}
+
+static unsigned int eb_read(eb_device_t device, eb_address_t address, eb_format_t format)
+{
+	eb_cycle_t cycle;
+	eb_status_t status;
+	int stop;
+	/* Begin the cycle */
+	if ((status = eb_cycle_open(device, &stop, &set_stop_read, &cycle)) != EB_OK) {
+		fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+		exit(1);
+	}
+	eb_cycle_read(cycle, address, format, 0);
+	if (force) eb_cycle_close_silently(cycle);
+	else eb_cycle_close(cycle);
+	stop = 0;
+	eb_device_flush(device);
+	while (!stop) { eb_socket_run(socket, -1); }
+	return (unsigned int) readdata;
+}
+
+static void eb_write(eb_device_t device, eb_address_t address, eb_format_t format, unsigned int data)
+{
+	eb_cycle_t cycle;
+	eb_status_t status;
+	int stop;
+	/* Begin the cycle */
+	if ((status = eb_cycle_open(device, &stop, &set_stop_write, &cycle)) != EB_OK) {
+		fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+		exit(1);
+	}
+	eb_cycle_write(cycle, address, format, (eb_data_t) data);
+	if (force) eb_cycle_close_silently(cycle);
+	else eb_cycle_close(cycle);
+	stop = 0;
+	eb_device_flush(device);
+	while (!stop) { eb_socket_run(socket, -1); }
+}
+
+
+// Read a number of events from the fifo in one Etherbone cycle
+// Reading the low word takes the first event of the fifo, reading the high word removes it, so the words must be read in pairs.
+// The status word is read in the same cycle, so the next cycle can be sized to the fifo contents.
+//   Parameters :
+//      eb_device_t device : Etherbone device
+//      eb_address_t baseaddress : Base address of the wishbone input capture module
+//      eb_format_t format : Format of the Etherbone bus access
+//      int count : Number of events to read (1..EVENTS_PER_CYCLE)
+static void read_events(eb_device_t device, eb_address_t baseaddress, eb_format_t format, int count)
+{
+	eb_cycle_t cycle;
+	eb_status_t status;
+	int stop, i;
+	if ((status = eb_cycle_open(device, &stop, &set_stop_block, &cycle)) != EB_OK) {
+		fprintf(stderr, "%s: failed to create cycle: %s\n", program, eb_status(status));
+		exit(1);
+	}
+	for (i=0; i<count; i++) {
+		eb_cycle_read(cycle, baseaddress+CAPTURE_FIFO+8*i, format, 0);
+		eb_cycle_read(cycle, baseaddress+CAPTURE_FIFO+8*i+4, format, 0);
+	}
+	eb_cycle_read(cycle, baseaddress+CAPTURE_STATUS, format, 0);
+	if (force) eb_cycle_close_silently(cycle);
+	else eb_cycle_close(cycle);
+	stop = 0;
+	eb_device_flush(device);
+	while (!stop) { eb_socket_run(socket, -1); }
+}
+
+// Write one event as text: channel, edge, time in ns (timestamp in 5ns steps plus fine phase in 2ns steps)
+//   Parameters :
+//      unsigned int low : timestamp bits 31..0
+//      unsigned int high : flags and timestamp bits 55..32
+//      return : 1 if the event was valid
+static int print_event(unsigned int low, unsigned int high)
+{
+	unsigned long long timestamp, time_ns;
+	unsigned int channel, fine;
+	if ((high & 0x80000000)==0) return 0;
+	channel = (high >> 27) & 0x7;
+	fine = (high >> 25) & 0x3;
+	timestamp = (((unsigned long long)(high & 0x00ffffff)) << 32) | (unsigned long long)low;
+	time_ns = timestamp*5 + fine*2;
+	fprintf(output_f, "%u %c %llu%s\n", channel, (high & 0x40000000) ? 'r' : 'f', time_ns,
+		(high & 0x01000000) ? "" : " (no timestamp received)");
+	return 1;
+}
+
+
+int main(int argc, char** argv) {
+  long value;
+  char* value_end;
+  int opt, error, i, count, available;
+
+  eb_status_t status;
+  eb_device_t device;
+  eb_width_t line_width;
+  eb_format_t line_widths;
+  eb_format_t device_support;
+  eb_format_t write_sizes;
+  eb_format_t format;
+  eb_format_t size;
+  eb_address_t baseaddress;
+
+  /* Specific command-line options */
+  int attempts, probe, discover, keep;
+  const char* netaddress;
+  const char* output;
+  unsigned int rising, falling, stat, lost_start, lost_end;
+  unsigned long events, nr_events;
+  time_t start_time, end_time;
+
+  /* Default arguments */
+  program = argv[0];
+  address_width = EB_ADDRX;
+  data_width = EB_DATAX;
+  endian = 0; /* auto-detect */
+  attempts = 3;
+  probe = 1;
+  quiet = 0;
+  verbose = 0;
+  error = 0;
+  force = 0;
+  keep = 0;
+  size = 4;
+  rising = 0xff;
+  falling = 0x00;
+  output = 0;
+  output_f = stdout;
+
+  /* Process the command-line arguments */
+  while ((opt = getopt(argc, argv, "a:d:blr:fpvqR:F:o:kh")) != -1) {
+    switch (opt) {
+    case 'a':
+      value = parse_width(optarg);
+      if (value < 0) {
+        fprintf(stderr, "%s: invalid address width -- '%s'\n", program, optarg);
+        return 1;
+      }
+      address_width = value << 4;
+      break;
+    case 'd':
+      value = parse_width(optarg);
+      if (value < 0) {
+        fprintf(stderr, "%s: invalid data width -- '%s'\n", program, optarg);
+        return 1;
+      }
+      data_width = value;
+      break;
+    case 'b':
+      endian = EB_BIG_ENDIAN;
+      break;
+    case 'l':
+      endian = EB_LITTLE_ENDIAN;
+      break;
+    case 'r':
+      value = strtol(optarg, &value_end, 0);
+      if (*value_end || value < 0 || value > 100) {
+        fprintf(stderr, "%s: invalid number of retries -- '%s'\n", program, optarg);
+        return 1;
+      }
+      attempts = value;
+      break;
+    case 'f':
+      force = 1;
+      break;
+    case 'p':
+      probe = 0;
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    case 'q':
+      quiet = 1;
+      break;
+    case 'R':
+      value = strtol(optarg, &value_end, 0);
+      if (*value_end || value < 0 || value > 0xff) {
+        fprintf(stderr, "%s: invalid channel mask -- '%s'\n", program, optarg);
+        return 1;
+      }
+      rising = value;
+      break;
+    case 'F':
+      value = strtol(optarg, &value_end, 0);
+      if (*value_end || value < 0 || value > 0xff) {
+        fprintf(stderr, "%s: invalid channel mask -- '%s'\n", program, optarg);
+        return 1;
+      }
+      falling = value;
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    case 'k':
+      keep = 1;
+      break;
+    case 'h':
+      help();
+      return 1;
+    case ':':
+    case '?':
+      error = 1;
+      break;
+    default:
+      fprintf(stderr, "%s: bad getopt result\n", program);
+      return 1;
+    }
+  }
+
+  if (error) return 1;
+
+  if ((optind + 3 != argc) && (optind + 2 != argc)) {
+    fprintf(stderr, "%s: expecting two or three non-optional arguments: <proto/host/port> [baseaddress] <events>\n", program);
+    return 1;
+  }
+  discover = (optind + 2 == argc);
+
+  netaddress = argv[optind];
+
+  if (discover) {
+    baseaddress = 0; /* found in the SDB records after connecting, the next arguments move one place */
+    optind--;
+  } else {
+    baseaddress = strtoull(argv[optind+1], &value_end, 0);
+    if (*value_end != 0) {
+      fprintf(stderr, "%s: argument is not an unsigned value -- '%s'\n",
+                      program, argv[optind+1]);
+      return 1;
+    }
+  }
+
+  nr_events = strtoull(argv[optind+2], &value_end, 0);
+  if (*value_end != 0) {
+    fprintf(stderr, "%s: argument is not an unsigned value -- '%s'\n",
+                    program, argv[optind+2]);
+    return 1;
+  }
+
+  if (output != 0) {
+    if ((output_f = fopen(output, "w")) == 0) {
+      fprintf(stderr, "%s: fopen, %s -- '%s'\n",
+                      program, strerror(errno), output);
+      return 1;
+    }
+  }
+
+  if (verbose)
+    fprintf(stdout, "Opening socket with %s-bit address and %s-bit data widths\n",
+                    width_str[address_width>>4], width_str[data_width]);
+
+  if ((status = eb_socket_open(EB_ABI_CODE, 0, address_width|data_width, &socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if (verbose)
+    fprintf(stdout, "Connecting to '%s' with %d retry attempts...\n", netaddress, attempts);
+
+  if ((status = eb_device_open(socket, netaddress, EB_ADDRX|EB_DATAX, attempts, &device)) != EB_OK) {
+    fprintf(stderr, "%s: failed to open Etherbone device: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  line_width = eb_device_width(device);
+  if (verbose)
+    fprintf(stdout, "  negotiated %s-bit address and %s-bit data session.\n",
+                    width_str[line_width >> 4], width_str[line_width & EB_DATAX]);
+  if (discover) {
+    struct ebtool_bus bus = { socket, device, EB_BIG_ENDIAN|EB_DATA32 };
+    baseaddress = ebtool_find_base(&bus, SDB_VENDOR_GSI, SDB_DEVICE_INPUTCAPTURE, "input capture module");
+  }
+  address=baseaddress;
+  if (probe) {
+    if (verbose)
+      fprintf(stdout, "Scanning remote bus for Wishbone devices...\n");
+    device_support = 0;
+    if ((status = eb_sdb_scan_root(device, &device_support, &find_device)) != EB_OK) {
+      fprintf(stderr, "%s: failed to scan remote bus: %s\n", program, eb_status(status));
+    }
+    while (device_support == 0) {
+      eb_socket_run(socket, -1);
+    }
+  } else {
+    device_support = endian | EB_DATAX;
+  }
+
+  /* Did the user request a bad endian? We use it anyway, but issue warning. */
+  if (endian != 0 && (device_support & EB_ENDIAN_MASK) != endian) {
+    if (!quiet)
+      fprintf(stderr, "%s: warning: target device is %s (reading as %s).\n",
+                      program, endian_str[device_support >> 4], endian_str[endian >> 4]);
+  }
+
+  if (endian == 0) {
+    /* Select the probed endian. May still be 0 if device not found. */
+    endian = device_support & EB_ENDIAN_MASK;
+  }
+
+  /* We need to know endian if it's not aligned to the line size */
+  if (endian == 0) {
+    fprintf(stderr, "%s: error: must know endian to read events\n",program);
+    return 1;
+  }
+
+  /* We need to pick the operation width we use.
+   * It must be supported both by the device and the line.
+   */
+  line_widths = ((line_width & EB_DATAX) << 1) - 1; /* Link can support any access smaller than line_width */
+  write_sizes = line_widths & device_support;
+
+  /* We cannot work with a device that requires larger access than we support */
+  if (write_sizes == 0) {
+    fprintf(stderr, "%s: error: device's %s-bit data port cannot be used via a %s-bit wire format\n",
+                    program, width_str[device_support & EB_DATAX], width_str[line_width & EB_DATAX]);
+    return 1;
+  }
+
+  /* Final operation endian has been chosen. If 0 the access had better be a full data width access! */
+  format = endian;
+
+  /* Can the operation be performed with fidelity? */
+  if ((size & write_sizes) == 0) {
+    fprintf(stderr, "%s: error: unsupported bus width\n",program);
+	exit(1);
+  }
+  format |= (size & write_sizes);
+
+  /* Enable the channels, start with an empty fifo unless the old events are wanted */
+  if (keep) eb_write(device,baseaddress+CAPTURE_CONTROL,format,(falling << 8) | rising);
+  else eb_write(device,baseaddress+CAPTURE_CONTROL,format,0x00010000 | (falling << 8) | rising);
+  stat=eb_read(device,baseaddress+CAPTURE_STATUS,format);
+  if (((stat & 0x00040000)==0) && (!quiet)) {
+    fprintf(stderr, "%s: warning: no timestamp received yet, timestamps are not synchronized\n",program);
+  }
+  lost_start=eb_read(device,baseaddress+CAPTURE_LOST,format);
+
+  /* Read the fifo: the number of events in the fifo determines the size of the next block read */
+  events = 0;
+  start_time = time(NULL);
+  available = 1;
+  while ((nr_events == 0) || (events < nr_events)) {
+    count = available;
+    if (count > EVENTS_PER_CYCLE) count = EVENTS_PER_CYCLE;
+    if (count < 1) count = 1;
+    if ((nr_events != 0) && ((unsigned long)count > nr_events-events)) count = nr_events-events;
+    read_events(device, baseaddress, format, count);
+    for (i=0; i<count; i++) {
+      if (print_event((unsigned int)blockdata[2*i], (unsigned int)blockdata[2*i+1])) events++;
+    }
+    if ((unsigned int)blockdata[2*count] & 0x00010000) available = EVENTS_PER_CYCLE; /* fifo full */
+    else available = (unsigned int)blockdata[2*count] & 0xffff;
+  }
+  end_time = time(NULL);
+
+  lost_end=eb_read(device,baseaddress+CAPTURE_LOST,format);
+  stat=eb_read(device,baseaddress+CAPTURE_STATUS,format);
+  if (verbose) {
+    fprintf(stdout, "%lu events", events);
+    if (end_time > start_time) fprintf(stdout, ", %lu events/s", events/(unsigned long)(end_time-start_time));
+    fprintf(stdout, ", %u lost\n", lost_end-lost_start);
+  }
+  if ((stat & 0x00020000) && (!quiet)) {
+    fprintf(stderr, "%s: warning: events have been lost (%u)\n",program,lost_end-lost_start);
+  }
+  if (output != 0) fclose(output_f);
+
+  if ((status = eb_device_close(device)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone device: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  if ((status = eb_socket_close(socket)) != EB_OK) {
+    fprintf(stderr, "%s: failed to close Etherbone socket: %s\n", program, eb_status(status));
+    return 1;
+  }
+
+  return 0;
+}
@@ -1,34 +1,54 @@
+#include "../common/timer.h"
+#include "../common/sdb.h"
+#include "../common/irq.h"
+#include "access_flash.h"
 
-#define FLASHSIZE 16777216
-#define SECTORSIZE 65536
-#define APPICATIONFLASHADDRESS 0x00800000
 #define READBUFFERSIZE 256
 
+// timeouts in usec, measured with the tics counter
+#define FLASH_TIMEOUT_BUSY 1000 // wait till the flash update module has finished the previous command
+#define FLASH_TIMEOUT_COMMAND 1000 // read id, read status, read or write parameter
+#define FLASH_TIMEOUT_READ 1000 // wait for the next byte read from flash
+#define FLASH_TIMEOUT_WRITE 10000 // page program, maximum 5ms for EPCS devices
+#define FLASH_TIMEOUT_ERASE 5000000 // sector erase, maximum 3s for EPCS devices
 
-// addresses for flash
+
+// addresses for flash, defaults if the SDB ROM does not list the flash update module
+#define FLASH_ADDRESS 0x110800
 volatile unsigned int* flash_parameters = (unsigned int*)0x110800; // 24-bits data,3-bits address,write,request,reconf:0b101
 volatile unsigned int* flash_parameters_read = (unsigned int*)0x110804; // 24-bits data,3-bits address,busy,error,illegal
 volatile unsigned int* flash_data = (unsigned int*)0x110808; // 8-bits data, 24-bits address
 volatile unsigned int* flash_read = (unsigned int*)0x11080c; // 8-bits data,valid,busy,error
 volatile unsigned int* flash_access = (unsigned int*)0x110810; // enable,read_enable, write_enable on 0b101, erase_enable on 0b101, read_id, read_status
 
+// Set the addresses of the flash update module from the SDB ROM, sdb_init must be called before
+void flash_init(void) {
+	unsigned int base=sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_FLASH,FLASH_ADDRESS);
+	flash_parameters = (unsigned int*)(base+0x00);
+	flash_parameters_read = (unsigned int*)(base+0x04);
+	flash_data = (unsigned int*)(base+0x08);
+	flash_read = (unsigned int*)(base+0x0c);
+	flash_access = (unsigned int*)(base+0x10);
+}
+
 // Erase one sector. Sector size is defined by SECTORSIZE, depends on flash-type, probably 64k
 //   Parameters :
 //      unsigned int address : address inside the sector to erase
 //      return : on error below zero, on success zero
 int erase_flash_sector(unsigned int address) {
 	unsigned int bf;
-	int timeout=0;
+	unsigned int timeout;
+	timeout=timer_timeout(FLASH_TIMEOUT_BUSY);
 	do {
 		bf=*flash_read;
-	} while ((bf & 0x00000200) && (timeout++<1000)); // wait till busy=0
+	} while ((bf & 0x00000200) && !timer_expired(timeout)); // wait till busy=0
 	if (bf & 0x00000200) return -1; // error: still busy
 	*flash_access=0x000000a1; // enable erasing to flash with bit0=1 (access enable) and bit7..5=101 (erase enable)
 	*flash_data=(address<<8); // address in bits 31..8
-	timeout=0;
+	timeout=timer_timeout(FLASH_TIMEOUT_ERASE);
 	do {
 		bf=*flash_read;
-	} while ((bf & 0x00000200) && (timeout++<10000000)); // wait till busy=0, better to use sleep function
+	} while ((bf & 0x00000200) && !timer_expired(timeout)); // wait till busy=0
 	if ((bf & 0x00000200)!=0) return -3;
 	*flash_access=0x00000000;
 	return 0;
@@ -76,22 +96,22 @@ int erase_application_flash(void) {
 //      return : on error below zero, on success zero
 int write_flash(unsigned int address, unsigned char bytes[], int nrofbytes) {
 	unsigned int bf,i;
-	int timeout=0;
+	unsigned int timeout;
 	if (nrofbytes<=0) return -1;
+	timeout=timer_timeout(FLASH_TIMEOUT_BUSY);
 	do {
 		bf=*flash_read;
-	} while ((bf & 0x00000200) && (timeout++<1000)); // wait till busy=0
+	} while ((bf & 0x00000200) && !timer_expired(timeout)); // wait till busy=0
 	if (bf & 0x00000200) return -2; // error: still busy
 	*flash_access=0x00000015; // enable writing to flash with bit0=1 (access enable) and bit4..2=101 (write enable)
 	for (i=0; i<nrofbytes; i++) {
 		*flash_data=(address<<8) | (unsigned int) bytes[i]; // address in bits 31..8, data in bits 7..0
 	}
 	*flash_access=0x00000000; // disable writing; this will start writing process
-	timeout=0;
-	timeout=0;
+	timeout=timer_timeout(FLASH_TIMEOUT_WRITE);
 	do {
 		bf=*flash_read;
-	} while ((bf & 0x00000200) && (timeout++<10000000)); // wait till busy=0
+	} while ((bf & 0x00000200) && !timer_expired(timeout)); // wait till busy=0
 	if ((bf & 0x00000200)!=0) return -5;
 	return 0;
 }
@@ -106,26 +126,26 @@ int write_flash(unsigned int address, unsigned char bytes[], int nrofbytes) {
 int read_flash(unsigned int address, unsigned char bytes[], int nrofbytes) {
 	unsigned int bf,adr;
 	int i,j;
-	int timeout=0;
+	unsigned int timeout;
 	if (nrofbytes<=0) return -1;
 	*flash_access=0x00000003; // enable reading from flash with bit0=1 (access enable) and bit1=1 (read enable)
 	adr=address << 8; // address in bits 31..8, start flash reading
 	*flash_data=adr;
 	for (i=0; i<nrofbytes; i++) {
-		timeout=0;
+		timeout=timer_timeout(FLASH_TIMEOUT_READ);
 		do {
 			bf=*flash_read;
-		} while (((bf & 0x00000100)==0) && (timeout++<10000)); // wait till available or error
+		} while (((bf & 0x00000100)==0) && !timer_expired(timeout)); // wait till available or error
 		if ((bf & 0x00000100)==0) { *flash_access=0x00000000; return -2; }
 		if ((bf & 0x00000400)!=0) { *flash_access=0x00000000; return -3; }
 		*flash_data=adr; // read from fifo
 		bytes[i]=(unsigned char) *flash_read;
 	}
 	*flash_access=0x00000000;
-	timeout=0;
+	timeout=timer_timeout(FLASH_TIMEOUT_BUSY);
 	do {
 		bf=*flash_read;
-	} while ((bf & 0x00000200) && (timeout++<10000000)); // wait till busy=0
+	} while ((bf & 0x00000200) && !timer_expired(timeout)); // wait till busy=0
 	if ((bf & 0x00000200)!=0) return -5;
 	return 0;
 }
@@ -136,17 +156,17 @@ int read_flash(unsigned int address, unsigned char bytes[], int nrofbytes) {
 //      return : on error below zero, on success zero
 int read_flash_id(unsigned char *byte) {
 	unsigned int bf;
-	int timeout=0;
+	unsigned int timeout;
+	timeout=timer_timeout(FLASH_TIMEOUT_BUSY);
 	do {
 		bf=*flash_read;
-	} while ((bf & 0x00000200) && (timeout++<1000)); // wait till busy=0
+	} while ((bf & 0x00000200) && !timer_expired(timeout)); // wait till busy=0
 	if (bf & 0x00000200) return -1; // error: still busy
 	*flash_access=0x00000101; // start reading id from flash with bit0=1 (access enable) and bit8=1 (read id)
-	timeout=0;
-	timeout=0;
+	timeout=timer_timeout(FLASH_TIMEOUT_COMMAND);
 	do {
 		bf=*flash_read;
-	} while ((bf & 0x00000200) && (timeout++<100)); // wait till busy=0
+	} while ((bf & 0x00000200) && !timer_expired(timeout)); // wait till busy=0
 	if (bf & 0x00000200) return -1;
 	*byte=bf & 0xff;
 	*flash_access=0x00000000;
@@ -159,16 +179,17 @@ int read_flash_id(unsigned char *byte) {
 //      return : on error below zero, on success zero
 int read_flash_status(unsigned char *byte) {
 	unsigned int bf;
-	int timeout=0;
+	unsigned int timeout;
+	timeout=timer_timeout(FLASH_TIMEOUT_BUSY);
 	do {
 		bf=*flash_read;
-	} while ((bf & 0x00000200) && (timeout++<1000)); // wait till busy=0
+	} while ((bf & 0x00000200) && !timer_expired(timeout)); // wait till busy=0
 	if (bf & 0x00000200) return -1; // error: still busy
 	*flash_access=0x00000201; // start reading id from flash with bit0=1 (access enable) and bit8=1 (read status)
-	timeout=0;
+	timeout=timer_timeout(FLASH_TIMEOUT_COMMAND);
 	do {
 		bf=*flash_read;
-	} while ((bf & 0x00000200) && (timeout++<100)); // wait till busy=0
+	} while ((bf & 0x00000200) && !timer_expired(timeout)); // wait till busy=0
 	if (bf & 0x00000200) return -1;
 	*byte=bf & 0xff;
 	*flash_access=0x00000000;
@@ -188,16 +209,17 @@ int read_flash_status(unsigned char *byte) {
 //      return : on error below zero, on success zero
 int write_flash_parameter(unsigned int address, unsigned int param) {
 	unsigned int bf;
-	int timeout=0;
+	unsigned int timeout;
+	timeout=timer_timeout(FLASH_TIMEOUT_BUSY);
 	do {
 		bf=*flash_parameters_read;
-	} while ((bf & 0x08000000) && (timeout++<1000)); // wait till busy=0
+	} while ((bf & 0x08000000) && !timer_expired(timeout)); // wait till busy=0
 	bf = ((address & 0x7) << 24) | (param & 0x00ffffff) | (0x08000000); // param address and data and bit27=write
 	*flash_parameters = bf;
-	timeout=0;
+	timeout=timer_timeout(FLASH_TIMEOUT_BUSY);
 	do {
 		bf=*flash_parameters_read;
-	} while (((bf & 0x08000000)!=0) && (timeout++<1000)); // wait till busy=0 
+	} while (((bf & 0x08000000)!=0) && !timer_expired(timeout)); // wait till busy=0 
 	if ((bf & 0x08000000)!=0) return -1;
 	return 0;
 }
@@ -216,17 +238,18 @@ int write_flash_parameter(unsigned int address, unsigned int param) {
 //      return : on error below zero, on success zero
 int read_flash_parameter(unsigned int address, unsigned int *param) {
 	unsigned int bf,parbf;
-	int timeout=0;
+	unsigned int timeout;
+	timeout=timer_timeout(FLASH_TIMEOUT_BUSY);
 	do {
 		bf=*flash_parameters_read;
-	} while ((bf & 0x08000000) && (timeout++<1000)); // wait till busy=0
+	} while ((bf & 0x08000000) && !timer_expired(timeout)); // wait till busy=0
 	if (bf & 0x08000000) return -2;
 	parbf = ((address & 0x7) << 24) | (0x10000000); // 3 bits parameter address plus bit28=read request;
 	*flash_parameters = parbf;
-	timeout=0;
+	timeout=timer_timeout(FLASH_TIMEOUT_COMMAND);
 	do {
 		bf=*flash_parameters_read; 
-	} while ((bf & 0x08000000) && (timeout++<100)); // wait till busy=0
+	} while ((bf & 0x08000000) && !timer_expired(timeout)); // wait till busy=0
 	*param =  bf & 0x00ffffff;
 //	if (bf & 0x30000000) return bf>>28;
 	if (((bf >> 24) & 0x7) != address) return -2;
@@ -262,7 +285,7 @@ int factory_mode(void) {
 // If this funcion is called from the lm32 soft-core cpu, the function will not return, the cpu is stopped
 int start_reconfiguration(void) {
 	unsigned int bf;
-	int timeout;
+	unsigned int timeout;
 	int rval;
 //	rval=write_flash_parameter(4,APPICATIONFLASHADDRESS >> 16); // according to the manual, but this does not work
 	rval=write_flash_parameter(4,APPICATIONFLASHADDRESS);
@@ -270,10 +293,10 @@ int start_reconfiguration(void) {
 	rval=write_flash_parameter(5,1); // set to application page
 	if (rval<0) return rval;
 
-	timeout=0;
+	timeout=timer_timeout(FLASH_TIMEOUT_BUSY);
 	do {
 		bf=*flash_parameters_read;
-	} while ((bf & 0x08000000) && (timeout++<1000)); // wait till busy=0
+	} while ((bf & 0x08000000) && !timer_expired(timeout)); // wait till busy=0
 	if ((bf & 0x08000000)!=0) return -10;
 	*flash_parameters = 0xa0000000; 
 	return 0;
@@ -287,3 +310,243 @@ void reset_flashupdate_module(void) {
 }
 
 
+
+// Non-blocking flash access
+// A job (erase, program or read) is started with one of the flash_start_ functions and returns at once.
+// The job is advanced by flash_step each time the flash update module is ready for the next command,
+// or has read data available: from the interrupt handler (VIC_IRQ_FLASH) if flash_async_init was called
+// with useirq, otherwise from flash_poll. At the end of the job the callback is called with the result.
+// Only one job at a time; the blocking functions above must not be used while a job is running.
+//
+//     flash_async_init(1); // after vic_init
+//     flash_start_program(APPICATIONFLASHADDRESS,image,imagesize,program_done);
+//     ... the application keeps running, program_done(result) is called from the interrupt handler
+
+#define FLASH_READ_BUSY 0x00000200
+#define FLASH_READ_VALID 0x00000100
+#define FLASH_READ_ERROR 0x00000400
+#define FLASH_PAGESIZE 256
+
+enum { FLASH_JOB_IDLE, FLASH_JOB_ERASE, FLASH_JOB_WRITE, FLASH_JOB_READ };
+
+static volatile struct {
+	int state;
+	int pending; // a command has been given to the module, waiting till it has finished
+	unsigned int erase_address; // next sector to erase
+	unsigned int erase_end;
+	unsigned int address; // next address to write or read
+	unsigned char *data;
+	int remaining; // bytes to write or read
+	int chunk; // bytes left to read with the current read command
+	int result;
+	unsigned int timeout;
+	flash_callback_t callback;
+} job_s = { FLASH_JOB_IDLE };
+
+static int useirq_s = 0;
+
+// end the job, called with interrupts disabled or from the interrupt handler
+static void flash_finish(int result) {
+	flash_callback_t callback = job_s.callback;
+	*flash_access=0x00000000;
+	job_s.state = FLASH_JOB_IDLE;
+	job_s.pending = 0;
+	job_s.result = result;
+	if (useirq_s) vic_disableirq(VIC_IRQ_FLASH);
+	if (callback) callback(result);
+}
+
+// result for a timeout: -2 no read data, -5 command not finished, -1 module busy before the first command
+static int flash_timeouterror(void) {
+	if (job_s.state==FLASH_JOB_READ && job_s.chunk>0) return -2;
+	return job_s.pending ? -5 : -1;
+}
+
+// start writing the next page, the module must be ready
+static void flash_writepage(void) {
+	int i,n;
+	n = FLASH_PAGESIZE - (job_s.address & (FLASH_PAGESIZE-1)); // do not cross a page boundary
+	if (n>job_s.remaining) n=job_s.remaining;
+	*flash_access=0x00000015; // enable writing to flash with bit0=1 (access enable) and bit4..2=101 (write enable)
+	for (i=0; i<n; i++) {
+		*flash_data=(job_s.address<<8) | (unsigned int) job_s.data[i]; // address in bits 31..8, data in bits 7..0
+	}
+	*flash_access=0x00000000; // disable writing; this will start writing process
+	job_s.address += n;
+	job_s.data += n;
+	job_s.remaining -= n;
+	job_s.pending = 1;
+	job_s.timeout = timer_timeout(FLASH_TIMEOUT_WRITE);
+}
+
+// Advance the job: give the next command if the module is ready, move read data to the buffer
+// Called from the interrupt handler or from flash_poll
+static void flash_step(void) {
+	unsigned int bf=*flash_read;
+	int got=0;
+	if (job_s.state==FLASH_JOB_READ && job_s.chunk>0) {
+		while ((bf & FLASH_READ_VALID) && job_s.chunk>0) {
+			if (bf & FLASH_READ_ERROR) { flash_finish(-3); return; }
+			*flash_data=job_s.address<<8; // read from fifo
+			*job_s.data++ = (unsigned char) *flash_read;
+			job_s.chunk--;
+			job_s.remaining--;
+			got=1;
+			bf=*flash_read;
+		}
+		if (job_s.chunk>0) {
+			if (got) job_s.timeout = timer_timeout(FLASH_TIMEOUT_READ);
+			else if (timer_expired(job_s.timeout)) flash_finish(flash_timeouterror());
+			return;
+		}
+		*flash_access=0x00000000; // end of this read command
+		job_s.pending = 0;
+		if (job_s.remaining==0) flash_finish(0);
+		else job_s.timeout = timer_timeout(FLASH_TIMEOUT_BUSY);
+		return;
+	}
+	if (bf & FLASH_READ_BUSY) {
+		if (timer_expired(job_s.timeout)) flash_finish(flash_timeouterror());
+		return;
+	}
+	switch (job_s.state) {
+	case FLASH_JOB_ERASE:
+		if (job_s.pending) {
+			*flash_access=0x00000000;
+			job_s.pending = 0;
+			if (*flash_parameters_read & 0x40000000) { flash_finish(-20); return; }
+		}
+		if (job_s.erase_address<job_s.erase_end) {
+			*flash_access=0x000000a1; // enable erasing to flash with bit0=1 (access enable) and bit7..5=101 (erase enable)
+			*flash_data=(job_s.erase_address<<8); // address in bits 31..8
+			job_s.erase_address += SECTORSIZE;
+			job_s.pending = 1;
+			job_s.timeout = timer_timeout(FLASH_TIMEOUT_ERASE);
+			return;
+		}
+		if (job_s.remaining==0) { flash_finish(0); return; }
+		job_s.state = FLASH_JOB_WRITE; // program after erase
+		flash_writepage();
+		return;
+	case FLASH_JOB_WRITE:
+		if (job_s.remaining==0) { flash_finish(0); return; }
+		flash_writepage();
+		return;
+	case FLASH_JOB_READ:
+		job_s.chunk = (job_s.remaining<READBUFFERSIZE) ? job_s.remaining : READBUFFERSIZE;
+		*flash_access=0x00000003; // enable reading from flash with bit0=1 (access enable) and bit1=1 (read enable)
+		*flash_data=job_s.address<<8; // address in bits 31..8, start flash reading
+		job_s.address += job_s.chunk;
+		job_s.pending = 1;
+		job_s.timeout = timer_timeout(FLASH_TIMEOUT_READ);
+		return;
+	default:
+		if (useirq_s) vic_disableirq(VIC_IRQ_FLASH);
+		return;
+	}
+}
+
+// interrupt handler: the flash update module is ready or has read data available
+static void flash_irq(void) {
+	flash_step();
+}
+
+// Initialize the non-blocking flash access
+//   Parameters :
+//      int useirq : 1: the job is advanced by the interrupt of the flash update module, vic_init must be called before
+//                   0: the job is advanced by calling flash_poll
+void flash_async_init(int useirq) {
+	useirq_s = useirq;
+	job_s.state = FLASH_JOB_IDLE;
+	if (useirq) {
+		vic_disableirq(VIC_IRQ_FLASH);
+		vic_sethandler(VIC_IRQ_FLASH, flash_irq);
+	}
+}
+
+static int flash_start(int state, unsigned int erase_address, unsigned int erase_end,
+	unsigned int address, unsigned char *data, int nrofbytes, flash_callback_t callback) {
+	unsigned int ie=irq_disable();
+	if (job_s.state!=FLASH_JOB_IDLE) {
+		irq_restore(ie);
+		return -1;
+	}
+	job_s.state = state;
+	job_s.pending = 0;
+	job_s.erase_address = erase_address & ~(SECTORSIZE-1);
+	job_s.erase_end = erase_end;
+	job_s.address = address;
+	job_s.data = data;
+	job_s.remaining = nrofbytes;
+	job_s.chunk = 0;
+	job_s.result = FLASH_BUSY;
+	job_s.callback = callback;
+	job_s.timeout = timer_timeout(FLASH_TIMEOUT_BUSY);
+	if (useirq_s) vic_enableirq(VIC_IRQ_FLASH); // the module is ready: the interrupt starts the first command
+	else flash_step();
+	irq_restore(ie);
+	return 0;
+}
+
+// Start erasing the sectors from address to address+nrofbytes
+//   Parameters :
+//      unsigned int address : address inside the first sector to erase
+//      unsigned int nrofbytes : number of bytes to erase, rounded up to whole sectors
+//      flash_callback_t callback : called at the end with the result, can be 0
+//      return : -1 if a job is running, zero if the job has been started
+int flash_start_erase(unsigned int address, unsigned int nrofbytes, flash_callback_t callback) {
+	if (nrofbytes==0) return -1;
+	return flash_start(FLASH_JOB_ERASE,address,address+nrofbytes,address,0,0,callback);
+}
+
+// Start writing bytes to flash, any number of bytes, the flash must have been erased
+//   Parameters :
+//      unsigned int address : starting address
+//      unsigned char bytes[] : bytes to write, must stay valid till the job has finished
+//      int nrofbytes : number of bytes to write
+//      flash_callback_t callback : called at the end with the result, can be 0
+//      return : -1 if a job is running, zero if the job has been started
+int flash_start_write(unsigned int address, unsigned char bytes[], int nrofbytes, flash_callback_t callback) {
+	if (nrofbytes<=0) return -1;
+	return flash_start(FLASH_JOB_WRITE,0,0,address,bytes,nrofbytes,callback);
+}
+
+// Start erasing the sectors and writing an image, for instance the application firmware
+//   Parameters :
+//      unsigned int address : starting address, normally the start of a sector
+//      unsigned char bytes[] : image, must stay valid till the job has finished
+//      int nrofbytes : size of the image
+//      flash_callback_t callback : called at the end with the result, can be 0
+//      return : -1 if a job is running, zero if the job has been started
+int flash_start_program(unsigned int address, unsigned char bytes[], int nrofbytes, flash_callback_t callback) {
+	if (nrofbytes<=0) return -1;
+	return flash_start(FLASH_JOB_ERASE,address,address+nrofbytes,address,bytes,nrofbytes,callback);
+}
+
+// Start reading bytes from flash
+//   Parameters :
+//      unsigned int address : starting address
+//      unsigned char bytes[] : buffer for the bytes read, must stay valid till the job has finished
+//      int nrofbytes : number of bytes to read
+//      flash_callback_t callback : called at the end with the result, can be 0
+//      return : -1 if a job is running, zero if the job has been started
+int flash_start_read(unsigned int address, unsigned char bytes[], int nrofbytes, flash_callback_t callback) {
+	if (nrofbytes<=0) return -1;
+	return flash_start(FLASH_JOB_READ,0,0,address,bytes,nrofbytes,callback);
+}
+
+// State of the job, advances the job if no interrupt is used
+// With the interrupt a timeout is checked here too: the interrupt does not come if the module hangs
+//   Parameters :
+//      return : FLASH_BUSY while the job is running, otherwise the result of the last job: on error below zero, on success zero
+int flash_poll(void) {
+	unsigned int ie=irq_disable();
+	int result;
+	if (job_s.state!=FLASH_JOB_IDLE) {
+		if (!useirq_s) flash_step();
+		else if (timer_expired(job_s.timeout)) flash_finish(flash_timeouterror());
+	}
+	result = (job_s.state==FLASH_JOB_IDLE) ? job_s.result : FLASH_BUSY;
+	irq_restore(ie);
+	return result;
+}
@@ -0,0 +1,48 @@
+// Access to the external flash and the remote update of the FPGA with the flash update module (FlashUpdateModule)
+// The blocking functions wait for the module with a timeout, the flash_start_ functions run the
+// access in the background, see access_flash.c
+
+#ifndef ACCESS_FLASH_H
+#define ACCESS_FLASH_H
+
+#define FLASHSIZE 16777216
+#define SECTORSIZE 65536
+#define APPICATIONFLASHADDRESS 0x00800000
+
+#define FLASH_BUSY 1 // flash_poll: the job is running
+
+extern volatile unsigned int* flash_parameters;
+extern volatile unsigned int* flash_parameters_read;
+extern volatile unsigned int* flash_data;
+extern volatile unsigned int* flash_read;
+extern volatile unsigned int* flash_access;
+
+void flash_init(void);
+
+// blocking access
+int erase_flash_sector(unsigned int address);
+int erase_factory_flash(void);
+int erase_application_flash(void);
+int write_flash(unsigned int address, unsigned char bytes[], int nrofbytes);
+int read_flash(unsigned int address, unsigned char bytes[], int nrofbytes);
+int read_flash_id(unsigned char *byte);
+int read_flash_status(unsigned char *byte);
+int write_flash_parameter(unsigned int address, unsigned int param);
+int read_flash_parameter(unsigned int address, unsigned int *param);
+unsigned char read_status(void);
+int factory_mode(void);
+int start_reconfiguration(void);
+void reset_flashupdate_module(void);
+
+// non-blocking access, the callback is called with the result (on error below zero, on success zero),
+// from the interrupt handler if the interrupt is used
+typedef void (*flash_callback_t)(int result);
+
+void flash_async_init(int useirq);
+int flash_start_erase(unsigned int address, unsigned int nrofbytes, flash_callback_t callback);
+int flash_start_write(unsigned int address, unsigned char bytes[], int nrofbytes, flash_callback_t callback);
+int flash_start_program(unsigned int address, unsigned char bytes[], int nrofbytes, flash_callback_t callback);
+int flash_start_read(unsigned int address, unsigned char bytes[], int nrofbytes, flash_callback_t callback);
+int flash_poll(void);
+
+#endif
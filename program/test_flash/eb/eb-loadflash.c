@@ -39,6 +39,9 @@
 #include "../etherbone.h"
 #include "../glue/version.h"
 #include "common.h"
+#include "../../common/sdb.h"
+#include "../../common/ebtool.h"
+#include "../../common/pcie_irq.h"
 
 #define OPERATIONS_PER_CYCLE 256
 
@@ -66,7 +69,7 @@ unsigned long long strtoull (const char * nptr, char ** endptr, int base);
 extern int usleep (__useconds_t __useconds);
 
 static void help(void) {
-  fprintf(stderr, "Usage: %s [OPTION] <proto/host/port> <baseaddress> <flashaddress> <firmware>\n", program);
+  fprintf(stderr, "Usage: %s [OPTION] <proto/host/port> [baseaddress] <flashaddress> <firmware>\n", program);
   fprintf(stderr, "\n");
   fprintf(stderr, "  -a <width>     acceptable address bus widths     (8/16/32/64)\n");
   fprintf(stderr, "  -d <width>     acceptable data bus widths        (8/16/32/64)\n");
@@ -79,8 +82,12 @@ static void help(void) {
   fprintf(stderr, "  -c <cycles>    read cycles per verbose operation\n");
   fprintf(stderr, "  -q             quiet: do not display warnings\n");
   fprintf(stderr, "  -m             mirror byte: reverse bits, needed for Altera rbf-files\n");
+  fprintf(stderr, "  -i <uiodev>    wait for the flash interrupt on the UIO device of the card\n");
   fprintf(stderr, "  -h             display this help and exit\n");
   fprintf(stderr, "\n");
+  fprintf(stderr, "Without baseaddress the flash update module is found in the SDB records at 0x%x.\n", SDB_ADDRESS);
+  fprintf(stderr, "Without -i the busy bit of the flash is polled over Etherbone.\n");
+  fprintf(stderr, "\n");
   fprintf(stderr, "Report Etherbone bugs to <etherbone-core@ohwr.org>\n");
   fprintf(stderr, "Version %"PRIx32" (%s). Licensed under the LGPL v3.\n", EB_VERSION_SHORT, EB_DATE_FULL);
 }
@@ -143,6 +150,23 @@ static unsigned char invbyte(unsigned char bt)
 
 static int force;
 static eb_socket_t socket;
+static struct pcie_event event = { -1, 0 };
+
+// Wait for the interrupt of the flash update module, it rises when the flash is not busy anymore
+// Does nothing without the -i option. The busy bit is read afterwards as before.
+//   Parameters :
+//      int timeout_ms : timeout in ms
+static void wait_flash_event(int timeout_ms)
+{
+	long rval;
+	if (event.fd<0) return;
+	rval=pcie_event_wait(&event,PCIE_IRQ_FLASH,timeout_ms);
+	if (rval<0) {
+		fprintf(stderr, "%s: waiting for the flash interrupt: %s\n", program, strerror(errno));
+		exit(1);
+	}
+	if ((rval==0) && !quiet) fprintf(stderr, "%s: warning: no flash interrupt, polling\n", program);
+}
 
 static unsigned int eb_read(eb_device_t device, eb_address_t address, eb_format_t format)
 {
@@ -180,6 +204,7 @@ static void eb_write(eb_device_t device, eb_address_t address, eb_format_t forma
 	eb_device_flush(device);
 	while (!stop) { eb_socket_run(socket, -1); }
 }
+
   
 // Read one of the parameters of the FPGA altremote_update component
 // altremote_update parameters, defined by address:
@@ -229,7 +254,7 @@ static unsigned int read_flash_parameter(eb_device_t device, eb_address_t basead
 static void erase_flash_sector(eb_device_t device, eb_address_t baseaddress, unsigned long flash_address, eb_format_t format) {
 	unsigned int bf;
 	int timeout=0;
-	if (verbose) fprintf(stdout,"\rErase segment 0x%"EB_ADDR_FMT"... ",(int) flash_address);
+	if (verbose) fprintf(stdout,"\rErase segment 0x%"EB_ADDR_FMT"... ",(eb_address_t) flash_address);
 	fflush(stdout);
 	do {
 		bf=eb_read(device,baseaddress+FLASH_READ,format);
@@ -239,10 +264,12 @@ static void erase_flash_sector(eb_device_t device, eb_address_t baseaddress, uns
 		exit(1);
 	}
 	eb_write(device,baseaddress+FLASH_ACCESS,format,0x000000a1);
+	if (event.fd>=0) pcie_event_clear(&event,PCIE_IRQ_FLASH);
 	eb_write(device,baseaddress+FLASH_DATA,format,flash_address<<8); // address in bits 31..8
+	wait_flash_event(5000);
 	timeout=0;
 	do {
-		usleep(100);
+		if ((event.fd<0) || (timeout>0)) usleep(100);
 		bf=eb_read(device,baseaddress+FLASH_READ,format);
 	} while ((bf & 0x00000200) && (timeout++<5000)); // wait till busy=0
 	if ((bf & 0x00000200)!=0) { 
@@ -342,7 +369,9 @@ static void transfer(eb_device_t device, eb_address_t baseaddress, unsigned long
 			data = (flash_address<<8) | (unsigned int)(buffer[0]); // address in bits 31..8, data in bits 7..0, invert bytes from rbf file
 		eb_write(device,baseaddress+FLASH_DATA,format,data);
 	}
+	if (event.fd>=0) pcie_event_clear(&event,PCIE_IRQ_FLASH);
 	eb_write(device,baseaddress+FLASH_ACCESS,format,0x00000000); // disable writing; this will start writing process
+	wait_flash_event(1000);
 	timeout=0;
 	do {
 		bf=eb_read(device,baseaddress+FLASH_READ,format);
@@ -370,11 +399,12 @@ int main(int argc, char** argv) {
 
   
   /* Specific command-line options */
-  int attempts, probe, cycles;
+  int attempts, probe, discover, cycles;
   const char* netaddress;
   eb_address_t firmware_length;
   
   unsigned int flashaddress;
+  const char* uiodev;
   
   /* Default arguments */
   program = argv[0];
@@ -389,9 +419,10 @@ int main(int argc, char** argv) {
   cycles = 100;
   force = 0;
   size = 4;
+  uiodev = 0;
   
   /* Process the command-line arguments */
-  while ((opt = getopt(argc, argv, "a:d:c:blr:fpvqmh")) != -1) {
+  while ((opt = getopt(argc, argv, "a:d:c:blr:fpvqmi:h")) != -1) {
     switch (opt) {
     case 'a':
       value = parse_width(optarg);
@@ -446,6 +477,9 @@ int main(int argc, char** argv) {
     case 'm':
       bitreverse = 1;
       break;
+    case 'i':
+      uiodev = optarg;
+      break;
     case 'h':
       help();
       return 1;
@@ -461,18 +495,24 @@ int main(int argc, char** argv) {
   
   if (error) return 1;
   
-  if (optind + 4 != argc) {
-    fprintf(stderr, "%s: expecting four non-optional arguments: <proto/host/port> <baseaddress> <flashaddress> <firmware>\n", program);
+  if ((optind + 4 != argc) && (optind + 3 != argc)) {
+    fprintf(stderr, "%s: expecting three or four non-optional arguments: <proto/host/port> [baseaddress] <flashaddress> <firmware>\n", program);
     return 1;
   }
+  discover = (optind + 3 == argc);
   
   netaddress = argv[optind];
 
-  baseaddress = strtoull(argv[optind+1], &value_end, 0);
-  if (*value_end != 0) {
-    fprintf(stderr, "%s: argument is not an unsigned value -- '%s'\n",
-                    program, argv[optind+1]);
-    return 1;
+  if (discover) {
+    baseaddress = 0; /* found in the SDB records after connecting, the next arguments move one place */
+    optind--;
+  } else {
+    baseaddress = strtoull(argv[optind+1], &value_end, 0);
+    if (*value_end != 0) {
+      fprintf(stderr, "%s: argument is not an unsigned value -- '%s'\n",
+                      program, argv[optind+1]);
+      return 1;
+    }
   }
 
   
@@ -520,6 +560,10 @@ int main(int argc, char** argv) {
     fprintf(stdout, "  negotiated %s-bit address and %s-bit data session.\n", 
                     width_str[line_width >> 4], width_str[line_width & EB_DATAX]);
   
+  if (discover) {
+    struct ebtool_bus bus = { socket, device, EB_BIG_ENDIAN|EB_DATA32 };
+    baseaddress = ebtool_find_base(&bus, SDB_VENDOR_GSI, SDB_DEVICE_FLASH, "flash update module");
+  }
   address=baseaddress;
   if (probe) {
     if (verbose)
@@ -579,6 +623,14 @@ int main(int argc, char** argv) {
   format |= (size & write_sizes);
   end_address = flashaddress + firmware_length;
 
+  if (uiodev) {
+    if (pcie_event_open(&event, uiodev) < 0) {
+      fprintf(stderr, "%s: cannot open %s, %s -- polling the flash\n", program, uiodev, strerror(errno));
+    } else if (verbose) {
+      fprintf(stdout, "Waiting for the flash interrupt on %s\n", uiodev);
+    }
+  }
+
   // check registers
   if (check_flash(device,baseaddress,format)) {
     fprintf(stderr, "%s: error: reading from flash\n",program);
@@ -598,7 +650,7 @@ int main(int argc, char** argv) {
     /* Flush? */
     if (++cycle == cycles) {
       if (verbose) {
-        fprintf(stdout, "\rProgramming 0x%"EB_ADDR_FMT"... ", flashaddress);
+        fprintf(stdout, "\rProgramming 0x%"EB_ADDR_FMT"... ", (eb_address_t) flashaddress);
         fflush(stdout);
       }
       cycle = 0;
@@ -607,6 +659,7 @@ int main(int argc, char** argv) {
   
   if (verbose) fprintf(stdout, "\ndone!\n");
 
+  pcie_event_close(&event);
   
   if ((status = eb_device_close(device)) != EB_OK) {
     fprintf(stderr, "%s: failed to close Etherbone device: %s\n", program, eb_status(status));
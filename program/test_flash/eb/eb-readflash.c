@@ -39,6 +39,9 @@
 #include "../etherbone.h"
 #include "../glue/version.h"
 #include "common.h"
+#include "../../common/sdb.h"
+#include "../../common/ebtool.h"
+#include "../../common/pcie_irq.h"
 
 #define OPERATIONS_PER_CYCLE 512
 
@@ -65,7 +68,7 @@
 unsigned long long strtoull (const char * nptr, char ** endptr, int base);
 
 static void help(void) {
-  fprintf(stderr, "Usage: %s [OPTION] <proto/host/port> <baseaddress> <flashaddress> <flashsize> <firmware>\n", program);
+  fprintf(stderr, "Usage: %s [OPTION] <proto/host/port> [baseaddress] <flashaddress> <flashsize> <firmware>\n", program);
   fprintf(stderr, "\n");
   fprintf(stderr, "  -a <width>     acceptable address bus widths     (8/16/32/64)\n");
   fprintf(stderr, "  -d <width>     acceptable data bus widths        (8/16/32/64)\n");
@@ -78,8 +81,12 @@ static void help(void) {
   fprintf(stderr, "  -c <cycles>    read cycles per verbose operation\n");
   fprintf(stderr, "  -q             quiet: do not display warnings\n");
   fprintf(stderr, "  -m             mirror byte: reverse bits, needed for Altera rbf-files\n");
+  fprintf(stderr, "  -i <uiodev>    wait for the flash interrupt on the UIO device of the card\n");
   fprintf(stderr, "  -h             display this help and exit\n");
   fprintf(stderr, "\n");
+  fprintf(stderr, "Without baseaddress the flash update module is found in the SDB records at 0x%x.\n", SDB_ADDRESS);
+  fprintf(stderr, "Without -i the flash status is polled over Etherbone.\n");
+  fprintf(stderr, "\n");
   fprintf(stderr, "Report Etherbone bugs to <etherbone-core@ohwr.org>\n");
   fprintf(stderr, "Version %"PRIx32" (%s). Licensed under the LGPL v3.\n", EB_VERSION_SHORT, EB_DATE_FULL);
 }
@@ -143,6 +150,7 @@ static unsigned char invbyte(unsigned char bt)
 
 static int force;
 static eb_socket_t socket;
+static struct pcie_event event = { -1, 0 };
 
 static unsigned int eb_read(eb_device_t device, eb_address_t address, eb_format_t format)
 {
@@ -180,6 +188,7 @@ static void eb_write(eb_device_t device, eb_address_t address, eb_format_t forma
 	eb_device_flush(device);
 	while (!stop) { eb_socket_run(socket, -1); }
 }
+
   
 // Read one of the parameters of the FPGA altremote_update component
 // altremote_update parameters, defined by address:
@@ -253,6 +262,34 @@ static int check_flash(eb_device_t device, eb_address_t baseaddress, eb_format_t
 	return 0; // zero: ok
 }
 	
+// Wait with the interrupt of the flash update module till a status bit is set
+// The interrupt rises when read data is available, or when the flash is not busy while not reading.
+// Does nothing without the -i option or when the condition is already true.
+//   Parameters :
+//      eb_device_t device : Etherbone device
+//      eb_address_t baseaddress : Base address of the wishbone update_flash module
+//      eb_format_t format : Format of the Etherbone bus access
+//      unsigned int bits : wait till one of these bits is set in FLASH_READ
+//      unsigned int invert : bits of FLASH_READ that count when they are zero (busy)
+//      return : the last value read from FLASH_READ
+static unsigned int wait_flash_event(eb_device_t device, eb_address_t baseaddress, eb_format_t format, unsigned int bits, unsigned int invert)
+{
+	unsigned int bf;
+	long rval;
+	bf=eb_read(device,baseaddress+FLASH_READ,format);
+	if ((event.fd<0) || ((bf ^ invert) & bits)) return bf;
+	pcie_event_clear(&event,PCIE_IRQ_FLASH);
+	bf=eb_read(device,baseaddress+FLASH_READ,format); // the status may have changed before the clear
+	if ((bf ^ invert) & bits) return bf;
+	rval=pcie_event_wait(&event,PCIE_IRQ_FLASH,1000);
+	if (rval<0) {
+		fprintf(stderr, "\r%s: waiting for the flash interrupt: %s\n", program, strerror(errno));
+		exit(1);
+	}
+	if ((rval==0) && !quiet) fprintf(stderr, "\r%s: warning: no flash interrupt, polling\n", program);
+	return eb_read(device,baseaddress+FLASH_READ,format);
+}
+
 // Transfer data the pexaria2a flash to a file (firmware_f)
 //   Parameters :
 //      eb_device_t device : Etherbone device
@@ -277,9 +314,10 @@ static void transfer(eb_device_t device, eb_address_t baseaddress, unsigned long
 	eb_write(device,baseaddress+FLASH_DATA,format,adr);
 	for (i=0; i<count; i++) {
 		timeout=0;
-		do {
+		bf=wait_flash_event(device,baseaddress,format,0x00000500,0);
+		while (((bf & 0x00000100)==0) && ((bf & 0x00000400)==0) && (timeout++<100000)) { // wait till available or error
 			bf=eb_read(device,baseaddress+FLASH_READ,format);
-		} while (((bf & 0x00000100)==0) && ((bf & 0x00000400)==0) && (timeout++<100000)); // wait till available or error
+		}
 		if ((bf & 0x00000100)==0) {
 			eb_write(device,baseaddress+FLASH_ACCESS,format,0x00000000);
 			fprintf(stderr, "\r%s: flash data not valid\n",program);
@@ -293,9 +331,10 @@ static void transfer(eb_device_t device, eb_address_t baseaddress, unsigned long
 	}
 	eb_write(device,baseaddress+FLASH_ACCESS,format,0x00000000);
 	timeout=0;
-	do {
+	bf=wait_flash_event(device,baseaddress,format,0x00000200,0x00000200);
+	while ((bf & 0x00000200) && (timeout++<10000000)) { // wait till busy=0
 		bf=eb_read(device,baseaddress+FLASH_READ,format);
-	} while ((bf & 0x00000200) && (timeout++<10000000)); // wait till busy=0
+	}
 	if ((bf & 0x00000200)!=0) {
 		fprintf(stderr, "\r%s: error during flash reading: still busy\n",program);
 		exit(1); 
@@ -326,11 +365,12 @@ int main(int argc, char** argv) {
 
   
   /* Specific command-line options */
-  int attempts, probe, cycles;
+  int attempts, probe, discover, cycles;
   const char* netaddress;
   eb_address_t firmware_length;
   
   unsigned int flashaddress;
+  const char* uiodev;
   
   /* Default arguments */
   program = argv[0];
@@ -345,9 +385,10 @@ int main(int argc, char** argv) {
   cycles = 100;
   force = 0;
   size = 4;
+  uiodev = 0;
   
   /* Process the command-line arguments */
-  while ((opt = getopt(argc, argv, "a:d:c:blr:fpvqmh")) != -1) {
+  while ((opt = getopt(argc, argv, "a:d:c:blr:fpvqmi:h")) != -1) {
     switch (opt) {
     case 'a':
       value = parse_width(optarg);
@@ -402,6 +443,9 @@ int main(int argc, char** argv) {
     case 'm':
       bitreverse = 1;
       break;
+    case 'i':
+      uiodev = optarg;
+      break;
     case 'h':
       help();
       return 1;
@@ -417,18 +461,24 @@ int main(int argc, char** argv) {
   
   if (error) return 1;
   
-  if (optind + 5 != argc) {
-    fprintf(stderr, "%s: expecting five non-optional arguments: <proto/host/port> <baseaddress> <flashaddress> <flashsize> <firmware>\n", program);
+  if ((optind + 5 != argc) && (optind + 4 != argc)) {
+    fprintf(stderr, "%s: expecting four or five non-optional arguments: <proto/host/port> [baseaddress] <flashaddress> <flashsize> <firmware>\n", program);
     return 1;
   }
+  discover = (optind + 4 == argc);
   
   netaddress = argv[optind];
 
-  baseaddress = strtoull(argv[optind+1], &value_end, 0);
-  if (*value_end != 0) {
-    fprintf(stderr, "%s: argument is not an unsigned value -- '%s'\n",
-                    program, argv[optind+1]);
-    return 1;
+  if (discover) {
+    baseaddress = 0; /* found in the SDB records after connecting, the next arguments move one place */
+    optind--;
+  } else {
+    baseaddress = strtoull(argv[optind+1], &value_end, 0);
+    if (*value_end != 0) {
+      fprintf(stderr, "%s: argument is not an unsigned value -- '%s'\n",
+                      program, argv[optind+1]);
+      return 1;
+    }
   }
 
   
@@ -475,6 +525,10 @@ int main(int argc, char** argv) {
   if (verbose)
     fprintf(stdout, "  negotiated %s-bit address and %s-bit data session.\n", 
                     width_str[line_width >> 4], width_str[line_width & EB_DATAX]);
+  if (discover) {
+    struct ebtool_bus bus = { socket, device, EB_BIG_ENDIAN|EB_DATA32 };
+    baseaddress = ebtool_find_base(&bus, SDB_VENDOR_GSI, SDB_DEVICE_FLASH, "flash update module");
+  }
   address=baseaddress;
   if (probe) {
     if (verbose)
@@ -534,6 +588,14 @@ int main(int argc, char** argv) {
   /* Calculate end address */
   end_address = flashaddress + firmware_length;
 
+  if (uiodev) {
+    if (pcie_event_open(&event, uiodev) < 0) {
+      fprintf(stderr, "%s: cannot open %s, %s -- polling the flash\n", program, uiodev, strerror(errno));
+    } else if (verbose) {
+      fprintf(stdout, "Waiting for the flash interrupt on %s\n", uiodev);
+    }
+  }
+
   // check registers
   if (check_flash(device,baseaddress,format)) {
     fprintf(stderr, "%s: error: reading from flash\n",program);
@@ -547,7 +609,7 @@ int main(int argc, char** argv) {
     transfer(device, baseaddress, flashaddress, format, step);
     if (++cycle == cycles) {
       if (verbose) {
-        fprintf(stdout, "\rReading 0x%"EB_ADDR_FMT"... ", flashaddress);
+        fprintf(stdout, "\rReading 0x%"EB_ADDR_FMT"... ", (eb_address_t) flashaddress);
         fflush(stdout);
       }
       cycle = 0;
@@ -556,6 +618,8 @@ int main(int argc, char** argv) {
   fclose(firmware_f);
  
   if (verbose) fprintf(stdout, "\ndone!\n");
+
+  pcie_event_close(&event);
   
   if ((status = eb_device_close(device)) != EB_OK) {
     fprintf(stderr, "%s: failed to close Etherbone device: %s\n", program, eb_status(status));
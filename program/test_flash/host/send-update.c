@@ -0,0 +1,391 @@
+/** @file send-update.c
+ *  @brief A program which sends an FPGA image to the update agent of the test_flash firmware over rs232.
+ *
+ *  The image is programmed in the application part of the flash, verified and, unless -n is given,
+ *  loaded with a reconfiguration of the FPGA. See ../update.h for the frames.
+ *  The serial device is set to 115k2, 8 bits, no parity, raw.
+ *  UPDATE_WINDOW pages are sent ahead of the acknowledges, so the line is kept busy while the
+ *  firmware programs the previous pages or erases the next sector. At the end the effective throughput is reported.
+ *
+ *  @author Peter Schakel <p.schakel@rug.nl>
+ *
+ *  @bug None!
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <unistd.h> /* getopt */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <termios.h>
+
+#include "../update.h"
+
+#define FRAME_MAXSIZE (UPDATE_OVERHEAD+UPDATE_MAXPAYLOAD)
+#define APPICATIONFLASHADDRESS 0x00800000
+#define LINE_BYTES_PER_SECOND 11520 // 115k2, 10 bits per byte
+#define ACK_TIMEOUT 4000 // ms, more than a sector erase
+#define START_TIMEOUT 2000 // ms, the firmware handles the frames in its main loop
+#define MAX_RETRIES 5
+
+static const char* program;
+static int verbose = 0;
+static int fd;
+static unsigned char rxbuffer[2*FRAME_MAXSIZE];
+static int rxfill = 0;
+static unsigned long resent = 0;
+static unsigned long crcerrors = 0;
+
+// reverse the bits of a byte
+static unsigned char invbyte(unsigned char b) {
+  b = ((b & 0xf0) >> 4) | ((b & 0x0f) << 4);
+  b = ((b & 0xcc) >> 2) | ((b & 0x33) << 2);
+  b = ((b & 0xaa) >> 1) | ((b & 0x55) << 1);
+  return b;
+}
+
+static void help(void) {
+  fprintf(stderr, "Usage: %s [OPTION] <device> <image>\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -a <address>   flash address, start of a sector (default 0x%x)\n", APPICATIONFLASHADDRESS);
+  fprintf(stderr, "  -m             mirror byte: reverse bits, needed for Altera rbf-files\n");
+  fprintf(stderr, "  -n             no reconfiguration after the verify\n");
+  fprintf(stderr, "  -v             verbose: report every acknowledge\n");
+  fprintf(stderr, "  -h             display this help and exit\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Programs an FPGA image in the flash with the update agent of the test_flash firmware.\n");
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// set a serial device to 115k2, 8 bits, no parity, raw
+static int setserial(int fd) {
+  struct termios tio;
+  if (tcgetattr(fd, &tio) < 0) return -1;
+  tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF);
+  tio.c_oflag &= ~OPOST;
+  tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+  tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB);
+  tio.c_cflag |= CS8 | CREAD | CLOCAL;
+  tio.c_cc[VMIN] = 1;
+  tio.c_cc[VTIME] = 0;
+  cfsetispeed(&tio, B115200);
+  cfsetospeed(&tio, B115200);
+  return tcsetattr(fd, TCSANOW, &tio);
+}
+
+static int sendframe(int type, const unsigned char *payload, int len) {
+  unsigned char frame[FRAME_MAXSIZE];
+  unsigned int crc;
+  int i, pos;
+  ssize_t done;
+  frame[0] = UPDATE_SYNC;
+  frame[1] = len >> 8;
+  frame[2] = len;
+  frame[3] = type;
+  memcpy(&frame[UPDATE_HEADERSIZE], payload, len);
+  crc = ~crc32_update(0xffffffff, &frame[1], UPDATE_HEADERSIZE-1+len);
+  for (i = 0; i < UPDATE_CRCSIZE; i++) frame[UPDATE_HEADERSIZE+len+i] = (crc >> (i*8)) & 0xff;
+  for (pos = 0; pos < len+UPDATE_OVERHEAD; pos += done) {
+    done = write(fd, &frame[pos], len+UPDATE_OVERHEAD-pos);
+    if (done < 0) {
+      if (errno == EINTR) { done = 0; continue; }
+      fprintf(stderr, "%s: write error: %s\n", program, strerror(errno));
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static int senddata(const unsigned char *image, unsigned int size, unsigned int offset) {
+  unsigned char payload[UPDATE_MAXPAYLOAD];
+  unsigned int n = size-offset;
+  if (n > UPDATE_PAGESIZE) n = UPDATE_PAGESIZE;
+  update_put32(payload, offset);
+  memcpy(&payload[4], &image[offset], n);
+  return sendframe(UPDATE_TYPE_DATA, payload, 4+n);
+}
+
+// Wait for the next acknowledge frame, other bytes (text output of the firmware) are skipped
+// returns 1 with the acknowledge, 0 on timeout, -1 on error
+static int getack(int timeout, int *type, int *status, unsigned int *value) {
+  struct pollfd pfd;
+  double end = now() + timeout*1e-3;
+  int pos, len, rval;
+  unsigned int crc, framecrc;
+  ssize_t got;
+  for (;;) {
+    pos = 0;
+    while (pos < rxfill) {
+      if (rxbuffer[pos] != UPDATE_SYNC) { pos++; continue; }
+      if (rxfill-pos < UPDATE_HEADERSIZE) break;
+      len = (rxbuffer[pos+1] << 8) | rxbuffer[pos+2];
+      if (len > UPDATE_MAXPAYLOAD) { pos++; continue; }
+      if (rxfill-pos < len+UPDATE_OVERHEAD) break;
+      crc = ~crc32_update(0xffffffff, &rxbuffer[pos+1], UPDATE_HEADERSIZE-1+len);
+      framecrc = rxbuffer[pos+UPDATE_HEADERSIZE+len] |
+        ((unsigned int)rxbuffer[pos+UPDATE_HEADERSIZE+len+1] << 8) |
+        ((unsigned int)rxbuffer[pos+UPDATE_HEADERSIZE+len+2] << 16) |
+        ((unsigned int)rxbuffer[pos+UPDATE_HEADERSIZE+len+3] << 24);
+      if ((crc != framecrc) || (rxbuffer[pos+3] != UPDATE_TYPE_ACK) || (len != UPDATE_ACKSIZE)) {
+        if (crc != framecrc) crcerrors++;
+        pos++;
+        continue;
+      }
+      *type = rxbuffer[pos+UPDATE_HEADERSIZE];
+      *status = rxbuffer[pos+UPDATE_HEADERSIZE+1];
+      *value = update_get32(&rxbuffer[pos+UPDATE_HEADERSIZE+2]);
+      pos += len+UPDATE_OVERHEAD;
+      memmove(rxbuffer, &rxbuffer[pos], rxfill-pos);
+      rxfill -= pos;
+      if (verbose) fprintf(stderr, "%s: ack type=0x%02x status=%d value=0x%x\n", program, *type, *status, *value);
+      return 1;
+    }
+    memmove(rxbuffer, &rxbuffer[pos], rxfill-pos);
+    rxfill -= pos;
+
+    timeout = (int)((end-now())*1e3);
+    if (timeout <= 0) return 0;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    rval = poll(&pfd, 1, timeout);
+    if (rval < 0) {
+      if (errno == EINTR) continue;
+      fprintf(stderr, "%s: poll error: %s\n", program, strerror(errno));
+      return -1;
+    }
+    if (rval == 0) return 0;
+    got = read(fd, &rxbuffer[rxfill], sizeof(rxbuffer)-rxfill);
+    if (got <= 0) {
+      fprintf(stderr, "%s: read error: %s\n", program, got < 0 ? strerror(errno) : "end of file");
+      return -1;
+    }
+    rxfill += got;
+  }
+}
+
+static const char* statusname(int status) {
+  switch (status) {
+  case UPDATE_STATUS_OK:          return "ok";
+  case UPDATE_STATUS_RANGE:       return "address or size out of range";
+  case UPDATE_STATUS_SEQUENCE:    return "unexpected offset";
+  case UPDATE_STATUS_FLASH:       return "flash access failed";
+  case UPDATE_STATUS_VERIFY:      return "verify failed";
+  case UPDATE_STATUS_SESSION:     return "no update session";
+  case UPDATE_STATUS_RECONFIGURE: return "reconfiguration not started";
+  default:                        return "unknown status";
+  }
+}
+
+int main(int argc, char** argv) {
+  int opt, error, type, status, rval, retries, reconfigure, bitreverse;
+  unsigned int address, size, crc, value, next, acked, n;
+  unsigned char payload[UPDATE_STARTSIZE];
+  unsigned char *image;
+  const char *device, *filename;
+  char *end;
+  FILE* f;
+  long filesize;
+  double tstart, tdata, tend;
+
+  program = argv[0];
+  error = 0;
+  address = APPICATIONFLASHADDRESS;
+  reconfigure = 1;
+  bitreverse = 0;
+
+  while ((opt = getopt(argc, argv, "a:mnvh")) != -1) {
+    switch (opt) {
+    case 'a':
+      address = strtoul(optarg, &end, 0);
+      if (*end != 0) {
+        fprintf(stderr, "%s: invalid flash address -- '%s'\n", program, optarg);
+        error = 1;
+      }
+      break;
+    case 'm':
+      bitreverse = 1;
+      break;
+    case 'n':
+      reconfigure = 0;
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    case 'h':
+      help();
+      return 0;
+    case ':':
+    case '?':
+      error = 1;
+      break;
+    default:
+      fprintf(stderr, "%s: bad getopt result\n", program);
+      return 1;
+    }
+  }
+
+  if (error) return 1;
+
+  if (optind + 2 != argc) {
+    fprintf(stderr, "%s: expecting two non-optional arguments: <device> <image>\n", program);
+    return 1;
+  }
+  device = argv[optind];
+  filename = argv[optind+1];
+
+  f = fopen(filename, "rb");
+  if (f == 0) {
+    fprintf(stderr, "%s: cannot open %s: %s\n", program, filename, strerror(errno));
+    return 1;
+  }
+  fseek(f, 0, SEEK_END);
+  filesize = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  if (filesize <= 0) {
+    fprintf(stderr, "%s: %s is empty\n", program, filename);
+    return 1;
+  }
+  size = filesize;
+  image = malloc(size);
+  if ((image == 0) || (fread(image, 1, size, f) != size)) {
+    fprintf(stderr, "%s: cannot read %s\n", program, filename);
+    return 1;
+  }
+  fclose(f);
+  if (bitreverse) for (n = 0; n < size; n++) image[n] = invbyte(image[n]);
+  crc = ~crc32_update(0xffffffff, image, size);
+
+  fd = open(device, O_RDWR | O_NOCTTY);
+  if (fd < 0) {
+    fprintf(stderr, "%s: cannot open %s: %s\n", program, device, strerror(errno));
+    return 1;
+  }
+  if (isatty(fd)) {
+    if (setserial(fd) < 0) {
+      fprintf(stderr, "%s: cannot set serial parameters of %s: %s\n", program, device, strerror(errno));
+      return 1;
+    }
+    tcflush(fd, TCIOFLUSH);
+  }
+
+  // start the session
+  tstart = now();
+  update_put32(&payload[0], address);
+  update_put32(&payload[4], size);
+  update_put32(&payload[8], crc);
+  for (retries = 0; ; retries++) {
+    if (retries == MAX_RETRIES) {
+      fprintf(stderr, "%s: no answer from the update agent\n", program);
+      return 1;
+    }
+    if (sendframe(UPDATE_TYPE_START, payload, UPDATE_STARTSIZE) < 0) return 1;
+    while ((rval = getack(START_TIMEOUT, &type, &status, &value)) > 0 && type != UPDATE_TYPE_START);
+    if (rval < 0) return 1;
+    if (rval > 0) break;
+  }
+  if (status != UPDATE_STATUS_OK) {
+    fprintf(stderr, "%s: START refused: %s\n", program, statusname(status));
+    return 1;
+  }
+  printf("programming %u bytes at flash address 0x%06x, CRC-32 0x%08x\n", size, address, crc);
+
+  // pages, UPDATE_WINDOW ahead of the acknowledges
+  tdata = now();
+  next = 0;
+  acked = 0;
+  retries = 0;
+  while (acked < size) {
+    while ((next < size) && (next-acked < UPDATE_WINDOW*UPDATE_PAGESIZE)) {
+      if (senddata(image, size, next) < 0) return 1;
+      next += UPDATE_PAGESIZE;
+      if (next > size) next = size;
+    }
+    rval = getack(ACK_TIMEOUT, &type, &status, &value);
+    if (rval < 0) return 1;
+    if (rval == 0) { // lost frame or acknowledge: send again from the oldest page not acknowledged
+      if (++retries > MAX_RETRIES) {
+        fprintf(stderr, "%s: no acknowledge for offset 0x%x\n", program, acked);
+        return 1;
+      }
+      resent += (next-acked+UPDATE_PAGESIZE-1)/UPDATE_PAGESIZE;
+      next = acked;
+      continue;
+    }
+    if (type != UPDATE_TYPE_DATA) continue;
+    if (status == UPDATE_STATUS_SEQUENCE) { // the firmware expects another page
+      if (value < acked) value = acked;
+      resent += (next > value) ? (next-value+UPDATE_PAGESIZE-1)/UPDATE_PAGESIZE : 0;
+      next = value;
+      continue;
+    }
+    if (status != UPDATE_STATUS_OK) {
+      fprintf(stderr, "%s: page at offset 0x%x: %s\n", program, value, statusname(status));
+      return 1;
+    }
+    if (value != acked) continue; // acknowledge of a page sent again
+    n = size-acked;
+    acked += (n < UPDATE_PAGESIZE) ? n : UPDATE_PAGESIZE;
+    retries = 0;
+    if (verbose == 0 && (acked % (64*UPDATE_PAGESIZE) == 0 || acked == size)) {
+      printf("\r%u%%", (unsigned int)((unsigned long long)acked*100/size));
+      fflush(stdout);
+    }
+  }
+  tend = now();
+  printf("\rprogrammed %u bytes in %.1f s: %.0f bytes/s, %.0f%% of the line rate, %lu pages sent again\n",
+    size, tend-tdata, size/(tend-tdata), size/(tend-tdata)*100.0/LINE_BYTES_PER_SECOND, resent);
+
+  // verify and reconfiguration
+  payload[0] = reconfigure ? UPDATE_FLAG_RECONFIGURE : 0;
+  if (sendframe(UPDATE_TYPE_END, payload, UPDATE_ENDSIZE) < 0) return 1;
+  // reading back takes about 1us per byte in the firmware, plus a margin
+  while ((rval = getack(ACK_TIMEOUT+size/500, &type, &status, &value)) > 0 && type != UPDATE_TYPE_END);
+  if (rval <= 0) {
+    if (rval == 0) fprintf(stderr, "%s: no answer on the verify\n", program);
+    return 1;
+  }
+  if (status != UPDATE_STATUS_OK) {
+    fprintf(stderr, "%s: verify: %s (CRC-32 read back 0x%08x)\n", program, statusname(status), value);
+    return 1;
+  }
+  printf("verified, total time %.1f s\n", now()-tstart);
+  if (reconfigure) {
+    // no answer: the FPGA is loading the new image
+    rval = getack(1000, &type, &status, &value);
+    if ((rval > 0) && (type == UPDATE_TYPE_END) && (status != UPDATE_STATUS_OK)) {
+      fprintf(stderr, "%s: %s\n", program, statusname(status));
+      return 1;
+    }
+    printf("reconfiguration started\n");
+  }
+  if (verbose) fprintf(stderr, "%s: %lu CRC errors on received frames\n", program, crcerrors);
+
+  free(image);
+  close(fd);
+  return 0;
+}
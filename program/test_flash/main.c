@@ -1,6 +1,11 @@
 // This program test some functions of the KVI modules for the white rabbit project
 
 #include "access_flash.h"
+#include "update.h"
+#include "../common/timer.h"
+#include "../common/sdb.h"
+#include "../common/irq.h"
+#include "../common/format.h"
 
 // address for LED register
 volatile unsigned int* leds = (unsigned int*)0x100400;
@@ -39,6 +44,40 @@ volatile unsigned int* readtime_errors = (unsigned int*)0x110708; // number of e
 volatile unsigned int* readtime_corrections = (unsigned int*)0x11070c; // number of corrections
 volatile unsigned int* readtime_control = (unsigned int*)0x110710; // control bit 0..3 = disable,error,correction,clear
 
+// Set the addresses of the modules to the base addresses found in the SDB ROM,
+// the addresses above are the defaults for devices that are not found
+static void init_addresses(void) {
+	unsigned int base;
+	leds = (unsigned int*)sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_GPIO,0x100400);
+	base = sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_SINGLEPULSE,0x110000);
+	singlepulse_delay = (unsigned int*)(base+0x0);
+	singlepulse_duration = (unsigned int*)(base+0x4);
+	singlepulse_control = (unsigned int*)(base+0x8);
+	singlepulse_status = (unsigned int*)(base+0xc);
+	base = sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_PATTERN,0x110400);
+	pattern_data = (unsigned int*)(base+0x0);
+	pattern_period = (unsigned int*)(base+0x4);
+	pattern_control = (unsigned int*)(base+0x8);
+	pattern_status = (unsigned int*)(base+0xc);
+	base = sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_BUTIS,0x110500);
+	BuTiSclock_lw = (unsigned int*)(base+0x0);
+	BuTiSclock_hw = (unsigned int*)(base+0x4);
+	BuTiSclock_control = (unsigned int*)(base+0x8);
+	BuTiSclock_status = (unsigned int*)(base+0xc);
+	base = sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_RS232,0x110600);
+	rs232_datasend = (unsigned int*)(base+0x00);
+	rs232_dataread = (unsigned int*)(base+0x04);
+	rs232_readdone = (unsigned int*)(base+0x08);
+	rs232_status = (unsigned int*)(base+0x0c);
+	rs232_control = (unsigned int*)(base+0x10);
+	base = sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_READTIMESTAMP,0x110700);
+	readtime_highword = (unsigned int*)(base+0x00);
+	readtime_lowword = (unsigned int*)(base+0x04);
+	readtime_errors = (unsigned int*)(base+0x08);
+	readtime_corrections = (unsigned int*)(base+0x0c);
+	readtime_control = (unsigned int*)(base+0x10);
+}
+
 /*
 void _read(void) {}
 void isatty(void) {}
@@ -49,42 +88,20 @@ void _fstat(void) {}
 void _lseek(void) {}
 */
 
-#define INT_DIGITS 19		/* enough for 64 bit integer */
-
-// integer to ascii conversion
-char *itoa(int i)
-{
-  /* Room for INT_DIGITS digits, - and '\0' */
-  static char buf[INT_DIGITS + 2];
-  char *p = buf + INT_DIGITS + 1;	/* points to terminating '\0' */
-  if (i >= 0) {
-    do {
-      *--p = '0' + (i % 10);
-      i /= 10;
-    } while (i != 0);
-    return p;
-  }
-  else {			/* i < 0 */
-    do {
-      *--p = '0' - (i % 10);
-      i /= 10;
-    } while (i != 0);
-    *--p = '-';
-  }
-  return p;
-}
 
+// background read of the application flash, done in flash_read_done
+unsigned char flash_readbuffer[256];
+volatile int flash_readresult = 1; // FLASH_BUSY while running
 
-void _irq_entry(void) {
-  /* Currently only triggered by DMA completion */
+void flash_read_done(int result) {
+	flash_readresult = result;
 }
 
 // send character using the simple rs232 module
 int writechar_rs232module(char c) {// send character, return 0 on success
-	int timeout=0;
+	unsigned int timeout=timer_timeout(2000); // 2ms, more than one character at 9k6
 	while ((*rs232_status & 0x1)==0) { // wait till previous character has been sent
-		asm("# noop"); /* no-op the compiler can't optimize away */
-		if (timeout++>=20000) return -1;
+		if (timer_expired(timeout)) return -1;
 	}
 	*rs232_datasend=c;
 	return 0;
@@ -92,11 +109,10 @@ int writechar_rs232module(char c) {// send character, return 0 on success
 
 // send character using the pattern generator as rs232 transmitter
 int writechar(char c) {// send character, return 0 on success
-	int timeout=0;
+	unsigned int timeout=timer_timeout(2000); // 2ms, more than one character at 9k6
 	int i;
 	while ((*pattern_status & 0x1)==1) { // wait till previous character has been sent
-		asm("# noop"); /* no-op the compiler can't optimize away */
-		if (timeout++>=20000) return -1;
+		if (timer_expired(timeout)) return -1;
 	}
 	*pattern_control = 2;
 	*pattern_data = 1; // start bit
@@ -119,50 +135,36 @@ int writestring(char *s) {// send characters, return 0 on success
 	return 0;
 }
 
-// send received timestamp data over the rs232 line
-char *int2hex(unsigned int w, int l) {
-	static char buf[9];
-	int i=0;
-	char c;
-	char *p = buf;
-	for (i=0; i<l; i++) {
-		c=(w >> ((l-i-1)*4)) & 0xf;
-		if (c<10) buf[i]=c+'0'; else buf[i]=c-10+'A';
-	}
-	buf[l]=0;
-	return p;
+// send a signed decimal value over the rs232 line
+int writeint(int i) {// return 0 on success
+	char buf[FORMAT_INTSIZE];
+	format_int(buf,i);
+	return writestring(buf);
+}
+
+// send a hexadecimal value with l digits over the rs232 line
+int writehex(unsigned int w, int l) {// return 0 on success
+	char buf[FORMAT_HEXSIZE];
+	format_hex(buf,w,l);
+	return writestring(buf);
 }
 
 
 // send received timestamp data over the rs232 line
 void printhex(unsigned int hw, unsigned int lw, unsigned int cw) {
-	int i=0;
-	char c;
-	unsigned int n = 0;
+	char buf[FORMAT_TIMESTAMPSIZE+3];
 	if (cw & 0x02) { // error detected in serially sent timestamp
-		c='X';
+		buf[0]='X';
 	} else if (cw & 0x04) { // error succesfully corrected in serially sent timestamp
-		c='`';
+		buf[0]='`';
 	} else {
-		c=' ';
-	}
-	if (writechar(c)) return;
-	
-	for (i=0; i<18; i++) {
-		if (i<8) {
-			n=(hw >> ((7-i)*4)) & 0xf;
-			if (n<10) c=n+'0';
-			else c=n-10+'A';
-		} 
-		else if (i<16) {
-			n=(lw >> ((7-i)*4)) & 0xf;
-			if (n<10) c=n+'0';
-			else c=n-10+'A';
-		} 
-		else if (i==16) c=13; 
-		else c=10;
-		if (writechar(c)) return;
+		buf[0]=' ';
 	}
+	format_timestamp(&buf[1],hw,lw);
+	buf[FORMAT_TIMESTAMPSIZE]=13;
+	buf[FORMAT_TIMESTAMPSIZE+1]=10;
+	buf[FORMAT_TIMESTAMPSIZE+2]=0;
+	writestring(buf);
 }
 
 
@@ -180,10 +182,7 @@ void load_pattern(unsigned int *pattern, int nrofwords, int period) {
 
 void sleep1s(void)
 {
-	int j;
-	for (j = 0; j < 125000000/4; ++j) {
-		asm("# noop"); /* no-op the compiler can't optimize away */
-	}
+	timer_sleep(TIMER_TICS_PER_SECOND);
 }
 
 unsigned char invbyte(unsigned char bt)
@@ -198,12 +197,19 @@ void main(void) {
 	int i, j;
 	int phase=0;
 	int nrofwords=10;
-	unsigned int param,adr;
+	unsigned int param,adr,timeout;
 	int rval;
 	unsigned char bf[256];
 	unsigned char bt;
 	unsigned int pattern[10] = {0xff,0,0xff,0,0x55,0xaa,0,0xff,0xff,0};
 	
+	sdb_init(); // find the base addresses of the modules
+	init_addresses();
+	timer_init();
+	flash_init();
+	vic_init();
+	flash_async_init(1); // flash jobs advanced by the flash interrupt
+	
 	// initialize single pulse generator
 	*singlepulse_control = 1; // enable
 	*singlepulse_delay = 100; // delay 100 clock-cycles
@@ -212,8 +218,7 @@ void main(void) {
 	*rs232_control = 1;	// set baudrate to 115k2
 	*readtime_control = 8; // clear timpestamp receiver error counters
 	*BuTiSclock_control = 0x2; // start re-synchronizing on PPS
-	for (j = 0; j < 1250000/4/5; ++j)  // 0.002s
-		asm("# noop"); /* no-op the compiler can't optimize away */
+	timer_sleep(2000); // 0.002s
 	*BuTiSclock_control = 0x4; // reset phase PLL
 	*BuTiSclock_lw = 0x00000000; // timestamp low-word
 	*BuTiSclock_hw = 0x00000000; // timestamp high-word
@@ -227,11 +232,11 @@ void main(void) {
 	load_pattern(pattern,nrofwords,1085); // load pattern
 
 	writestring("-------------------- start ----------------------\r\n");
-	writestring("status: "); rval=read_status(); writestring(int2hex(rval,2)); writestring("\r\n"); 
+	writestring("status: "); rval=read_status(); writehex(rval,2); writestring("\r\n"); 
 
 	rval=factory_mode();
 	if (rval<0) { 
-		writestring("factory_mode returns "); writestring(itoa(rval)); writestring("\r\n"); 
+		writestring("factory_mode returns "); writeint(rval); writestring("\r\n"); 
 	} else if (rval==0) {
 		writestring("application mode\r\n"); 
 	} else {
@@ -239,67 +244,67 @@ void main(void) {
 	}
 	writestring("reset !!!!!!!!\r\n");
 	reset_flashupdate_module()	;
-	writestring("status: "); rval=read_status(); writestring(int2hex(rval,2)); writestring("\r\n"); 
+	writestring("status: "); rval=read_status(); writehex(rval,2); writestring("\r\n"); 
 
 	
 	adr=0x00000000;
 //	rval=write_flash_parameter(4,adr>>16);
-//	if (rval) { writestring("write_flash_parameter returns "); writestring(itoa(rval)); writestring("\r\n"); }
+//	if (rval) { writestring("write_flash_parameter returns "); writeint(rval); writestring("\r\n"); }
 //	rval=read_flash_parameter(4,&param);
-//	if (rval) { writestring("read_flash_parameter returns "); writestring(itoa(rval)); writestring("\r\n"); }
-//	writestring("param[4]="); writestring(int2hex(param,6)); writestring("\r\n");
+//	if (rval) { writestring("read_flash_parameter returns "); writeint(rval); writestring("\r\n"); }
+//	writestring("param[4]="); writehex(param,6); writestring("\r\n");
 
 	
 	rval=read_flash_parameter(0,&param);
-	if (rval) { writestring("read_flash_parameter returns "); writestring(itoa(rval)); writestring("\r\n"); }
-	writestring("param[0]="); writestring(int2hex(param,6)); writestring("\r\n");
+	if (rval) { writestring("read_flash_parameter returns "); writeint(rval); writestring("\r\n"); }
+	writestring("param[0]="); writehex(param,6); writestring("\r\n");
 
 	rval=read_flash_parameter(2,&param);
-	if (rval) { writestring("read_flash_parameter returns "); writestring(itoa(rval)); writestring("\r\n"); }
-	writestring("param[2]="); writestring(int2hex(param,6)); writestring("\r\n");
+	if (rval) { writestring("read_flash_parameter returns "); writeint(rval); writestring("\r\n"); }
+	writestring("param[2]="); writehex(param,6); writestring("\r\n");
 
 	rval=read_flash_parameter(3,&param);
-	if (rval) { writestring("read_flash_parameter returns "); writestring(itoa(rval)); writestring("\r\n"); }
-	writestring("param[3]="); writestring(int2hex(param,6)); writestring("\r\n");
+	if (rval) { writestring("read_flash_parameter returns "); writeint(rval); writestring("\r\n"); }
+	writestring("param[3]="); writehex(param,6); writestring("\r\n");
 
 	rval=read_flash_parameter(4,&param);
-	if (rval) { writestring("read_flash_parameter returns "); writestring(itoa(rval)); writestring("\r\n"); }
-	writestring("param[4]="); writestring(int2hex(param,6)); writestring("\r\n");
+	if (rval) { writestring("read_flash_parameter returns "); writeint(rval); writestring("\r\n"); }
+	writestring("param[4]="); writehex(param,6); writestring("\r\n");
 	
 	rval=read_flash_parameter(5,&param);
-	if (rval) { writestring("read_flash_parameter returns "); writestring(itoa(rval)); writestring("\r\n"); }
-	writestring("param[5]="); writestring(int2hex(param,6)); writestring("\r\n");
+	if (rval) { writestring("read_flash_parameter returns "); writeint(rval); writestring("\r\n"); }
+	writestring("param[5]="); writehex(param,6); writestring("\r\n");
 
 	rval=read_flash_id(&bt);
-	if (rval) { writestring("read_flash_id returns "); writestring(itoa(rval)); writestring("\r\n"); }
-	writestring("flash ID="); writestring(int2hex(bt,2)); writestring("\r\n");
+	if (rval) { writestring("read_flash_id returns "); writeint(rval); writestring("\r\n"); }
+	writestring("flash ID="); writehex(bt,2); writestring("\r\n");
 
 	rval=read_flash_status(&bt);
-	if (rval) { writestring("read_flash_status returns "); writestring(itoa(rval)); writestring("\r\n"); }
-	writestring("flash status="); writestring(int2hex(bt,2)); writestring("\r\n");
+	if (rval) { writestring("read_flash_status returns "); writeint(rval); writestring("\r\n"); }
+	writestring("flash status="); writehex(bt,2); writestring("\r\n");
 
-	writestring("status: "); rval=read_status(); writestring(int2hex(rval,2)); writestring("\r\n"); 
+	writestring("status: "); rval=read_status(); writehex(rval,2); writestring("\r\n"); 
 
 /*
 	writestring("start erase_factory_flash\r\n");
 	rval=erase_factory_flash();
-	if (rval) { writestring("erase_factory_flash returns "); writestring(itoa(rval)); writestring("\r\n"); }
+	if (rval) { writestring("erase_factory_flash returns "); writeint(rval); writestring("\r\n"); }
 	writestring("\r\nerase_factory_flash done\r\n");
 	
 	writestring("start erase_application_flash\r\n");
 	rval=erase_application_flash();
-	if (rval) { writestring("erase_application_flash returns "); writestring(itoa(rval)); writestring("\r\n"); }
+	if (rval) { writestring("erase_application_flash returns "); writeint(rval); writestring("\r\n"); }
 	writestring("\r\nerase_application_flash done\r\n");
 
 	adr=0x00800000;
 
 	rval=erase_flash_sector(adr);
-	if (rval) { writestring("erase_flash_sector returns "); writestring(itoa(rval)); writestring("\r\n"); }
+	if (rval) { writestring("erase_flash_sector returns "); writeint(rval); writestring("\r\n"); }
 	writestring("\r\nerase_flash_sector done\r\n");
 	for (i=0; i<256; i++) bf[i]=i;
 	adr=0x00800000;
 	rval=write_flash(adr,bf,8);
-	if (rval) { writestring("write_flash returns "); writestring(itoa(rval)); writestring("\r\n"); }
+	if (rval) { writestring("write_flash returns "); writeint(rval); writestring("\r\n"); }
 
 */
 /*
@@ -308,8 +313,8 @@ void main(void) {
 writestring(".");
 		adr=i*SECTORSIZE;
 		rval=erase_flash(adr);
-		if (rval) { writestring("\r\nerase_flash returns "); writestring(itoa(rval)); writestring("\r\n"); }
-		if (*flash_parameters_read & 0x40000000) { writestring("\r\nerase_flash error : "); writestring(int2hex(*flash_parameters_read,8));	 writestring("\r\n"); }
+		if (rval) { writestring("\r\nerase_flash returns "); writeint(rval); writestring("\r\n"); }
+		if (*flash_parameters_read & 0x40000000) { writestring("\r\nerase_flash error : "); writehex(*flash_parameters_read,8);	 writestring("\r\n"); }
 	}
 writestring("\r\n");
 */
@@ -317,24 +322,24 @@ writestring("\r\n");
 /*
 adr=0x00800000;
 rval=erase_flash(adr);
-if (rval) { writestring("\r\nerase_flash returns "); writestring(itoa(rval)); writestring("\r\n"); }
+if (rval) { writestring("\r\nerase_flash returns "); writeint(rval); writestring("\r\n"); }
 writestring("\r\nflash_parameters_read=");		
-writestring(int2hex(*flash_parameters_read,8));	
+writehex(*flash_parameters_read,8);	
 */
 /*
 adr=0x00800000;
 rval=erase_flash(adr);
-if (rval) { writestring("\r\nerase_flash returns "); writestring(itoa(rval)); writestring("\r\n"); }
+if (rval) { writestring("\r\nerase_flash returns "); writeint(rval); writestring("\r\n"); }
 writestring("\r\nflash_parameters_read=");		
-writestring(int2hex(*flash_parameters_read,8));		
+writehex(*flash_parameters_read,8);		
 
 	adr=0x00000000;
 	for (i=0; i<20; i++) {
-		writestring("\r\nadr["); writestring(int2hex(adr,6)); writestring("]: ");
+		writestring("\r\nadr["); writehex(adr,6); writestring("]: ");
 		for (j=0; j<16; j++) {
 			rval=read_flash(adr,&bt);
-			if (rval) { writestring("\r\nread_flash returns "); writestring(itoa(rval)); writestring("\r\n"); }
-			writestring(" "); writestring(int2hex(bt,2)); 
+			if (rval) { writestring("\r\nread_flash returns "); writeint(rval); writestring("\r\n"); }
+			writestring(" "); writehex(bt,2); 
 			adr++;
 		}
 	}
@@ -342,22 +347,22 @@ writestring(int2hex(*flash_parameters_read,8));
 	
 	adr=0x00000000;
 	for (i=0; i<20; i++) {
-		writestring("\r\nadr["); writestring(int2hex(adr,6)); writestring("]: ");
+		writestring("\r\nadr["); writehex(adr,6); writestring("]: ");
 		for (j=0; j<16; j++) {
 			rval=read_flash(adr,&bt);
-			if (rval) { writestring("\r\nread_flash returns "); writestring(itoa(rval)); writestring("\r\n"); }
-			writestring(" "); writestring(int2hex(bt,2)); 
+			if (rval) { writestring("\r\nread_flash returns "); writeint(rval); writestring("\r\n"); }
+			writestring(" "); writehex(bt,2); 
 			adr++;
 		}
 	}
 
 	adr=SECTORSIZE; // -40*16;
 	for (i=0; i<20; i++) {
-		writestring("\r\nadr["); writestring(int2hex(adr,6)); writestring("]: ");
+		writestring("\r\nadr["); writehex(adr,6); writestring("]: ");
 		for (j=0; j<16; j++) {
 			rval=read_flash(adr,&bt);
-			if (rval) { writestring("\r\nread_flash returns "); writestring(itoa(rval)); writestring("\r\n"); }
-			writestring(" "); writestring(int2hex(bt,2)); 
+			if (rval) { writestring("\r\nread_flash returns "); writeint(rval); writestring("\r\n"); }
+			writestring(" "); writehex(bt,2); 
 			adr++;
 		}
 	}
@@ -367,26 +372,26 @@ writestring(int2hex(*flash_parameters_read,8));
 	adr=0x00800000;
 	for (i=0; i<10; i++) {
 		rval=read_flash(adr,bf,256);
-		if (rval) { writestring("\r\nread_flash returns "); writestring(itoa(rval)); writestring("\r\n"); }
+		if (rval) { writestring("\r\nread_flash returns "); writeint(rval); writestring("\r\n"); }
 		for (j=0; j<256; j++) {
-			if ((adr & 0xf) == 0) { writestring("\r\nadr["); writestring(int2hex(adr,6)); writestring("]: "); }
-			writestring(" "); writestring(int2hex(bf[j],2)); // writestring(int2hex(invbyte(bt),2)); 
+			if ((adr & 0xf) == 0) { writestring("\r\nadr["); writehex(adr,6); writestring("]: "); }
+			writestring(" "); writehex(bf[j],2); // writehex(invbyte(bt),2); 
 			adr++;
 		}
 	}
 	writestring("\r\n");
 
-	writestring("status: "); rval=read_status(); writestring(int2hex(rval,2)); writestring("\r\n"); 
+	writestring("status: "); rval=read_status(); writehex(rval,2); writestring("\r\n"); 
 //	writestring("\r\nstart_reconfiguration\r\n"); start_reconfiguration();
-	writestring("status: "); rval=read_status(); writestring(int2hex(rval,2)); writestring("\r\n"); 
+	writestring("status: "); rval=read_status(); writehex(rval,2); writestring("\r\n"); 
 	
 	rval=read_flash_parameter(4,&param);
-	if (rval) { writestring("read_flash_parameter returns "); writestring(itoa(rval)); writestring("\r\n"); }
-	writestring("param[4]="); writestring(int2hex(param,6)); writestring("\r\n");
+	if (rval) { writestring("read_flash_parameter returns "); writeint(rval); writestring("\r\n"); }
+	writestring("param[4]="); writehex(param,6); writestring("\r\n");
 
 	rval=factory_mode();
 	if (rval<0) { 
-		writestring("factory_mode returns "); writestring(itoa(rval)); writestring("\r\n"); 
+		writestring("factory_mode returns "); writeint(rval); writestring("\r\n"); 
 	} else if (rval==0) {
 		writestring("application mode\r\n"); 
 	} else {
@@ -394,12 +399,33 @@ writestring(int2hex(*flash_parameters_read,8));
 	}
 
 	
+	update_init(); // firmware update over rs232, see host/send-update.c
+
+	// read the start of the application flash in the background, the LEDs keep rotating
+	if (flash_start_read(APPICATIONFLASHADDRESS,flash_readbuffer,256,flash_read_done)) {
+		writestring("flash_start_read failed\r\n");
+		flash_readresult = -1;
+	}
+//	programming in the background, same way:
+//	flash_start_program(APPICATIONFLASHADDRESS,image,imagesize,flash_program_done);
+
 	writestring("\r\nStart while loop\r\n");
 	while (1) {
+		if (update_poll()) continue; // update session running: no output on the rs232 line, no delays
+		if (flash_readresult!=FLASH_BUSY) {
+			if (flash_readresult) {
+				writestring("background read returns "); writeint(flash_readresult); writestring("\r\n");
+			} else {
+				writestring("application flash :");
+				for (j=0; j<16; j++) { writestring(" "); writehex(flash_readbuffer[j],2); }
+				writestring("\r\n");
+			}
+			flash_readresult = FLASH_BUSY; // report once
+		}
 
 //		rval=read_flash_id(&bt);
-//		if (rval) { writestring("read_flash_id returns "); writestring(itoa(rval)); writestring("\r\n"); }
-//		writestring("flash ID="); writestring(int2hex(bt,2)); writestring("\r\n");
+//		if (rval) { writestring("read_flash_id returns "); writeint(rval); writestring("\r\n"); }
+//		writestring("flash ID="); writehex(bt,2); writestring("\r\n");
 		for (i = 0; i < 8; ++i) {
 			
 			/* Rotate the LEDs */
@@ -407,13 +433,8 @@ writestring(int2hex(*flash_parameters_read,8));
 			*singlepulse_delay = 100+i*10;
 			*singlepulse_duration = 200+i*20;
 
-			/* Each loop iteration takes 4 cycles.
-			* It runs at 125MHz.
-			* Sleep 0.2 second.
-			*/
-			for (j = 0; j < 125000000/4/5; ++j) {
-				asm("# noop"); /* no-op the compiler can't optimize away */
-			}
+			timeout = timer_timeout(200000); // 0.2s, handling update frames meanwhile
+			while (!timer_expired(timeout) && !update_poll());
 		}
 	}
 }
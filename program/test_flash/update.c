@@ -0,0 +1,391 @@
+// Firmware update agent: receives an FPGA image over the rs232 line and programs it in the flash, see update.h
+// The receive interrupt moves the received bytes to a ring buffer, update_poll (main loop) takes the frames
+// out of the ring buffer. The pages go into a ring of UPDATE_WINDOW page buffers and are programmed with the
+// non-blocking flash access (flash_start_) while the next pages are received. The sectors are erased in
+// separate jobs, one sector ahead of the pages programmed, so the line keeps running during an erase.
+// sdb_init, vic_init, flash_init and flash_async_init must be called before update_init.
+
+#include "../common/timer.h"
+#include "../common/sdb.h"
+#include "../common/irq.h"
+#include "access_flash.h"
+#include "update.h"
+
+// addresses for simple rs232 module, defaults if the SDB ROM does not list it
+#define RS232_ADDRESS 0x110600
+static volatile unsigned int* rs232_datasend = (unsigned int*)0x110600; // bit 7..0 = data to send
+static volatile unsigned int* rs232_dataread = (unsigned int*)0x110604; // bit 7..0 = received data
+static volatile unsigned int* rs232_readdone = (unsigned int*)0x110608; // write enables next receive data
+static volatile unsigned int* rs232_status = (unsigned int*)0x11060c; // status bit 0,1,2 = sending allowed, received data available, transmitter empty
+static volatile unsigned int* rs232_control = (unsigned int*)0x110610; // control bit 2..0 = baudrate, bit 3,4 = transmit, receive interrupt enable
+static volatile unsigned int* rs232_threshold = (unsigned int*)0x110618; // bit 15..0 = transmit interrupt threshold, bit 31..16 = receive interrupt threshold
+
+#define UPDATE_RXBUFFERSIZE 1024 // size of the receive ring buffer, must be a power of 2, more than one frame
+#define UPDATE_SENDTIMEOUT 100000 // usec to wait for room in the transmit fifo
+#define UPDATE_EMPTYTIMEOUT 50000 // usec to wait till the last acknowledge has been sent before the reconfiguration
+#define UPDATE_NOJOB -1000 // flashresult_s: no flash job running
+
+enum { RX_SYNC, RX_LENGTH1, RX_LENGTH2, RX_TYPE, RX_PAYLOAD, RX_CRC };
+enum { JOB_ERASE, JOB_WRITE, JOB_READ };
+
+static volatile unsigned char rxbuffer_s[UPDATE_RXBUFFERSIZE];
+static volatile unsigned int rxhead_s=0; // written by the interrupt handler
+static volatile unsigned int rxtail_s=0; // written by update_poll
+static volatile unsigned int rxlost_s=0; // bytes dropped because the ring buffer was full
+
+// frame being received
+static struct {
+	int state;
+	int length;
+	int type;
+	int count;
+	unsigned char payload[UPDATE_MAXPAYLOAD];
+	unsigned char crc[UPDATE_CRCSIZE];
+} frame_s;
+
+// ring of page buffers, filled and programmed in turn
+static struct {
+	unsigned char data[UPDATE_PAGESIZE];
+	unsigned int offset;
+	int length; // 0: buffer free
+} page_s[UPDATE_WINDOW];
+static int fillpage_s=0; // next buffer to fill
+static int progpage_s=0; // next buffer to program
+
+static struct {
+	int active;
+	unsigned int address; // flash address of the image
+	unsigned int size;
+	unsigned int crc; // CRC-32 of the image
+	unsigned int received; // next offset expected
+	unsigned int written; // bytes programmed
+	unsigned int erased; // bytes erased from the start of the image, whole sectors
+	int end; // END received, flags in bits 7..0
+	int verifying;
+	unsigned int verified; // bytes read back
+	unsigned int verifycrc;
+	unsigned int timeout;
+} session_s;
+
+static volatile int flashresult_s=UPDATE_NOJOB; // FLASH_BUSY while a job runs, result when it has finished
+static int flashjob_s; // JOB_ kind of the last job started
+
+// interrupt handler: received data available, move it to the ring buffer
+static void update_rxirq(void) {
+	unsigned int next;
+	while (*rs232_status & 0x2) {
+		next = (rxhead_s+1) & (UPDATE_RXBUFFERSIZE-1);
+		if (next!=rxtail_s) {
+			rxbuffer_s[rxhead_s] = *rs232_dataread;
+			rxhead_s = next;
+		} else rxlost_s++; // the frame is damaged, the host sends again
+		*rs232_readdone = 1;
+	}
+}
+
+// flash job finished, called from the interrupt handler
+static void update_flashdone(int result) {
+	flashresult_s = result;
+}
+
+static void update_putc(unsigned char c) {
+	unsigned int timeout=timer_timeout(UPDATE_SENDTIMEOUT);
+	while (((*rs232_status & 0x1)==0) && !timer_expired(timeout)) // wait for room in the transmit fifo
+		asm("# noop"); /* no-op the compiler can't optimize away */
+	*rs232_datasend = c;
+}
+
+// Send an acknowledge frame
+//   Parameters :
+//      int type : frame type acknowledged
+//      int status : UPDATE_STATUS_...
+//      unsigned int value : depends on the type, see update.h
+static void update_ack(int type, int status, unsigned int value) {
+	unsigned char frame[UPDATE_HEADERSIZE+UPDATE_ACKSIZE];
+	unsigned int crc;
+	int i;
+	frame[0] = UPDATE_SYNC;
+	frame[1] = 0;
+	frame[2] = UPDATE_ACKSIZE;
+	frame[3] = UPDATE_TYPE_ACK;
+	frame[4] = type;
+	frame[5] = status;
+	update_put32(&frame[6],value);
+	crc = ~crc32_update(0xffffffff,&frame[1],UPDATE_HEADERSIZE-1+UPDATE_ACKSIZE);
+	for (i=0; i<UPDATE_HEADERSIZE+UPDATE_ACKSIZE; i++) update_putc(frame[i]);
+	for (i=0; i<UPDATE_CRCSIZE; i++) update_putc((crc >> (i*8)) & 0xff);
+}
+
+static void update_endsession(void) {
+	session_s.active = 0;
+	session_s.end = 0;
+	session_s.verifying = 0;
+}
+
+static void update_start(const unsigned char *payload) {
+	unsigned int address=update_get32(&payload[0]);
+	unsigned int size=update_get32(&payload[4]);
+	int i;
+	if (flashresult_s==FLASH_BUSY) return; // job of an aborted session still running, the host sends again
+	if ((address & (SECTORSIZE-1)) || (address<APPICATIONFLASHADDRESS) || (address>=FLASHSIZE) ||
+		(size==0) || (size>FLASHSIZE-address)) {
+		update_ack(UPDATE_TYPE_START,UPDATE_STATUS_RANGE,size);
+		return;
+	}
+	session_s.active = 1;
+	session_s.address = address;
+	session_s.size = size;
+	session_s.crc = update_get32(&payload[8]);
+	session_s.received = 0;
+	session_s.written = 0;
+	session_s.erased = 0;
+	session_s.end = 0;
+	session_s.verifying = 0;
+	for (i=0; i<UPDATE_WINDOW; i++) page_s[i].length = 0;
+	fillpage_s = 0;
+	progpage_s = 0;
+	update_ack(UPDATE_TYPE_START,UPDATE_STATUS_OK,size);
+}
+
+static void update_data(const unsigned char *payload, int length) {
+	unsigned int offset=update_get32(payload);
+	int n=length-4;
+	int i;
+	if (!session_s.active) {
+		update_ack(UPDATE_TYPE_DATA,UPDATE_STATUS_SESSION,offset);
+		return;
+	}
+	if (offset<session_s.received) { // sent again, the acknowledge has been lost
+		if (offset<session_s.written) update_ack(UPDATE_TYPE_DATA,UPDATE_STATUS_OK,offset);
+		return; // otherwise acknowledged when programmed
+	}
+	if (offset!=session_s.received) {
+		update_ack(UPDATE_TYPE_DATA,UPDATE_STATUS_SEQUENCE,session_s.received);
+		return;
+	}
+	if ((n<=0) || ((unsigned int)n>session_s.size-offset) || ((n<UPDATE_PAGESIZE) && (offset+n!=session_s.size))) {
+		update_ack(UPDATE_TYPE_DATA,UPDATE_STATUS_RANGE,offset);
+		return;
+	}
+	if (page_s[fillpage_s].length) return; // all buffers in use: more than UPDATE_WINDOW frames, the host sends again
+	for (i=0; i<n; i++) page_s[fillpage_s].data[i] = payload[4+i];
+	page_s[fillpage_s].offset = offset;
+	page_s[fillpage_s].length = n;
+	if (++fillpage_s==UPDATE_WINDOW) fillpage_s = 0;
+	session_s.received += n;
+}
+
+static void update_end(const unsigned char *payload) {
+	if (!session_s.active) {
+		update_ack(UPDATE_TYPE_END,UPDATE_STATUS_SESSION,0);
+		return;
+	}
+	if (session_s.received!=session_s.size) {
+		update_ack(UPDATE_TYPE_END,UPDATE_STATUS_SEQUENCE,session_s.received);
+		return;
+	}
+	session_s.end = 0x100 | payload[0]; // verify when all pages are programmed
+}
+
+// handle a received frame with a correct CRC
+static void update_frame(void) {
+	session_s.timeout = timer_timeout(UPDATE_TIMEOUT);
+	switch (frame_s.type) {
+	case UPDATE_TYPE_START:
+		if (frame_s.length==UPDATE_STARTSIZE) update_start(frame_s.payload);
+		break;
+	case UPDATE_TYPE_DATA:
+		if (frame_s.length>4) update_data(frame_s.payload,frame_s.length);
+		break;
+	case UPDATE_TYPE_END:
+		if (frame_s.length==UPDATE_ENDSIZE) update_end(frame_s.payload);
+		break;
+	case UPDATE_TYPE_ABORT:
+		update_endsession();
+		break;
+	default:
+		break;
+	}
+}
+
+// take the received bytes out of the ring buffer and assemble the frames
+static void update_receive(void) {
+	unsigned char c;
+	unsigned char header[UPDATE_HEADERSIZE-1];
+	unsigned int crc;
+	while (rxtail_s!=rxhead_s) {
+		c = rxbuffer_s[rxtail_s];
+		rxtail_s = (rxtail_s+1) & (UPDATE_RXBUFFERSIZE-1);
+		switch (frame_s.state) {
+		case RX_SYNC:
+			if (c==UPDATE_SYNC) frame_s.state = RX_LENGTH1;
+			break;
+		case RX_LENGTH1:
+			frame_s.length = c << 8;
+			frame_s.state = RX_LENGTH2;
+			break;
+		case RX_LENGTH2:
+			frame_s.length |= c;
+			frame_s.state = (frame_s.length<=UPDATE_MAXPAYLOAD) ? RX_TYPE : RX_SYNC;
+			break;
+		case RX_TYPE:
+			frame_s.type = c;
+			frame_s.count = 0;
+			frame_s.state = (frame_s.length>0) ? RX_PAYLOAD : RX_CRC;
+			break;
+		case RX_PAYLOAD:
+			frame_s.payload[frame_s.count++] = c;
+			if (frame_s.count==frame_s.length) {
+				frame_s.count = 0;
+				frame_s.state = RX_CRC;
+			}
+			break;
+		case RX_CRC:
+			frame_s.crc[frame_s.count++] = c;
+			if (frame_s.count<UPDATE_CRCSIZE) break;
+			frame_s.state = RX_SYNC;
+			header[0] = frame_s.length >> 8;
+			header[1] = frame_s.length;
+			header[2] = frame_s.type;
+			crc = crc32_update(0xffffffff,header,UPDATE_HEADERSIZE-1);
+			crc = ~crc32_update(crc,frame_s.payload,frame_s.length);
+			if ((frame_s.crc[0]==(crc & 0xff)) && (frame_s.crc[1]==((crc >> 8) & 0xff)) &&
+				(frame_s.crc[2]==((crc >> 16) & 0xff)) && (frame_s.crc[3]==(crc >> 24)))
+				update_frame(); // otherwise dropped: no acknowledge, the host sends again
+			break;
+		default:
+			frame_s.state = RX_SYNC;
+			break;
+		}
+	}
+}
+
+// start the next flash job: program a received page in an erased sector, erase the next sector,
+// or read back the next part for the verify
+// A sector is erased as soon as the programmed pages have reached the sector before it: the erase runs
+// while the pages of that sector are received, the page buffers take the pages that arrive meanwhile.
+static void update_nextjob(void) {
+	unsigned int n;
+	int rval;
+	if (session_s.verifying) {
+		n = session_s.size-session_s.verified;
+		if (n>UPDATE_PAGESIZE) n=UPDATE_PAGESIZE;
+		flashjob_s = JOB_READ;
+		flashresult_s = FLASH_BUSY;
+		rval = flash_start_read(session_s.address+session_s.verified,page_s[0].data,n,update_flashdone);
+	} else if (page_s[progpage_s].length && (page_s[progpage_s].offset<session_s.erased)) {
+		flashjob_s = JOB_WRITE;
+		flashresult_s = FLASH_BUSY;
+		rval = flash_start_write(session_s.address+page_s[progpage_s].offset,page_s[progpage_s].data,
+			page_s[progpage_s].length,update_flashdone);
+	} else if ((session_s.erased<session_s.size) && (session_s.erased<session_s.written+SECTORSIZE)) {
+		flashjob_s = JOB_ERASE;
+		flashresult_s = FLASH_BUSY;
+		rval = flash_start_erase(session_s.address+session_s.erased,SECTORSIZE,update_flashdone);
+	} else return;
+	if (rval) flashresult_s = rval;
+}
+
+// the last flash job has finished
+static void update_jobdone(int result) {
+	unsigned int n;
+	session_s.timeout = timer_timeout(UPDATE_TIMEOUT);
+	if (session_s.verifying) {
+		if (result<0) {
+			update_ack(UPDATE_TYPE_END,UPDATE_STATUS_FLASH,session_s.verified);
+			update_endsession();
+			return;
+		}
+		n = session_s.size-session_s.verified;
+		if (n>UPDATE_PAGESIZE) n=UPDATE_PAGESIZE;
+		session_s.verifycrc = crc32_update(session_s.verifycrc,page_s[0].data,n);
+		session_s.verified += n;
+		if (session_s.verified<session_s.size) return;
+		n = ~session_s.verifycrc;
+		if (n!=session_s.crc) {
+			update_ack(UPDATE_TYPE_END,UPDATE_STATUS_VERIFY,n);
+			update_endsession();
+			return;
+		}
+		if ((session_s.end & UPDATE_FLAG_RECONFIGURE) && (session_s.address!=APPICATIONFLASHADDRESS)) {
+			update_ack(UPDATE_TYPE_END,UPDATE_STATUS_RECONFIGURE,n); // only the application image can be loaded
+			update_endsession();
+			return;
+		}
+		update_ack(UPDATE_TYPE_END,UPDATE_STATUS_OK,n);
+		if (session_s.end & UPDATE_FLAG_RECONFIGURE) {
+			n = timer_timeout(UPDATE_EMPTYTIMEOUT);
+			while (((*rs232_status & 0x4)==0) && !timer_expired(n)) // wait till the acknowledge has been sent
+				asm("# noop"); /* no-op the compiler can't optimize away */
+			start_reconfiguration(); // does not return on success
+			update_ack(UPDATE_TYPE_END,UPDATE_STATUS_RECONFIGURE,0);
+		}
+		update_endsession();
+		return;
+	}
+	if (flashjob_s==JOB_ERASE) {
+		if (result<0) {
+			update_ack(UPDATE_TYPE_DATA,UPDATE_STATUS_FLASH,session_s.erased);
+			update_endsession();
+			return;
+		}
+		session_s.erased += SECTORSIZE;
+		return;
+	}
+	if (result<0) {
+		update_ack(UPDATE_TYPE_DATA,UPDATE_STATUS_FLASH,page_s[progpage_s].offset);
+		update_endsession();
+		return;
+	}
+	update_ack(UPDATE_TYPE_DATA,UPDATE_STATUS_OK,page_s[progpage_s].offset);
+	session_s.written += page_s[progpage_s].length;
+	page_s[progpage_s].length = 0;
+	if (++progpage_s==UPDATE_WINDOW) progpage_s = 0;
+}
+
+// Initialize the update agent: enable the receive interrupt of the rs232 module
+// The baudrate is not changed, the host program uses 115k2
+void update_init(void) {
+	unsigned int base=sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_RS232,RS232_ADDRESS);
+	vic_disableirq(VIC_IRQ_RS232RX);
+	rs232_datasend = (unsigned int*)(base+0x00);
+	rs232_dataread = (unsigned int*)(base+0x04);
+	rs232_readdone = (unsigned int*)(base+0x08);
+	rs232_status = (unsigned int*)(base+0x0c);
+	rs232_control = (unsigned int*)(base+0x10);
+	rs232_threshold = (unsigned int*)(base+0x18);
+	rxhead_s = 0;
+	rxtail_s = 0;
+	frame_s.state = RX_SYNC;
+	update_endsession();
+	flashresult_s = UPDATE_NOJOB;
+	*rs232_threshold = (1 << 16) | (*rs232_threshold & 0xffff); // receive interrupt for each byte
+	*rs232_control = (*rs232_control & 0xf) | 0x10; // receive interrupt enabled
+	vic_sethandler(VIC_IRQ_RS232RX, update_rxirq);
+	vic_enableirq(VIC_IRQ_RS232RX);
+}
+
+// Handle the received frames and the flash jobs, call from the main loop
+// The main loop should not send on the rs232 line while a session is active
+//   Parameters :
+//      return : 1 while an update session is active, otherwise 0
+int update_poll(void) {
+	int result;
+	update_receive();
+	if (flashresult_s!=UPDATE_NOJOB) {
+		flash_poll(); // timeout check of the flash job
+		result = flashresult_s;
+		if (result==FLASH_BUSY) return 1;
+		flashresult_s = UPDATE_NOJOB;
+		if (session_s.active) update_jobdone(result);
+	}
+	if (!session_s.active) return 0;
+	if (session_s.end && !session_s.verifying && (session_s.written==session_s.size)) {
+		session_s.verifying = 1; // all pages programmed: read back
+		session_s.verified = 0;
+		session_s.verifycrc = 0xffffffff;
+	}
+	update_nextjob();
+	if ((flashresult_s==UPDATE_NOJOB) && timer_expired(session_s.timeout)) update_endsession(); // host gone
+	return session_s.active;
+}
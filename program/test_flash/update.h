@@ -0,0 +1,82 @@
+// Firmware update over the rs232 line
+// The host program (host/send-update.c) sends an FPGA image in frames, the update agent in the
+// firmware (update.c) programs it in the application part of the flash, verifies it and
+// starts the reconfiguration. Used by both sides.
+//
+// Frame layout, both directions:
+//     byte 0 : UPDATE_SYNC
+//     byte 1,2 : length of the payload in bytes, big-endian (0..UPDATE_MAXPAYLOAD)
+//     byte 3 : frame type, see UPDATE_TYPE_...
+//     byte 4..length+3 : payload, multi-byte values are big-endian
+//     last 4 bytes : CRC-32 over length, type and payload, least significant byte first (../common/crc32.h)
+// A receiver synchronizes on UPDATE_SYNC and drops frames with a wrong CRC.
+//
+// Session:
+//     host   START (address, size, CRC-32 of the image)      agent  ACK START
+//     host   DATA (offset, page) ...                          agent  ACK DATA (offset) when the page is in flash
+//     host   END (flags)                                      agent  ACK END (CRC-32 read back) after the verify
+// The host has at most UPDATE_WINDOW data frames not acknowledged, the agent has a buffer for each of them.
+// The agent erases each sector in the background as soon as the pages programmed have reached the sector
+// before it, and programs the buffered pages when the erase has finished: the window covers a sector erase,
+// so the line stays busy during the erase too. The acknowledge of a page comes when it is in flash.
+// A lost or damaged frame is not acknowledged; the host sends again from the oldest page not acknowledged.
+
+#ifndef UPDATE_H
+#define UPDATE_H
+
+#include "../common/crc32.h"
+
+#define UPDATE_SYNC 0x5a
+#define UPDATE_HEADERSIZE 4 // sync, length, type
+#define UPDATE_CRCSIZE 4
+#define UPDATE_OVERHEAD (UPDATE_HEADERSIZE+UPDATE_CRCSIZE)
+#define UPDATE_PAGESIZE 256 // data bytes in one DATA frame, a flash page
+#define UPDATE_MAXPAYLOAD (4+UPDATE_PAGESIZE)
+#define UPDATE_WINDOW 32 // DATA frames sent without acknowledge, page buffers in the agent: 0.7s of the line at 115k2
+#define UPDATE_TIMEOUT 5000000 // usec, the agent ends the session without frames, longer than a sector erase
+
+// frame types, host to agent
+#define UPDATE_TYPE_START 0x10
+	// 4 bytes flash address, start of a sector in the application part, 4 bytes image size, 4 bytes image CRC-32
+#define UPDATE_TYPE_DATA 0x11
+	// 4 bytes offset in the image, multiple of UPDATE_PAGESIZE, UPDATE_PAGESIZE data bytes (less in the last frame)
+#define UPDATE_TYPE_END 0x12
+	// 1 byte flags UPDATE_FLAG_...
+#define UPDATE_TYPE_ABORT 0x13
+	// no payload
+
+// frame types, agent to host
+#define UPDATE_TYPE_ACK 0x20
+	// 1 byte type acknowledged, 1 byte status UPDATE_STATUS_..., 4 bytes value:
+	// START: image size, DATA: offset of the page, END: CRC-32 read back, error: offset expected
+
+#define UPDATE_STARTSIZE 12
+#define UPDATE_ENDSIZE 1
+#define UPDATE_ACKSIZE 6
+
+#define UPDATE_FLAG_RECONFIGURE 0x01 // start the reconfiguration after a successful verify
+
+#define UPDATE_STATUS_OK 0
+#define UPDATE_STATUS_RANGE 1 // START: address or size outside the application part of the flash
+#define UPDATE_STATUS_SEQUENCE 2 // DATA: offset not expected, value is the offset expected
+#define UPDATE_STATUS_FLASH 3 // erase, write or read of the flash failed
+#define UPDATE_STATUS_VERIFY 4 // END: CRC-32 read back differs
+#define UPDATE_STATUS_SESSION 5 // DATA or END without START
+#define UPDATE_STATUS_RECONFIGURE 6 // END: reconfiguration not started
+
+static inline unsigned int update_get32(const unsigned char *p) {
+	return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+static inline void update_put32(unsigned char *p, unsigned int value) {
+	p[0] = value >> 24;
+	p[1] = value >> 16;
+	p[2] = value >> 8;
+	p[3] = value;
+}
+
+// firmware, update.c
+void update_init(void);
+int update_poll(void);
+
+#endif
@@ -0,0 +1,150 @@
+// Console output over the simple rs232 module with a transmit ring buffer
+// The main program puts characters in the ring buffer, the interrupt handler sends them.
+// The rs232 module has a transmit fifo: the interrupt handler fills this fifo in bursts.
+// The rs232 transmit interrupt (fifo level equal or below CONSOLE_TXTHRESHOLD) is enabled in the VIC
+// as long as the ring buffer is not empty.
+// Only the main program writes txhead_s, only the interrupt handler writes txtail_s.
+
+#include "../common/timer.h"
+#include "../common/sdb.h"
+#include "../common/irq.h"
+#include "console.h"
+
+// addresses for simple rs232 module, defaults if the SDB ROM does not list it
+#define RS232_ADDRESS 0x110600
+volatile unsigned int* rs232_datasend = (unsigned int*)0x110600; // bit 7..0 = data to send
+volatile unsigned int* rs232_dataread = (unsigned int*)0x110604; // bit 7..0 = received data
+volatile unsigned int* rs232_readdone = (unsigned int*)0x110608; // write enables next receive data
+volatile unsigned int* rs232_status = (unsigned int*)0x11060c; // status bit 0,1,2 = sending allowed (transmit fifo not full), received data available, transmitter empty
+volatile unsigned int* rs232_control = (unsigned int*)0x110610; // control bit 2..0 = baudrate (0to7): clock,115k2,57k6,38k4,19k2,9k6,4k8,2k4, bit 3,4 = transmit, receive interrupt enable
+volatile unsigned int* rs232_level = (unsigned int*)0x110614; // bit 15..0 = bytes in transmit fifo, bit 31..16 = bytes in receive fifo
+volatile unsigned int* rs232_threshold = (unsigned int*)0x110618; // bit 15..0 = transmit interrupt threshold, bit 31..16 = receive interrupt threshold
+volatile unsigned int* rs232_lost = (unsigned int*)0x11061c; // number of received bytes lost
+
+#define CONSOLE_TXTHRESHOLD 16 // transmit interrupt when the transmit fifo has this number of bytes or less
+#define CONSOLE_WAITTIMEOUT 10000 // usec to wait for room in the buffer with CONSOLE_OVERFLOW_WAIT, about 2 characters at 2k4
+
+static volatile char txbuffer_s[CONSOLE_TXBUFFERSIZE];
+static volatile unsigned int txhead_s=0;
+static volatile unsigned int txtail_s=0;
+static int policy_s=CONSOLE_OVERFLOW_DROP;
+static volatile struct console_stats stats_s;
+
+// interrupt handler: transmit fifo of the rs232 module is almost empty, fill it from the ring buffer
+static void console_txirq(void) {
+	while ((txtail_s!=txhead_s) && (*rs232_status & 0x1)) {
+		*rs232_datasend = txbuffer_s[txtail_s];
+		txtail_s = (txtail_s+1) & (CONSOLE_TXBUFFERSIZE-1);
+		stats_s.sent++;
+	}
+	if (txtail_s==txhead_s) vic_disableirq(VIC_IRQ_RS232TX); // nothing more to send
+}
+
+// Set the addresses of the rs232 registers
+//   Parameters :
+//      unsigned int base : base address of the simple rs232 module
+static void rs232_setbase(unsigned int base) {
+	rs232_datasend = (unsigned int*)(base+0x00);
+	rs232_dataread = (unsigned int*)(base+0x04);
+	rs232_readdone = (unsigned int*)(base+0x08);
+	rs232_status = (unsigned int*)(base+0x0c);
+	rs232_control = (unsigned int*)(base+0x10);
+	rs232_level = (unsigned int*)(base+0x14);
+	rs232_threshold = (unsigned int*)(base+0x18);
+	rs232_lost = (unsigned int*)(base+0x1c);
+}
+
+// Initialize the console, sdb_init and vic_init must be called before
+//   Parameters :
+//      int baudrate : baudrate setting of the rs232 module (0to7): clock,115k2,57k6,38k4,19k2,9k6,4k8,2k4
+//      int policy : CONSOLE_OVERFLOW_DROP or CONSOLE_OVERFLOW_WAIT
+void console_init(int baudrate, int policy) {
+	vic_disableirq(VIC_IRQ_RS232TX);
+	rs232_setbase(sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_RS232,RS232_ADDRESS));
+	txhead_s = 0;
+	txtail_s = 0;
+	policy_s = policy;
+	console_clearstats();
+	*rs232_threshold = CONSOLE_TXTHRESHOLD;
+	*rs232_control = (baudrate & 0x7) | 0x8; // transmit interrupt enabled
+	vic_sethandler(VIC_IRQ_RS232TX, console_txirq);
+}
+
+void console_setpolicy(int policy) {
+	policy_s = policy;
+}
+
+// Put one character in the transmit buffer
+//   Parameters :
+//      char c : character to send
+//      return : 0 on success, -1 if the character has been dropped
+int console_putc(char c) {
+	unsigned int next=(txhead_s+1) & (CONSOLE_TXBUFFERSIZE-1);
+	unsigned int level;
+	unsigned int timeout;
+	if ((txhead_s==txtail_s) && (*rs232_status & 0x1)) { // ring buffer empty and room in the transmit fifo: send directly
+		*rs232_datasend = c;
+		stats_s.queued++;
+		stats_s.sent++;
+		return 0;
+	}
+	if (next==txtail_s) { // buffer full
+		stats_s.overflows++;
+		if (policy_s==CONSOLE_OVERFLOW_WAIT) {
+			timeout=timer_timeout(CONSOLE_WAITTIMEOUT);
+			while ((next==txtail_s) && !timer_expired(timeout))
+				asm("# noop"); /* no-op the compiler can't optimize away */
+		}
+		if (next==txtail_s) {
+			stats_s.dropped++;
+			return -1;
+		}
+	}
+	txbuffer_s[txhead_s] = c;
+	txhead_s = next;
+	stats_s.queued++;
+	level = (txhead_s-txtail_s) & (CONSOLE_TXBUFFERSIZE-1);
+	if (level>stats_s.maxlevel) stats_s.maxlevel = level;
+	vic_enableirq(VIC_IRQ_RS232TX);
+	return 0;
+}
+
+// Put a string in the transmit buffer
+//   Parameters :
+//      char *s : string to send
+//      return : 0 on success, -1 if one or more characters have been dropped
+int console_puts(char *s) {
+	int rval=0;
+	while (*s) { if (console_putc(*s++)) rval=-1; }
+	return rval;
+}
+
+// Number of characters in the ring buffer and the transmit fifo that are not sent yet
+int console_pending(void) {
+	return ((txhead_s-txtail_s) & (CONSOLE_TXBUFFERSIZE-1)) + (*rs232_level & 0xffff);
+}
+
+// Number of characters that can be put in the ring buffer without dropping
+int console_free(void) {
+	return CONSOLE_TXBUFFERSIZE-1-((txhead_s-txtail_s) & (CONSOLE_TXBUFFERSIZE-1));
+}
+
+void console_getstats(struct console_stats *stats) {
+	unsigned int ie=irq_disable();
+	stats->queued = stats_s.queued;
+	stats->sent = stats_s.sent;
+	stats->dropped = stats_s.dropped;
+	stats->overflows = stats_s.overflows;
+	stats->maxlevel = stats_s.maxlevel;
+	irq_restore(ie);
+}
+
+void console_clearstats(void) {
+	unsigned int ie=irq_disable();
+	stats_s.queued = 0;
+	stats_s.sent = 0;
+	stats_s.dropped = 0;
+	stats_s.overflows = 0;
+	stats_s.maxlevel = 0;
+	irq_restore(ie);
+}
@@ -0,0 +1,31 @@
+// Console output over the simple rs232 module with a transmit ring buffer
+// console_putc and console_puts return immediately: the characters are put in the ring buffer
+// and moved to the transmit fifo of the rs232 module by the interrupt handler on the transmit interrupt.
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#define CONSOLE_TXBUFFERSIZE 1024 // size of the transmit ring buffer, must be a power of 2
+
+// overflow policy: what to do when the ring buffer is full
+#define CONSOLE_OVERFLOW_DROP 0 // drop the character and return immediately
+#define CONSOLE_OVERFLOW_WAIT 1 // wait until there is room in the buffer, drop on timeout
+
+struct console_stats {
+	unsigned int queued; // number of characters put in the ring buffer
+	unsigned int sent; // number of characters sent to the rs232 module
+	unsigned int dropped; // number of characters dropped because the ring buffer was full
+	unsigned int overflows; // number of times the ring buffer was full on console_putc
+	unsigned int maxlevel; // maximum number of characters in the ring buffer
+};
+
+void console_init(int baudrate, int policy);
+void console_setpolicy(int policy);
+int console_putc(char c);
+int console_puts(char *s);
+int console_pending(void);
+int console_free(void);
+void console_getstats(struct console_stats *stats);
+void console_clearstats(void);
+
+#endif
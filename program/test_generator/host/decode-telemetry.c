@@ -0,0 +1,221 @@
+/** @file decode-telemetry.c
+ *  @brief A program which decodes the binary telemetry frames sent by the test_generator firmware over rs232.
+ *
+ *  The frames are read from a serial device (set to 115k2, 8 bits, no parity, raw) or from a file.
+ *  Each frame is checked with its CRC-32, on a wrong CRC the decoder searches for the next sync byte.
+ *  Valid frames are printed as one text line per record.
+ *
+ *  @author Peter Schakel <p.schakel@rug.nl>
+ *
+ *  @bug None!
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <unistd.h> /* getopt */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+
+#include "../telemetry.h"
+
+#define FRAME_MAXSIZE (TELEMETRY_OVERHEAD+TELEMETRY_MAXPAYLOAD)
+
+static const char* program;
+static int verbose = 0;
+static unsigned long frames = 0;
+static unsigned long crcerrors = 0;
+static unsigned long skipped = 0;
+
+static void help(void) {
+  fprintf(stderr, "Usage: %s [OPTION] <device or file>\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -o <file>      write the decoded records to file instead of stdout\n");
+  fprintf(stderr, "  -v             verbose: report CRC errors and frame counters\n");
+  fprintf(stderr, "  -h             display this help and exit\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Decodes the binary telemetry frames of the test_generator firmware.\n");
+  fprintf(stderr, "Use - as device to read from stdin.\n");
+}
+
+static unsigned int get32(const unsigned char *p) {
+  return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+// set a serial device to 115k2, 8 bits, no parity, raw
+static int setserial(int fd) {
+  struct termios tio;
+  if (tcgetattr(fd, &tio) < 0) return -1;
+  tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF);
+  tio.c_oflag &= ~OPOST;
+  tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+  tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB);
+  tio.c_cflag |= CS8 | CREAD | CLOCAL;
+  tio.c_cc[VMIN] = 1;
+  tio.c_cc[VTIME] = 0;
+  cfsetispeed(&tio, B115200);
+  cfsetospeed(&tio, B115200);
+  return tcsetattr(fd, TCSANOW, &tio);
+}
+
+static void print_record(FILE* out, int type, const unsigned char *payload, int len) {
+  unsigned int flags;
+  switch (type) {
+  case TELEMETRY_TYPE_TEXT:
+    fprintf(out, "text    %.*s\n", len, (const char*)payload);
+    break;
+  case TELEMETRY_TYPE_SAMPLE:
+    if (len != TELEMETRY_SAMPLESIZE) goto unknown;
+    flags = payload[8];
+    fprintf(out, "sample  timestamp=%08x%08x phase=%u errors=%u corrections=%u%s%s%s%s\n",
+      get32(&payload[0]), get32(&payload[4]), payload[9], get32(&payload[10]), get32(&payload[14]),
+      (flags & TELEMETRY_FLAG_ERROR) ? " error" : "",
+      (flags & TELEMETRY_FLAG_CORRECTED) ? " corrected" : "",
+      (flags & TELEMETRY_FLAG_PPSPHASE) ? " pps" : "",
+      (flags & TELEMETRY_FLAG_SETWAITING) ? " setwaiting" : "");
+    break;
+  case TELEMETRY_TYPE_CONSOLE:
+    if (len != TELEMETRY_CONSOLESIZE) goto unknown;
+    fprintf(out, "console queued=%u sent=%u dropped=%u overflows=%u maxlevel=%u droppedframes=%u\n",
+      get32(&payload[0]), get32(&payload[4]), get32(&payload[8]),
+      get32(&payload[12]), get32(&payload[16]), get32(&payload[20]));
+    break;
+  case TELEMETRY_TYPE_SCHED:
+    if (len != TELEMETRY_SCHEDSIZE) goto unknown;
+    fprintf(out, "sched   ticks=%u idle=%u.%u%% late=%u missed=%u maxrun=%uus\n",
+      get32(&payload[0]), get32(&payload[4])/10, get32(&payload[4])%10,
+      get32(&payload[8]), get32(&payload[12]), get32(&payload[16]));
+    break;
+  default:
+  unknown:
+    fprintf(out, "unknown type=0x%02x length=%d\n", type, len);
+    break;
+  }
+  fflush(out);
+}
+
+// Decode the frames in buffer, returns the number of bytes that are consumed
+static int decode(FILE* out, const unsigned char *buffer, int size) {
+  int pos = 0, len;
+  unsigned int crc, framecrc;
+  while (pos < size) {
+    if (buffer[pos] != TELEMETRY_SYNC) {
+      skipped++;
+      pos++;
+      continue;
+    }
+    if (size-pos < TELEMETRY_HEADERSIZE) break;
+    len = buffer[pos+1];
+    if (size-pos < len+TELEMETRY_OVERHEAD) break;
+    crc = ~telemetry_crc32(0xffffffff, &buffer[pos+1], len+TELEMETRY_HEADERSIZE-1);
+    framecrc = buffer[pos+TELEMETRY_HEADERSIZE+len] |
+      ((unsigned int)buffer[pos+TELEMETRY_HEADERSIZE+len+1] << 8) |
+      ((unsigned int)buffer[pos+TELEMETRY_HEADERSIZE+len+2] << 16) |
+      ((unsigned int)buffer[pos+TELEMETRY_HEADERSIZE+len+3] << 24);
+    if (crc != framecrc) {
+      // not a frame or a corrupted frame: resynchronize on the next sync byte
+      crcerrors++;
+      if (verbose) fprintf(stderr, "%s: CRC error (frames %lu, CRC errors %lu)\n", program, frames, crcerrors);
+      skipped++;
+      pos++;
+      continue;
+    }
+    frames++;
+    print_record(out, buffer[pos+2], &buffer[pos+TELEMETRY_HEADERSIZE], len);
+    pos += len+TELEMETRY_OVERHEAD;
+  }
+  return pos;
+}
+
+int main(int argc, char** argv) {
+  int opt, error, fd, fill, used;
+  ssize_t got;
+  const char* device;
+  FILE* out = stdout;
+  unsigned char buffer[2*FRAME_MAXSIZE];
+
+  program = argv[0];
+  error = 0;
+
+  while ((opt = getopt(argc, argv, "o:vh")) != -1) {
+    switch (opt) {
+    case 'o':
+      out = fopen(optarg, "w");
+      if (out == 0) {
+        fprintf(stderr, "%s: cannot open %s: %s\n", program, optarg, strerror(errno));
+        return 1;
+      }
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    case 'h':
+      help();
+      return 0;
+    case ':':
+    case '?':
+      error = 1;
+      break;
+    default:
+      fprintf(stderr, "%s: bad getopt result\n", program);
+      return 1;
+    }
+  }
+
+  if (error) return 1;
+
+  if (optind + 1 != argc) {
+    fprintf(stderr, "%s: expecting one non-optional argument: <device or file>\n", program);
+    return 1;
+  }
+
+  device = argv[optind];
+  if (strcmp(device, "-") == 0) {
+    fd = 0;
+  } else {
+    fd = open(device, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+      fprintf(stderr, "%s: cannot open %s: %s\n", program, device, strerror(errno));
+      return 1;
+    }
+  }
+  if (isatty(fd) && (setserial(fd) < 0)) {
+    fprintf(stderr, "%s: cannot set serial parameters of %s: %s\n", program, device, strerror(errno));
+    return 1;
+  }
+
+  fill = 0;
+  while ((got = read(fd, &buffer[fill], sizeof(buffer)-fill)) > 0) {
+    fill += got;
+    used = decode(out, buffer, fill);
+    memmove(buffer, &buffer[used], fill-used);
+    fill -= used;
+  }
+  if (got < 0) {
+    fprintf(stderr, "%s: read error on %s: %s\n", program, device, strerror(errno));
+    return 1;
+  }
+
+  if (verbose) fprintf(stderr, "%s: %lu frames, %lu CRC errors, %lu bytes skipped\n", program, frames, crcerrors, skipped);
+  if (out != stdout) fclose(out);
+  if (fd != 0) close(fd);
+  return 0;
+}
@@ -1,3 +1,10 @@
+#include "../common/timer.h"
+#include "../common/sdb.h"
+#include "../common/irq.h"
+#include "console.h"
+#include "sched.h"
+#include "telemetry.h"
+
 // address for LED register
 volatile unsigned int* leds = (unsigned int*)0x100400;
 
@@ -16,15 +23,11 @@ volatile unsigned int* pattern_status = (unsigned int*)0x11040c; // status bit =
 // addresses for BuTiS clock module
 volatile unsigned int* BuTiSclock_lw = (unsigned int*)0x110500; // Timestamp to set: low 32 bits of 64-bits timestamp
 volatile unsigned int* BuTiSclock_hw = (unsigned int*)0x110504; // Timestamp to set: high 32 bits of 64-bits timestamp
-volatile unsigned int* BuTiSclock_control = (unsigned int*)0x110508; // control bit 0,1,2 = set,sync,reset, bit 15..8 = phase
-volatile unsigned int* BuTiSclock_status = (unsigned int*)0x11050c; // status bit 0,1 = set, phase of PPS signal
-
-// addresses for simple rs232 module
-volatile unsigned int* rs232_datasend = (unsigned int*)0x110600; // bit 7..0 = data to send
-volatile unsigned int* rs232_dataread = (unsigned int*)0x110604; // bit 7..0 = received data
-volatile unsigned int* rs232_readdone = (unsigned int*)0x110608; // write enables next receive data
-volatile unsigned int* rs232_status = (unsigned int*)0x11060c; // status bit 0,1 = sending allowed, received data available
-volatile unsigned int* rs232_control = (unsigned int*)0x110610; // control bit 2..0 = baudrate (0to7): clock,115k2,57k6,38k4,19k2,9k6,4k8,2k4
+volatile unsigned int* BuTiSclock_control = (unsigned int*)0x110508; // control bit 0..5 = set,sync,reset,calibrate,use calibrated phase,track phase, bit 15..8 = phase
+volatile unsigned int* BuTiSclock_status = (unsigned int*)0x11050c; // status bit 0..3 = set, phase of PPS signal, calibration busy, eye found, bit 15..8 = calibrated phase, bit 23..16 = eye width
+volatile unsigned int* BuTiSclock_eyemap = (unsigned int*)0x110510; // bit n set: phase step n error-free during calibration
+volatile unsigned int* BuTiSclock_tracker = (unsigned int*)0x110514; // phase tracker bit 15..0 = phase error, bit 23..16 = offset, bit 24 = locked, bit 29..25 = trace index
+volatile unsigned int* BuTiSclock_trace = (unsigned int*)0x110580; // phase tracker trace buffer, 32 words
 
 // addresses for timestamp reading
 volatile unsigned int* readtime_highword = (unsigned int*)0x110700; // 64-bits timestamp received, bits 63..32
@@ -33,6 +36,37 @@ volatile unsigned int* readtime_errors = (unsigned int*)0x110708; // number of e
 volatile unsigned int* readtime_corrections = (unsigned int*)0x11070c; // number of corrections
 volatile unsigned int* readtime_control = (unsigned int*)0x110710; // control bit 0..3 = disable,error,correction,clear
 
+// Set the addresses of the modules to the base addresses found in the SDB ROM,
+// the addresses above are the defaults for devices that are not found
+static void init_addresses(void) {
+	unsigned int base;
+	leds = (unsigned int*)sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_GPIO,0x100400);
+	base = sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_SINGLEPULSE,0x110000);
+	singlepulse_delay = (unsigned int*)(base+0x0);
+	singlepulse_duration = (unsigned int*)(base+0x4);
+	singlepulse_control = (unsigned int*)(base+0x8);
+	singlepulse_status = (unsigned int*)(base+0xc);
+	base = sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_PATTERN,0x110400);
+	pattern_data = (unsigned int*)(base+0x0);
+	pattern_period = (unsigned int*)(base+0x4);
+	pattern_control = (unsigned int*)(base+0x8);
+	pattern_status = (unsigned int*)(base+0xc);
+	base = sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_BUTIS,0x110500);
+	BuTiSclock_lw = (unsigned int*)(base+0x00);
+	BuTiSclock_hw = (unsigned int*)(base+0x04);
+	BuTiSclock_control = (unsigned int*)(base+0x08);
+	BuTiSclock_status = (unsigned int*)(base+0x0c);
+	BuTiSclock_eyemap = (unsigned int*)(base+0x10);
+	BuTiSclock_tracker = (unsigned int*)(base+0x14);
+	BuTiSclock_trace = (unsigned int*)(base+0x80);
+	base = sdb_base(SDB_VENDOR_GSI,SDB_DEVICE_READTIMESTAMP,0x110700);
+	readtime_highword = (unsigned int*)(base+0x00);
+	readtime_lowword = (unsigned int*)(base+0x04);
+	readtime_errors = (unsigned int*)(base+0x08);
+	readtime_corrections = (unsigned int*)(base+0x0c);
+	readtime_control = (unsigned int*)(base+0x10);
+}
+
 void _read(void) {}
 void isatty(void) {}
 void _sbrk(void) {}
@@ -42,214 +76,110 @@ void _fstat(void) {}
 void _lseek(void) {}
 
 
-#define INT_DIGITS 19		/* enough for 64 bit integer */
-
-// integer to ascii conversion
-char *itoa(int i)
-{
-  /* Room for INT_DIGITS digits, - and '\0' */
-  static char buf[INT_DIGITS + 2];
-  char *p = buf + INT_DIGITS + 1;	/* points to terminating '\0' */
-  if (i >= 0) {
-    do {
-      *--p = '0' + (i % 10);
-      i /= 10;
-    } while (i != 0);
-    return p;
-  }
-  else {			/* i < 0 */
-    do {
-      *--p = '0' - (i % 10);
-      i /= 10;
-    } while (i != 0);
-    *--p = '-';
-  }
-  return p;
+
+// write pattern into memory
+void load_pattern(unsigned int *pattern, int nrofwords, int period) {
+	unsigned int *p=pattern;
+	int i;
+	*pattern_period = period;
+	*pattern_control = 3;
+	for (i=0; i<nrofwords; i++) *pattern_data = *p++;
+	*pattern_control = 1;
 }
 
+static int led_s=0;
+static int phase_s=0;
+static int phasedownwards_s=0;
+static unsigned int prev_phasestat_s=0;
+static int telemetrycount_s=0;
 
-void _irq_entry(void) {
-  /* Currently only triggered by DMA completion */
+// task: rotate the LEDs
+static void led_task(void) {
+	*leds = 1 << led_s;
 }
 
-// send character using the simple rs232 module
-int writechar_rs232module(char c) {// send character, return 0 on success
-	int timeout=0;
-	while ((*rs232_status & 0x1)==0) { // wait till previous character has been sent
-		asm("# noop"); /* no-op the compiler can't optimize away */
-		if (timeout++>=20000) return -1;
-	}
-	*rs232_datasend=c;
-	return 0;
+// task: change the single pulse parameters together with the LEDs
+static void pulse_task(void) {
+	*singlepulse_delay = 100+led_s*10;
+	*singlepulse_duration = 200+led_s*20;
+	led_s = (led_s+1) & 7;
 }
 
-// send character using the pattern generator as rs232 transmitter
-int writechar(char c) {// send character, return 0 on success
-	int timeout=0;
-	int i;
-	while ((*pattern_status & 0x1)==1) { // wait till previous character has been sent
-		asm("# noop"); /* no-op the compiler can't optimize away */
-		if (timeout++>=20000) return -1;
+// task: change phase upwards and downwards on each PPS for testing behaviour
+static void phase_task(void) {
+	unsigned int phasestat=*BuTiSclock_status & 0x3;
+	if ((phasestat & 0x2) && (!(prev_phasestat_s & 0x2))) {
+		if (phasedownwards_s) {
+			if (--phase_s<=0) phasedownwards_s=0;
+		}
+		else {
+			if (++phase_s>=27) phasedownwards_s=1;
+		}
+		*BuTiSclock_control = phase_s << 8;
 	}
-	*pattern_control = 2;
-	*pattern_data = 1; // start bit
-	for (i=0; i<8; i++) 
-		if ((c >> i) & 1) *pattern_data = 0; else *pattern_data = 1; // put character as serial data in pattern generator
-	*pattern_data = 0; // stop bit
-	*pattern_data = 0; // stop bit
-	*pattern_control = 0;
-	*pattern_control = 8; // soft trigger
-writechar_rs232module(c); // transmit character also with simple rs232 module, just for testing
-	return 0;
-}
-
-
-
-// send a string over the rs232 line
-int writestring(char *s) {// send characters, return 0 on success
-	int i=0;
-	while (s[i]) { if (writechar(s[i++])) return -1; }
-	return 0;
+	prev_phasestat_s=phasestat;
 }
 
-// send received timestamp data over the rs232 line
-void printhex(unsigned int hw, unsigned int lw, unsigned int cw) {
-	int i=0;
-	char c;
-	unsigned int n;
-	if (cw & 0x02) { // error detected in serially sent timestamp
-		c='X';
-	} else if (cw & 0x04) { // error succesfully corrected in serially sent timestamp
-		c='`';
-	} else {
-		c=' ';
-	}
-	if (writechar(c)) return;
+// task: send timestamp, phase and counters as binary telemetry frame, console and scheduler counters every 8th time
+static void telemetry_task(void) {
+	unsigned int hw,lw,cw,phasestat,flags;
+
+	// reading of BuTiS received timestamp and error counters
+	*readtime_control = 0x1; // disable updating timestamp reading registers
+	hw = *readtime_highword;
+	lw = *readtime_lowword;
+	cw = *readtime_control;
+	*readtime_control = 0x0; // enable updating timestamp reading registers
+	phasestat=*BuTiSclock_status & 0x3;
 	
-	for (i=0; i<18; i++) {
-		if (i<8) {
-			n=(hw >> ((7-i)*4)) & 0xf;
-			if (n<10) c=n+'0';
-			else c=n-10+'A';
-		} 
-		else if (i<16) {
-			n=(lw >> ((7-i)*4)) & 0xf;
-			if (n<10) c=n+'0';
-			else c=n-10+'A';
-		} 
-		else if (i==16) c=13; 
-		else c=10;
-		if (writechar(c)) return;
-	}
-}
+	flags=0;
+	if (cw & 0x02) flags |= TELEMETRY_FLAG_ERROR; // error detected in serially sent timestamp
+	if (cw & 0x04) flags |= TELEMETRY_FLAG_CORRECTED; // error succesfully corrected in serially sent timestamp
+	if (phasestat & 0x2) flags |= TELEMETRY_FLAG_PPSPHASE; // second half second of PPS phase
+	if (phasestat & 0x1) flags |= TELEMETRY_FLAG_SETWAITING; // timestamp setting waiting for PPS
+	telemetry_sample(hw,lw,flags,phase_s,*readtime_errors,*readtime_corrections);
 	
-// write pattern into memory
-void load_pattern(unsigned int *pattern, int nrofwords, int period) {
-	unsigned int *p=pattern;
-	int i;
-	*pattern_period = period;
-	*pattern_control = 3;
-	for (i=0; i<nrofwords; i++) *pattern_data = *p++;
-	*pattern_control = 1;
+	if (telemetrycount_s++==0) {
+		telemetry_console();
+		telemetry_sched();
+	}
+	telemetrycount_s &= 7;
 }
 
 void main(void) {
-	int i, j;
-	int phase=0;
-	unsigned int errors=0;
-	unsigned int corrections=0;
-	unsigned int hw,lw,cw,phasestat,prev_phasestat;
 	int nrofwords=10;
-	int n=0; 
-	int phasedownwards=0;
-	char k;
 	unsigned int pattern[10] = {0xff,0,0xff,0,0x55,0xaa,0,0xff,0xff,0};
 	
+	sdb_init(); // find the base addresses of the modules
+	init_addresses();
+	timer_init();
+	
 	// initialize single pulse generator
 	*singlepulse_control = 1; // enable
 	*singlepulse_delay = 100; // delay 100 clock-cycles
 	*singlepulse_duration = 200; // pulse-width 200 clock-cycles
 	
-	*rs232_control = 1;	// set baudrate to 115k2
+	vic_init(); // interrupts via the vectored interrupt controller
+	console_init(1,CONSOLE_OVERFLOW_DROP); // set baudrate to 115k2, drop characters if the buffer is full
 	*readtime_control = 8; // clear timpestamp receiver error counters
 	*BuTiSclock_control = 0x2; // start re-synchronizing on PPS
-	for (j = 0; j < 1250000/4/5; ++j)  // 0.002s
-		asm("# noop"); /* no-op the compiler can't optimize away */
+	timer_sleep(2000); // 0.002s
 	*BuTiSclock_control = 0x4; // reset phase PLL
 	*BuTiSclock_lw = 0x00000000; // timestamp low-word
 	*BuTiSclock_hw = 0x00000000; // timestamp high-word
 	*BuTiSclock_control = 0x1; // set the timestamp (hw & lw) on the next PPS-pulse
-	phase=0;
-	*BuTiSclock_control = phase << 8; // set phase
-	*pattern_period = 1085; // pattern period : 1085/125MHz => 8.68us => 115k2 baud
+	phase_s=0;
+	*BuTiSclock_control = phase_s << 8; // set phase
 	
 	// example how to load a pattern
-	// this is now overwritten by the rs232 data in writechar()
 	load_pattern(pattern,nrofwords,1085); // load pattern
-	writestring("Start while loop\n");
 	
-	while (1) {
-
-		for (i = 0; i < 8; ++i) {
-		
-			// print errors/correction if amount has changed
-			if ((*readtime_errors!=errors) || (*readtime_corrections!=corrections)) {
-				errors=*readtime_errors;
-				corrections=*readtime_corrections;
-				writestring("errors=");
-				writestring(itoa(*readtime_errors));
-				writestring("  corrections=");
-				writestring(itoa(*readtime_corrections));
-				writestring("\n\r");
-			}
-			
-			// reading of BuTiS received timestamp and error counters
-			*readtime_control = 0x1; // disable updating timestamp reading registers
-			hw = *readtime_highword;
-			lw = *readtime_lowword;
-			cw = *readtime_control;
-			*readtime_control = 0x0; // enable updating timestamp reading registers
-			printhex(hw,lw,cw); // send over rs232
-			
-			// change phase upwards and downwards for testing behaviour
-			phasestat=*BuTiSclock_status & 0x3;
-			if ((phasestat & 0x2) && (!(prev_phasestat & 0x2))) {
-				if (phasedownwards) {
-					if (--phase<=0) phasedownwards=0;
-				}
-				else {
-					if (++phase>=27) phasedownwards=1;
-				}
-				*BuTiSclock_control = phase << 8;
-				n=0;
-				writestring("phase="); 
-				writestring(itoa(phase)); // send actual phase over rs232
-				writestring("\n\r");
-			}
-			
-			// check PPS : first half second or second half second
-			prev_phasestat=phasestat;
-			switch(phasestat) {
-				case 0x0 : k=' '; break; // first half second of PPS phase
-				case 0x1 : k='s'; break; // first half second of PPS phase and timestamp setting waiting for PPS
-				case 0x2 : k='.'; break; // second half second of PPS phase
-				case 0x3 : k='S'; break; // second half second of PPS phase and timestamp setting waiting for PPS
-				default  : k='*';
-			}
-			if (writechar(k)) return;
-			
-			/* Rotate the LEDs */
-			*leds = 1 << i;
-			*singlepulse_delay = 100+i*10;
-			*singlepulse_duration = 200+i*20;
-
-			/* Each loop iteration takes 4 cycles.
-			* It runs at 125MHz.
-			* Sleep 0.2 second.
-			*/
-			for (j = 0; j < 125000000/4/5; ++j) {
-				asm("# noop"); /* no-op the compiler can't optimize away */
-			}
-		}
-	}
+	// periods in scheduler ticks of 1ms, the offsets spread the tasks
+	sched_init();
+	sched_addtask(led_task,200,0);
+	sched_addtask(pulse_task,200,1);
+	sched_addtask(phase_task,10,2); // PPS phase has a period of 1s
+	sched_addtask(telemetry_task,200,3);
+	telemetry_text("Start scheduler");
+	sched_run();
 }
@@ -0,0 +1,99 @@
+// Cooperative scheduler driven by the periodic interrupt of the tics timer, see sched.h
+// Only the interrupt handler writes ticks_s, only sched_run writes the other statistics.
+
+#include "../common/timer.h"
+#include "../common/irq.h"
+#include "sched.h"
+
+struct sched_entry {
+	sched_task_t task;
+	unsigned int period; // in ticks
+	unsigned int next; // tick on which the task is called next
+};
+
+static struct sched_entry tasks_s[SCHED_MAXTASKS];
+static int nroftasks_s=0;
+static volatile unsigned int ticks_s=0;
+static volatile unsigned int missed_s=0;
+static unsigned int late_s=0;
+static unsigned int maxrun_s=0;
+static unsigned int idle_s=0;
+
+// interrupt handler: next scheduler tick
+static void sched_timerirq(void) {
+	missed_s = timer_ack();
+	ticks_s++;
+}
+
+// Initialize the scheduler and start the timer interrupt, vic_init must be called before
+void sched_init(void) {
+	nroftasks_s = 0;
+	vic_sethandler(VIC_IRQ_TIMER,sched_timerirq);
+	timer_setperiod(SCHED_TICK);
+	vic_enableirq(VIC_IRQ_TIMER);
+}
+
+// Add a periodic task
+//   Parameters :
+//      sched_task_t task : function to call
+//      unsigned int period : period in scheduler ticks
+//      unsigned int offset : ticks before the first call, to spread tasks with the same period
+//      return : 0 on success, -1 if there is no room for the task
+int sched_addtask(sched_task_t task, unsigned int period, unsigned int offset) {
+	if ((nroftasks_s>=SCHED_MAXTASKS) || (period==0)) return -1;
+	tasks_s[nroftasks_s].task = task;
+	tasks_s[nroftasks_s].period = period;
+	tasks_s[nroftasks_s].next = ticks_s+offset;
+	nroftasks_s++;
+	return 0;
+}
+
+// Run the tasks, does not return
+void sched_run(void) {
+	unsigned int now,start,windowstart,windowidle=0,run,elapsed;
+	int i,busy;
+	windowstart = ticks_s;
+	while (1) {
+		now = ticks_s;
+		busy = 0;
+		for (i=0; i<nroftasks_s; i++) {
+			if ((int)(now-tasks_s[i].next)>=0) {
+				start = timer_tics();
+				tasks_s[i].task();
+				run = timer_tics()-start;
+				if (run>maxrun_s) maxrun_s = run;
+				tasks_s[i].next += tasks_s[i].period;
+				if ((int)(now-tasks_s[i].next)>=0) { // more than one period late: skip the missed calls
+					late_s++;
+					tasks_s[i].next = now+tasks_s[i].period;
+				}
+				busy = 1;
+			}
+		}
+		if (!busy) { // nothing to do until the next tick
+			start = timer_tics();
+			while (ticks_s==now)
+				asm("# noop"); /* no-op the compiler can't optimize away */
+			windowidle += timer_tics()-start;
+		}
+		now = ticks_s;
+		elapsed = now-windowstart;
+		if (elapsed>=SCHED_IDLEWINDOW) { // idle per mille: idle usec / (elapsed usec / 1000)
+			idle_s = windowidle/(elapsed*(SCHED_TICK/1000));
+			windowstart = now;
+			windowidle = 0;
+		}
+	}
+}
+
+unsigned int sched_ticks(void) {
+	return ticks_s;
+}
+
+void sched_getstats(struct sched_stats *stats) {
+	stats->ticks = ticks_s;
+	stats->idle = idle_s;
+	stats->late = late_s;
+	stats->missed = missed_s;
+	stats->maxrun = maxrun_s;
+}
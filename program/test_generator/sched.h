@@ -0,0 +1,29 @@
+// Cooperative scheduler driven by the periodic interrupt of the tics timer
+// Tasks are functions that are called periodically from sched_run; they must return quickly.
+// The timer interrupt only counts scheduler ticks, the tasks run in the main program.
+// When no task is due the scheduler waits for the next tick and measures this idle time.
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#define SCHED_TICK 1000 // scheduler tick in usec
+#define SCHED_MAXTASKS 8
+#define SCHED_IDLEWINDOW 1000 // ticks over which the idle time is measured
+
+typedef void (*sched_task_t)(void);
+
+struct sched_stats {
+	unsigned int ticks; // scheduler ticks since sched_init
+	unsigned int idle; // idle time in the last measurement window, per mille
+	unsigned int late; // number of task calls that were more than one period late
+	unsigned int missed; // timer interrupts that came before the previous one was acknowledged
+	unsigned int maxrun; // longest task run time in usec
+};
+
+void sched_init(void);
+int sched_addtask(sched_task_t task, unsigned int period, unsigned int offset);
+void sched_run(void);
+unsigned int sched_ticks(void);
+void sched_getstats(struct sched_stats *stats);
+
+#endif
@@ -0,0 +1,95 @@
+// Binary telemetry frames over the rs232 line, see telemetry.h for the frame layout
+// A frame is only put in the console buffer if it fits completely, otherwise the whole frame is dropped.
+
+#include "console.h"
+#include "sched.h"
+#include "telemetry.h"
+
+static unsigned int dropped_s=0;
+
+static void put32(unsigned char *p, unsigned int value) {
+	p[0] = value >> 24;
+	p[1] = value >> 16;
+	p[2] = value >> 8;
+	p[3] = value;
+}
+
+// Send one frame
+//   Parameters :
+//      int type : record type TELEMETRY_TYPE_...
+//      const unsigned char *payload : data of the record
+//      int len : number of bytes in payload (0..255)
+//      return : 0 on success, -1 if the frame has been dropped
+int telemetry_send(int type, const unsigned char *payload, int len) {
+	unsigned char header[TELEMETRY_HEADERSIZE];
+	unsigned int crc;
+	int i;
+	if ((len<0) || (len>TELEMETRY_MAXPAYLOAD) || (console_free()<len+TELEMETRY_OVERHEAD)) {
+		dropped_s++;
+		return -1;
+	}
+	header[0] = TELEMETRY_SYNC;
+	header[1] = len;
+	header[2] = type;
+	crc = telemetry_crc32(0xffffffff,&header[1],2);
+	crc = ~telemetry_crc32(crc,payload,len);
+	for (i=0; i<TELEMETRY_HEADERSIZE; i++) console_putc(header[i]);
+	for (i=0; i<len; i++) console_putc(payload[i]);
+	for (i=0; i<TELEMETRY_CRCSIZE; i++) console_putc((crc >> (i*8)) & 0xff);
+	return 0;
+}
+
+int telemetry_text(char *s) {
+	int len=0;
+	while ((s[len]) && (len<TELEMETRY_MAXPAYLOAD)) len++;
+	return telemetry_send(TELEMETRY_TYPE_TEXT,(const unsigned char *)s,len);
+}
+
+// Send received timestamp, phase and timestamp receiver counters
+//   Parameters :
+//      unsigned int hw, lw : timestamp bits 63..32 and 31..0
+//      unsigned int flags : TELEMETRY_FLAG_...
+//      unsigned int phase : phase of the BuTiS PLL
+//      unsigned int errors, corrections : timestamp receiver counters
+//      return : 0 on success, -1 if the frame has been dropped
+int telemetry_sample(unsigned int hw, unsigned int lw, unsigned int flags, unsigned int phase, unsigned int errors, unsigned int corrections) {
+	unsigned char payload[TELEMETRY_SAMPLESIZE];
+	put32(&payload[0],hw);
+	put32(&payload[4],lw);
+	payload[8] = flags;
+	payload[9] = phase;
+	put32(&payload[10],errors);
+	put32(&payload[14],corrections);
+	return telemetry_send(TELEMETRY_TYPE_SAMPLE,payload,TELEMETRY_SAMPLESIZE);
+}
+
+// Send the console counters and the number of dropped telemetry frames
+int telemetry_console(void) {
+	unsigned char payload[TELEMETRY_CONSOLESIZE];
+	struct console_stats stats;
+	console_getstats(&stats);
+	put32(&payload[0],stats.queued);
+	put32(&payload[4],stats.sent);
+	put32(&payload[8],stats.dropped);
+	put32(&payload[12],stats.overflows);
+	put32(&payload[16],stats.maxlevel);
+	put32(&payload[20],dropped_s);
+	return telemetry_send(TELEMETRY_TYPE_CONSOLE,payload,TELEMETRY_CONSOLESIZE);
+}
+
+// Send the scheduler counters and the measured cpu idle time
+int telemetry_sched(void) {
+	unsigned char payload[TELEMETRY_SCHEDSIZE];
+	struct sched_stats stats;
+	sched_getstats(&stats);
+	put32(&payload[0],stats.ticks);
+	put32(&payload[4],stats.idle);
+	put32(&payload[8],stats.late);
+	put32(&payload[12],stats.missed);
+	put32(&payload[16],stats.maxrun);
+	return telemetry_send(TELEMETRY_TYPE_SCHED,payload,TELEMETRY_SCHEDSIZE);
+}
+
+unsigned int telemetry_dropped(void) {
+	return dropped_s;
+}
@@ -0,0 +1,57 @@
+// Binary telemetry frames over the rs232 line
+// Used by the firmware to send and by the host decoder (host/decode-telemetry.c) to receive.
+//
+// Frame layout:
+//     byte 0 : TELEMETRY_SYNC
+//     byte 1 : length of the payload in bytes (0..255)
+//     byte 2 : record type, see TELEMETRY_TYPE_...
+//     byte 3..length+2 : payload, multi-byte values are big-endian
+//     last 4 bytes : CRC-32 over length, type and payload, least significant byte first
+// The CRC-32 is the same as the default gc_crc_gen (Ethernet CRC): polynomial 0x04C11DB7,
+// initial value 0xffffffff, bits shifted in least significant bit first, result inverted.
+// A receiver synchronizes on TELEMETRY_SYNC and rejects frames with a wrong CRC.
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "../common/crc32.h"
+
+#define TELEMETRY_SYNC 0xa5
+#define TELEMETRY_HEADERSIZE 3 // sync, length, type
+#define TELEMETRY_CRCSIZE 4
+#define TELEMETRY_OVERHEAD (TELEMETRY_HEADERSIZE+TELEMETRY_CRCSIZE)
+#define TELEMETRY_MAXPAYLOAD 255
+
+// record types
+#define TELEMETRY_TYPE_TEXT 0x01
+	// ascii text, not terminated
+#define TELEMETRY_TYPE_SAMPLE 0x02
+	// 8 bytes timestamp, 1 byte flags, 1 byte phase, 4 bytes errors, 4 bytes corrections
+	// flags bit 0,1 = timestamp error, timestamp corrected, bit 2,3 = PPS phase, timestamp setting waiting for PPS
+#define TELEMETRY_TYPE_CONSOLE 0x03
+	// 4 bytes each: characters queued, sent, dropped, overflows, maximum buffer level, dropped telemetry frames
+#define TELEMETRY_TYPE_SCHED 0x04
+	// 4 bytes each: scheduler ticks, cpu idle time per mille, late task calls, missed timer interrupts, longest task run time in usec
+
+#define TELEMETRY_SAMPLESIZE 18
+#define TELEMETRY_CONSOLESIZE 24
+#define TELEMETRY_SCHEDSIZE 20
+
+#define TELEMETRY_FLAG_ERROR 0x01
+#define TELEMETRY_FLAG_CORRECTED 0x02
+#define TELEMETRY_FLAG_PPSPHASE 0x04
+#define TELEMETRY_FLAG_SETWAITING 0x08
+
+// CRC-32 of the frame, see ../common/crc32.h
+static inline unsigned int telemetry_crc32(unsigned int crc, const unsigned char *data, int len) {
+	return crc32_update(crc,data,len);
+}
+
+int telemetry_send(int type, const unsigned char *payload, int len);
+int telemetry_text(char *s);
+int telemetry_sample(unsigned int hw, unsigned int lw, unsigned int flags, unsigned int phase, unsigned int errors, unsigned int corrections);
+int telemetry_console(void);
+int telemetry_sched(void);
+unsigned int telemetry_dropped(void);
+
+#endif
@@ -18,8 +18,8 @@ entity lm32_test_system is
 end lm32_test_system;
 
 architecture rtl of lm32_test_system is  
-  constant c_cnx_slave_ports  : integer := 2;
-  constant c_cnx_master_ports : integer := 3;
+  constant c_cnx_slave_ports  : integer := 4;
+  constant c_cnx_master_ports : integer := 5;
 
   constant c_peripherals : integer := 3;
 
@@ -37,12 +37,16 @@ architecture rtl of lm32_test_system is
   constant c_cfg_base_addr : t_wishbone_address_array(c_cnx_master_ports-1 downto 0) :=
     (0 => x"00000000",                  -- 64KB of fpga memory
      1 => x"10000000",                  -- The second port to the same memory
-     2 => x"20000000");                 -- Peripherals
+     2 => x"20000000",                  -- Peripherals
+     3 => x"30000000",                  -- Cycle counter for benchmarks
+     4 => x"40000000");                 -- DMA controller
 
   constant c_cfg_base_mask : t_wishbone_address_array(c_cnx_master_ports-1 downto 0) :=
     (0 => x"ffff0000",
      1 => x"ffff0000",
-     2 => x"f0000000");
+     2 => x"f0000000",
+     3 => x"f0000000",
+     4 => x"f0000000");
 
   signal owr_en_slv, owr_in_slv : std_logic_vector(0 downto 0);
   
@@ -133,6 +137,33 @@ begin  -- rtl
       uart_rxd_i => rxd_i,
       uart_txd_o => txd_o);
 
+  -- tics counter counting every clock cycle: cycle counter for the benchmarks in sw/main.c
+  U_Cycles : xwb_tics
+    generic map (
+      g_interface_mode      => PIPELINED,
+      g_address_granularity => BYTE,
+      g_period              => 1)
+    port map (
+      clk_sys_i => clk_sys_i,
+      rst_n_i   => rst_n_i,
+      slave_i   => cnx_master_out(3),
+      slave_o   => cnx_master_in(3),
+      desc_o    => open,
+      irq_o     => open);
+
+  -- DMA controller, read and write master are crossbar masters 2 and 3, tested by sw/main.c
+  U_DMA : xwb_dma
+    port map (
+      clk_i       => clk_sys_i,
+      rst_n_i     => rst_n_i,
+      slave_i     => cnx_master_out(4),
+      slave_o     => cnx_master_in(4),
+      r_master_i  => cnx_slave_out(2),
+      r_master_o  => cnx_slave_in(2),
+      w_master_i  => cnx_slave_out(3),
+      w_master_o  => cnx_slave_in(3),
+      interrupt_o => open);
+
   --U_OneWire : xwb_onewire_master
   --  generic map (
   --    g_interface_mode      => CLASSIC,
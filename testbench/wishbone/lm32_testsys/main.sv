@@ -4,6 +4,10 @@ module main;
 
    reg clk_sys  =0;
    reg rst_n    = 0;
+   wire txd;
+
+   // bit time of the uart: CPU_CLOCK/UART_BAUDRATE clock cycles, see sw/uart.c
+   parameter uart_bit_ns = 10 * (1000000 / 10000);
 
    always #5 clk_sys <= ~clk_sys;
    
@@ -17,8 +21,26 @@ module main;
      DUT (
           .clk_sys_i (clk_sys),
           .rst_n_i   (rst_n),
-          .gpio_b ()
+          .gpio_b (),
+          .txd_o (txd),
+          .rxd_i (1'b1)
           );
+
+   // print the characters sent by the uart (benchmark results of sw/main.c)
+   reg [7:0] uart_char;
+   integer   uart_bit;
+   initial begin
+      @(posedge rst_n);
+      forever begin
+         @(negedge txd);
+         #(uart_bit_ns + uart_bit_ns / 2);
+         for(uart_bit = 0; uart_bit < 8; uart_bit = uart_bit + 1) begin
+            uart_char[uart_bit] = txd;
+            #(uart_bit_ns);
+         end
+         if(uart_char != 8'h0d) $write("%c", uart_char);
+      end
+   end
    
                             
 
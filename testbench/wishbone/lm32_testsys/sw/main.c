@@ -2,30 +2,229 @@
 //#include <stdint.h>
 
 #include "gpio.h"
+#include "../../../../program/common/format.h"
+#include "../../../../program/common/wb_dma.h"
+
+// Benchmark of the number formatting of the firmware (program/common/format.c, compile it with main.c)
+// against the itoa and int2hex functions it replaces.
+// The cycles are counted with the tics counter at 0x30000000 (g_period 1: one tic per clock cycle),
+// the results are sent over the uart and printed by main.sv, in clock cycles per call.
+// Then the modes of the DMA controller at 0x40000000 are tested against the same loops on the LM32:
+// incrementing, strided and fixed addresses, byte packing and a descriptor chain.
+
+#define CYCLES (*(volatile unsigned int*)0x30000000)
+#define NROFVALUES 16
+#define DMA(reg) (*(volatile unsigned int*)(0x40000000+(reg)))
+#define DMAWORDS 64
 
 void _irq_entry(){}
 
+static volatile char sink; // keeps the results of the calls
+
+static const unsigned int values[NROFVALUES] = {
+	0, 7, 42, 999, 1085, 65535, 100000, 1234567,
+	9999999, 16777216, 123456789, 1000000000, 2147483647, 3000000000u, 4000000000u, 4294967295u};
+
+// the replaced functions, with division and static buffers
+static char *old_itoa(int i)
+{
+	static char buf[21];
+	char *p = buf + 20;
+	if (i >= 0) {
+		do {
+			*--p = '0' + (i % 10);
+			i /= 10;
+		} while (i != 0);
+		return p;
+	}
+	do {
+		*--p = '0' - (i % 10);
+		i /= 10;
+	} while (i != 0);
+	*--p = '-';
+	return p;
+}
+
+static char *old_int2hex(unsigned int w, int l)
+{
+	static char buf[9];
+	int i;
+	char c;
+	for (i=0; i<l; i++) {
+		c=(w >> ((l-i-1)*4)) & 0xf;
+		if (c<10) buf[i]=c+'0'; else buf[i]=c-10+'A';
+	}
+	buf[l]=0;
+	return buf;
+}
+
+static void uart_write_string(const char *s)
+{
+	while (*s) uart_write_byte(*s++);
+}
+
+static void report(const char *name, unsigned int cycles)
+{
+	char buf[FORMAT_INTSIZE];
+	uart_write_string(name);
+	format_uint(buf, cycles / NROFVALUES);
+	uart_write_string(buf);
+	uart_write_string(" cycles/call\n");
+}
+
+// volatile: the DMA changes them behind the back of the compiler
+static volatile unsigned int src[DMAWORDS], dst[4*DMAWORDS];
+static volatile struct wb_dma_desc desc[2] __attribute__((aligned(WBDMA_DESC_SIZE)));
+
+// One transfer of the DMA, waits until it is done
+//   return : clock cycles
+static unsigned int dma_copy(unsigned int from, int from_stride, unsigned int to, int to_stride, unsigned int count, unsigned int mode)
+{
+	unsigned int start = CYCLES;
+	DMA(WBDMA_MODE) = mode;
+	DMA(WBDMA_READ) = from;
+	DMA(WBDMA_WRITE) = to;
+	DMA(WBDMA_READ_STRIDE) = from_stride;
+	DMA(WBDMA_WRITE_STRIDE) = to_stride;
+	DMA(WBDMA_COUNT) = count;
+	while (DMA(WBDMA_DESC_CONTROL) & WBDMA_DESC_BUSY);
+	return CYCLES-start;
+}
+
+static void clear_dst(void)
+{
+	int i;
+	for (i=0; i<4*DMAWORDS; i++) dst[i] = 0;
+}
+
+static void dma_report(const char *name, int ok, unsigned int dma_cycles, unsigned int cpu_cycles)
+{
+	char buf[FORMAT_INTSIZE];
+	uart_write_string(name);
+	uart_write_string(ok ? "ok, dma " : "FAILED, dma ");
+	format_uint(buf, dma_cycles);
+	uart_write_string(buf);
+	if (cpu_cycles) {
+		uart_write_string(", cpu ");
+		format_uint(buf, cpu_cycles);
+		uart_write_string(buf);
+	}
+	uart_write_string(" cycles\n");
+}
+
+static void dma_test(void)
+{
+	const volatile unsigned char *bytes = (const volatile unsigned char *)src;
+	unsigned int dma_cycles, cpu_cycles, start;
+	int i, ok;
+
+	for (i=0; i<DMAWORDS; i++) src[i] = 0x01234567 ^ (i * 0x11111111);
+
+	// incrementing addresses
+	clear_dst();
+	dma_cycles = dma_copy((unsigned int)src, 4, (unsigned int)dst, 4, DMAWORDS, WBDMA_MODE_WORD);
+	for (ok=1, i=0; i<DMAWORDS; i++) ok &= dst[i] == src[i];
+	start = CYCLES;
+	for (i=0; i<DMAWORDS; i++) dst[DMAWORDS+i] = src[i];
+	cpu_cycles = CYCLES-start;
+	dma_report("dma copy   : ", ok, dma_cycles, cpu_cycles);
+
+	// strided destination, every second word
+	clear_dst();
+	dma_cycles = dma_copy((unsigned int)src, 4, (unsigned int)dst, 8, DMAWORDS, WBDMA_MODE_WORD);
+	for (ok=1, i=0; i<DMAWORDS; i++) ok &= dst[2*i] == src[i] && dst[2*i+1] == 0;
+	dma_report("dma stride : ", ok, dma_cycles, 0);
+
+	// fixed source, as from a FIFO register
+	clear_dst();
+	dma_cycles = dma_copy((unsigned int)&src[5], 0, (unsigned int)dst, 4, DMAWORDS, WBDMA_MODE_WORD);
+	for (ok=1, i=0; i<DMAWORDS; i++) ok &= dst[i] == src[5];
+	dma_report("dma fixed  : ", ok, dma_cycles, 0);
+
+	// unpack: one byte per word in bits 7..0, as for a FIFO with 8-bit data
+	clear_dst();
+	dma_cycles = dma_copy((unsigned int)src, 4, (unsigned int)dst, 4, DMAWORDS, WBDMA_MODE_UNPACK);
+	for (ok=1, i=0; i<4*DMAWORDS; i++) ok &= dst[i] == bytes[i];
+	start = CYCLES;
+	for (i=0; i<4*DMAWORDS; i++) dst[i] = bytes[i];
+	cpu_cycles = CYCLES-start;
+	dma_report("dma unpack : ", ok, dma_cycles, cpu_cycles);
+
+	// pack the bytes of the unpacked words again
+	for (i=0; i<DMAWORDS; i++) src[i] = ~src[i];
+	dma_cycles = dma_copy((unsigned int)dst, 4, (unsigned int)src, 4, 4*DMAWORDS, WBDMA_MODE_PACK);
+	for (ok=1, i=0; i<4*DMAWORDS; i++) ok &= dst[i] == bytes[i];
+	dma_report("dma pack   : ", ok, dma_cycles, 0);
+
+	// descriptor chain: a copy and an unpack
+	clear_dst();
+	desc[0].read = (unsigned int)src;
+	desc[0].write = (unsigned int)dst;
+	desc[0].read_stride = 4;
+	desc[0].write_stride = 4;
+	desc[0].count = DMAWORDS;
+	desc[0].flags = 0;
+	desc[0].next = (unsigned int)&desc[1];
+	desc[0].status = 0;
+	desc[1].read = (unsigned int)src;
+	desc[1].write = (unsigned int)&dst[DMAWORDS];
+	desc[1].read_stride = 4;
+	desc[1].write_stride = 4;
+	desc[1].count = DMAWORDS/4;
+	desc[1].flags = WBDMA_FLAG_MODE(WBDMA_MODE_UNPACK);
+	desc[1].next = 0;
+	desc[1].status = 0;
+	start = CYCLES;
+	DMA(WBDMA_DESC_DONE) = 0;
+	DMA(WBDMA_DESC) = (unsigned int)desc;
+	DMA(WBDMA_DESC_CONTROL) = WBDMA_DESC_START;
+	while (DMA(WBDMA_DESC_CONTROL) & WBDMA_DESC_START);
+	dma_cycles = CYCLES-start;
+	ok = DMA(WBDMA_DESC_DONE) == 2 && desc[0].status == WBDMA_STATUS_DONE && desc[1].status == WBDMA_STATUS_DONE;
+	for (i=0; i<DMAWORDS; i++) ok &= dst[i] == src[i];
+	for (i=0; i<DMAWORDS; i++) ok &= dst[DMAWORDS+i] == bytes[i];
+	dma_report("dma chain  : ", ok, dma_cycles, 0);
+}
+
 int main(void)
 {
+	char buf[FORMAT_UINT64SIZE];
+	unsigned int start;
+	int i;
+
 	uart_init();
-	uart_write_byte('U');
-	uart_write_byte('U');
-	uart_write_byte('U');
-	uart_write_byte('U');
-	uart_write_byte('U');
-	uart_write_byte('U');
-	uart_write_byte('U');
-	uart_write_byte('U');
+	uart_write_string("format benchmark\n");
 
-/*	gpio_dir(1,1);
-	for(;;)
-	{
-		gpio_out(1,0);
-		delay(10);
-		gpio_out(1,1);
-		delay(10);
-	}*/
-}
+	start = CYCLES;
+	for (i=0; i<NROFVALUES; i++) sink = *old_itoa((int)values[i]);
+	report("itoa             : ", CYCLES-start);
+
+	start = CYCLES;
+	for (i=0; i<NROFVALUES; i++) { format_int(buf, (int)values[i]); sink = buf[0]; }
+	report("format_int       : ", CYCLES-start);
 
+	start = CYCLES;
+	for (i=0; i<NROFVALUES; i++) { format_uint(buf, values[i]); sink = buf[0]; }
+	report("format_uint      : ", CYCLES-start);
 
+	start = CYCLES;
+	for (i=0; i<NROFVALUES; i++) sink = *old_int2hex(values[i], 8);
+	report("int2hex          : ", CYCLES-start);
 
+	start = CYCLES;
+	for (i=0; i<NROFVALUES; i++) { format_hex(buf, values[i], 8); sink = buf[0]; }
+	report("format_hex       : ", CYCLES-start);
+
+	start = CYCLES;
+	for (i=0; i<NROFVALUES; i++) { format_timestamp(buf, values[i], values[NROFVALUES-1-i]); sink = buf[0]; }
+	report("format_timestamp : ", CYCLES-start);
+
+	start = CYCLES;
+	for (i=0; i<NROFVALUES; i++) { format_uint64(buf, values[i], values[NROFVALUES-1-i]); sink = buf[0]; }
+	report("format_uint64    : ", CYCLES-start);
+
+	dma_test();
+
+	uart_write_string("done\n");
+	for (;;);
+}
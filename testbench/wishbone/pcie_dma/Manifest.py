@@ -0,0 +1,4 @@
+action = "simulation"
+target = "altera"
+
+files = ["main.sv", "../../../modules/wishbone/wb_pcie/pcie_dma.vhd"]
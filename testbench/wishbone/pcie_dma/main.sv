@@ -0,0 +1,295 @@
+`timescale 1ns/1ps
+
+// Testbench of pcie_dma, the DMA from the FPGA into host memory.
+// The "cpu" writes a counter into the data window. A model of the pcie_altera TX queue
+// decodes the memory write TLPs into a host memory, and the host consumer checks the
+// counter in the ring behind the write-back pointer and returns the space with the read
+// pointer. A model of pcie_tlp sends completions in between to check the TX arbitration.
+// One buffer is above 4GB (4DW header) and partial TLPs are flushed, so the pad of the
+// 3DW and 4DW headers is checked for both alignments.
+
+module main;
+
+   parameter BUFLOG2  = 8;            // 256 byte buffers
+   parameter RINGLOG2 = 2;            // 4 buffers
+   parameter FLUSH    = 64;           // cycles
+   parameter WORDS    = 20000;        // counter words sent through the ring
+   parameter BUSDEV   = 13'h0a8;
+
+   localparam NBUF    = 1 << RINGLOG2;
+   localparam BUFSIZE = 1 << BUFLOG2;
+   localparam [63:0] WBADDR = 64'h0000_0000_0800_0040;
+
+   reg [63:0] bufaddr [0:NBUF-1];
+
+   reg clk  = 0;
+   reg rstn = 0;
+
+   always #4 clk <= ~clk; // 125 MHz PCIe core clock
+
+   reg         wb_cyc = 0, wb_stb = 0, wb_we = 0;
+   reg  [31:0] wb_adr = 0, wb_dat_w = 0;
+   wire        wb_stall, wb_ack;
+   wire [31:0] wb_dat_r;
+
+   reg         tx_rdy  = 1;
+   reg         tx_busy = 0;
+   wire        tx_block, tx_alloc, tx_en, tx_eop, tx_pad;
+   wire [31:0] tx_dat;
+
+   pcie_dma
+     #(.g_buffer_bits (6),
+       .g_fifo_bits   (9))
+   DUT (
+        .clk_i        (clk),
+        .rstn_i       (rstn),
+        .wb_cyc_i     (wb_cyc),
+        .wb_stb_i     (wb_stb),
+        .wb_adr_i     (wb_adr),
+        .wb_we_i      (wb_we),
+        .wb_sel_i     (4'hf),
+        .wb_dat_i     (wb_dat_w),
+        .wb_stall_o   (wb_stall),
+        .wb_ack_o     (wb_ack),
+        .wb_dat_o     (wb_dat_r),
+        .tx_busy_i    (tx_busy),
+        .tx_block_o   (tx_block),
+        .tx_rdy_i     (tx_rdy),
+        .tx_alloc_o   (tx_alloc),
+        .tx_en_o      (tx_en),
+        .tx_dat_o     (tx_dat),
+        .tx_eop_o     (tx_eop),
+        .tx_pad_o     (tx_pad),
+        .cfg_busdev_i (BUSDEV),
+        .irq_o        ()
+        );
+
+   integer errors = 0;
+   integer tlps   = 0;
+   integer cycles = 0;
+
+   bit [31:0] hostmem [bit [63:0]];
+
+   // Wishbone master, driven and sampled on the falling edge
+   task wb_access(input we, input [31:0] adr, input [31:0] dat, output [31:0] q);
+      integer t;
+      begin
+         @(negedge clk);
+         wb_cyc = 1; wb_stb = 1; wb_we = we; wb_adr = adr; wb_dat_w = dat;
+         t = 0;
+         while (wb_stall) begin
+            @(negedge clk);
+            t = t + 1;
+            if (t > 100000) begin
+               $display("ERROR: stalled writing 0x%08x", adr);
+               $finish;
+            end
+         end
+         @(negedge clk);
+         wb_stb = 0;
+         while (!wb_ack) @(negedge clk);
+         q = wb_dat_r;
+         wb_cyc = 0;
+      end
+   endtask
+
+   task wb_write(input [31:0] adr, input [31:0] dat);
+      reg [31:0] q;
+      wb_access(1, adr, dat, q);
+   endtask
+
+   task wb_read(input [31:0] adr, output [31:0] q);
+      wb_access(0, adr, 0, q);
+   endtask
+
+   // TX ready of the pcie_altera queue, changes on the falling edge
+   always @(negedge clk) tx_rdy <= ($random & 7) != 0;
+
+   // pcie_tlp: starts a completion when not blocked, busy from the next cycle
+   integer busy_left = 0;
+   reg     start = 0;
+   always @(posedge clk) begin
+      start <= 0;
+      if (busy_left == 0 && !tx_block && ($random & 31) == 0) begin
+         start <= 1;
+         busy_left <= 4 + ($random & 15);
+      end else if (busy_left > 0)
+        busy_left <= busy_left - 1;
+   end
+   always @(negedge clk) tx_busy <= start || busy_left > 1;
+
+   // pcie_altera TX queue: collect the words of a TLP
+   reg [31:0] tlp [0:63];
+   reg        tlp_pad [0:63];
+   integer    tlp_n = 0;
+   reg        rdy_q = 0;
+
+   always @(posedge clk) begin
+      cycles = cycles + 1;
+      if (rstn) begin
+         if (tx_alloc !== tx_en) begin
+            $display("ERROR: alloc and en differ");
+            errors = errors + 1;
+         end
+         if (tx_en && !rdy_q) begin
+            $display("ERROR: word sent without ready");
+            errors = errors + 1;
+         end
+         if (tx_en && tx_busy) begin
+            $display("ERROR: DMA word while a completion is sent");
+            errors = errors + 1;
+         end
+         if (tx_en) begin
+            if (tlp_n > 40) begin
+               $display("ERROR: TLP does not fit in the TX queue");
+               $finish;
+            end
+            tlp[tlp_n] = tx_dat;
+            tlp_pad[tlp_n] = tx_pad;
+            tlp_n = tlp_n + 1;
+            if (tx_eop) begin
+               decode_tlp;
+               tlp_n = 0;
+            end
+         end
+      end
+      rdy_q <= tx_rdy;
+   end
+
+   task decode_tlp;
+      reg [63:0] addr;
+      integer    len, first, i;
+      begin
+         len = tlp[0][9:0];
+         addr = 0;
+         first = 0;
+         if (tlp[0][31:24] == 8'h40) begin
+            addr = {32'h0, tlp[2]};
+            if (tlp_pad[2] !== !addr[2]) begin
+               $display("ERROR: pad of the 3DW header 0x%016x", addr);
+               errors = errors + 1;
+            end
+            first = 3;
+         end else if (tlp[0][31:24] == 8'h60) begin
+            addr = {tlp[2], tlp[3]};
+            if (addr[63:32] == 0) begin
+               $display("ERROR: 4DW header below 4GB");
+               errors = errors + 1;
+            end
+            first = 4;
+            if (addr[2]) begin
+               if (tlp[4] !== 0) begin
+                  $display("ERROR: pad word of the 4DW header");
+                  errors = errors + 1;
+               end
+               first = 5;
+            end
+         end else begin
+            $display("ERROR: not a memory write: 0x%08x", tlp[0]);
+            errors = errors + 1;
+         end
+         if (tlp[0][23:10] !== 0 || tlp[1][31:16] !== {BUSDEV, 3'b000} ||
+             tlp[1][3:0] !== 4'hf || tlp[1][7:4] !== (len == 1 ? 4'h0 : 4'hf)) begin
+            $display("ERROR: header 0x%08x 0x%08x", tlp[0], tlp[1]);
+            errors = errors + 1;
+         end
+         if (tlp_n != first + len || len == 0) begin
+            $display("ERROR: length %0d, %0d words", len, tlp_n);
+            errors = errors + 1;
+         end
+         if (addr[11:0] + len*4 > 4096) begin
+            $display("ERROR: TLP at 0x%016x crosses 4KB", addr);
+            errors = errors + 1;
+         end
+         for (i = 0; i < len; i = i + 1)
+           hostmem[addr + i*4] = tlp[first + i];
+         tlps = tlps + 1;
+      end
+   endtask
+
+   // Host consumer: the ring up to the write-back pointer
+   reg [31:0] rdptr  = 0;
+   reg [31:0] expect = 0;
+
+   task consume;
+      reg [31:0] wrptr;
+      reg [63:0] a;
+      begin
+         wrptr = hostmem.exists(WBADDR) ? hostmem[WBADDR] : 0;
+         if (wrptr - rdptr > NBUF*BUFSIZE) begin
+            $display("ERROR: write pointer 0x%08x, read pointer 0x%08x", wrptr, rdptr);
+            errors = errors + 1;
+         end
+         while (rdptr != wrptr) begin
+            a = bufaddr[(rdptr >> BUFLOG2) & (NBUF-1)] + (rdptr & (BUFSIZE-1));
+            if (!hostmem.exists(a) || hostmem[a] !== expect) begin
+               $display("ERROR: word %0d at 0x%016x is 0x%08x", expect, a, hostmem.exists(a) ? hostmem[a] : 32'hx);
+               errors = errors + 1;
+            end
+            hostmem.delete(a);
+            expect = expect + 1;
+            rdptr = rdptr + 4;
+         end
+         wb_write(32'h014, rdptr);
+      end
+   endtask
+
+   integer    i, n, pushed;
+   reg [31:0] q;
+
+   initial begin
+      bufaddr[0] = 64'h0000_0000_1000_0000;
+      bufaddr[1] = 64'h0000_0001_2000_0100; // above 4GB
+      bufaddr[2] = 64'h0000_0000_1000_0f00; // last 256 bytes of a page
+      bufaddr[3] = 64'h0000_0002_0000_0000;
+
+      repeat(3) @(posedge clk);
+      rstn = 1;
+
+      wb_write(32'h008, (RINGLOG2 << 8) | BUFLOG2);
+      for (i = 0; i < NBUF; i = i + 1) begin
+         wb_write(32'h200 + i*8, bufaddr[i][31:0]);
+         wb_write(32'h204 + i*8, bufaddr[i][63:32]);
+      end
+      wb_write(32'h00c, FLUSH);
+      wb_write(32'h018, WBADDR[31:0]);
+      wb_write(32'h01c, WBADDR[63:32]);
+      wb_write(32'h000, 1);
+
+      pushed = 0;
+      while (expect < WORDS) begin
+         // a burst of data, sometimes a pause to flush partial TLPs
+         n = 1 + ($random & 63);
+         for (i = 0; i < n && pushed < WORDS; i = i + 1) begin
+            wb_write(32'h400 + ((pushed & 255) << 2), pushed);
+            pushed = pushed + 1;
+         end
+         if (($random & 3) == 0) repeat(FLUSH * 3) @(posedge clk);
+         consume;
+         if (cycles > 10000000) begin
+            $display("ERROR: timeout, %0d words received", expect);
+            errors = errors + 1;
+            break;
+         end
+      end
+
+      wb_read(32'h010, q);
+      if (q !== rdptr) begin
+         $display("ERROR: write pointer register 0x%08x, read 0x%08x", q, rdptr);
+         errors = errors + 1;
+      end
+      wb_read(32'h004, q);
+      if (q[15:0] !== 0) begin
+         $display("ERROR: %0d words left in the fifo", q[15:0]);
+         errors = errors + 1;
+      end
+      wb_read(32'h020, q);
+      $display("%0d words in %0d data TLPs, %0d TLPs with the write-backs, %0d cycles", expect, q, tlps, cycles);
+      if (errors == 0)
+        $display("PASS");
+      else
+        $display("FAIL: %0d errors", errors);
+      $finish;
+   end
+
+endmodule // main
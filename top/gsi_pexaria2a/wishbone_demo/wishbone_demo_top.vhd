@@ -79,7 +79,9 @@ component PatternGeneratorModule is
 
   component simplers232module is
 	generic(
-		CLOCK_FREQUENCY    : integer := 125000000
+		CLOCK_FREQUENCY    : integer := 125000000;
+		g_txfifosize       : integer := 256;
+		g_rxfifosize       : integer := 256
 	);
 	port(
 		clk_sys_i                              : in std_logic;
@@ -87,7 +89,9 @@ component PatternGeneratorModule is
 		gpio_slave_i                           : in t_wishbone_slave_in;
 		gpio_slave_o                           : out t_wishbone_slave_out;
 		serial_i                               : in std_logic;
-		serial_o                               : out std_logic
+		serial_o                               : out std_logic;
+		txirq_o                                : out std_logic;
+		rxirq_o                                : out std_logic
     );
   end component;
 
@@ -104,7 +108,11 @@ component BuTis_clock_generator is
 		BuTis_C2_o                             : out std_logic;
 		BuTis_T0_o                             : out std_logic;
 		BuTis_T0_timestamp_o                   : out std_logic;
-		error_o                                : out std_logic);
+		error_o                                : out std_logic;
+		decoder_clock_i                        : in  std_logic;
+		decoder_write_i                        : in  std_logic;
+		decoder_corrected_i                    : in  std_logic;
+		decoder_error_i                        : in  std_logic);
 end component;
 
 component TimestampDecoder is
@@ -124,12 +132,17 @@ component TimestampDecoder is
 		timestamp_o                              : out std_logic_vector(g_timestampbytes*8-1 downto 0);
 		timestamp_write_o                        : out std_logic;
 		corrected_o                              : out std_logic;
-		error_o                                  : out std_logic);
+		error_o                                  : out std_logic;
+		corrected_symbols_o                      : out std_logic_vector(3 downto 0);
+		T0_period_o                              : out std_logic_vector(15 downto 0);
+		linkstat_write_o                         : out std_logic);
 end component;
 
 component readTimestampModule is
 	generic(
-		g_timestampbytes                       : integer := 8
+		g_timestampbytes                       : integer := 8;
+		g_BuTis_ratio                          : integer := 2000;
+		g_BuTis_T0_precision                   : integer := 100
 	);
 	port(
 		clk_sys_i                              : in std_logic;
@@ -140,10 +153,49 @@ component readTimestampModule is
 		timestamp_i                            : in std_logic_vector(g_timestampbytes*8-1 downto 0);
 		timestamp_write_i                      : in std_logic;
 		timestamp_corrected_i                  : in std_logic;
-		timestamp_error_i                      : in std_logic
+		timestamp_error_i                      : in std_logic;
+		corrected_symbols_i                    : in std_logic_vector(3 downto 0);
+		T0_period_i                            : in std_logic_vector(15 downto 0);
+		linkstat_write_i                       : in std_logic
     );
 end component;
 
+component InputCaptureModule is
+	generic(
+		g_channels                             : integer := 4;
+		g_fifosize                             : integer := 2048;
+		g_deadtime                             : integer := 12
+	);
+	port(
+		clk_sys_i                              : in std_logic;
+		rst_n_i                                : in std_logic;
+		gpio_slave_i                           : in t_wishbone_slave_in;
+		gpio_slave_o                           : out t_wishbone_slave_out;
+		BuTis_C2_i                             : in std_logic;
+		clock500MHz_i                          : in std_logic;
+		clock500MHz_locked_i                   : in std_logic;
+		timestamp_i                            : in std_logic_vector(63 downto 0);
+		timestamp_write_i                      : in std_logic;
+		BuTis_T0_i                             : in std_logic;
+		inputs_i                               : in std_logic_vector(g_channels-1 downto 0)
+    );
+end component;
+
+component PLL125MHz500MHz IS
+	PORT
+	(
+		areset		: IN STD_LOGIC  := '0';
+		inclk0		: IN STD_LOGIC  := '0';
+		phasecounterselect		: IN STD_LOGIC_VECTOR (3 DOWNTO 0) :=  (OTHERS => '0');
+		phasestep		: IN STD_LOGIC  := '0';
+		phaseupdown		: IN STD_LOGIC  := '0';
+		scanclk		: IN STD_LOGIC  := '1';
+		c0		: OUT STD_LOGIC ;
+		locked		: OUT STD_LOGIC ;
+		phasedone		: OUT STD_LOGIC 
+	);
+end component;
+
 component FlashUpdateModule is
 	port(
 		clk_sys_i                              : in std_logic;
@@ -151,7 +203,8 @@ component FlashUpdateModule is
 		rst_n_i                                : in std_logic;
 		gpio_slave_i                           : in t_wishbone_slave_in;
 		gpio_slave_o                           : out t_wishbone_slave_out;
-		watchdog_reset_i                       : in std_logic
+		watchdog_reset_i                       : in std_logic;
+		irq_o                                  : out std_logic
     );
 end component;
 
@@ -212,7 +265,7 @@ end component;
     wbd_width     => x"4", -- 8/16/32-bit port granularity
     sdb_component => (
     addr_first    => x"0000000000000000",
-    addr_last     => x"000000000000000f", -- four 4 byte registers
+    addr_last     => x"00000000000000ff", -- six 4 byte registers and phase tracker trace buffer from 0x80
     product => (
     vendor_id     => x"0000000000000651", -- GSI
     device_id     => x"35aa6b98",
@@ -228,11 +281,11 @@ end component;
     wbd_width     => x"4", -- 8/16/32-bit port granularity
     sdb_component => (
     addr_first    => x"0000000000000000",
-    addr_last     => x"000000000000001f", -- five 4 byte registers
+    addr_last     => x"000000000000001f", -- eight 4 byte registers
     product => (
     vendor_id     => x"0000000000000651", -- GSI
     device_id     => x"35aa6b99",
-    version       => x"00000001",
+    version       => x"00000002",
     date          => x"20120830",
     name          => "KVI_RS232          ")));
 
@@ -244,7 +297,7 @@ end component;
     wbd_width     => x"4", -- 8/16/32-bit port granularity
     sdb_component => (
     addr_first    => x"0000000000000000",
-    addr_last     => x"000000000000001f", -- six 4 byte registers
+    addr_last     => x"00000000000000ff", -- six 4 byte registers and histogram block from 0x80
     product => (
     vendor_id     => x"0000000000000651", -- GSI
     device_id     => x"35aa6b9a",
@@ -267,9 +320,84 @@ end component;
     version       => x"00000001",
     date          => x"20120830",
     name          => "KVI_FLASHUPDATE    ")));
+
+   constant c_xwb_inputCapture_sdb : t_sdb_device := (
+    abi_class     => x"0000", -- undocumented device
+    abi_ver_major => x"01",
+    abi_ver_minor => x"00",
+    wbd_endian    => c_sdb_endian_big,
+    wbd_width     => x"4", -- 8/16/32-bit port granularity
+    sdb_component => (
+    addr_first    => x"0000000000000000",
+    addr_last     => x"00000000000000ff", -- four 4 byte registers and fifo block from 0x80
+    product => (
+    vendor_id     => x"0000000000000651", -- GSI
+    device_id     => x"35aa6b9c",
+    version       => x"00000001",
+    date          => x"20121024",
+    name          => "KVI_INPUTCAPTURE   ")));
+
+   constant c_xwb_vic_sdb : t_sdb_device := (
+    abi_class     => x"0000", -- undocumented device
+    abi_ver_major => x"01",
+    abi_ver_minor => x"00",
+    wbd_endian    => c_sdb_endian_big,
+    wbd_width     => x"4", -- 8/16/32-bit port granularity
+    sdb_component => (
+    addr_first    => x"0000000000000000",
+    addr_last     => x"00000000000000ff", -- eight 4 byte registers and vector table from 0x80
+    product => (
+    vendor_id     => x"000000000000CE42", -- CERN
+    device_id     => x"00000013",
+    version       => x"00000001",
+    date          => x"20121024",
+    name          => "WB-VIC-Int.Control ")));
+
+   constant c_xwb_tics_sdb : t_sdb_device := (
+    abi_class     => x"0000", -- undocumented device
+    abi_ver_major => x"01",
+    abi_ver_minor => x"00",
+    wbd_endian    => c_sdb_endian_big,
+    wbd_width     => x"4", -- 8/16/32-bit port granularity
+    sdb_component => (
+    addr_first    => x"0000000000000000",
+    addr_last     => x"000000000000000f", -- tics counter, interrupt period and interrupt status
+    product => (
+    vendor_id     => x"0000000000000651", -- GSI
+    device_id     => x"35aa6b9d",
+    version       => x"00000001",
+    date          => x"20121025",
+    name          => "WB-Tics-Timer      ")));
+
+   constant c_pcie_dma_sdb : t_sdb_device := (
+    abi_class     => x"0000", -- undocumented device
+    abi_ver_major => x"01",
+    abi_ver_minor => x"00",
+    wbd_endian    => c_sdb_endian_big,
+    wbd_width     => x"4", -- 32-bit port granularity
+    sdb_component => (
+    addr_first    => x"0000000000000000",
+    addr_last     => x"00000000000007ff", -- registers, buffer descriptors and data window
+    product => (
+    vendor_id     => x"0000000000000651", -- GSI
+    device_id     => x"35aa6b9e",
+    version       => x"00000001",
+    date          => x"20261019",
+    name          => "WB-PCIe-DMA        ")));
+	 
+	 -- Debug bus behind slave 13: statistics, bus monitor and program counter sampler.
+	 -- A bridge keeps the SDB ROM of the top crossbar at 16 records (1KB below the gpio).
+  constant c_dbg_slaves : natural := 3;
+  constant c_dbg_layout : t_sdb_record_array(c_dbg_slaves-1 downto 0) :=
+   (0 => f_sdb_embed_device(c_xwb_crossbar_stats_sdb,  x"00000400"),
+    1 => f_sdb_embed_device(c_xwb_bus_monitor_sdb,     x"00000800"),
+    2 => f_sdb_embed_device(c_xwb_pc_sampler_sdb,      x"00000c00"));
+  constant c_dbg_sdb_address : t_wishbone_address := x"00000000";
+  constant c_dbg_bridge_sdb : t_sdb_bridge := 
+    f_xwb_bridge_layout_sdb(true, c_dbg_layout, c_dbg_sdb_address);
 	 
 	 -- Top crossbar layout
-  constant c_slaves : natural := 9;
+  constant c_slaves : natural := 14;
   constant c_masters : natural := 5;
   constant c_dpram_size : natural := 16384; -- in 32-bit words (64KB)
   constant c_layout : t_sdb_record_array(c_slaves-1 downto 0) :=
@@ -281,7 +409,12 @@ end component;
 	 5 => f_sdb_embed_device(c_xwb_BuTiSclock_sdb,      x"00110500"),
 	 6 => f_sdb_embed_device(c_xwb_simplers232_sdb,     x"00110600"),
 	 7 => f_sdb_embed_device(c_xwb_readTimestamp_sdb,   x"00110700"),
-	 8 => f_sdb_embed_device(c_xwb_flashUpdate_sdb,     x"00110800")
+	 8 => f_sdb_embed_device(c_xwb_flashUpdate_sdb,     x"00110800"),
+	 9 => f_sdb_embed_device(c_xwb_inputCapture_sdb,    x"00110900"),
+	10 => f_sdb_embed_device(c_xwb_vic_sdb,             x"00110a00"),
+	11 => f_sdb_embed_device(c_xwb_tics_sdb,            x"00110b00"),
+	12 => f_sdb_embed_device(c_pcie_dma_sdb,            x"00111000"),
+	13 => f_sdb_embed_bridge(c_dbg_bridge_sdb,          x"00112000")
 	 );
   constant c_sdb_address : t_wishbone_address := x"00100000";
   constant WATCHDOGTIME : integer := 1000;
@@ -290,9 +423,28 @@ end component;
   signal cbar_slave_o  : t_wishbone_slave_out_array(c_masters-1 downto 0);
   signal cbar_master_i : t_wishbone_master_in_array(c_slaves-1 downto 0);
   signal cbar_master_o : t_wishbone_master_out_array(c_slaves-1 downto 0);
+  
+  -- Busses watched by the bus monitor
+  constant c_taps : natural := 6;
+  signal tap_master : t_wishbone_master_out_array(c_taps-1 downto 0);
+  signal tap_slave  : t_wishbone_master_in_array(c_taps-1 downto 0);
+  
+  signal dbg_master_i : t_wishbone_master_in_array(c_dbg_slaves-1 downto 0);
+  signal dbg_master_o : t_wishbone_master_out_array(c_dbg_slaves-1 downto 0);
+  signal lm32_pc, lm32_ra : t_wishbone_address;
 
   signal clk_sys, clk_cal, rstn, locked : std_logic;
   signal lm32_interrupt : std_logic_vector(31 downto 0);
+  constant c_vic_irqs : natural := 8;
+  signal vic_slave_o : t_wishbone_slave_out;
+  signal vic_slave_i : t_wishbone_slave_in;
+  signal vic_irqs_s : std_logic_vector(c_vic_irqs-1 downto 0) := (others => '0');
+  signal host_irqs_s : std_logic_vector(30 downto 0) := (others => '0');
+  signal dma_irq_s : std_logic := '0';
+  signal rs232_txirq_s : std_logic := '0';
+  signal rs232_rxirq_s : std_logic := '0';
+  signal tics_irq_s : std_logic := '0';
+  signal flash_irq_s : std_logic := '0';
   
   signal gpio_slave_o : t_wishbone_slave_out;
   signal gpio_slave_i : t_wishbone_slave_in;
@@ -326,6 +478,12 @@ end component;
   signal flashUpdate_slave_i : t_wishbone_slave_in;
   signal watchdog_reset_timer_s : std_logic := '0';
   
+  signal inputCapture_slave_o : t_wishbone_slave_out;
+  signal inputCapture_slave_i : t_wishbone_slave_in;
+  signal clock500MHz_s : std_logic := '0';
+  signal clock500MHz_locked_s : std_logic := '0';
+  signal capture_inputs_s : std_logic_vector(3 downto 0) := (others => '0');
+  
   signal BuTis_C2_s : std_logic := '0';
   signal clock200MHz_S : std_logic := '0';
   signal clock100MHz_S : std_logic := '0';
@@ -343,6 +501,9 @@ end component;
   signal decoder_corrected_s : std_logic := '0';
   signal decoder_error_s : std_logic := '0';
   signal timestamp_s  : std_logic_vector(63 downto 0) := (others => '0');
+  signal decoder_corrected_symbols_s : std_logic_vector(3 downto 0) := (others => '0');
+  signal decoder_T0_period_s : std_logic_vector(15 downto 0) := (others => '0');
+  signal decoder_linkstat_write_s : std_logic := '0';
  
   signal clock200MHzdiv2_s : std_logic := '0';
   signal clk_sysdiv2_s : std_logic := '0';
@@ -382,7 +543,12 @@ attribute keep of clk_sys: signal is true;
      g_registered  => true,
      g_wraparound  => false, -- Should be true for nested buses
      g_layout      => c_layout,
-     g_sdb_addr    => c_sdb_address)
+     g_sdb_addr    => c_sdb_address,
+     -- The LM32 (masters 1 and 2) wins over PCIe and DMA, the DMA (masters 3 and 4) yields
+     -- its slave to the LM32: pulse and phase control have a bounded latency under bulk load
+     g_qos_realtime => x"00000006",
+     g_qos_preempt  => x"00000018",
+     g_stats        => true)
    port map(
      clk_sys_i     => clk_sys,
      rst_n_i       => rstn,
@@ -391,7 +557,27 @@ attribute keep of clk_sys: signal is true;
      slave_o       => cbar_slave_o,
      -- Slave connections (INTERCON is a master)
      master_i      => cbar_master_i,
-     master_o      => cbar_master_o);
+     master_o      => cbar_master_o,
+     -- Statistics of the crossbar on the debug bus
+     stats_i       => dbg_master_o(0),
+     stats_o       => dbg_master_i(0));
+  
+  -- Slave 13 is the debug bus
+  debug : xwb_sdb_crossbar
+   generic map(
+     g_num_masters => 1,
+     g_num_slaves  => c_dbg_slaves,
+     g_registered  => true,
+     g_wraparound  => true,
+     g_layout      => c_dbg_layout,
+     g_sdb_addr    => c_dbg_sdb_address)
+   port map(
+     clk_sys_i     => clk_sys,
+     rst_n_i       => rstn,
+     slave_i(0)    => cbar_master_o(13),
+     slave_o(0)    => cbar_master_i(13),
+     master_i      => dbg_master_i,
+     master_o      => dbg_master_o);
   
   -- Master 0 is the PCIe bridge
   PCIe : pcie_wb
@@ -407,7 +593,10 @@ attribute keep of clk_sys: signal is true;
       pcie_tx_o     => pcie_tx_o,
       wb_clk        => clk_sys,       -- Desired clock for the WB bus
       master_o      => cbar_slave_i(0),
-      master_i      => cbar_slave_o(0));
+      master_i      => cbar_slave_o(0),
+      dma_slave_i   => cbar_master_o(12), -- slave 12: DMA into host memory
+      dma_slave_o   => cbar_master_i(12),
+      irq_i         => host_irqs_s);      -- MSI to the host, same bits as the VIC
   
   -- The LM32 is master 1+2
   LM32 : xwb_lm32
@@ -420,13 +609,28 @@ attribute keep of clk_sys: signal is true;
       dwb_o     => cbar_slave_i(1), -- Data bus
       dwb_i     => cbar_slave_o(1),
       iwb_o     => cbar_slave_i(2), -- Instruction bus
-      iwb_i     => cbar_slave_o(2));
+      iwb_i     => cbar_slave_o(2),
+      pc_o      => lm32_pc,         -- Program counter sampling
+      ra_o      => lm32_ra);
+  
+  -- The program counter sampler is slave 2 of the debug bus
+  pc_sampler : xwb_pc_sampler
+    port map(
+      clk_sys_i => clk_sys,
+      rst_n_i   => rstn,
+      pc_i      => lm32_pc,
+      ra_i      => lm32_ra,
+      slave_i   => dbg_master_o(2),
+      slave_o   => dbg_master_i(2));
   
-  -- The other 31 interrupt pins are unconnected
+  -- LM32 interrupt 0 is the vectored interrupt controller, the other 31 interrupt pins are unconnected
   lm32_interrupt(31 downto 1) <= (others => '0');
   
-  -- A DMA controller is master 3+4, slave 2, and interrupt 0
+  -- A DMA controller is master 3+4, slave 2, and VIC interrupt 0
+  -- 32 words in flight, so that the copy streams from slaves with a latency of up to 30 cycles
   dma : xwb_dma
+    generic map(
+      logRingLen  => 5)
     port map(
       clk_i       => clk_sys,
       rst_n_i     => rstn,
@@ -436,7 +640,33 @@ attribute keep of clk_sys: signal is true;
       r_master_o  => cbar_slave_i(3),
       w_master_i  => cbar_slave_o(4),
       w_master_o  => cbar_slave_i(4),
-      interrupt_o => lm32_interrupt(0));
+      interrupt_o => dma_irq_s);
+  
+  -- Slave 1 of the debug bus counts the traffic and the latency of the busiest masters and slaves
+  -- Taps: 0 PCIe, 1 LM32 data, 2 DMA read, 3 DMA write (master ports), 4 RAM, 5 flash (slave ports)
+  tap_master(0) <= cbar_slave_i(0);
+  tap_slave(0)  <= cbar_slave_o(0);
+  tap_master(1) <= cbar_slave_i(1);
+  tap_slave(1)  <= cbar_slave_o(1);
+  tap_master(2) <= cbar_slave_i(3);
+  tap_slave(2)  <= cbar_slave_o(3);
+  tap_master(3) <= cbar_slave_i(4);
+  tap_slave(3)  <= cbar_slave_o(4);
+  tap_master(4) <= cbar_master_o(0);
+  tap_slave(4)  <= cbar_master_i(0);
+  tap_master(5) <= cbar_master_o(8);
+  tap_slave(5)  <= cbar_master_i(8);
+  
+  busmon : xwb_bus_monitor
+    generic map(
+      g_taps       => c_taps)
+    port map(
+      clk_sys_i    => clk_sys,
+      rst_n_i      => rstn,
+      tap_master_i => tap_master,
+      tap_slave_i  => tap_slave,
+      slave_i      => dbg_master_o(1),
+      slave_o      => dbg_master_i(1));
   
   -- Slave 0 is the RAM
   ram : xwb_dpram
@@ -484,11 +714,11 @@ attribute keep of clk_sys: signal is true;
 			end if;
       end if;
       if gpio_slave_i.adr(2) = '0' then
-        gpio_slave_o.dat(31 downto 1) <= (others => '0');
-        gpio_slave_o.dat(0) <= r_reset;
-      else
         gpio_slave_o.dat(31 downto 8) <= (others => '0');
         gpio_slave_o.dat(7 downto 0) <= r_leds;
+      else
+        gpio_slave_o.dat(31 downto 1) <= (others => '0');
+        gpio_slave_o.dat(0) <= r_reset;
       end if;
     end if;
   end process;
@@ -637,7 +867,11 @@ BuTis_clock_generator1: BuTis_clock_generator port map(
 		BuTis_C2_o => BuTis_C2_s,
 		BuTis_T0_o => BuTis_T0_s,
 		BuTis_T0_timestamp_o => BuTis_T0_out_s,
-		error_o => encoder_error_s);
+		error_o => encoder_error_s,
+		decoder_clock_i => clock200MHz_s,
+		decoder_write_i => timestamp_write_s,
+		decoder_corrected_i => decoder_corrected_s,
+		decoder_error_i => decoder_error_s);
 	 
  -- slave 6 is rs232
   simplers232_slave_i <= cbar_master_o(6);
@@ -648,7 +882,9 @@ simplers232module1: simplers232module port map(
 		gpio_slave_i => simplers232_slave_i,
 		gpio_slave_o => simplers232_slave_o,
 		serial_i => serial_in_s,
-		serial_o => serial_out_s
+		serial_o => serial_out_s,
+		txirq_o => rs232_txirq_s,
+		rxirq_o => rs232_rxirq_s
     );
  	 
 
@@ -682,7 +918,10 @@ TimestampDecoder1: TimestampDecoder port map(
 		timestamp_o => timestamp_s,
 		timestamp_write_o => timestamp_write_s,
 		corrected_o => decoder_corrected_s,
-		error_o => decoder_error_s);
+		error_o => decoder_error_s,
+		corrected_symbols_o => decoder_corrected_symbols_s,
+		T0_period_o => decoder_T0_period_s,
+		linkstat_write_o => decoder_linkstat_write_s);
 
 -- slave 7 is rs232
   readTimestamp_slave_i <= cbar_master_o(7);
@@ -696,7 +935,10 @@ readTimestampModule1: readTimestampModule port map(
 		timestamp_i => timestamp_s,
 		timestamp_write_i => timestamp_write_s,
 		timestamp_corrected_i => decoder_corrected_s,
-		timestamp_error_i => decoder_error_s);
+		timestamp_error_i => decoder_error_s,
+		corrected_symbols_i => decoder_corrected_symbols_s,
+		T0_period_i => decoder_T0_period_s,
+		linkstat_write_i => decoder_linkstat_write_s);
 		
 serialsync_process : process(clock200MHz_s)
 begin
@@ -714,7 +956,79 @@ FlashUpdateModule1: FlashUpdateModule port map(
 		rst_n_i => rstn,
 		gpio_slave_i => flashUpdate_slave_i,
 		gpio_slave_o => flashUpdate_slave_o,
-		watchdog_reset_i => watchdog_reset_timer_s);
+		watchdog_reset_i => watchdog_reset_timer_s,
+		irq_o => flash_irq_s);
+
+-- slave 9 is input capture
+  inputCapture_slave_i <= cbar_master_o(9);
+  cbar_master_i(9) <= inputCapture_slave_o;
+-- The 500MHz sampling clock has the same reference as the BuTiS C2 clock of the capture (clock200MHz_s):
+-- both come from the 125MHz oscillator, clock200MHz_s as c2 of sys_pll_inst next to clk_sys (c0, same VCO),
+-- the 500MHz clock from clk_sys. Both PLLs are in normal mode and compensate their output to their input,
+-- so the edges of the 200MHz and the 500MHz clock coincide every 10ns with the same phase after every lock.
+-- The capture waits for the lock of this PLL.
+PLL125MHz500MHz1: PLL125MHz500MHz port map(
+		areset => reset_s,
+		inclk0 => clk_sys,
+		scanclk => clk_cal,
+		c0 => clock500MHz_s,
+		locked => clock500MHz_locked_s,
+		phasedone => open);
+
+-- capture channels: trigger input, BuTiS T0 input, PPS pulse and single pulse generator output
+capture_inputs_s(0) <= triggerin_s;
+capture_inputs_s(1) <= BuTis_T0_in_s;
+capture_inputs_s(2) <= wr_PPSpulse_s;
+capture_inputs_s(3) <= pulse_s;
+InputCaptureModule1: InputCaptureModule port map(
+		clk_sys_i => clk_sys,
+		rst_n_i => rstn,
+		gpio_slave_i => inputCapture_slave_i,
+		gpio_slave_o => inputCapture_slave_o,
+		BuTis_C2_i => clock200MHz_s,
+		clock500MHz_i => clock500MHz_s,
+		clock500MHz_locked_i => clock500MHz_locked_s,
+		timestamp_i => timestamp_s,
+		timestamp_write_i => timestamp_write_s,
+		BuTis_T0_i => BuTis_T0_rec_s,
+		inputs_i => capture_inputs_s);
+
+-- slave 10 is the vectored interrupt controller: interrupt 0 is the DMA controller, 1 and 2 are rs232 transmit and receive, 3 is the tics timer, 4 is the flash update module
+  vic_slave_i <= cbar_master_o(10);
+  cbar_master_i(10) <= vic_slave_o;
+  vic_irqs_s(0) <= dma_irq_s;
+  vic_irqs_s(1) <= rs232_txirq_s;
+  vic_irqs_s(2) <= rs232_rxirq_s;
+  vic_irqs_s(3) <= tics_irq_s;
+  vic_irqs_s(4) <= flash_irq_s;
+  vic_irqs_s(c_vic_irqs-1 downto 5) <= (others => '0');
+  host_irqs_s(4 downto 0) <= vic_irqs_s(4 downto 0);
+vic1: xwb_vic
+   generic map(
+     g_interface_mode      => PIPELINED,
+     g_address_granularity => BYTE,
+     g_num_interrupts      => c_vic_irqs)
+   port map(
+     clk_sys_i    => clk_sys,
+     rst_n_i      => rstn,
+     slave_i      => vic_slave_i,
+     slave_o      => vic_slave_o,
+     irqs_i       => vic_irqs_s,
+     irq_master_o => lm32_interrupt(0));
+
+-- slave 11 is the usec tics counter with periodic interrupt, used as time base for the firmware scheduler
+tics1: xwb_tics
+   generic map(
+     g_interface_mode      => PIPELINED,
+     g_address_granularity => BYTE,
+     g_period              => 125) -- 125MHz system clock: 1 usec tics
+   port map(
+     clk_sys_i => clk_sys,
+     rst_n_i   => rstn,
+     slave_i   => cbar_master_o(11),
+     slave_o   => cbar_master_i(11),
+     desc_o    => open,
+     irq_o     => tics_irq_s);
 
 -- module to generate watchdog signal, only used for testing
 watchdogresetprocess: process(clock20MHz_s)